@@ -63,7 +63,8 @@
 
 AbstractTask::AbstractTask() :
 	pid(0), accTime(), accPct(0), cursorTime(), cursorPct(0), isNew(true),
-	offset(0), scale(0), graph(nullptr), horizontalDelayBars(nullptr)
+	hasTail(false), offset(0), scale(0), graph(nullptr),
+	horizontalDelayBars(nullptr)
 {}
 
 AbstractTask::~AbstractTask()
@@ -83,6 +84,16 @@ bool AbstractTask::doScale()
 	return false; /* No error */
 }
 
+void AbstractTask::removeTail()
+{
+	if (!hasTail)
+		return;
+	schedTimev.removeLast();
+	schedData.removeLast();
+	schedEventIdx.removeLast();
+	hasTail = false;
+}
+
 bool AbstractTask::doStats()
 {
 	int startidx, endidx;
@@ -92,8 +103,9 @@ bool AbstractTask::doStats()
 	vtl::Time delta;
 	int s = schedEventIdx.size();
 	unsigned int prevState;
-	vtl::Time prevTime;
-	vtl::Time t;
+	vtl::CompactTime prevTime;
+	vtl::CompactTime t;
+	vtl::CompactTime sum;
 	unsigned int state;
 
 	accTime = ABSTRACT_TASK_TIME_ZERO;
@@ -150,11 +162,12 @@ bool AbstractTask::doStats()
 		t = (*events)[schedEventIdx[i]].time;
 		state = schedData.read(i);
 		if (SCHED_BIT == prevState) {
-			accTime += t - prevTime;
+			sum += t - prevTime;
 		}
 		prevTime = t;
 		prevState = state;
 	}
+	accTime += sum;
 
 	if (prevTime < end && prevState == SCHED_BIT) {
 		accTime += end - prevTime;
@@ -172,8 +185,9 @@ bool AbstractTask::doStatsTimeLimited()
 	vtl::Time delta;
 	int s = schedEventIdx.size();
 	unsigned int prevState;
-	vtl::Time prevTime;
-	vtl::Time t;
+	vtl::CompactTime prevTime;
+	vtl::CompactTime t;
+	vtl::CompactTime sum;
 	unsigned int state;
 
 	cursorTime = ABSTRACT_TASK_TIME_ZERO;
@@ -245,11 +259,12 @@ bool AbstractTask::doStatsTimeLimited()
 		t = (*events)[schedEventIdx[i]].time;
 		state = schedData.read(i);
 		if (SCHED_BIT == prevState) {
-			cursorTime += t - prevTime;
+			sum += t - prevTime;
 		}
 		prevTime = t;
 		prevState = state;
 	}
+	cursorTime += sum;
 
 	if (prevTime < end && prevState == SCHED_BIT) {
 		cursorTime += end - prevTime;
@@ -335,7 +350,7 @@ int AbstractTask::binarySearch_(const vtl::Time &time, int lowerIdx,
 {
 	int pivot = (lowerIdx + higherIdx) / 2;
 	int width = higherIdx - lowerIdx;
-	const vtl::Time &pTime = (*events)[schedEventIdx[pivot]].time;
+	const vtl::CompactTime &pTime = (*events)[schedEventIdx[pivot]].time;
 	bool pSmaller = pTime < time;
 
 	if (width < 2) {
@@ -361,7 +376,7 @@ int AbstractTask::findLower(const vtl::Time &time)
 	int idxmax = schedEventIdx.size() - 1;
 	int idx = binarySearch_(time, 0, idxmax);
 
-	vtl::Time idxtime = (*events)[schedEventIdx[idx]].time;
+	vtl::CompactTime idxtime = (*events)[schedEventIdx[idx]].time;
 	/*
 	 * In normal circumstances this could only do one loop iteration but
 	 * if we have many identical timestamps, we could end up in a situation
@@ -381,7 +396,7 @@ int AbstractTask::findHigher(const vtl::Time &time)
 	int idxmax = schedEventIdx.size() - 1;
 	int idx = binarySearch_(time, 0, idxmax);
 
-	vtl::Time idxtime = (*events)[schedEventIdx[idx]].time;
+	vtl::CompactTime idxtime = (*events)[schedEventIdx[idx]].time;
 	/*
 	 * In normal circumstances this could only do one loop iteration but
 	 * if we have many identical timestamps, we could end up in a situation
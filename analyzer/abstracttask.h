@@ -110,6 +110,13 @@ public:
 	/* Only used during extraction */
 	bool isNew;
 
+	/*
+	 * This is true if the last sched data is a tail that extends the task
+	 * until the end of the trace, it is removed before the processing of
+	 * a trace that is followed continues.
+	 */
+	bool hasTail;
+
 	/* These are for scaling purposes */
 	double offset;
 	double scale;
@@ -121,6 +128,7 @@ public:
 	bool doScaleRunning();
 	bool doScalePreempted();
 	bool doScaleUnint();
+	void removeTail();
 
 	static void setCursorTime(enum TShark::CursorIdx cursor,
 				  const vtl::Time &time);
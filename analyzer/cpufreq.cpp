@@ -52,6 +52,10 @@
 
 #include "analyzer/cpufreq.h"
 
+CpuFreq::CpuFreq() :
+	offset(0), scale(0), hasTail(false)
+{}
+
 bool CpuFreq::doScale()
 {
 	int i;
@@ -61,3 +65,12 @@ bool CpuFreq::doScale()
 		scaledData[i] = data[i] * scale + offset;
 	return false; /* No error */	
 }
+
+void CpuFreq::removeTail()
+{
+	if (!hasTail)
+		return;
+	timev.removeLast();
+	data.removeLast();
+	hasTail = false;
+}
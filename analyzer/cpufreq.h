@@ -57,12 +57,16 @@
 
 class CpuFreq {
 public:
+	CpuFreq();
 	QVector<double> timev;
 	QVector<double> data;
 	QVector<double> scaledData;
 	double offset;
 	double scale;
+	/* The last data is a tail that extends it until the end of the trace */
+	bool hasTail;
 	bool doScale();
+	void removeTail();
 };
 
 #endif /* CPUFREQ_H*/
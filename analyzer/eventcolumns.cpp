@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "analyzer/eventcolumns.h"
+
+EventColumns::EventColumns()
+{}
+
+/*
+ * The elements of a TList are stored in maps of TLIST_MAP_NR_ELEMENTS
+ * elements, so the scans below run over one map at a time with a plain pointer.
+ */
+
+/*
+ * Returns the greatest index that is not greater than from and that has the
+ * type type1 or type2, or -1 if there is none.
+ */
+int EventColumns::findPrevType(int from, event_t type1, event_t type2) const
+{
+	const event_t *ptr;
+	int first;
+	int i;
+
+	if (from >= types.size())
+		from = types.size() - 1;
+
+	for (i = from; i >= 0; i = first - 1) {
+		first = i & ~TLIST_MAP_ELEMENT_MASK;
+		ptr = &types.at(first);
+		for (; i >= first; i--) {
+			if (ptr[i - first] == type1 || ptr[i - first] == type2)
+				return i;
+		}
+	}
+	return -1;
+}
+
+/*
+ * Returns the smallest index that is not less than from and that has the type
+ * type, or -1 if there is none.
+ */
+int EventColumns::findNextType(int from, event_t type) const
+{
+	const event_t *ptr;
+	int s = types.size();
+	int end;
+	int i;
+
+	if (from < 0)
+		from = 0;
+
+	for (i = from; i < s; i = end) {
+		end = (i | TLIST_MAP_ELEMENT_MASK) + 1;
+		if (end > s)
+			end = s;
+		ptr = &types.at(i);
+		for (; i < end; i++, ptr++) {
+			if (*ptr == type)
+				return i;
+		}
+	}
+	return -1;
+}
+
+void EventColumns::clear()
+{
+	times.clear();
+	cpus.clear();
+	pids.clear();
+	types.clear();
+	nameIds.clear();
+}
@@ -82,8 +82,8 @@ public:
 		ORDER_REVERSE
 	} order_t;
 
-	vtl::Time time;
-	vtl::Time delay;
+	vtl::CompactTime time;
+	vtl::CompactTime delay;
 	int pid;
 	unsigned int place;
 	int sched_idx;
@@ -60,7 +60,7 @@ public:
 	int pid;
 	int oldcpu;
 	int newcpu;
-	vtl::Time time;
+	vtl::CompactTime time;
 };
 
 #endif /* MIGRATION */
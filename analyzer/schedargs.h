@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SCHEDARGS_H
+#define SCHEDARGS_H
+
+#include <climits>
+#include <cstdint>
+
+#include "misc/traceshark.h"
+#include "parser/traceevent.h"
+#include "vtl/compiler.h"
+
+/*
+ * The arguments of a scheduling event, decoded once by the analyzer, so that
+ * the argument strings don't need to be parsed again when the events are
+ * searched or filtered. There is one of these for every event, at the same
+ * index as the event. Which members are used depends on the event type:
+ *
+ * sched_switch:       pid = next pid, oldpid = prev pid, state = prev state
+ * sched_wakeup(_new): pid, cpu = target cpu, success
+ * sched_waking:       pid, cpu = target cpu
+ * sched_migrate_task: pid, cpu = destination cpu, origcpu
+ * sched_process_fork: pid = child pid, oldpid = parent pid
+ * sched_process_exit: pid
+ *
+ * For all other events, and for the events whose arguments could not be
+ * parsed, the pids are INT_MAX and the state is TASK_STATE_RUNNABLE.
+ */
+class SchedArgs {
+public:
+	int pid;
+	int oldpid;
+	uint16_t state;
+	uint16_t cpu;
+	uint16_t origcpu;
+	uint16_t flags;
+
+	enum : uint16_t {
+		FLAG_OK = 1,
+		FLAG_SUCCESS = 2,
+	};
+
+	/* CPUs that don't fit are stored as this, which is not valid */
+	static const uint16_t INVALID_CPU = UINT16_MAX;
+
+	vtl_always_inline void clear();
+	vtl_always_inline bool isOk() const;
+	vtl_always_inline bool isSuccess() const;
+	vtl_always_inline static uint16_t packCPU(unsigned int c);
+};
+
+static_assert(NR_CPUS_ALLOWED < SchedArgs::INVALID_CPU,
+	      "The CPUs don't fit in SchedArgs");
+static_assert(TASK_FLAG_MAX * 2 - 1 <= UINT16_MAX,
+	      "The task state doesn't fit in SchedArgs");
+
+vtl_always_inline void SchedArgs::clear()
+{
+	pid = INT_MAX;
+	oldpid = INT_MAX;
+	state = TASK_STATE_RUNNABLE;
+	cpu = INVALID_CPU;
+	origcpu = INVALID_CPU;
+	flags = 0;
+}
+
+vtl_always_inline bool SchedArgs::isOk() const
+{
+	return (flags & FLAG_OK) != 0;
+}
+
+vtl_always_inline bool SchedArgs::isSuccess() const
+{
+	return (flags & FLAG_SUCCESS) != 0;
+}
+
+vtl_always_inline uint16_t SchedArgs::packCPU(unsigned int c)
+{
+	return isValidCPU(c) ? (uint16_t) c : INVALID_CPU;
+}
+
+#endif /* SCHEDARGS_H */
@@ -188,6 +188,8 @@ vtl_always_inline void Task::generateGhostName(const Task *realtask)
 
 vtl_always_inline void Task::generateDisplayName()
 {
+	/* The name is generated again when a trace that is followed grows */
+	displayName->clear();
 	generateNameFromTask(this);
 }
 
@@ -62,6 +62,7 @@ extern "C" {
 }
 
 #include <cerrno>
+#include <cmath>
 
 #include <QtGlobal>
 #include <QList>
@@ -87,6 +88,7 @@ extern "C" {
 #include "threads/workthread.h"
 #include "threads/workitem.h"
 #include "threads/workqueue.h"
+#include "ui/migrationarrow.h"
 
 vtl_always_inline static int clib_open(const char *pathname, int flags,
 				       mode_t mode)
@@ -101,16 +103,23 @@ vtl_always_inline static int clib_close(int fd)
 
 TraceAnalyzer::TraceAnalyzer(const SettingStore *sstore)
 	: events(nullptr), cpuTaskMaps(nullptr), cpuFreq(nullptr),
-	  cpuIdle(nullptr), black(0, 0, 0), white(255, 255, 255),
-	  migrationOffset(0), migrationScale(0), maxCPU(0), nrCPUs(0),
+	  cpuIdle(nullptr), columns(nullptr), black(0, 0, 0),
+	  white(255, 255, 255), migrationOffset(0), migrationScale(0),
+	  maxCPU(0), nrCPUs(0),
 	  endTime(0, 6), startTime(0, 6), endTimeDbl(0), startTimeDbl(0),
 	  endTimeIdx(0), maxFreq(0), minFreq(0), maxIdleState(0),
 	  minIdleState(0), timePrecision(0), CPUs(nullptr),
 	  customPlot(nullptr), pidFilterInclusive(false),
 	  OR_pidFilterInclusive(false), setstor(sstore)
 {
-	taskNamePool = new StringPool<>(16384, 256);
+	taskNamePool = new InternPool<>(16384, 256);
 	parser = new TraceParser();
+	analysisThread = new WorkThread<TraceAnalyzer>
+		(QString("analysisThread"), this,
+		 &TraceAnalyzer::threadAnalyze);
+	canceled.store(false);
+	nrProcessed.store(0);
+	argCache = new ArgCache();
 	filterState.disableAll();
 	OR_filterState.disableAll();
 }
@@ -120,15 +129,43 @@ TraceAnalyzer::~TraceAnalyzer()
 	int dummy;
 
 	TraceAnalyzer::close(&dummy);
+	delete analysisThread;
+	delete argCache;
 	delete parser;
 	delete taskNamePool;
 }
 
 int TraceAnalyzer::open(const QString &fileName)
 {
-	int retval = parser->open(fileName);
-	if (retval == 0)
+	return open(QStringList(fileName));
+}
+
+/*
+ * Several files are merged into one trace, ordered by the timestamps of the
+ * events.
+ */
+int TraceAnalyzer::open(const QStringList &fileNames)
+{
+	int retval;
+
+	parser->setParallelParse(setstor->getValue(Setting::PARALLEL_PARSE)
+				 .boolv());
+	parser->setMappedLoad(setstor->getValue(Setting::MAPPED_LOAD).boolv());
+	parser->setLazyArgs(setstor->getValue(Setting::LAZY_ARGS).boolv());
+	parser->setIndexCache(setstor->getValue(Setting::INDEX_CACHE).boolv());
+	parser->setFollow(setstor->getValue(Setting::FOLLOW_TRACE).boolv());
+	parser->setRetentionPolicy(&retentionPolicy);
+	parser->setTimeWindow(&timeWindow);
+	parser->setLoadBuffers(setstor->getValue(Setting::LOAD_BUFFERS).intv(),
+			       setstor->getValue(Setting::LOAD_BUFFER_SIZE)
+			       .intv() * 1024 * 1024);
+	retval = parser->open(fileNames);
+	if (retval == 0) {
+		argCache->setTraceFile(parser->traceFile);
+		if (setstor->getValue(Setting::EVENT_COLUMNS).boolv())
+			columns = new EventColumns();
 		prepareDataStructures();
+	}
 	return retval;
 }
 
@@ -161,6 +198,11 @@ bool TraceAnalyzer::isOpen() const
 
 void TraceAnalyzer::close(int *ts_errno)
 {
+	/* In case that the processing was canceled and not waited for */
+	analysisThread->wait();
+	canceled.store(false, std::memory_order_relaxed);
+	nrProcessed.store(0, std::memory_order_relaxed);
+
 	if (cpuTaskMaps != nullptr) {
 		delete[] cpuTaskMaps;
 		cpuTaskMaps = nullptr;
@@ -190,10 +232,18 @@ void TraceAnalyzer::close(int *ts_errno)
 	migrations.clear();
 	colorMap.clear();
 	origColorMap.clear();
+	argCache->setTraceFile(nullptr);
+	/* This shares the elements of the list of the parser */
+	followEvents.clear();
 	parser->close(ts_errno);
 	taskNamePool->clear();
 	schedLatencies.clear();
 	wakeLatencies.clear();
+	schedArgs.clear();
+	if (columns != nullptr) {
+		delete columns;
+		columns = nullptr;
+	}
 }
 
 void TraceAnalyzer::resetProperties()
@@ -223,9 +273,84 @@ bool TraceAnalyzer::processTrace(const QMap<int, QColor> &cmap)
 	return colorizeTasks(cmap);
 }
 
+/*
+ * This starts the processing of the trace that has been opened in the
+ * analysisThread. The main thread can show the progress, while it calls
+ * waitForProcessing() until it returns true, and then finishProcessing() must
+ * be called. The statistics are computed after the processing, so doStats()
+ * does not need to be called.
+ */
+void TraceAnalyzer::startProcessing()
+{
+	resetProperties();
+	analysisThread->start();
+}
+
+/* Returns true if the processing has been completed or canceled */
+bool TraceAnalyzer::waitForProcessing(unsigned long time)
+{
+	return analysisThread->wait(time);
+}
+
+/*
+ * The colors are set from the main thread, because it may change them later.
+ * Returns true if the colors in cmap were used, like processTrace(). If the
+ * processing was canceled, then the trace should be closed instead.
+ */
+bool TraceAnalyzer::finishProcessing(const QMap<int, QColor> &cmap)
+{
+	analysisThread->wait();
+	if (isCanceled())
+		return false;
+	return colorizeTasks(cmap);
+}
+
+/*
+ * This may be called from any thread. The loading of the trace is stopped and
+ * the analysisThread stops processing after the current batch of events.
+ */
+void TraceAnalyzer::cancelProcessing()
+{
+	canceled.store(true, std::memory_order_relaxed);
+	parser->stopLoading();
+}
+
+bool TraceAnalyzer::isCanceled() const
+{
+	return canceled.load(std::memory_order_relaxed);
+}
+
+/* See TraceParser::getLoadProgress() */
+bool TraceAnalyzer::getLoadProgress(int64_t *loaded, int64_t *total) const
+{
+	return parser->getLoadProgress(loaded, total);
+}
+
+/* This may be called from any thread, while the trace is processed */
+int TraceAnalyzer::getNrProcessedEvents() const
+{
+	return nrProcessed.load(std::memory_order_relaxed);
+}
+
+void TraceAnalyzer::threadAnalyze()
+{
+	threadProcess();
+	if (!isCanceled())
+		doStats();
+}
+
 void TraceAnalyzer::threadProcess()
 {
+	bool eof;
+
 	parser->waitForTraceType();
+	if (parser->isFollowing()) {
+		/* The events that are appended later are processed later */
+		events = &followEvents;
+		AbstractTask::setEvents(events);
+		processFollowed(eof);
+		return;
+	}
 	events = parser->getEventsTList();
 	switch (getTraceType()) {
 	case TRACE_TYPE_FTRACE:
@@ -237,8 +362,141 @@ void TraceAnalyzer::threadProcess()
 	default:
 		return;
 	}
+	if (isCanceled())
+		return;
+	processSchedAddTail();
+	processFreqAddTail();
+}
+
+/* This sets the properties that depend on the end of the trace */
+void TraceAnalyzer::processEnd()
+{
+	timePrecision = guessTimePrecision();
+	vtl::CompactTime::setTracePrecision(timePrecision);
+	/* The start time was converted before the precision was known */
+	startTime.setPrecision(timePrecision);
+	AbstractTask::setStartTime(startTime);
+	endTime = events->last().time;
+	endTimeIdx = events->size() - 1;
+	AbstractTask::setEndTime(endTime);
+	endTimeDbl = endTime.toDouble();
+	nrCPUs = maxCPU + 1;
+}
+
+bool TraceAnalyzer::isFollowing() const
+{
+	return parser->isFollowing();
+}
+
+/*
+ * After this, the events that the parser has posted so far are the last ones,
+ * and processNewEvents() will report EOF after it has processed them.
+ */
+void TraceAnalyzer::stopFollowing()
+{
+	parser->stopFollowing();
+}
+
+/*
+ * This is called periodically from the mainthread when a trace is followed, in
+ * order to process the events that have been appended to it since the last
+ * call. The graphs of the tasks that are new are colorized but the colors of
+ * the old ones are not changed. Returns the number of new events.
+ */
+int TraceAnalyzer::processNewEvents(const QMap<int, QColor> &cmap, bool &eof)
+{
+	int n = processFollowed(eof);
+
+	if (n > 0) {
+		colorizeNewTasks(cmap);
+		if (isFiltered())
+			processAllFilters();
+	}
+	return n;
+}
+
+/*
+ * Processes the new events that the parser has posted without waiting for more.
+ * The tails of the tasks and CPU frequencies are removed first, so that the
+ * new events continue from where the data really ended, and then they are
+ * added again to extend the data until the new end of the trace.
+ */
+int TraceAnalyzer::processFollowed(bool &eof)
+{
+	int from = followEvents.size();
+	int n;
+
+	n = takeNewEvents(eof);
+	if (n <= 0)
+		return 0;
+
+	if (from == 0) {
+		startTime = followEvents[0].time;
+		AbstractTask::setStartTime(startTime);
+		startTimeDbl = startTime.toDouble();
+	}
+
+	removeTails();
+	switch (getTraceType()) {
+	case TRACE_TYPE_FTRACE:
+		processEvents(TRACE_TYPE_FTRACE, from, followEvents.size());
+		break;
+	case TRACE_TYPE_PERF:
+		processEvents(TRACE_TYPE_PERF, from, followEvents.size());
+		break;
+	default:
+		break;
+	}
+	processEnd();
 	processSchedAddTail();
 	processFreqAddTail();
+	return n;
+}
+
+/*
+ * Extends followEvents with the events that the parser has completed since the
+ * last call and returns their number. The elements of the list of the parser
+ * are never moved, so followEvents shares them and we can read the ones that
+ * have been posted while the parser appends to it. The last posted event is
+ * not taken until EOF, because the parser sets its postEventInfo when it
+ * parses the next event.
+ */
+int TraceAnalyzer::takeNewEvents(bool &eof)
+{
+	const vtl::TList<TraceEvent> *pevents;
+	int from = followEvents.size();
+	int index;
+
+	parser->pollNextIndex(eof, index);
+	pevents = parser->getEventsTList();
+	if (pevents == nullptr)
+		return 0;
+	if (!eof)
+		index--;
+	if (index <= from)
+		return 0;
+	followEvents.share(*pevents, index);
+	return index - from;
+}
+
+void TraceAnalyzer::removeTails()
+{
+	unsigned int cpu;
+
+	for (cpu = 0; cpu <= maxCPU; cpu++) {
+		DEFINE_CPUTASKMAP_ITERATOR(iter) = cpuTaskMaps[cpu].begin();
+		while (iter != cpuTaskMaps[cpu].end()) {
+			iter.value().removeTail();
+			iter++;
+		}
+		cpuFreq[cpu].removeTail();
+	}
+
+	DEFINE_TASKMAP_ITERATOR(iter) = taskMap.begin();
+	while (iter != taskMap.end()) {
+		iter.value().task->removeTail();
+		iter++;
+	}
 }
 
 void TraceAnalyzer::processSchedAddTail()
@@ -268,9 +526,16 @@ void TraceAnalyzer::processSchedAddTail()
 			task.schedTimev.append(endTimeDbl);
 			task.schedData.append(d);
 			task.schedEventIdx.append(endTimeIdx);
+			task.hasTail = true;
 		}
 	}
 
+	const QHash<int, QByteArray> &prescanNames =
+		parser->getPrescanNames();
+	QHash<int, QByteArray>::const_iterator piter;
+	const TString *pname;
+	TString tname;
+
 	DEFINE_TASKMAP_ITERATOR(iter) = taskMap.begin();
 	while (iter != taskMap.end()) {
 		Task &task = *iter.value().task;
@@ -278,6 +543,20 @@ void TraceAnalyzer::processSchedAddTail()
 		double lastTime;
 		int s = task.schedTimev.size();
 		iter++;
+		/*
+		 * If only a time window was loaded, then a task may be nameless
+		 * in the window but have a name from before it.
+		 */
+		if (task.taskName == nullptr && !prescanNames.isEmpty()) {
+			piter = prescanNames.find(task.pid);
+			if (piter != prescanNames.end()) {
+				tname.ptr = (char*) piter.value().constData();
+				tname.len = piter.value().size();
+				pname = taskNamePool->allocString(&tname, 0);
+				if (pname != nullptr)
+					task.addName(pname->ptr);
+			}
+		}
 		task.generateDisplayName();
 		if (s <= 0) {
 			if (task.isGhostAlias && !task.oneToManyError) {
@@ -303,6 +582,7 @@ void TraceAnalyzer::processSchedAddTail()
 		task.schedTimev.append(endTimeDbl);
 		task.schedData.append(d);
 		task.schedEventIdx.append(endTimeIdx);
+		task.hasTail = true;
 	}
 }
 
@@ -316,31 +596,34 @@ void TraceAnalyzer::processFreqAddTail()
 			double freq = cpuFreq[cpu].data.last();
 			cpuFreq[cpu].data.append(freq);
 			cpuFreq[cpu].timev.append(end);
+			cpuFreq[cpu].hasTail = true;
 		}
 	}
 }
 
+/*
+ * The events only store the nanoseconds of their time, so the precision is
+ * guessed from the number of decimals that a sample of them needs. A sample of
+ * a trace with microsecond precision will not all end with a zero, except with
+ * a negligible probability.
+ */
 unsigned int TraceAnalyzer::guessTimePrecision()
 {
+	const int nr_samples = 64;
 	int s = events->size();
-	int r, p;
+	unsigned int r, p;
+	int i;
 
 	r = 0;
-	if (s < 1)
-		return r;
-
-	p = events->at(0).time.getPrecision();
-	if (p > r)
-		r = p;
-
-	p = events->at(s / 2).time.getPrecision();
-	if (p > r)
-		r = p;
-
-	p = events->at(s - 1).time.getPrecision();
-	if (p > r)
-		r = p;
-
+	for (i = 0; i < nr_samples && i < s; i++) {
+		/* Spread the samples evenly, from the first to the last event */
+		int idx = s <= nr_samples ? i :
+			(int) ((int64_t) (s - 1) * i / (nr_samples - 1));
+		p = vtl::CompactTime::precisionOf(events->at(idx).time
+						  .getNanoseconds());
+		if (p > r)
+			r = p;
+	}
 	return r;
 }
 
@@ -510,6 +793,46 @@ retry:
 	return usercolors;
 }
 
+/*
+ * Gives the tasks that don't have a color yet a random color, which is chosen
+ * with the same restrictions as in colorizeTasks(). The colors of the other
+ * tasks are not changed, because they are already used by the graphs.
+ */
+void TraceAnalyzer::colorizeNewTasks(const QMap<int, QColor> &cmap)
+{
+	unsigned int cpu;
+	int tries;
+	QMap<int, QColor>::const_iterator uiter;
+	TColor color;
+	TColor gray;
+
+	for (cpu = 0; cpu <= getMaxCPU(); cpu++) {
+		DEFINE_CPUTASKMAP_ITERATOR(iter) = cpuTaskMaps[cpu].begin();
+		while (iter != cpuTaskMaps[cpu].end()) {
+			CPUTask &task = iter.value();
+			iter++;
+			if (colorMap.contains(task.pid))
+				continue;
+			for (tries = 0; tries < 1000; tries++) {
+				color = TColor(lrand48() % 256,
+					       lrand48() % 256,
+					       lrand48() % 256);
+				gray = TColor(color.red, color.red,
+					      color.red);
+				if (color.SqDistance(black) >= 10000 &&
+				    color.SqDistance(white) >= 12000 &&
+				    color.SqDistance(gray) >= 2500)
+					break;
+			}
+			uiter = cmap.find(task.pid);
+			if (uiter != cmap.constEnd()) {
+				origColorMap[task.pid] = color;
+				color = TColor::fromQColor(uiter.value());
+			}
+			colorMap.insert(task.pid, color);
+		}
+	}
+}
 
 int TraceAnalyzer::binarySearch(const vtl::Time &time, int start, int end)
 	const
@@ -517,7 +840,7 @@ int TraceAnalyzer::binarySearch(const vtl::Time &time, int start, int end)
 	int pivot = (end + start) / 2;
 	if (pivot == start)
 		return pivot;
-	if (time < events->at(pivot).time)
+	if (time.getNanoseconds() < eventNs(pivot))
 		return binarySearch(time, start, pivot);
 	else
 		return binarySearch(time, pivot, end);
@@ -537,40 +860,44 @@ int TraceAnalyzer::binarySearchFiltered(const vtl::Time &time, int start,
 
 int TraceAnalyzer::findIndexBefore(const vtl::Time &time) const
 {
+	vtl::Time::timeint_t ns = time.getNanoseconds();
+
 	if (events->size() < 1)
 		return -1;
 
 	int end = events->size() - 1;
 
 	/* Basic sanity checks */
-	if (time > events->at(end).time)
+	if (ns > eventNs(end))
 		return end;
-	if (time < events->at(0).time)
+	if (ns < eventNs(0))
 		return 0;
 
 	int c = binarySearch(time, 0, end);
 
-	while (c > 0 && events->at(c).time >= time)
+	while (c > 0 && eventNs(c) >= ns)
 		c--;
 	return c;
 }
 
 int TraceAnalyzer::findIndexAfter(const vtl::Time &time) const
 {
+	vtl::Time::timeint_t ns = time.getNanoseconds();
+
 	if (events->size() < 1)
 		return -1;
 
 	int end = events->size() - 1;
 
 	/* Basic sanity checks */
-	if (time > events->at(end).time)
+	if (ns > eventNs(end))
 		return end;
-	if (time < events->at(0).time)
+	if (ns < eventNs(0))
 		return 0;
 
 	int c = binarySearch(time, 0, end);
 
-	while (c < end && events->at(c).time <= time)
+	while (c < end && eventNs(c) <= ns)
 		c++;
 	return c;
 }
@@ -595,6 +922,44 @@ int TraceAnalyzer::findFilteredIndexBefore(const vtl::Time &time) const
 	return c;
 }
 
+/*
+ * Returns the greatest index that is not greater than from and that has the
+ * type type1 or type2, or -1 if there is none.
+ */
+int TraceAnalyzer::findPrevType(int from, event_t type1, event_t type2) const
+{
+	int i;
+
+	if (columns != nullptr)
+		return columns->findPrevType(from, type1, type2);
+
+	for (i = from; i >= 0; i--) {
+		const TraceEvent &event = events->at(i);
+		if (event.type == type1 || event.type == type2)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Returns the smallest index that is not less than from and that has the type
+ * type, or -1 if there is none.
+ */
+int TraceAnalyzer::findNextType(int from, event_t type) const
+{
+	int s = events->size();
+	int i;
+
+	if (columns != nullptr)
+		return columns->findNextType(from, type);
+
+	for (i = from; i < s; i++) {
+		if (events->at(i).type == type)
+			return i;
+	}
+	return -1;
+}
+
 const TraceEvent *TraceAnalyzer::findPreviousSchedEvent(const vtl::Time &time,
 							int pid,
 							int *index) const
@@ -605,13 +970,12 @@ const TraceEvent *TraceAnalyzer::findPreviousSchedEvent(const vtl::Time &time,
 	if (start < 0)
 		return nullptr;
 
-	for (i = start; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if (event.type == SCHED_SWITCH  &&
-		    generic_sched_switch_newpid(event) == pid) {
+	for (i = findPrevType(start, SCHED_SWITCH, SCHED_SWITCH); i >= 0;
+	     i = findPrevType(i - 1, SCHED_SWITCH, SCHED_SWITCH)) {
+		if (schedArgs.at(i).pid == pid) {
 			if (index != nullptr)
 				*index = i;
-			return &event;
+			return &events->at(i);
 		}
 	}
 	return nullptr;
@@ -623,20 +987,17 @@ const TraceEvent *TraceAnalyzer::findNextSchedSleepEvent(const vtl::Time &time,
 {
 	int start = findIndexAfter(time);
 	int i;
-	int s = events->size();
 
 	if (start < 0)
 		return nullptr;
 
-	for (i = start; i < s; i++) {
-		const TraceEvent &event = events->at(i);
-		if (event.type == SCHED_SWITCH &&
-		    generic_sched_switch_oldpid(event) == pid &&
-		    !task_state_is_runnable(
-			    generic_sched_switch_state(event))) {
+	for (i = findNextType(start, SCHED_SWITCH); i >= 0;
+	     i = findNextType(i + 1, SCHED_SWITCH)) {
+		const SchedArgs &args = schedArgs.at(i);
+		if (args.oldpid == pid && !task_state_is_runnable(args.state)) {
 			if (index != nullptr)
 				*index = i;
-			return &event;
+			return &events->at(i);
 		}
 	}
 	return nullptr;
@@ -672,7 +1033,7 @@ const TraceEvent *TraceAnalyzer::findPreviousWakEvent(int startidx,
 						      int *index) const
 {
 	int i;
-	int epid = 0;
+	event_t also;
 
 	if (startidx < 0 || startidx >= (int) events->size())
 		return nullptr;
@@ -681,20 +1042,13 @@ const TraceEvent *TraceAnalyzer::findPreviousWakEvent(int startidx,
 	    wanted != SCHED_WAKING)
 		return nullptr;
 
-	for (i = startidx; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if ((event.type == wanted ||
-		     (wanted == SCHED_WAKEUP &&
-		      event.type == SCHED_WAKEUP_NEW))) {
-			if (wanted == SCHED_WAKING)
-				epid = generic_sched_waking_pid(event);
-			else
-				epid = generic_sched_wakeup_pid(event);
-			if (epid != pid)
-				continue;
+	also = wanted == SCHED_WAKEUP ? SCHED_WAKEUP_NEW : wanted;
+	for (i = findPrevType(startidx, wanted, also); i >= 0;
+	     i = findPrevType(i - 1, wanted, also)) {
+		if (schedArgs.at(i).pid == pid) {
 			if (index != nullptr)
 				*index = i;
-			return &event;
+			return &events->at(i);
 		}
 	}
 	return nullptr;
@@ -714,15 +1068,13 @@ const TraceEvent *TraceAnalyzer::findWakingEvent(const TraceEvent *wakeup,
 	if (startidx < 0 || startidx >= (int) events->size())
 		return nullptr;
 
-	for (i = startidx; i >= 0; i--) {
-		const TraceEvent &event = events->at(i);
-		if (event.type != SCHED_WAKING)
-			continue;
-		pid = generic_sched_waking_pid(event);
+	for (i = findPrevType(startidx, SCHED_WAKING, SCHED_WAKING); i >= 0;
+	     i = findPrevType(i - 1, SCHED_WAKING, SCHED_WAKING)) {
+		pid = schedArgs.at(i).pid;
 		if (pid == wpid) {
 			if (index != nullptr)
 				*index = i;
-			return &event;
+			return &events->at(i);
 		} else if (pid == INT_MAX) {
 			/*
 			 * If we encounter a single waking event where we
@@ -1011,6 +1363,7 @@ void TraceAnalyzer::processAllFilters()
 	int i;
 	int s = events->size();
 	const TraceEvent *eptr;
+	vtl::Time::timeint_t ns;
 
 	filteredEvents.clear();
 
@@ -1019,26 +1372,28 @@ void TraceAnalyzer::processAllFilters()
 		eptr = &event;
 		/* OR filters */
 		if (OR_filterState.isEnabled(FilterState::FILTER_CPU)) {
-			if (OR_filterCPUMap.contains(event.cpu)) {
+			if (OR_filterCPUMap.contains(eventCPU(i))) {
 				filteredEvents.append(eptr);
 				continue;
 			}
 		}
 		if (OR_filterState.isEnabled(FilterState::FILTER_PID) &&
-		    !processPidFilter(event, OR_filterPidMap,
+		    !processPidFilter(eventPid(i), eventType(i),
+				      schedArgs.at(i), OR_filterPidMap,
 				      OR_pidFilterInclusive)) {
 			filteredEvents.append(eptr);
 			continue;
 		}
 		if (OR_filterState.isEnabled(FilterState::FILTER_EVENT)) {
-			if (OR_filterEventMap.contains(event.type) ) {
+			if (OR_filterEventMap.contains(eventType(i))) {
 				filteredEvents.append(eptr);
 				continue;
 			}
 		}
 		if (OR_filterState.isEnabled(FilterState::FILTER_TIME)) {
-			if (event.time >= OR_filterTimeLow &&
-			    event.time <= OR_filterTimeHigh) {
+			ns = eventNs(i);
+			if (ns >= OR_filterTimeLow.getNanoseconds() &&
+			    ns <= OR_filterTimeHigh.getNanoseconds()) {
 				filteredEvents.append(eptr);
 				continue;
 			}
@@ -1051,21 +1406,24 @@ void TraceAnalyzer::processAllFilters()
 		}
 		/* AND filters */
 		if (filterState.isEnabled(FilterState::FILTER_CPU) &&
-		    !filterCPUMap.contains(event.cpu)) {
+		    !filterCPUMap.contains(eventCPU(i))) {
 			continue;
 		}
 		if (filterState.isEnabled(FilterState::FILTER_PID) &&
-		    processPidFilter(event, filterPidMap,
-				     pidFilterInclusive)) {
+		    processPidFilter(eventPid(i), eventType(i), schedArgs.at(i),
+				     filterPidMap, pidFilterInclusive)) {
 			continue;
 		}
 		if (filterState.isEnabled(FilterState::FILTER_EVENT) &&
-		    !filterEventMap.contains(event.type)) {
+		    !filterEventMap.contains(eventType(i))) {
 			continue;
 		}
-		if (filterState.isEnabled(FilterState::FILTER_TIME) &&
-		    (event.time < filterTimeLow || event.time > filterTimeHigh))
-			continue;
+		if (filterState.isEnabled(FilterState::FILTER_TIME)) {
+			ns = eventNs(i);
+			if (ns < filterTimeLow.getNanoseconds() ||
+			    ns > filterTimeHigh.getNanoseconds())
+				continue;
+		}
 		if (filterState.isEnabled(FilterState::FILTER_REGEX) &&
 		    !processRegexFilter(event, filterRegex))
 			continue;
@@ -1675,13 +2033,15 @@ int TraceAnalyzer::writePerfEvent(char *wb, int *space, const TraceEvent *eptr,
 	int w;
 	const char *ename;
 	int nrspaces;
+	ArgCache::Args argv;
+	int argc;
 	int i;
 
 	*ts_errno = 0;
 
 	eptr->time.sprint(tbuf);
 	w = snprintf(wb, *space, "%s %5u [%03u] %s: ",
-		     eptr->taskName->ptr, eptr->pid, eptr->cpu, tbuf);
+		     eptr->getTaskName()->ptr, eptr->pid, eptr->cpu, tbuf);
 	if (likely(w > 0)) {
 		written += w;
 		*space  -= w;
@@ -1714,8 +2074,9 @@ int TraceAnalyzer::writePerfEvent(char *wb, int *space, const TraceEvent *eptr,
 		wb      += w;
 	}
 
-	for (i = 0; i < eptr->argc; i++) {
-		w = snprintf(wb, *space, " %s", eptr->argv[i]->ptr);
+	argv = argCache->getArgs(*eptr, argc);
+	for (i = 0; i < argc; i++) {
+		w = snprintf(wb, *space, " %s", argv[i]->ptr);
 		if (likely(w > 0)) {
 			written += w;
 			*space  -= w;
@@ -1730,9 +2091,8 @@ int TraceAnalyzer::writePerfEvent(char *wb, int *space, const TraceEvent *eptr,
 	}
 
 	if (eptr->postEventInfo != nullptr && eptr->postEventInfo->len > 0) {
-		size_t cs = TSMIN(*space, eptr->postEventInfo->len);
-		parser->traceFile->readChunk(eptr->postEventInfo, wb, *space,
-					     ts_errno);
+		size_t cs = parser->traceFile->readChunk(eptr->postEventInfo,
+							 wb, *space, ts_errno);
 		if (*ts_errno != 0)
 			return written;
 
@@ -1816,6 +2176,47 @@ TraceFile *TraceAnalyzer::getTraceFile()
 	return parser->traceFile;
 }
 
+/*
+ * The policy is used when the next trace is opened, see RetentionPolicy for
+ * the format of spec. Returns 0 or a negative TS_ERROR_* code.
+ */
+int TraceAnalyzer::setRetentionPolicy(const QString &spec)
+{
+	return retentionPolicy.parse(spec);
+}
+
+const QString &TraceAnalyzer::getRetentionPolicy() const
+{
+	return retentionPolicy.getSpec();
+}
+
+/* Returns the number of dropped events of each type, indexed by event_t */
+QVector<quint64> TraceAnalyzer::getDroppedCounts() const
+{
+	QVector<quint64> counts;
+	int nr = TraceEvent::getNrEvents();
+	int t;
+
+	counts.resize(nr);
+	for (t = 0; t < nr; t++)
+		counts[t] = parser->getDroppedEvents((event_t) t);
+	return counts;
+}
+
+/*
+ * The window is used when the next trace is opened, see TimeWindow for the
+ * format of spec. Returns 0 or a negative TS_ERROR_* code.
+ */
+int TraceAnalyzer::setTimeWindow(const QString &spec)
+{
+	return timeWindow.parse(spec);
+}
+
+const QString &TraceAnalyzer::getTimeWindow() const
+{
+	return timeWindow.getSpec();
+}
+
 void TraceAnalyzer::setTaskColor(int pid, const QColor &color)
 {
 	TColor newColor = TColor::fromQColor(color);
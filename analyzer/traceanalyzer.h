@@ -59,6 +59,8 @@
 #include <QList>
 #include <QMap>
 #include <QtGlobal>
+#include <atomic>
+#include <cstdint>
 #include <limits>
 
 #include "vtl/avltree.h"
@@ -71,21 +73,25 @@
 #include "analyzer/cpufreq.h"
 #include "analyzer/cpuidle.h"
 #include "analyzer/cputask.h"
+#include "analyzer/eventcolumns.h"
 #include "analyzer/filterstate.h"
 #include "analyzer/latency.h"
 #include "analyzer/migration.h"
 #include "analyzer/regexfilter.h"
+#include "analyzer/schedargs.h"
 #include "analyzer/task.h"
 #include "analyzer/tcolor.h"
 #include "misc/traceshark.h"
 #include "mm/mempool.h"
+#include "parser/argcache.h"
 #include "parser/genericparams.h"
+#include "parser/retentionpolicy.h"
+#include "parser/timewindow.h"
 #include "parser/traceevent.h"
 #include "parser/traceparser.h"
 #include "threads/workitem.h"
 #include "threads/workthread.h"
 #include "threads/workqueue.h"
-#include "ui/migrationarrow.h"
 
 /*
  * Ftrace and perf only record sched_switch events, there is no record of when
@@ -132,9 +138,20 @@ public:
 	TraceAnalyzer(const SettingStore *sstore);
 	~TraceAnalyzer();
 	int open(const QString &fileName);
+	int open(const QStringList &fileNames);
 	bool isOpen() const;
 	void close(int *ts_errno);
 	bool processTrace(const QMap<int, QColor> &cmap);
+	void startProcessing();
+	bool waitForProcessing(unsigned long time);
+	bool finishProcessing(const QMap<int, QColor> &cmap);
+	void cancelProcessing();
+	bool isCanceled() const;
+	bool getLoadProgress(int64_t *loaded, int64_t *total) const;
+	int getNrProcessedEvents() const;
+	bool isFollowing() const;
+	void stopFollowing();
+	int processNewEvents(const QMap<int, QColor> &cmap, bool &eof);
 	const TraceEvent *findPreviousSchedEvent(const vtl::Time &time,
 						 int pid,
 						 int *index) const;
@@ -199,6 +216,11 @@ public:
 	bool exportLatencies(exportformat_t format, latencytype_t type,
 			     const char *fileName, int *ts_errno);
 	TraceFile *getTraceFile();
+	int setRetentionPolicy(const QString &spec);
+	const QString &getRetentionPolicy() const;
+	QVector<quint64> getDroppedCounts() const;
+	int setTimeWindow(const QString &spec);
+	const QString &getTimeWindow() const;
 	vtl::TList<TraceEvent> *events;
 	vtl::TList<const TraceEvent*> filteredEvents;
 	vtl::TList<Latency> schedLatencies;
@@ -211,27 +233,56 @@ public:
 	QList<Migration> migrations;
 private:
 	TraceParser *parser;
+	/* The decoded arguments of the events, at the same index as events */
+	vtl::TList<SchedArgs> schedArgs;
+	/*
+	 * The members of the events that are read by the searches and the
+	 * filters, at the same index as events. This is nullptr unless the
+	 * EVENT_COLUMNS setting was enabled when the trace was opened, the
+	 * members are then read from the events instead.
+	 */
+	EventColumns *columns;
+	/* For the arguments that the parser did not store, used by filters */
+	ArgCache *argCache;
+	/* Which events the parser should keep when a trace is opened */
+	RetentionPolicy retentionPolicy;
+	/* Which part of a text trace the parser should load */
+	TimeWindow timeWindow;
+	/*
+	 * When a trace is followed, the parser keeps appending to its list of
+	 * events, so this list shares the elements of it but only contains the
+	 * ones that have been processed. This is the one that events points to.
+	 */
+	vtl::TList<TraceEvent> followEvents;
 	void prepareDataStructures();
 	void resetProperties();
 	void threadProcess();
+	void threadAnalyze();
+	int processFollowed(bool &eof);
+	int takeNewEvents(bool &eof);
+	void removeTails();
+	void processEnd();
 	int binarySearch(const vtl::Time &time, int start, int end) const;
+	vtl_always_inline vtl::Time::timeint_t eventNs(int index) const;
+	vtl_always_inline event_t eventType(int index) const;
+	vtl_always_inline unsigned int eventCPU(int index) const;
+	vtl_always_inline int eventPid(int index) const;
+	int findPrevType(int from, event_t type1, event_t type2) const;
+	int findNextType(int from, event_t type) const;
 	int binarySearchFiltered(const vtl::Time &time, int start, int end)
 		const;
 	bool colorizeTasks(const QMap<int, QColor> &cmap);
+	void colorizeNewTasks(const QMap<int, QColor> &cmap);
 	event_t determineCPUEvent(bool &ok);
 	int findIndexBefore(const vtl::Time &time) const;
 	int findIndexAfter(const vtl::Time &time) const;
 	int findFilteredIndexBefore(const vtl::Time &time) const;
-	vtl_always_inline int
-		generic_sched_switch_newpid(const TraceEvent &event) const;
-	vtl_always_inline int
-		generic_sched_switch_oldpid(const TraceEvent &event) const;
-	vtl_always_inline taskstate_t
-		generic_sched_switch_state(const TraceEvent &event) const;
 	vtl_always_inline int
 		generic_sched_wakeup_pid(const TraceEvent &event) const;
-	vtl_always_inline int
-		generic_sched_waking_pid(const TraceEvent &event) const;
+	vtl_always_inline void decodeSchedArgs(tracetype_t ttype,
+					       const TraceEvent &event,
+					       sched_switch_handle_t &handle,
+					       SchedArgs &args);
 	vtl_always_inline
 	vtl::Time estimateSchedDelayNew(const CPU *eventCPU,
 					const vtl::Time &newTime,
@@ -249,9 +300,13 @@ private:
 				  int idx);
 	vtl_always_inline void processSwitchEvent(tracetype_t ttype,
 						  const TraceEvent &event,
+						  const SchedArgs &args,
+						  const sched_switch_handle_t
+						  &handle,
 						  int idx);
 	vtl_always_inline void processWakeupEvent(tracetype_t ttype,
 						  const TraceEvent &event,
+						  const SchedArgs &args,
 						  int idx);
 	vtl_always_inline void processCPUfreqEvent(tracetype_t ttype,
 						   const TraceEvent &event,
@@ -259,14 +314,15 @@ private:
 	vtl_always_inline void processCPUidleEvent(tracetype_t ttype,
 						   const TraceEvent &event,
 						   int idx);
-	vtl_always_inline void processMigrateEvent(tracetype_t ttype,
-						   const TraceEvent &event,
+	vtl_always_inline void processMigrateEvent(const TraceEvent &event,
+						   const SchedArgs &args,
 						   int idx);
 	vtl_always_inline void processForkEvent(tracetype_t ttype,
 						const TraceEvent &event,
+						const SchedArgs &args,
 						int idx);
-	vtl_always_inline void processExitEvent(tracetype_t ttype,
-						const TraceEvent &event,
+	vtl_always_inline void processExitEvent(const TraceEvent &event,
+						const SchedArgs &args,
 						int idx);
 	void addCpuFreqWork(unsigned int cpu,
 			    QList<AbstractWorkItem*> &list);
@@ -279,6 +335,8 @@ private:
 	void processFreqAddTail();
 	unsigned int guessTimePrecision();
 	vtl_always_inline void processGeneric(tracetype_t ttype);
+	vtl_always_inline void processEvents(tracetype_t ttype, int from,
+					     int to);
 	vtl_always_inline void updateMaxCPU(unsigned int cpu);
 	vtl_always_inline void updateMaxFreq(unsigned int freq);
 	vtl_always_inline void updateMinFreq(unsigned int freq);
@@ -288,7 +346,8 @@ private:
 	void processPerf();
 	void processAllFilters();
 	vtl_always_inline
-		bool processPidFilter(const TraceEvent &event,
+		bool processPidFilter(int epid, event_t type,
+				      const SchedArgs &args,
 				      QMap<int, int> &map,
 				      bool inclusive);
 	vtl_always_inline bool processRegexFilter(const TraceEvent &event,
@@ -300,6 +359,14 @@ private:
 	int writeLatency(char *wb, int *space, const Latency *lptr, int size,
 			 const char *sep, int *ts_errno);
 	WorkQueue processingQueue;
+	/*
+	 * This runs threadAnalyze(), so that the UI stays responsive while a
+	 * trace is processed. The number of processed events is updated after
+	 * each batch, so that the progress can be shown.
+	 */
+	WorkThread<TraceAnalyzer> *analysisThread;
+	std::atomic<bool> canceled;
+	std::atomic<int> nrProcessed;
 	WorkQueue scalingQueue;
 	WorkQueue statsQueue;
 	WorkQueue statsLimitedQueue;
@@ -328,7 +395,7 @@ private:
 	int minIdleState;
 	unsigned int timePrecision;
 	CPU *CPUs;
-	StringPool<> *taskNamePool;
+	InternPool<> *taskNamePool;
 	QCustomPlot *customPlot;
 	FilterState filterState;
 	FilterState OR_filterState;
@@ -412,45 +479,6 @@ vtl::Time TraceAnalyzer::estimateWakeDelay(const Task *task,
 	return delay;
 }
 
-vtl_always_inline int
-TraceAnalyzer::generic_sched_switch_newpid(const TraceEvent &event) const
-{
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_switch_parse(ttype, event, handle))
-		return INT_MAX;
-	return sched_switch_handle_newpid(ttype, event, handle);
-}
-
-vtl_always_inline int
-TraceAnalyzer::generic_sched_switch_oldpid(const TraceEvent &event) const
-{
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_switch_parse(ttype, event, handle))
-		return INT_MAX;
-	return sched_switch_handle_oldpid(ttype, event, handle);
-}
-
-vtl_always_inline taskstate_t
-TraceAnalyzer::generic_sched_switch_state(const TraceEvent &event) const
-{
-	sched_switch_handle_t handle;
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return 0;
-	if (!sched_switch_parse(ttype, event, handle))
-		return 0;
-	return sched_switch_handle_state(ttype, event, handle);
-}
-
 vtl_always_inline int
 TraceAnalyzer::generic_sched_wakeup_pid(const TraceEvent &event) const
 {
@@ -463,16 +491,66 @@ TraceAnalyzer::generic_sched_wakeup_pid(const TraceEvent &event) const
 	return sched_wakeup_pid(ttype, event);
 }
 
-vtl_always_inline int
-TraceAnalyzer::generic_sched_waking_pid(const TraceEvent &event) const
+/*
+ * Decodes the arguments of the scheduling events into args. The handle is
+ * also needed for sched_switch events, because the task names are only looked
+ * up when the events are processed.
+ */
+vtl_always_inline
+void TraceAnalyzer::decodeSchedArgs(tracetype_t ttype,
+				    const TraceEvent &event,
+				    sched_switch_handle_t &handle,
+				    SchedArgs &args)
 {
-	tracetype_t ttype = getTraceType();
-
-	if (!tracetype_is_valid(ttype))
-		return INT_MAX;
-	if (!sched_waking_args_ok(ttype, event))
-		return INT_MAX;
-	return sched_waking_pid(ttype, event);
+	args.clear();
+
+	switch (event.type) {
+	case SCHED_SWITCH:
+		if (!sched_switch_parse(ttype, event, handle))
+			return;
+		args.pid = sched_switch_handle_newpid(ttype, event, handle);
+		args.oldpid = sched_switch_handle_oldpid(ttype, event, handle);
+		args.state = sched_switch_handle_state(ttype, event, handle);
+		break;
+	case SCHED_WAKEUP:
+	case SCHED_WAKEUP_NEW:
+		if (!sched_wakeup_args_ok(ttype, event))
+			return;
+		args.pid = sched_wakeup_pid(ttype, event);
+		args.cpu = SchedArgs::packCPU(sched_wakeup_cpu(ttype, event));
+		if (sched_wakeup_success(ttype, event))
+			args.flags |= SchedArgs::FLAG_SUCCESS;
+		break;
+	case SCHED_WAKING:
+		if (!sched_waking_args_ok(ttype, event))
+			return;
+		args.pid = sched_waking_pid(ttype, event);
+		args.cpu = SchedArgs::packCPU(sched_waking_cpu(ttype, event));
+		break;
+	case SCHED_MIGRATE_TASK:
+		if (!sched_migrate_args_ok(ttype, event))
+			return;
+		args.pid = sched_migrate_pid(ttype, event);
+		args.cpu = SchedArgs::packCPU(
+			sched_migrate_destCPU(ttype, event));
+		args.origcpu = SchedArgs::packCPU(
+			sched_migrate_origCPU(ttype, event));
+		break;
+	case SCHED_PROCESS_FORK:
+		if (!sched_process_fork_args_ok(ttype, event))
+			return;
+		args.pid = sched_process_fork_childpid(ttype, event);
+		args.oldpid = sched_process_fork_parent_pid(ttype, event);
+		break;
+	case SCHED_PROCESS_EXIT:
+		if (!sched_process_exit_args_ok(ttype, event))
+			return;
+		args.pid = sched_process_exit_pid(ttype, event);
+		break;
+	default:
+		return;
+	}
+	args.flags |= SchedArgs::FLAG_OK;
 }
 
 vtl_always_inline unsigned int TraceAnalyzer::getMaxCPU() const
@@ -550,19 +628,19 @@ vtl_always_inline Task *TraceAnalyzer::findTask(int pid)
 }
 
 vtl_always_inline
-void TraceAnalyzer::processMigrateEvent(tracetype_t ttype,
-					const TraceEvent &event,
+void TraceAnalyzer::processMigrateEvent(const TraceEvent &event,
+					const SchedArgs &args,
 					int /* idx */)
 {
 	Migration m;
 	unsigned int oldcpu;
 	unsigned int newcpu;
 
-	if (!sched_migrate_args_ok(ttype, event))
+	if (!args.isOk())
 		return;
 
-	oldcpu = sched_migrate_origCPU(ttype, event);
-	newcpu = sched_migrate_destCPU(ttype, event);
+	oldcpu = args.origcpu;
+	newcpu = args.cpu;
 
 	if (!isValidCPU(oldcpu) || !isValidCPU(newcpu))
 		return;
@@ -570,7 +648,7 @@ void TraceAnalyzer::processMigrateEvent(tracetype_t ttype,
 	updateMaxCPU(oldcpu);
 	updateMaxCPU(newcpu);
 
-	m.pid = sched_migrate_pid(ttype, event);
+	m.pid = args.pid;
 	m.oldcpu = oldcpu;
 	m.newcpu = newcpu;
 	m.time = event.time;
@@ -579,15 +657,16 @@ void TraceAnalyzer::processMigrateEvent(tracetype_t ttype,
 
 vtl_always_inline void TraceAnalyzer::processForkEvent(tracetype_t ttype,
 						       const TraceEvent &event,
+						       const SchedArgs &args,
 						       int idx)
 {
 	Migration m;
 	const char *childname;
 
-	if (!sched_process_fork_args_ok(ttype, event))
+	if (!args.isOk())
 		return;
 
-	m.pid = sched_process_fork_childpid(ttype, event);
+	m.pid = args.pid;
 	m.oldcpu = -1;
 	m.newcpu = event.cpu;
 	m.time = event.time;
@@ -608,16 +687,16 @@ vtl_always_inline void TraceAnalyzer::processForkEvent(tracetype_t ttype,
 	}
 }
 
-vtl_always_inline void TraceAnalyzer::processExitEvent(tracetype_t ttype,
-						       const TraceEvent &event,
+vtl_always_inline void TraceAnalyzer::processExitEvent(const TraceEvent &event,
+						       const SchedArgs &args,
 						       int /* idx */)
 {
 	Migration m;
 
-	if (!sched_process_exit_args_ok(ttype, event))
+	if (!args.isOk())
 		return;
 
-	m.pid = sched_process_exit_pid(ttype, event);
+	m.pid = args.pid;
 	m.oldcpu = event.cpu;
 	m.newcpu = -1;
 	m.time = event.time;
@@ -632,9 +711,10 @@ vtl_always_inline void TraceAnalyzer::processExitEvent(tracetype_t ttype,
 vtl_always_inline
 void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
 				       const TraceEvent &event,
+				       const SchedArgs &args,
+				       const sched_switch_handle_t &handle,
 				       int idx)
 {
-	sched_switch_handle_t handle;
 	unsigned int cpu = event.cpu;
 	vtl::Time oldtime = event.time - FAKE_DELTA;
 	vtl::Time newtime = event.time + FAKE_DELTA;
@@ -655,11 +735,11 @@ void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
 	bool preempted;
 	bool uint;
 
-	if (!sched_switch_parse(ttype, event, handle))
+	if (!args.isOk())
 		return;
 
-	oldpid = sched_switch_handle_oldpid(ttype, event, handle);
-	newpid = sched_switch_handle_newpid(ttype, event, handle);
+	oldpid = args.oldpid;
+	newpid = args.pid;
 
 	if (!isValidCPU(cpu))
 		return;
@@ -746,7 +826,7 @@ void TraceAnalyzer::processSwitchEvent(tracetype_t ttype,
 	/* Handle the outgoing task */
 	cpuTask = &cpuTaskMaps[cpu][oldpid];
 	task = &taskMap[oldpid].getTask();
-	state = sched_switch_handle_state(ttype, event, handle);
+	state = args.state;
 
 	name = sched_switch_handle_oldname_strdup(ttype,
 						  event,
@@ -945,6 +1025,7 @@ out:
 vtl_always_inline
 void TraceAnalyzer::processWakeupEvent(tracetype_t ttype,
 				       const TraceEvent &event,
+				       const SchedArgs &args,
 				       int idx)
 {
 	int pid;
@@ -952,15 +1033,15 @@ void TraceAnalyzer::processWakeupEvent(tracetype_t ttype,
 	vtl::Time time;
 	const char *name;
 
-	if (!sched_wakeup_args_ok(ttype, event))
+	if (!args.isOk())
 		return;
 
 	/* Only interested in success */
-	if (!sched_wakeup_success(ttype, event))
+	if (!args.isSuccess())
 		return;
 
 	time = event.time;
-	pid = sched_wakeup_pid(ttype, event);
+	pid = args.pid;
 
 	/* Handle the woken up task */
 	task = &taskMap[pid].getTask();
@@ -1068,9 +1149,36 @@ vtl_always_inline void TraceAnalyzer::updateMinIdleState(int state)
 		minIdleState = state;
 }
 
+vtl_always_inline vtl::Time::timeint_t TraceAnalyzer::eventNs(int index) const
+{
+	if (columns != nullptr)
+		return columns->time(index);
+	return events->at(index).time.getNanoseconds();
+}
+
+vtl_always_inline event_t TraceAnalyzer::eventType(int index) const
+{
+	if (columns != nullptr)
+		return columns->type(index);
+	return events->at(index).type;
+}
+
+vtl_always_inline unsigned int TraceAnalyzer::eventCPU(int index) const
+{
+	if (columns != nullptr)
+		return columns->cpu(index);
+	return events->at(index).cpu;
+}
+
+vtl_always_inline int TraceAnalyzer::eventPid(int index) const
+{
+	if (columns != nullptr)
+		return columns->pid(index);
+	return events->at(index).pid;
+}
+
 vtl_always_inline void TraceAnalyzer::processGeneric(tracetype_t ttype)
 {
-	int i;
 	bool eof = false;
 	int indexReady = 0;
 	int prevIndex = 0;
@@ -1087,86 +1195,88 @@ vtl_always_inline void TraceAnalyzer::processGeneric(tracetype_t ttype)
 	startTimeDbl = startTime.toDouble();
 
 	while(true) {
-		for (i = prevIndex; i < indexReady; i++) {
-			TraceEvent &event = (*events)[i];
-			if (!isValidCPU(event.cpu))
-				continue;
-			updateMaxCPU(event.cpu);
-			switch (event.type) {
-			case CPU_FREQUENCY:
-				processCPUfreqEvent(ttype, event, i);
-				break;
-			case CPU_IDLE:
-				processCPUidleEvent(ttype, event, i);
-				break;
-			case SCHED_MIGRATE_TASK:
-				processMigrateEvent(ttype, event, i);
-				break;
-			case SCHED_SWITCH:
-				processSwitchEvent(ttype, event, i);
-				break;
-			case SCHED_WAKEUP:
-			case SCHED_WAKEUP_NEW:
-				processWakeupEvent(ttype, event, i);
-				break;
-			case SCHED_PROCESS_FORK:
-				processForkEvent(ttype, event, i);
-				break;
-			case SCHED_PROCESS_EXIT:
-				processExitEvent(ttype, event, i);
-				break;
-			default:
-				break;
-			}
-		}
+		processEvents(ttype, prevIndex, indexReady);
+		nrProcessed.store(indexReady, std::memory_order_relaxed);
 		if (eof)
 			break;
+		if (canceled.load(std::memory_order_relaxed))
+			return;
 		prevIndex = indexReady;
 		parser->waitForNextBatch(eof, indexReady);
 	}
-	endTime = events->last().time;
-	endTimeIdx = events->size() - 1;
-	AbstractTask::setEndTime(endTime);
-	endTimeDbl = endTime.toDouble();
-	nrCPUs = maxCPU + 1;
-	timePrecision = guessTimePrecision();
+	processEnd();
+}
+
+/* Processes the events from index from up to, but not including, index to */
+vtl_always_inline void TraceAnalyzer::processEvents(tracetype_t ttype,
+						    int from, int to)
+{
+	sched_switch_handle_t handle;
+	int i;
+
+	for (i = from; i < to; i++) {
+		TraceEvent &event = (*events)[i];
+		SchedArgs &args = schedArgs.increase();
+		if (columns != nullptr)
+			columns->append(event);
+		decodeSchedArgs(ttype, event, handle, args);
+		if (!isValidCPU(event.cpu))
+			continue;
+		updateMaxCPU(event.cpu);
+		switch (event.type) {
+		case CPU_FREQUENCY:
+			processCPUfreqEvent(ttype, event, i);
+			break;
+		case CPU_IDLE:
+			processCPUidleEvent(ttype, event, i);
+			break;
+		case SCHED_MIGRATE_TASK:
+			processMigrateEvent(event, args, i);
+			break;
+		case SCHED_SWITCH:
+			processSwitchEvent(ttype, event, args, handle, i);
+			break;
+		case SCHED_WAKEUP:
+		case SCHED_WAKEUP_NEW:
+			processWakeupEvent(ttype, event, args, i);
+			break;
+		case SCHED_PROCESS_FORK:
+			processForkEvent(ttype, event, args, i);
+			break;
+		case SCHED_PROCESS_EXIT:
+			processExitEvent(event, args, i);
+			break;
+		default:
+			break;
+		}
+	}
 }
 
 vtl_always_inline
-bool TraceAnalyzer::processPidFilter(const TraceEvent &event,
+bool TraceAnalyzer::processPidFilter(int epid, event_t type,
+				     const SchedArgs &args,
 				     QMap<int, int> &map,
 				     bool inclusive)
 {
-	sched_switch_handle sw_handle;
 	DEFINE_FILTER_PIDMAP_ITERATOR(iter);
-	iter = map.find(event.pid);
+	iter = map.find(epid);
 	if (iter == map.end()) {
-		tracetype_t ttype = getTraceType();
-		int pid = INT_MAX;
+		int pid;
 		if (!inclusive)
 			return true;
-		switch (event.type) {
+		switch (type) {
 		case SCHED_WAKEUP:
 		case SCHED_WAKEUP_NEW:
-			if (!sched_wakeup_args_ok(ttype, event))
-				return true;
-			pid = sched_wakeup_pid(ttype, event);
-			break;
 		case SCHED_WAKING:
-			if (!sched_waking_args_ok(ttype, event))
-				return true;
-			pid = sched_waking_pid(ttype, event);
-			break;
 		case SCHED_PROCESS_FORK:
-			if (!sched_process_fork_args_ok(ttype, event))
+			if (!args.isOk())
 				return true;
-			pid = sched_process_fork_childpid(ttype, event);
+			pid = args.pid;
 			break;
 		case SCHED_SWITCH:
-			if (!sched_switch_parse(ttype, event, sw_handle))
+			if (!args.isOk())
 				return true;
-			pid = sched_switch_handle_newpid(ttype, event,
-							 sw_handle);
+			pid = args.pid;
 			if (pid == 0)
 				return true;
 			break;
@@ -1191,15 +1301,18 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 	int pidx = 0;
 	bool pvalue = false;
 	int pos;
+	ArgCache::Args argv;
+	int argc;
 
+	argv = argCache->getArgs(event, argc);
 	for (i = 0; i < rvec.size(); i++) {
 		const Regex &regex = rvec[i];
 		value = false;
 		switch (regex.posType) {
 		case Regex::POS_NONE:
-			for (j = 0; j < event.argc; j++) {
+			for (j = 0; j < argc; j++) {
 				value = !regexec(&regex.regex,
-						 event.argv[j]->ptr,
+						 argv[j]->ptr,
 						 0, NULL, 0);
 				if (value) {
 					pidx = j;
@@ -1208,11 +1321,11 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 			}
 			break;
 		case Regex::POS_ABSOLUTE:
-			if (regex.pos < 0 || regex.pos > event.argc - 1)
+			if (regex.pos < 0 || regex.pos > argc - 1)
 				value = false;
 			else {
 				value = !regexec(&regex.regex,
-						 event.argv[regex.pos]->ptr,
+						 argv[regex.pos]->ptr,
 						 0, NULL, 0);
 				if (value) {
 					pidx = regex.pos;
@@ -1224,11 +1337,11 @@ bool TraceAnalyzer::processRegexFilter(const TraceEvent &event,
 			if (!pvalue)
 				break;
 			pos = pidx + regex.pos;
-			if (pos < 0 || pos > event.argc - 1)
+			if (pos < 0 || pos > argc - 1)
 				value = false;
 			else {
 				value = !regexec(&regex.regex,
-						 event.argv[pos]->ptr,
+						 argv[pos]->ptr,
 						 0, NULL, 0);
 				if (value) {
 					pidx = pos;
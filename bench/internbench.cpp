@@ -0,0 +1,381 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This program compares the speed of InternPool with that of StringPool. It
+ * generates task names and event arguments that are distributed like in a
+ * trace of a large machine: per CPU kernel threads, such as "kworker/12:1",
+ * which differ only in the middle, and user space threads of which a few are
+ * much more common than the rest. The arguments are those of sched_switch and
+ * sched_wakeup, many of which are numbers that are seldom reused. The names
+ * are interned without a cutoff and the arguments with the cutoff that the
+ * grammars use, in pools of the same sizes as the grammars use. Usage:
+ *
+ * internbench [-c cpus] [-t tasks] [-n strings] [-i iterations]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include "bench/benchrandom.h"
+#include "mm/internpool.h"
+#include "mm/stringpool.h"
+#include "misc/traceshark.h"
+#include "misc/tstring.h"
+#include "vtl/bsdexits.h"
+
+#define DEFAULT_CPUS (256)
+#define DEFAULT_TASKS (20000)
+#define DEFAULT_STRINGS (4000000)
+#define DEFAULT_ITERATIONS (5)
+
+/* This is the cutoff that the grammars use for the arguments */
+#define ARG_CUTOFF (16)
+
+/* The kernel truncates the task names to 15 characters */
+#define TASK_COMM_LEN (16)
+
+static const char * const kernelThreads[] = {
+	"kworker/%u:%u",
+	"kworker/%u:%uH",
+	"kworker/u%u:%u",
+	"ksoftirqd/%u",
+	"migration/%u",
+	"cpuhp/%u",
+	"rcuop/%u",
+	"idle_inject/%u",
+};
+
+static const char * const userThreads[] = {
+	"chrome",
+	"ThreadPoolForeg",
+	"Chrome_ChildIOT",
+	"gnome-shell",
+	"Xorg",
+	"pulseaudio",
+	"systemd-journal",
+	"java",
+	"GC Thread#%u",
+	"C2 CompilerThre",
+	"VM Periodic Tas",
+	"php-fpm",
+	"postgres",
+	"nginx",
+	"gcc",
+	"cc1plus",
+	"make",
+	"bash",
+};
+
+class Strings {
+public:
+	Strings(): size(0) {}
+	void add(const char *s) {
+		offsets.push_back(buf.size());
+		buf.append(s);
+		buf.push_back('\0');
+		size++;
+	}
+	/* This must not be called before all strings have been added */
+	void makeTStrings() {
+		unsigned int i;
+		TString ts;
+
+		strings.clear();
+		for (i = 0; i < size; i++) {
+			ts.ptr = &buf[offsets[i]];
+			ts.len = strlen(ts.ptr);
+			strings.push_back(ts);
+		}
+	}
+	std::string buf;
+	std::vector<size_t> offsets;
+	std::vector<TString> strings;
+	unsigned int size;
+};
+
+static void makeTaskNames(std::vector<std::string> &names, unsigned int cpus,
+			  unsigned int tasks, Random &rnd)
+{
+	const unsigned int nrKernel = arraylen(kernelThreads);
+	const unsigned int nrUser = arraylen(userThreads);
+	const char *fmt;
+	char name[64];
+	unsigned int i;
+
+	for (i = 0; i < tasks; i++) {
+		if (i < tasks / 4) {
+			fmt = kernelThreads[rnd.below(nrKernel)];
+			snprintf(name, sizeof(name), fmt,
+				 (unsigned) rnd.below(cpus),
+				 (unsigned) rnd.below(4));
+		} else {
+			fmt = userThreads[rnd.skewed(nrUser)];
+			snprintf(name, sizeof(name), fmt,
+				 (unsigned) rnd.below(64));
+		}
+		name[TASK_COMM_LEN - 1] = '\0';
+		names.push_back(name);
+	}
+}
+
+/*
+ * The names are those that the grammars intern for each event, the tasks that
+ * run the most are the most common.
+ */
+static void makeNames(Strings &strs, const std::vector<std::string> &names,
+		      unsigned int n, Random &rnd)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++)
+		strs.add(names[rnd.skewed(names.size())].c_str());
+	strs.makeTStrings();
+}
+
+/* The arguments are those of a sched_switch or a sched_wakeup event */
+static void makeArgs(Strings &strs, const std::vector<std::string> &names,
+		     unsigned int cpus, unsigned int n, Random &rnd)
+{
+	static const char states[] = "RSDX";
+	unsigned int i, a, b;
+	char arg[64];
+
+	for (i = 0; i < n; i += 10) {
+		a = rnd.skewed(names.size());
+		b = rnd.skewed(names.size());
+		if (rnd.below(2) == 0) {
+			snprintf(arg, sizeof(arg), "prev_comm=%s",
+				 names[a].c_str());
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "prev_pid=%u", 1000 + a * 7);
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "prev_prio=%u",
+				 100 + (unsigned) rnd.skewed(40));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "prev_state=%c",
+				 states[rnd.skewed(4)]);
+			strs.add(arg);
+			strs.add("==>");
+			snprintf(arg, sizeof(arg), "next_comm=%s",
+				 names[b].c_str());
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "next_pid=%u", 1000 + b * 7);
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "next_prio=%u",
+				 100 + (unsigned) rnd.skewed(40));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "%u", (unsigned)
+				 rnd.below(1000000000));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "cpu_id=%u",
+				 (unsigned) rnd.below(cpus));
+			strs.add(arg);
+		} else {
+			snprintf(arg, sizeof(arg), "comm=%s",
+				 names[a].c_str());
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "pid=%u", 1000 + a * 7);
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "prio=%u",
+				 100 + (unsigned) rnd.skewed(40));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "target_cpu=%03u",
+				 (unsigned) rnd.below(cpus));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "success=%u",
+				 (unsigned) rnd.below(2));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "orig_cpu=%u",
+				 (unsigned) rnd.below(cpus));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "dest_cpu=%u",
+				 (unsigned) rnd.below(cpus));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "state=%u",
+				 (unsigned) rnd.skewed(8));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "%u", (unsigned)
+				 rnd.below(1000000000));
+			strs.add(arg);
+			snprintf(arg, sizeof(arg), "%llx", (unsigned long long)
+				 rnd.next());
+			strs.add(arg);
+		}
+	}
+	strs.makeTStrings();
+}
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/*
+ * Returns the best time of the iterations, a new pool is used for each one.
+ * The pool is created with the same sizes as in the grammars.
+ */
+template<typename Pool>
+static double bench(const Strings &strs, unsigned int nr_pages,
+		    unsigned int hsize, uint32_t cutoff, int iterations,
+		    unsigned long *sum)
+{
+	const TString *str;
+	double best = 0;
+	double begin;
+	double t;
+	Pool *pool;
+	unsigned int i;
+	int it;
+
+	*sum = 0;
+	for (it = 0; it < iterations; it++) {
+		pool = new Pool(nr_pages, hsize);
+		*sum = 0;
+		begin = now();
+		for (i = 0; i < strs.size; i++) {
+			str = pool->allocString(&strs.strings[i], cutoff);
+			if (str == nullptr) {
+				fprintf(stderr, "Out of memory\n");
+				exit(BSD_EX_OSERR);
+			}
+			*sum += str->len + (unsigned char) str->ptr[0];
+		}
+		t = now() - begin;
+		if (it == 0 || t < best)
+			best = t;
+		delete pool;
+	}
+	return best;
+}
+
+static void report(const char *what, const Strings &strs, unsigned int nr_pages,
+		   unsigned int hsize, uint32_t cutoff, int iterations)
+{
+	unsigned long spSum, ipSum;
+	double spTime, ipTime;
+
+	spTime = bench<StringPool<>>(strs, nr_pages, hsize, cutoff,
+				     iterations, &spSum);
+	ipTime = bench<InternPool<>>(strs, nr_pages, hsize, cutoff,
+				     iterations, &ipSum);
+	printf("%-5s StringPool %8.1f ns/string InternPool %8.1f ns/string "
+	       "%6.2fx%s\n", what, spTime * 1e9 / strs.size,
+	       ipTime * 1e9 / strs.size, spTime / ipTime,
+	       spSum != ipSum ? " MISMATCH" : "");
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr,
+		"Usage: %s [-c cpus] [-t tasks] [-n strings] [-i iterations]\n",
+		name);
+	exit(BSD_EX_USAGE);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int cpus = DEFAULT_CPUS;
+	unsigned int tasks = DEFAULT_TASKS;
+	unsigned int n = DEFAULT_STRINGS;
+	int iterations = DEFAULT_ITERATIONS;
+	std::vector<std::string> names;
+	Strings nameStrs, argStrs;
+	Random rnd(1);
+	int opt;
+
+	while ((opt = getopt(argc, argv, "c:t:n:i:h")) != -1) {
+		switch (opt) {
+		case 'c':
+			cpus = strtoul(optarg, nullptr, 0);
+			break;
+		case 't':
+			tasks = strtoul(optarg, nullptr, 0);
+			break;
+		case 'n':
+			n = strtoul(optarg, nullptr, 0);
+			break;
+		case 'i':
+			iterations = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc || cpus < 1 || tasks < 1 || n < 1 ||
+	    iterations < 1)
+		usage(argv[0]);
+
+	makeTaskNames(names, cpus, tasks, rnd);
+	makeNames(nameStrs, names, n, rnd);
+	makeArgs(argStrs, names, cpus, n, rnd);
+
+	printf("%u cpus, %u tasks, %u names, %u args, best of %d "
+	       "iterations\n", cpus, tasks, nameStrs.size, argStrs.size,
+	       iterations);
+	/* These are the sizes of namePool and argPool in the grammars */
+	report("names", nameStrs, 1024, 65536, 0, iterations);
+	report("args", argStrs, 2048, 1024 * 1024, ARG_CUTOFF, iterations);
+	return 0;
+}
@@ -0,0 +1,369 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This program opens each of the given traces in turn and runs it through
+ * the same stages as MainWindow::openFile() does, without a GUI:
+ *
+ * load     TraceAnalyzer::open(), which starts the loading and parsing threads
+ * process  TraceAnalyzer::processTrace(), which waits for the parser
+ * scale    TraceAnalyzer::doScale(), with a fixed layout
+ * stats    TraceAnalyzer::doStats()
+ *
+ * The results are written to stdout as JSON. The default settings are used,
+ * not those in the settings file, so that the results can be compared between
+ * machines, they can be changed with the options below. Usage:
+ *
+ * pipelinebench [-P] [-M] [-l] [-c] [-C] [-b nr_buffers] [-s buffer_size]
+ *               [-r repeats] tracefile...
+ *
+ * -P  Disable parallel parsing
+ * -M  Disable the mapped loading
+ * -l  Enable lazy arguments
+ * -c  Enable the index cache
+ * -C  Store the events also in columns
+ * -b  The number of load buffers
+ * -s  The size of the load buffers in MB
+ * -r  Run each trace this many times, the best time of each stage is reported
+ *
+ * The peak RSS is that of the whole process, so it only grows from one trace
+ * to the next. Run the program with one trace at a time in order to measure
+ * the memory usage of each trace.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include <QCoreApplication>
+#include <QColor>
+#include <QMap>
+#include <QString>
+
+#include "analyzer/traceanalyzer.h"
+#include "misc/errors.h"
+#include "misc/setting.h"
+#include "misc/settingstore.h"
+#include "parser/tracefile.h"
+#include "vtl/bsdexits.h"
+#include "vtl/error.h"
+
+extern "C" {
+#include <sys/resource.h>
+#include <unistd.h>
+}
+
+/* These are about the same as what MainWindow::computeLayout() uses */
+#define BENCH_SCHED_HEIGHT (950)
+#define BENCH_CPU_HEIGHT (800)
+#define BENCH_SPACING (250)
+
+#define BENCH_MB (1024.0 * 1024.0)
+
+enum Stage : int {
+	STAGE_LOAD = 0,
+	STAGE_PROCESS,
+	STAGE_SCALE,
+	STAGE_STATS,
+	NR_STAGES
+};
+
+static const char * const stageNames[NR_STAGES] = {
+	"load",
+	"process",
+	"scale",
+	"stats"
+};
+
+struct Result {
+	double time[NR_STAGES];
+	int64_t bytes;
+	int events;
+	unsigned int cpus;
+	int tasks;
+	long peakRss;
+};
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* Returns the peak RSS of the process in kB */
+static long peakRss()
+{
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return -1;
+	return usage.ru_maxrss;
+}
+
+static void printString(const char *str)
+{
+	const char *c;
+
+	putchar('"');
+	for (c = str; *c != '\0'; c++) {
+		if (*c == '"' || *c == '\\')
+			printf("\\%c", *c);
+		else if ((unsigned char) *c < 0x20)
+			printf("\\u%04x", (unsigned int) *c);
+		else
+			putchar(*c);
+	}
+	putchar('"');
+}
+
+static void setLayout(TraceAnalyzer *analyzer)
+{
+	unsigned int nrCPUs = analyzer->getNrCPUs();
+	unsigned int cpu;
+	double offset = 0;
+
+	for (cpu = 0; cpu < nrCPUs; cpu++) {
+		analyzer->setSchedOffset(cpu, offset);
+		analyzer->setSchedScale(cpu, BENCH_SCHED_HEIGHT);
+		offset += BENCH_SCHED_HEIGHT + BENCH_SPACING;
+	}
+	for (cpu = 0; cpu < nrCPUs; cpu++) {
+		analyzer->setCpuFreqOffset(cpu, offset);
+		analyzer->setCpuIdleOffset(cpu, offset);
+		analyzer->setCpuFreqScale(cpu, BENCH_CPU_HEIGHT);
+		analyzer->setCpuIdleScale(cpu, BENCH_CPU_HEIGHT);
+		offset += BENCH_CPU_HEIGHT + BENCH_SPACING;
+	}
+}
+
+static int runOnce(TraceAnalyzer *analyzer, const char *name, Result *result)
+{
+	double t[NR_STAGES + 1];
+	int ts_errno;
+
+	t[STAGE_LOAD] = now();
+	ts_errno = analyzer->open(QString::fromLocal8Bit(name));
+	if (ts_errno != 0)
+		return ts_errno;
+	t[STAGE_PROCESS] = now();
+	analyzer->processTrace(QMap<int, QColor>());
+	t[STAGE_SCALE] = now();
+	setLayout(analyzer);
+	analyzer->doScale();
+	t[STAGE_STATS] = now();
+	analyzer->doStats();
+	t[NR_STAGES] = now();
+
+	for (int s = 0; s < NR_STAGES; s++)
+		result->time[s] = t[s + 1] - t[s];
+	result->bytes = analyzer->getTraceFile()->getFileSize();
+	result->events = analyzer->events->size();
+	result->cpus = analyzer->getNrCPUs();
+	result->tasks = analyzer->taskMap.size();
+
+	analyzer->close(&ts_errno);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to close() %s", name);
+	result->peakRss = peakRss();
+	return 0;
+}
+
+static void printResult(const char *name, const Result *result)
+{
+	double total = 0;
+	int s;
+
+	for (s = 0; s < NR_STAGES; s++)
+		total += result->time[s];
+
+	printf("    {\n      \"file\": ");
+	printString(name);
+	printf(",\n      \"bytes\": %lld,\n"
+	       "      \"events\": %d,\n"
+	       "      \"cpus\": %u,\n"
+	       "      \"tasks\": %d,\n",
+	       (long long) result->bytes, result->events, result->cpus,
+	       result->tasks);
+	printf("      \"seconds\": {");
+	for (s = 0; s < NR_STAGES; s++)
+		printf(" \"%s\": %.6f,", stageNames[s], result->time[s]);
+	printf(" \"total\": %.6f },\n", total);
+	printf("      \"mb_per_s\": %.3f,\n"
+	       "      \"events_per_s\": %.1f,\n"
+	       "      \"peak_rss_kb\": %ld\n    }",
+	       total > 0 ? result->bytes / BENCH_MB / total : 0,
+	       total > 0 ? result->events / total : 0,
+	       result->peakRss);
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-P] [-M] [-l] [-c] [-C] [-b nr_buffers] "
+		"[-s buffer_size] [-r repeats] tracefile...\n", name);
+	exit(BSD_EX_USAGE);
+}
+
+static const char *boolString(bool b)
+{
+	return b ? "true" : "false";
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	SettingStore settingStore;
+	Result best;
+	Result result;
+	int repeats = 1;
+	int ts_errno;
+	int opt;
+	int i, r, s;
+
+	while ((opt = getopt(argc, argv, "PMlcCb:s:r:")) != -1) {
+		switch (opt) {
+		case 'P':
+			settingStore.setBoolValue(Setting::PARALLEL_PARSE,
+						  false);
+			break;
+		case 'M':
+			settingStore.setBoolValue(Setting::MAPPED_LOAD, false);
+			break;
+		case 'l':
+			settingStore.setBoolValue(Setting::LAZY_ARGS, true);
+			break;
+		case 'c':
+			settingStore.setBoolValue(Setting::INDEX_CACHE, true);
+			break;
+		case 'C':
+			settingStore.setBoolValue(Setting::EVENT_COLUMNS, true);
+			break;
+		case 'b':
+			settingStore.setIntValue(Setting::LOAD_BUFFERS,
+						 atoi(optarg));
+			break;
+		case 's':
+			settingStore.setIntValue(Setting::LOAD_BUFFER_SIZE,
+						 atoi(optarg));
+			break;
+		case 'r':
+			repeats = atoi(optarg);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind >= argc)
+		usage(argv[0]);
+	if (repeats < 1)
+		repeats = 1;
+
+	vtl::set_strerror(ts_strerror);
+
+	/* The migration arrows would need a QCustomPlot */
+	settingStore.setBoolValue(Setting::SHOW_MIGRATION_GRAPHS, false);
+	settingStore.setBoolValue(Setting::FOLLOW_TRACE, false);
+	settingStore.setBoolValue(Setting::SHOW_SCHED_GRAPHS, true);
+	settingStore.setBoolValue(Setting::SHOW_CPUFREQ_GRAPHS, true);
+	settingStore.setBoolValue(Setting::SHOW_CPUIDLE_GRAPHS, true);
+
+	TraceAnalyzer analyzer(&settingStore);
+
+	printf("{\n  \"settings\": {\n"
+	       "    \"parallel_parse\": %s,\n"
+	       "    \"mapped_load\": %s,\n"
+	       "    \"lazy_args\": %s,\n"
+	       "    \"index_cache\": %s,\n"
+	       "    \"event_columns\": %s,\n"
+	       "    \"load_buffers\": %d,\n"
+	       "    \"load_buffer_size_mb\": %d,\n"
+	       "    \"repeats\": %d\n  },\n  \"traces\": [\n",
+	       boolString(settingStore.getValue(Setting::PARALLEL_PARSE)
+			  .boolv()),
+	       boolString(settingStore.getValue(Setting::MAPPED_LOAD)
+			  .boolv()),
+	       boolString(settingStore.getValue(Setting::LAZY_ARGS).boolv()),
+	       boolString(settingStore.getValue(Setting::INDEX_CACHE)
+			  .boolv()),
+	       boolString(settingStore.getValue(Setting::EVENT_COLUMNS)
+			  .boolv()),
+	       settingStore.getValue(Setting::LOAD_BUFFERS).intv(),
+	       settingStore.getValue(Setting::LOAD_BUFFER_SIZE).intv(),
+	       repeats);
+
+	for (i = optind; i < argc; i++) {
+		for (r = 0; r < repeats; r++) {
+			ts_errno = runOnce(&analyzer, argv[i], &result);
+			if (ts_errno != 0)
+				vtl::err(BSD_EX_NOINPUT, ts_errno,
+					 "Failed to open trace file %s",
+					 argv[i]);
+			if (r == 0) {
+				best = result;
+				continue;
+			}
+			for (s = 0; s < NR_STAGES; s++) {
+				if (result.time[s] < best.time[s])
+					best.time[s] = result.time[s];
+			}
+			best.peakRss = result.peakRss;
+		}
+		printResult(argv[i], &best);
+		printf(i + 1 < argc ? ",\n" : "\n");
+	}
+
+	printf("  ],\n  \"peak_rss_kb\": %ld\n}\n", peakRss());
+	return BSD_EX_OK;
+}
@@ -0,0 +1,250 @@
+# SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+#
+#  Traceshark - a visualizer for visualizing ftrace and perf traces
+#  Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+#
+# This file is dual licensed: you can use it either under the terms of
+# the GPL, or the BSD license, at your option.
+#
+#  a) This program is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU General Public License as
+#     published by the Free Software Foundation; either version 2 of the
+#     License, or (at your option) any later version.
+#
+#     This program is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU General Public License for more details.
+#
+#     You should have received a copy of the GNU General Public
+#     License along with this library; if not, write to the Free
+#     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+#     MA 02110-1301 USA
+#
+# Alternatively,
+#
+#  b) Redistribution and use in source and binary forms, with or
+#     without modification, are permitted provided that the following
+#     conditions are met:
+#
+#     1. Redistributions of source code must retain the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer.
+#     2. Redistributions in binary form must reproduce the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer in the documentation and/or other materials
+#        provided with the distribution.
+#
+#     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+#     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+#     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+#     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+#     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+#     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+#     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+#     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+#     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+#     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+#     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Runs the whole load pipeline, from opening the trace files to computing the
+# statistics, without a GUI and reports the performance as JSON.
+# This is not built as part of traceshark, build it with:
+# cd bench && qmake pipelinebench.pro && make
+
+TEMPLATE = app
+TARGET = pipelinebench
+CONFIG += console release
+CONFIG -= app_bundle
+QT += core
+QT += widgets
+QT += printsupport
+
+INCLUDEPATH += ..
+OBJECTS_DIR = obj
+MOC_DIR = obj
+
+GIT_VERSION_HEADERS = ../misc/gitversion-template.h
+gitversion.output =  obj/gitversion.h
+gitversion.dependency_type = TYPE_C
+gitversion.variable_out = HEADERS
+gitversion.commands = ../scripts/gitversion --input ${QMAKE_FILE_NAME} --output ${QMAKE_FILE_OUT}
+gitversion.input = GIT_VERSION_HEADERS
+QMAKE_EXTRA_COMPILERS += gitversion
+
+equals(QT_MAJOR_VERSION, 6) {
+QMAKE_CXXFLAGS_RELEASE += -pedantic -Wall -std=c++17
+} else {
+QMAKE_CXXFLAGS_RELEASE += -pedantic -Wall -std=c++11
+}
+DEFINES += _FILE_OFFSET_BITS=64 _POSIX_C_SOURCE=200809L
+
+!equals(DISABLE_GZIP, yes) {
+DEFINES += CONFIG_GZIP
+LIBS += -lz
+}
+
+!equals(DISABLE_ZSTD, yes) {
+DEFINES += CONFIG_ZSTD
+LIBS += -lzstd
+}
+
+!equals(DISABLE_XZ, yes) {
+DEFINES += CONFIG_XZ
+LIBS += -llzma
+}
+
+# The analyzer creates the migration arrows and deletes the task graphs, so
+# it cannot be linked without them and QCustomPlot.
+equals(USE_SYSTEM_QCUSTOMPLOT, yes) {
+DEFINES += CONFIG_SYSTEM_QCUSTOMPLOT
+LIBS += -lqcustomplot
+} else {
+HEADERS      +=  ../qcustomplot/qcustomplot.h
+HEADERS      +=  ../qcustomplot/qcppointer.h
+HEADERS      +=  ../qcustomplot/qcppointer_impl.h
+HEADERS      +=  ../qcustomplot/qcplist.h
+SOURCES      +=  ../qcustomplot/qcustomplot.cpp
+}
+
+HEADERS      +=  ../ui/migrationarrow.h
+HEADERS      +=  ../ui/qcustomplot.h
+HEADERS      +=  ../ui/taskgraph.h
+HEADERS      +=  ../analyzer/abstracttask.h
+HEADERS      +=  ../analyzer/cpufreq.h
+HEADERS      +=  ../analyzer/cpu.h
+HEADERS      +=  ../analyzer/cpuidle.h
+HEADERS      +=  ../analyzer/cputask.h
+HEADERS      +=  ../analyzer/eventcolumns.h
+HEADERS      +=  ../analyzer/filterstate.h
+HEADERS      +=  ../analyzer/latency.h
+HEADERS      +=  ../analyzer/latencycomp.h
+HEADERS      +=  ../analyzer/migration.h
+HEADERS      +=  ../analyzer/regexfilter.h
+HEADERS      +=  ../analyzer/schedargs.h
+HEADERS      +=  ../analyzer/task.h
+HEADERS      +=  ../analyzer/tcolor.h
+HEADERS      +=  ../analyzer/traceanalyzer.h
+HEADERS      +=  ../parser/argcache.h
+HEADERS      +=  ../parser/chunkparser.h
+HEADERS      +=  ../parser/eventcache.h
+HEADERS      +=  ../parser/eventstrings.h
+HEADERS      +=  ../parser/fileinfo.h
+HEADERS      +=  ../parser/genericparams.h
+HEADERS      +=  ../parser/paramhelpers.h
+HEADERS      +=  ../parser/retentionpolicy.h
+HEADERS      +=  ../parser/timewindow.h
+HEADERS      +=  ../parser/tokenizer.h
+HEADERS      +=  ../parser/traceevent.h
+HEADERS      +=  ../parser/tracefile.h
+HEADERS      +=  ../parser/tracelinedata.h
+HEADERS      +=  ../parser/traceline.h
+HEADERS      +=  ../parser/traceparser.h
+HEADERS      +=  ../parser/tracesniffer.h
+HEADERS      +=  ../parser/compress/compressedfile.h
+HEADERS      +=  ../parser/compress/decompressor.h
+HEADERS      +=  ../parser/compress/gzipdecompressor.h
+HEADERS      +=  ../parser/compress/xzdecompressor.h
+HEADERS      +=  ../parser/compress/zstddecompressor.h
+HEADERS      +=  ../parser/ftrace/ftraceparams.h
+HEADERS      +=  ../parser/ftrace/ftracegrammar.h
+HEADERS      +=  ../parser/perf/helpers.h
+HEADERS      +=  ../parser/perf/perfdatareader.h
+HEADERS      +=  ../parser/perf/perfparams.h
+HEADERS      +=  ../parser/perf/perfgrammar.h
+HEADERS      +=  ../parser/tracecmd/eventformat.h
+HEADERS      +=  ../parser/tracecmd/tracedatreader.h
+HEADERS      +=  ../parser/tracecmd/tracingdata.h
+HEADERS      +=  ../threads/eventcount.h
+HEADERS      +=  ../threads/indexwatcher.h
+HEADERS      +=  ../threads/loadbuffer.h
+HEADERS      +=  ../threads/loadthread.h
+HEADERS      +=  ../threads/threadbuffer.h
+HEADERS      +=  ../threads/tthread.h
+HEADERS      +=  ../threads/workitem.h
+HEADERS      +=  ../threads/workqueue.h
+HEADERS      +=  ../threads/workthread.h
+HEADERS      +=  ../mm/internpool.h
+HEADERS      +=  ../mm/mempool.h
+HEADERS      +=  ../mm/stringpool.h
+HEADERS      +=  ../mm/stringtree.h
+HEADERS      +=  ../mm/stringtable.h
+HEADERS      +=  ../misc/chunk.h
+HEADERS      +=  ../misc/errors.h
+HEADERS      +=  ../misc/eventhash.h
+HEADERS      +=  ../misc/maplist.h
+HEADERS      +=  ../misc/osapi.h
+HEADERS      +=  ../misc/qtcompat.h
+HEADERS      +=  ../misc/setting.h
+HEADERS      +=  ../misc/settingstore.h
+HEADERS      +=  ../misc/string.h
+HEADERS      +=  ../misc/traceshark.h
+HEADERS      +=  ../misc/translate.h
+HEADERS      +=  ../misc/tstring.h
+HEADERS      +=  ../misc/types.h
+HEADERS      +=  ../vtl/avltree.h
+HEADERS      +=  ../vtl/bitvector.h
+HEADERS      +=  ../vtl/bsdexits.h
+HEADERS      +=  ../vtl/compiler.h
+HEADERS      +=  ../vtl/error.h
+HEADERS      +=  ../vtl/heapsort.h
+HEADERS      +=  ../vtl/tlist.h
+HEADERS      +=  ../vtl/time.h
+
+SOURCES      +=  ../ui/migrationarrow.cpp
+SOURCES      +=  ../ui/taskgraph.cpp
+SOURCES      +=  ../analyzer/abstracttask.cpp
+SOURCES      +=  ../analyzer/cpufreq.cpp
+SOURCES      +=  ../analyzer/cpuidle.cpp
+SOURCES      +=  ../analyzer/cputask.cpp
+SOURCES      +=  ../analyzer/eventcolumns.cpp
+SOURCES      +=  ../analyzer/filterstate.cpp
+SOURCES      +=  ../analyzer/latencycomp.cpp
+SOURCES      +=  ../analyzer/regexfilter.cpp
+SOURCES      +=  ../analyzer/task.cpp
+SOURCES      +=  ../analyzer/tcolor.cpp
+SOURCES      +=  ../analyzer/traceanalyzer.cpp
+SOURCES      +=  ../parser/argcache.cpp
+SOURCES      +=  ../parser/chunkparser.cpp
+SOURCES      +=  ../parser/eventcache.cpp
+SOURCES      +=  ../parser/eventstrings.cpp
+SOURCES      +=  ../parser/fileinfo.cpp
+SOURCES      +=  ../parser/retentionpolicy.cpp
+SOURCES      +=  ../parser/timewindow.cpp
+SOURCES      +=  ../parser/tokenizer.cpp
+SOURCES      +=  ../parser/traceevent.cpp
+SOURCES      +=  ../parser/tracefile.cpp
+SOURCES      +=  ../parser/traceparser.cpp
+SOURCES      +=  ../parser/tracesniffer.cpp
+SOURCES      +=  ../parser/compress/compressedfile.cpp
+SOURCES      +=  ../parser/compress/decompressor.cpp
+SOURCES      +=  ../parser/compress/gzipdecompressor.cpp
+SOURCES      +=  ../parser/compress/xzdecompressor.cpp
+SOURCES      +=  ../parser/compress/zstddecompressor.cpp
+SOURCES      +=  ../parser/ftrace/ftraceparams.cpp
+SOURCES      +=  ../parser/ftrace/ftracegrammar.cpp
+SOURCES      +=  ../parser/perf/perfdatareader.cpp
+SOURCES      +=  ../parser/perf/perfparams.cpp
+SOURCES      +=  ../parser/perf/perfgrammar.cpp
+SOURCES      +=  ../parser/tracecmd/eventformat.cpp
+SOURCES      +=  ../parser/tracecmd/tracedatreader.cpp
+SOURCES      +=  ../parser/tracecmd/tracingdata.cpp
+SOURCES      +=  ../threads/eventcount.cpp
+SOURCES      +=  ../threads/indexwatcher.cpp
+SOURCES      +=  ../threads/loadbuffer.cpp
+SOURCES      +=  ../threads/loadthread.cpp
+SOURCES      +=  ../threads/tthread.cpp
+SOURCES      +=  ../threads/workqueue.cpp
+SOURCES      +=  ../mm/mempool.cpp
+SOURCES      +=  ../misc/errors.cpp
+SOURCES      +=  ../misc/qtcompat.cpp
+SOURCES      +=  ../misc/setting.cpp
+SOURCES      +=  ../misc/settingstore.cpp
+SOURCES      +=  ../misc/traceshark.cpp
+SOURCES      +=  ../misc/translate.cpp
+SOURCES      +=  ../vtl/bitvector.cpp
+SOURCES      +=  ../vtl/error.cpp
+SOURCES      +=  ../vtl/time.cpp
+SOURCES      +=  pipelinebench.cpp
@@ -0,0 +1,80 @@
+#!/bin/sh
+# SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+#
+#  pipelinebench.sh - a script to run pipelinebench on generated traces
+#  Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+#  This file is dual licensed: you can use it either under the terms of
+#  the GPL, or the BSD license, at your option.
+#
+#   a) This program is free software; you can redistribute it and/or
+#      modify it under the terms of the GNU General Public License as
+#      published by the Free Software Foundation; either version 2 of the
+#      License, or (at your option) any later version.
+#
+#      This program is distributed in the hope that it will be useful,
+#      but WITHOUT ANY WARRANTY; without even the implied warranty of
+#      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#      GNU General Public License for more details.
+#
+#      You should have received a copy of the GNU General Public
+#      License along with this library; if not, write to the Free
+#      Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+#      MA 02110-1301 USA
+#
+#  Alternatively,
+#
+#   b) Redistribution and use in source and binary forms, with or
+#      without modification, are permitted provided that the following
+#      conditions are met:
+#
+#      1. Redistributions of source code must retain the above
+#         copyright notice, this list of conditions and the following
+#         disclaimer.
+#      2. Redistributions in binary form must reproduce the above
+#         copyright notice, this list of conditions and the following
+#         disclaimer in the documentation and/or other materials
+#         provided with the distribution.
+#
+#      THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+#      CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+#      INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+#      MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#      DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+#      CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+#      SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+#      NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#      LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+#      HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+#      CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+#      OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+#      EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+# Generates a fixed set of traces with tracegen and runs pipelinebench on them,
+# so that the results can be compared between versions without depending on
+# captured traces. The arguments are passed on to pipelinebench, for example:
+# ./pipelinebench.sh -r 3 > results.json
+
+benchdir=$(dirname $0)
+tracedir=$(mktemp -d)
+
+if [ ! -x $benchdir/tracegen ] || [ ! -x $benchdir/pipelinebench ];then
+    echo "Build tracegen and pipelinebench first" 1>&2
+    rmdir $tracedir
+    exit 1
+fi
+
+# A desktop with few CPUs, one perf trace with backtraces
+$benchdir/tracegen -s 1 -c 8 -t 300 -n 2000000 $tracedir/ftrace-8cpu.txt
+$benchdir/tracegen -s 1 -c 8 -t 300 -n 1000000 -f perf -b 16 \
+		   $tracedir/perf-8cpu.txt
+# A large server with many tasks, long names and frequent migrations
+$benchdir/tracegen -s 2 -c 256 -t 20000 -n 2000000 -l 60 -m 0.2 -x 0.01 \
+		   $tracedir/ftrace-256cpu.txt
+
+$benchdir/pipelinebench "$@" $tracedir/ftrace-8cpu.txt \
+			$tracedir/perf-8cpu.txt $tracedir/ftrace-256cpu.txt
+status=$?
+
+rm -rf $tracedir
+exit $status
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This program first checks that vtl::Time::fromString() gives the same time,
+ * precision and ok flag as vtl::Time::fromStringScalar() for a large number of
+ * random strings, which are placed at all offsets near the end of a page in
+ * order to exercise the fallback as well. Then it measures the speed of both
+ * with typical timestamps of microsecond and nanosecond precision. Usage:
+ *
+ * timebench [nr_strings] [iterations]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "vtl/time.h"
+
+extern "C" {
+#include <sys/mman.h>
+#include <unistd.h>
+}
+
+#define DEFAULT_NR_STRINGS (100000)
+#define DEFAULT_ITERATIONS (20)
+#define FUZZ_ROUNDS (4000000)
+
+/* Large enough for the longest string that is generated */
+#define STR_SIZE (64)
+
+static const char tailChars[] = ":: .-x0\n";
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static void addDigits(char **b, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		**b = '0' + rand() % 10;
+		(*b)++;
+	}
+}
+
+/*
+ * Generates a string that mostly looks like a timestamp, with lengths of the
+ * integer and fractional parts that also cover the cases where the SSSE3
+ * parsing gives up.
+ */
+static void randomString(char *buf)
+{
+	char *b = buf;
+	int i;
+
+	if (rand() % 8 == 0) {
+		for (i = 0; i < STR_SIZE - 1; i++)
+			buf[i] = (char) (rand() % 256);
+		buf[rand() % STR_SIZE] = '\0';
+		buf[STR_SIZE - 1] = '\0';
+		return;
+	}
+	if (rand() % 8 == 0)
+		*b++ = '-';
+	addDigits(&b, rand() % 20);
+	if (rand() % 8 != 0) {
+		*b++ = '.';
+		addDigits(&b, rand() % 20);
+	}
+	*b++ = tailChars[rand() % (sizeof(tailChars) - 1)];
+	*b = '\0';
+}
+
+static bool compare(const char *str)
+{
+	vtl::Time t1, t2;
+	bool ok1 = false;
+	bool ok2 = false;
+
+	t1 = vtl::Time::fromString(str, ok1);
+	t2 = vtl::Time::fromStringScalar(str, ok2);
+	if (t1 == t2 && t1.getPrecision() == t2.getPrecision() && ok1 == ok2)
+		return true;
+
+	/* sprint() can't be used, because it needs a precision below 10 */
+	fprintf(stderr, "MISMATCH for \"%s\": %.9f %u %d != %.9f %u %d\n",
+		str, t1.toDouble(), t1.getPrecision(), (int) ok1,
+		t2.toDouble(), t2.getPrecision(), (int) ok2);
+	return false;
+}
+
+/*
+ * The strings are copied to the end of a page that is followed by a page that
+ * is not accessible, so that reading too much would crash the program.
+ */
+static bool fuzz()
+{
+	const long pageSize = sysconf(_SC_PAGESIZE);
+	char str[STR_SIZE];
+	char *pages;
+	char *dst;
+	size_t len;
+	long i;
+
+	pages = (char*) mmap(nullptr, 2 * pageSize, PROT_READ | PROT_WRITE,
+			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (pages == MAP_FAILED ||
+	    mprotect(pages + pageSize, pageSize, PROT_NONE) != 0) {
+		perror("mmap");
+		return false;
+	}
+
+	for (i = 0; i < FUZZ_ROUNDS; i++) {
+		randomString(str);
+		len = strlen(str) + 1;
+		if (i % 2 == 0)
+			dst = pages + pageSize - len;
+		else
+			dst = pages + pageSize - STR_SIZE - rand() % 64;
+		memcpy(dst, str, len);
+		if (!compare(dst))
+			return false;
+	}
+	munmap(pages, 2 * pageSize);
+	return true;
+}
+
+/* This is a template so that the parsing function can be inlined */
+template<vtl::Time (*fn)(const char *, bool &)>
+static double bench(char **strings, int nr, int iterations, vtl::Time *max)
+{
+	double besttime = 0;
+	double begin;
+	double t;
+	bool ok;
+	int i, j;
+
+	for (i = 0; i < iterations; i++) {
+		*max = VTL_TIME_MIN;
+		begin = now();
+		for (j = 0; j < nr; j++) {
+			vtl::Time time = fn(strings[j], ok);
+			if (ok && time > *max)
+				*max = time;
+		}
+		t = now() - begin;
+		if (i == 0 || t < besttime)
+			besttime = t;
+	}
+	return besttime;
+}
+
+static void benchFormat(char **strings, int nr, int iterations,
+			const char *format, unsigned int fracmod)
+{
+	vtl::Time max1, max2;
+	unsigned int sec = 4000;
+	double scalar, fast;
+	int i;
+
+	/* Increasing timestamps, like in a trace */
+	for (i = 0; i < nr; i++) {
+		sec += rand() % 2;
+		sprintf(strings[i], format, sec, (unsigned) rand() % fracmod);
+	}
+
+	scalar = bench<vtl::Time::fromStringScalar>(strings, nr, iterations,
+						    &max1);
+	fast = bench<vtl::Time::fromString>(strings, nr, iterations, &max2);
+	if (!(max1 == max2))
+		fprintf(stderr, "The results differ!\n");
+
+	printf("%s\n", format);
+	printf("  scalar     %8.2f ns/string\n", scalar * 1e9 / nr);
+	printf("  fromString %8.2f ns/string %6.2fx\n", fast * 1e9 / nr,
+	       scalar / fast);
+}
+
+int main(int argc, char *argv[])
+{
+	int nr = DEFAULT_NR_STRINGS;
+	int iterations = DEFAULT_ITERATIONS;
+	char **strings;
+	char *buf;
+	int i;
+
+	if (argc > 1)
+		nr = atoi(argv[1]);
+	if (argc > 2)
+		iterations = atoi(argv[2]);
+	if (nr < 1)
+		nr = 1;
+	if (iterations < 1)
+		iterations = 1;
+
+#ifdef VTL_TIME_SSSE3
+	printf("SSSE3 parsing is %s\n",
+	       vtl::Time::useSSSE3 ? "enabled" : "not supported by the CPU");
+#else
+	printf("SSSE3 parsing is not available on this platform\n");
+#endif
+
+	if (!fuzz())
+		return 1;
+	printf("%d random strings gave identical results\n", FUZZ_ROUNDS);
+
+	buf = new char[(size_t) nr * STR_SIZE];
+	strings = new char*[nr];
+	for (i = 0; i < nr; i++)
+		strings[i] = buf + (size_t) i * STR_SIZE;
+
+	printf("%d strings, best of %d iterations\n", nr, iterations);
+	benchFormat(strings, nr, iterations, "%u.%06u: ", 1000000);
+	benchFormat(strings, nr, iterations, "%u.%09u: ", 1000000000);
+
+	delete[] strings;
+	delete[] buf;
+	return 0;
+}
@@ -0,0 +1,202 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This program measures the throughput of the tokenizers in MB/s. It reads a
+ * trace file into memory and splits all of it into lines and words with each
+ * tokenizer that is supported by the CPU. Usage:
+ *
+ * tokenizerbench <tracefile> [iterations]
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "parser/tokenizer.h"
+#include "misc/tstring.h"
+
+extern "C" {
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+/* This is the same as EVENT_MAX_NR_ARGS */
+#define BENCH_MAX_WORDS (128)
+
+/* The tokenizers use unsigned int positions, so we limit the size */
+#define BENCH_MAX_SIZE (1024L * 1024 * 1024)
+
+#define DEFAULT_ITERATIONS (5)
+
+static char *readFile(const char *name, unsigned int *size)
+{
+	struct stat sbuf;
+	char *buf;
+	ssize_t r;
+	size_t count = 0;
+	size_t fsize;
+	int fd;
+
+	fd = open(name, O_RDONLY);
+	if (fd < 0 || fstat(fd, &sbuf) != 0) {
+		fprintf(stderr, "Failed to open %s: %s\n", name,
+			strerror(errno));
+		return nullptr;
+	}
+	fsize = sbuf.st_size < BENCH_MAX_SIZE ? sbuf.st_size : BENCH_MAX_SIZE;
+	buf = new char[fsize];
+	while (count < fsize) {
+		r = read(fd, buf + count, fsize - count);
+		if (r < 0 && errno == EINTR)
+			continue;
+		if (r <= 0)
+			break;
+		count += r;
+	}
+	close(fd);
+	*size = count;
+	return buf;
+}
+
+static double now()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* Returns the number of words, the best time is stored in besttime */
+static unsigned long bench(Tokenizer::tokenize_fn fn, const char *buf,
+			   unsigned int size, int iterations,
+			   double *besttime)
+{
+	TString strings[BENCH_MAX_WORDS];
+	unsigned long words = 0;
+	unsigned int pos;
+	unsigned int next;
+	double begin;
+	double t;
+	int i;
+
+	*besttime = 0;
+	for (i = 0; i < iterations; i++) {
+		words = 0;
+		begin = now();
+		for (pos = 0; pos < size; pos = next) {
+			words += fn(buf, pos, size, strings, BENCH_MAX_WORDS,
+				    &next);
+		}
+		t = now() - begin;
+		if (i == 0 || t < *besttime)
+			*besttime = t;
+	}
+	return words;
+}
+
+int main(int argc, char *argv[])
+{
+	Tokenizer::tokenize_fn fn;
+	unsigned long scalarWords = 0;
+	unsigned long words;
+	double scalarSpeed = 0;
+	double speed;
+	double t;
+	unsigned int size;
+	int iterations = DEFAULT_ITERATIONS;
+	char *buf;
+	int i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <tracefile> [iterations]\n",
+			argv[0]);
+		return 1;
+	}
+	if (argc > 2)
+		iterations = atoi(argv[2]);
+	if (iterations < 1)
+		iterations = 1;
+
+	buf = readFile(argv[1], &size);
+	if (buf == nullptr)
+		return 1;
+
+	printf("%u bytes, best of %d iterations, default tokenizer is %s\n",
+	       size, iterations, Tokenizer::getTokenizerName());
+
+	for (i = 0; Tokenizer::tokenizerNames[i] != nullptr; i++) {
+		fn = Tokenizer::getTokenizer(Tokenizer::tokenizerNames[i]);
+		if (fn == nullptr) {
+			printf("%-8s not supported by this CPU\n",
+			       Tokenizer::tokenizerNames[i]);
+			continue;
+		}
+		words = bench(fn, buf, size, iterations, &t);
+		speed = size / t / (1024 * 1024);
+		if (fn == Tokenizer::tokenizeScalar) {
+			scalarWords = words;
+			scalarSpeed = speed;
+		}
+		printf("%-8s %10.1f MB/s %6.2fx %lu words%s\n",
+		       Tokenizer::tokenizerNames[i], speed,
+		       speed / scalarSpeed, words,
+		       words != scalarWords ? " MISMATCH" : "");
+	}
+
+	delete[] buf;
+	return 0;
+}
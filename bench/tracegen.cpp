@@ -0,0 +1,591 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * This program generates synthetic traces in the formats of trace-cmd report
+ * and perf script, so that traceshark can be benchmarked and tested with
+ * traces of a known size and shape. The same options and seed always give the
+ * same trace. The scheduling is consistent: a task is woken up before it is
+ * switched in, if it went to sleep, it is migrated before it runs on another
+ * CPU, and an idle CPU enters and exits an idle state. Usage:
+ *
+ * tracegen [options] [outfile]
+ *
+ * -f format    ftrace or perf, the default is ftrace
+ * -c cpus      The number of CPUs, at most 9999
+ * -t tasks     The number of tasks
+ * -n events    The number of events
+ * -r rate      The average number of events per second
+ * -w ratio     The probability that a task sleeps, instead of being
+ *              preempted, when it is switched out and has to be woken up
+ * -m ratio     The probability that a switch picks a task from another CPU,
+ *              which then is migrated
+ * -F ratio     The probability that an event is a cpu_frequency event
+ * -I ratio     The probability that a CPU goes idle after a task
+ * -x ratio     The probability that a task forks a new task and exits
+ * -l length    The maximum length of the task names, they may contain spaces
+ * -b depth     The maximum length of the backtraces, only for perf
+ * -s seed      The seed of the random number generator
+ * -N           Print the timestamps with nanoseconds
+ *
+ * The trace is written to stdout if no outfile is given.
+ */
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench/benchrandom.h"
+#include "misc/traceshark.h"
+#include "vtl/bsdexits.h"
+
+extern "C" {
+#include <unistd.h>
+}
+
+/* These are the same as NR_CPUS_ALLOWED and TASKNAME_MAXLEN */
+#define GEN_MAX_CPUS (9999)
+#define GEN_MAX_NAMELEN (128)
+
+#define GEN_FIRST_PID (1000)
+#define GEN_PRIO (120)
+#define GEN_START_TIME (100ULL * 1000000000ULL)
+#define GEN_NR_IDLE_STATES (4)
+#define GEN_IDLE_EXIT (4294967295U)
+#define GEN_MIN_FREQ (800000)
+#define GEN_FREQ_STEP (100000)
+#define GEN_NR_FREQS (25)
+
+enum TaskState : int {
+	TASK_RUNNING = 0,
+	TASK_RUNNABLE,
+	TASK_SLEEPING
+};
+
+struct Task {
+	std::string name;
+	int pid;
+	unsigned int cpu;
+	TaskState state;
+	/* The index in the queue of cpu, when the task is not running */
+	unsigned int queueIdx;
+};
+
+struct Options {
+	bool perf;
+	unsigned int cpus;
+	unsigned int tasks;
+	uint64_t events;
+	uint64_t rate;
+	double wakeupRatio;
+	double migrationRatio;
+	double freqRatio;
+	double idleRatio;
+	double forkRatio;
+	unsigned int nameLen;
+	unsigned int btDepth;
+	uint64_t seed;
+	bool nsec;
+};
+
+static const char * const nameWords[] = {
+	"Web", "Content", "Isolated", "Servo", "Thread", "DOM", "Worker",
+	"Chrome_IOThread", "gmain", "pool", "Compositor", "Socket", "Process",
+	"kworker/u16:3", "rcu_sched", "bash", "Xorg", "gnome-shell", "a-b-c",
+	"JS", "Helper", "Renderer", "Media", "Timer", "ksoftirqd/1"
+};
+
+static const char * const functions[] = {
+	"__schedule", "schedule", "do_nanosleep", "hrtimer_nanosleep",
+	"__x64_sys_nanosleep", "do_syscall_64", "entry_SYSCALL_64_after_hwframe",
+	"futex_wait_queue_me", "futex_wait", "do_futex", "__x64_sys_futex",
+	"schedule_hrtimeout_range_clock", "do_sys_poll", "__x64_sys_poll",
+	"worker_thread", "kthread", "ret_from_fork", "smpboot_thread_fn",
+	"pipe_read", "new_sync_read", "vfs_read", "ksys_read"
+};
+
+class Generator {
+public:
+	Generator(const Options &opts, FILE *file);
+	void run();
+private:
+	void newTask(Task *task, unsigned int cpu);
+	void enqueue(unsigned int idx, unsigned int cpu);
+	void dequeue(unsigned int idx);
+	int pickTask(unsigned int cpu);
+	void contextSwitch(unsigned int cpu);
+	void header(unsigned int cpu, const char *subsys, const char *event);
+	void backtrace();
+	void emitFreq(unsigned int cpu);
+	void emitIdle(unsigned int cpu, unsigned int state);
+	void emitWake(unsigned int cpu, const char *event, const Task &task);
+	void emitMigrate(unsigned int cpu, const Task &task,
+			 unsigned int dest);
+	void emitFork(unsigned int cpu, const Task &parent, const Task &child);
+	void emitExit(unsigned int cpu, const Task &task);
+	void emitSwitch(unsigned int cpu, int next, char state);
+	const char *comm(int idx, unsigned int cpu);
+	int pid(int idx) const;
+	const Options &opts;
+	FILE *file;
+	Random rnd;
+	/* The backtraces have their own, so that perf gets the same schedule */
+	Random btRnd;
+	uint64_t time;
+	uint64_t nrEvents;
+	int nextPid;
+	std::vector<Task> tasks;
+	/* The tasks that are not running, by the CPU that they last ran on */
+	std::vector<std::vector<unsigned int>> queues;
+	/* The index of the running task of each CPU, or -1 if it is idle */
+	std::vector<int> current;
+	std::vector<bool> inIdleState;
+	char idleName[32];
+};
+
+Generator::Generator(const Options &o, FILE *f):
+	opts(o), file(f), rnd(o.seed), btRnd(~o.seed), time(GEN_START_TIME), nrEvents(0),
+	nextPid(GEN_FIRST_PID), tasks(o.tasks), queues(o.cpus),
+	current(o.cpus, -1), inIdleState(o.cpus, false)
+{
+	unsigned int i;
+
+	for (i = 0; i < tasks.size(); i++) {
+		newTask(&tasks[i], rnd.below(opts.cpus));
+		enqueue(i, tasks[i].cpu);
+	}
+}
+
+void Generator::newTask(Task *task, unsigned int cpu)
+{
+	unsigned int len = 1 + rnd.below(opts.nameLen);
+
+	task->name.clear();
+	while (task->name.size() < len) {
+		if (!task->name.empty())
+			task->name += ' ';
+		task->name += nameWords[rnd.below(arraylen(nameWords))];
+	}
+	task->name.resize(len);
+	while (task->name.back() == ' ')
+		task->name.pop_back();
+	task->pid = nextPid++;
+	task->cpu = cpu;
+	task->state = TASK_RUNNABLE;
+}
+
+void Generator::enqueue(unsigned int idx, unsigned int cpu)
+{
+	tasks[idx].cpu = cpu;
+	tasks[idx].queueIdx = queues[cpu].size();
+	queues[cpu].push_back(idx);
+}
+
+void Generator::dequeue(unsigned int idx)
+{
+	std::vector<unsigned int> &queue = queues[tasks[idx].cpu];
+	unsigned int last = queue.back();
+
+	queue[tasks[idx].queueIdx] = last;
+	tasks[last].queueIdx = tasks[idx].queueIdx;
+	queue.pop_back();
+}
+
+/* Returns the index of a task that is not running, or -1 if none is found */
+int Generator::pickTask(unsigned int cpu)
+{
+	const std::vector<unsigned int> &queue = queues[cpu];
+	unsigned int idx;
+
+	if (rnd.chance(opts.migrationRatio)) {
+		idx = rnd.below(tasks.size());
+		if (tasks[idx].state != TASK_RUNNING)
+			return idx;
+	}
+	if (queue.empty())
+		return -1;
+	return queue[rnd.below(queue.size())];
+}
+
+const char *Generator::comm(int idx, unsigned int cpu)
+{
+	if (idx >= 0)
+		return tasks[idx].name.c_str();
+	snprintf(idleName, sizeof(idleName), "swapper/%u", cpu);
+	return idleName;
+}
+
+int Generator::pid(int idx) const
+{
+	return idx >= 0 ? tasks[idx].pid : 0;
+}
+
+void Generator::header(unsigned int cpu, const char *subsys,
+		       const char *event)
+{
+	int idx = current[cpu];
+	unsigned long long sec = time / 1000000000ULL;
+	unsigned long long nsec = time % 1000000000ULL;
+	char tbuf[64];
+
+	if (opts.nsec)
+		snprintf(tbuf, sizeof(tbuf), "%llu.%09llu", sec, nsec);
+	else
+		snprintf(tbuf, sizeof(tbuf), "%llu.%06llu", sec, nsec / 1000);
+
+	if (opts.perf)
+		fprintf(file, "%16s %6d [%03u] %s: %s:%s: ",
+			idx >= 0 ? tasks[idx].name.c_str() : "swapper",
+			pid(idx), cpu, tbuf, subsys, event);
+	else
+		fprintf(file, "%16s-%-5d [%03u] %s: %s: ",
+			idx >= 0 ? tasks[idx].name.c_str() : "<idle>",
+			pid(idx), cpu, tbuf, event);
+	nrEvents++;
+}
+
+void Generator::backtrace()
+{
+	unsigned int depth;
+	unsigned int i;
+	unsigned int f;
+
+	if (!opts.perf || opts.btDepth == 0)
+		return;
+	depth = 1 + btRnd.below(opts.btDepth);
+	for (i = 0; i < depth; i++) {
+		f = btRnd.below(arraylen(functions));
+		fprintf(file, "\t    %016llx %s+0x%x ([kernel.kallsyms])\n",
+			0xffffffff81000000ULL + f * 0x1000 + i * 0x10,
+			functions[f], (unsigned int) (i * 0x10 + 0x5));
+	}
+	fputc('\n', file);
+}
+
+void Generator::emitFreq(unsigned int cpu)
+{
+	header(cpu, "power", "cpu_frequency");
+	fprintf(file, "state=%u cpu_id=%u\n",
+		(unsigned int) (GEN_MIN_FREQ +
+				rnd.below(GEN_NR_FREQS) * GEN_FREQ_STEP), cpu);
+	backtrace();
+}
+
+void Generator::emitIdle(unsigned int cpu, unsigned int state)
+{
+	header(cpu, "power", "cpu_idle");
+	fprintf(file, "state=%u cpu_id=%u\n", state, cpu);
+	backtrace();
+}
+
+void Generator::emitWake(unsigned int cpu, const char *event,
+			 const Task &task)
+{
+	header(cpu, "sched", event);
+	fprintf(file, "comm=%s pid=%d prio=%d target_cpu=%03u\n",
+		task.name.c_str(), task.pid, GEN_PRIO, cpu);
+	backtrace();
+}
+
+void Generator::emitMigrate(unsigned int cpu, const Task &task,
+			    unsigned int dest)
+{
+	header(cpu, "sched", "sched_migrate_task");
+	fprintf(file, "comm=%s pid=%d prio=%d orig_cpu=%u dest_cpu=%u\n",
+		task.name.c_str(), task.pid, GEN_PRIO, task.cpu, dest);
+	backtrace();
+}
+
+void Generator::emitFork(unsigned int cpu, const Task &parent,
+			 const Task &child)
+{
+	header(cpu, "sched", "sched_process_fork");
+	fprintf(file, "comm=%s pid=%d child_comm=%s child_pid=%d\n",
+		parent.name.c_str(), parent.pid, child.name.c_str(),
+		child.pid);
+	backtrace();
+}
+
+void Generator::emitExit(unsigned int cpu, const Task &task)
+{
+	header(cpu, "sched", "sched_process_exit");
+	fprintf(file, "comm=%s pid=%d prio=%d\n", task.name.c_str(),
+		task.pid, GEN_PRIO);
+	backtrace();
+}
+
+void Generator::emitSwitch(unsigned int cpu, int next, char state)
+{
+	int prev = current[cpu];
+
+	header(cpu, "sched", "sched_switch");
+	fprintf(file, "prev_comm=%s prev_pid=%d prev_prio=%d prev_state=%c "
+		"==> ", comm(prev, cpu), pid(prev), GEN_PRIO, state);
+	fprintf(file, "next_comm=%s next_pid=%d next_prio=%d\n",
+		comm(next, cpu), pid(next), GEN_PRIO);
+	backtrace();
+}
+
+void Generator::contextSwitch(unsigned int cpu)
+{
+	int prev = current[cpu];
+	int next;
+	char state = 'R';
+	Task child;
+
+	if (prev >= 0 && rnd.chance(opts.idleRatio))
+		next = -1;
+	else
+		next = pickTask(cpu);
+	if (prev < 0 && next < 0)
+		return;
+
+	if (prev < 0 && inIdleState[cpu]) {
+		emitIdle(cpu, GEN_IDLE_EXIT);
+		inIdleState[cpu] = false;
+	}
+
+	if (next >= 0) {
+		Task &task = tasks[next];
+		if (task.state == TASK_SLEEPING) {
+			emitWake(cpu, "sched_waking", task);
+			emitWake(cpu, "sched_wakeup", task);
+		}
+		if (task.cpu != cpu)
+			emitMigrate(cpu, task, cpu);
+		dequeue(next);
+		task.cpu = cpu;
+		task.state = TASK_RUNNING;
+	}
+
+	if (prev >= 0) {
+		Task &task = tasks[prev];
+		if (rnd.chance(opts.forkRatio)) {
+			/* The new task takes the place of the one that exits */
+			newTask(&child, cpu);
+			child.name = task.name;
+			emitFork(cpu, task, child);
+			emitWake(cpu, "sched_wakeup_new", child);
+			emitExit(cpu, task);
+			state = 'X';
+		} else if (rnd.chance(opts.wakeupRatio)) {
+			task.state = TASK_SLEEPING;
+			state = 'S';
+		} else {
+			task.state = TASK_RUNNABLE;
+		}
+	}
+
+	emitSwitch(cpu, next, state);
+	if (state == 'X')
+		tasks[prev] = child;
+	if (prev >= 0)
+		enqueue(prev, cpu);
+	current[cpu] = next;
+
+	if (next < 0) {
+		emitIdle(cpu, rnd.below(GEN_NR_IDLE_STATES));
+		inIdleState[cpu] = true;
+	}
+}
+
+void Generator::run()
+{
+	uint64_t gap = 2 * 1000000000ULL / opts.rate;
+	unsigned int cpu;
+
+	if (!opts.perf)
+		fprintf(file, "cpus=%u\n", opts.cpus);
+
+	while (nrEvents < opts.events) {
+		time += 1 + rnd.below(gap);
+		cpu = rnd.below(opts.cpus);
+		if (rnd.chance(opts.freqRatio))
+			emitFreq(cpu);
+		else
+			contextSwitch(cpu);
+	}
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [options] [outfile]\n\n"
+		"-f format    ftrace or perf, the default is ftrace\n"
+		"-c cpus      The number of CPUs, at most %d\n"
+		"-t tasks     The number of tasks\n"
+		"-n events    The number of events\n"
+		"-r rate      The average number of events per second\n"
+		"-w ratio     The probability that a task sleeps when it is "
+		"switched out\n"
+		"-m ratio     The probability that a task is migrated when it "
+		"is switched in\n"
+		"-F ratio     The probability that an event is cpu_frequency\n"
+		"-I ratio     The probability that a CPU goes idle after a "
+		"task\n"
+		"-x ratio     The probability that a task forks and exits\n"
+		"-l length    The maximum length of the task names\n"
+		"-b depth     The maximum length of the backtraces, only for "
+		"perf\n"
+		"-s seed      The seed of the random number generator\n"
+		"-N           Print the timestamps with nanoseconds\n",
+		name, GEN_MAX_CPUS);
+	exit(BSD_EX_USAGE);
+}
+
+static bool isRatio(double r)
+{
+	return r >= 0 && r <= 1;
+}
+
+int main(int argc, char *argv[])
+{
+	Options opts;
+	FILE *file = stdout;
+	int opt;
+
+	opts.perf = false;
+	opts.cpus = 8;
+	opts.tasks = 200;
+	opts.events = 1000000;
+	opts.rate = 100000;
+	opts.wakeupRatio = 0.5;
+	opts.migrationRatio = 0.05;
+	opts.freqRatio = 0.01;
+	opts.idleRatio = 0.1;
+	opts.forkRatio = 0.001;
+	opts.nameLen = 15;
+	opts.btDepth = 0;
+	opts.seed = 1;
+	opts.nsec = false;
+
+	while ((opt = getopt(argc, argv, "f:c:t:n:r:w:m:F:I:x:l:b:s:Nh"))
+	       != -1) {
+		switch (opt) {
+		case 'f':
+			if (!strcmp(optarg, "perf"))
+				opts.perf = true;
+			else if (strcmp(optarg, "ftrace"))
+				usage(argv[0]);
+			break;
+		case 'c':
+			opts.cpus = strtoul(optarg, nullptr, 0);
+			break;
+		case 't':
+			opts.tasks = strtoul(optarg, nullptr, 0);
+			break;
+		case 'n':
+			opts.events = strtoull(optarg, nullptr, 0);
+			break;
+		case 'r':
+			opts.rate = strtoull(optarg, nullptr, 0);
+			break;
+		case 'w':
+			opts.wakeupRatio = atof(optarg);
+			break;
+		case 'm':
+			opts.migrationRatio = atof(optarg);
+			break;
+		case 'F':
+			opts.freqRatio = atof(optarg);
+			break;
+		case 'I':
+			opts.idleRatio = atof(optarg);
+			break;
+		case 'x':
+			opts.forkRatio = atof(optarg);
+			break;
+		case 'l':
+			opts.nameLen = strtoul(optarg, nullptr, 0);
+			break;
+		case 'b':
+			opts.btDepth = strtoul(optarg, nullptr, 0);
+			break;
+		case 's':
+			opts.seed = strtoull(optarg, nullptr, 0);
+			break;
+		case 'N':
+			opts.nsec = true;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind + 1 < argc || opts.cpus < 1 || opts.cpus > GEN_MAX_CPUS ||
+	    opts.tasks < 1 || opts.rate < 1 || opts.nameLen < 1 ||
+	    opts.nameLen >= GEN_MAX_NAMELEN || !isRatio(opts.wakeupRatio) ||
+	    !isRatio(opts.migrationRatio) || !isRatio(opts.freqRatio) ||
+	    !isRatio(opts.idleRatio) || !isRatio(opts.forkRatio))
+		usage(argv[0]);
+
+	if (optind < argc) {
+		file = fopen(argv[optind], "w");
+		if (file == nullptr) {
+			fprintf(stderr, "Failed to open %s: %s\n",
+				argv[optind], strerror(errno));
+			return BSD_EX_CANTCREAT;
+		}
+	}
+
+	Generator generator(opts, file);
+	generator.run();
+
+	if (fclose(file) != 0) {
+		fprintf(stderr, "Failed to write the trace: %s\n",
+			strerror(errno));
+		return BSD_EX_IOERR;
+	}
+	return BSD_EX_OK;
+}
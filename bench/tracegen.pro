@@ -0,0 +1,87 @@
+# SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+#
+#  Traceshark - a visualizer for visualizing ftrace and perf traces
+#  Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+#
+# This file is dual licensed: you can use it either under the terms of
+# the GPL, or the BSD license, at your option.
+#
+#  a) This program is free software; you can redistribute it and/or
+#     modify it under the terms of the GNU General Public License as
+#     published by the Free Software Foundation; either version 2 of the
+#     License, or (at your option) any later version.
+#
+#     This program is distributed in the hope that it will be useful,
+#     but WITHOUT ANY WARRANTY; without even the implied warranty of
+#     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#     GNU General Public License for more details.
+#
+#     You should have received a copy of the GNU General Public
+#     License along with this library; if not, write to the Free
+#     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+#     MA 02110-1301 USA
+#
+# Alternatively,
+#
+#  b) Redistribution and use in source and binary forms, with or
+#     without modification, are permitted provided that the following
+#     conditions are met:
+#
+#     1. Redistributions of source code must retain the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer.
+#     2. Redistributions in binary form must reproduce the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer in the documentation and/or other materials
+#        provided with the distribution.
+#
+#     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+#     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+#     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+#     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+#     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+#     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+#     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+#     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+#     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+#     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+#     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+#     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+#     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Generates synthetic ftrace and perf traces for benchmarking and testing.
+# This is not built as part of traceshark, build it with:
+# cd bench && qmake tracegen.pro && make
+
+TEMPLATE = app
+TARGET = tracegen
+CONFIG += console release
+CONFIG -= app_bundle
+QT += core
+QT += widgets
+
+INCLUDEPATH += ..
+OBJECTS_DIR = obj
+
+GIT_VERSION_HEADERS = ../misc/gitversion-template.h
+gitversion.output =  obj/gitversion.h
+gitversion.dependency_type = TYPE_C
+gitversion.variable_out = HEADERS
+gitversion.commands = ../scripts/gitversion --input ${QMAKE_FILE_NAME} --output ${QMAKE_FILE_OUT}
+gitversion.input = GIT_VERSION_HEADERS
+QMAKE_EXTRA_COMPILERS += gitversion
+
+equals(QT_MAJOR_VERSION, 6) {
+QMAKE_CXXFLAGS_RELEASE += -pedantic -Wall -std=c++17
+} else {
+QMAKE_CXXFLAGS_RELEASE += -pedantic -Wall -std=c++11
+}
+DEFINES += _FILE_OFFSET_BITS=64 _POSIX_C_SOURCE=200809L
+
+HEADERS      +=  benchrandom.h
+HEADERS      +=  ../misc/traceshark.h
+HEADERS      +=  ../misc/tstring.h
+HEADERS      +=  ../vtl/bsdexits.h
+HEADERS      +=  ../vtl/compiler.h
+
+SOURCES      +=  tracegen.cpp
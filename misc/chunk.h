@@ -55,10 +55,26 @@
 
 #include <cstdint>
 
+/*
+ * A chunk is normally a range of text in the trace file, such as a backtrace
+ * in the output of perf script. A chunk can also be a callchain in a binary
+ * perf.data file, an array of 64-bit instruction pointers that need to be
+ * formatted as text before they can be shown.
+ */
+typedef enum : int16_t {
+	CHUNK_TEXT = 0,
+	CHUNK_CALLCHAIN,
+	/* A callchain with the opposite byte order of the host */
+	CHUNK_CALLCHAIN_SWAP
+} chunktype_t;
+
 class Chunk {
 public:
 	int64_t offset;
 	int32_t len;
+	/* The index of the file, if the trace was merged from several files */
+	int16_t file;
+	chunktype_t type;
 };
 
 #endif /* _TS_CHUNK_H */
@@ -133,6 +133,14 @@
 		     "Invalid back reference to a subexpression."),	\
 	TSHARK_ITEM_(TS_ERROR_BUF_NOSPACE,				\
 		     "The program ran out of space in an internal buffer."), \
+	TSHARK_ITEM_(TS_ERROR_DECOMPRESS,				\
+		     "The compressed data is corrupt."),		\
+	TSHARK_ITEM_(TS_ERROR_COMPRESSED,				\
+	     "The compression format is not supported by this build."), \
+	TSHARK_ITEM_(TS_ERROR_POLICY,					\
+		     "The event retention policy is invalid."),		\
+	TSHARK_ITEM_(TS_ERROR_TIMEWINDOW,				\
+		     "The time window is invalid."),			\
 	TSHARK_ITEM_(TS_NR_ERRORS,					\
 		     nullptr)
 
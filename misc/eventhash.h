@@ -0,0 +1,164 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTHASH_H
+#define EVENTHASH_H
+
+#include <cstdint>
+#include "misc/types.h"
+#include "vtl/compiler.h"
+
+/*
+ * This is a perfect hash for the names of the events in TRACEEVENTS_DEFS_. The
+ * seed is searched for at compile time, so that no two of the names map to the
+ * same slot, and the table that maps the slots to the event types is also
+ * computed at compile time. The functions are written in the restricted form
+ * that C++11 allows for constexpr functions, the same functions are used to
+ * hash the strings at runtime.
+ *
+ * If many events are added to TRACEEVENTS_DEFS_, then EVENTHASH_BITS needs to
+ * be increased, together with the initializer of table[] below.
+ */
+#define EVENTHASH_BITS (6)
+#define EVENTHASH_SIZE (1 << EVENTHASH_BITS)
+
+namespace EventHash {
+
+#undef TSHARK_ITEM_
+#define TSHARK_ITEM_(A, B) B
+	constexpr const char * const names[] = {
+		TRACEEVENTS_DEFS_
+	};
+#undef TSHARK_ITEM_
+
+	/* FNV-1a */
+	constexpr uint32_t fnv(const char *s, unsigned int len, uint32_t h)
+	{
+		return len == 0 ? h :
+			fnv(s + 1, len - 1, (h ^ (uint8_t) *s) * 16777619U);
+	}
+
+	constexpr unsigned int length(const char *s)
+	{
+		return *s == '\0' ? 0 : 1 + length(s + 1);
+	}
+
+	constexpr unsigned int slot(const char *s, unsigned int len,
+				    uint32_t seed)
+	{
+		return (fnv(s, len, 2166136261U ^ seed) * 0x9e3779b1U) >>
+			(32 - EVENTHASH_BITS);
+	}
+
+	constexpr unsigned int slotOf(int t, uint32_t seed)
+	{
+		return slot(names[t], length(names[t]), seed);
+	}
+
+	constexpr bool collides(int a, int b, uint32_t seed)
+	{
+		return b >= NR_EVENTS ? false :
+			(slotOf(a, seed) == slotOf(b, seed) ||
+			 collides(a, b + 1, seed));
+	}
+
+	constexpr bool isPerfect(int a, uint32_t seed)
+	{
+		return a >= NR_EVENTS ? true :
+			(!collides(a, a + 1, seed) && isPerfect(a + 1, seed));
+	}
+
+	constexpr uint32_t findSeed(uint32_t seed)
+	{
+		return isPerfect(0, seed) ? seed : findSeed(seed + 1);
+	}
+
+	constexpr uint32_t seed = findSeed(0);
+
+	constexpr int typeAt(unsigned int s, int t)
+	{
+		return t >= NR_EVENTS ? -1 :
+			(slotOf(t, seed) == s ? t : typeAt(s, t + 1));
+	}
+
+#define EVENTHASH_T4_(N) \
+	typeAt(N, 0), typeAt(N + 1, 0), typeAt(N + 2, 0), typeAt(N + 3, 0)
+#define EVENTHASH_T16_(N) \
+	EVENTHASH_T4_(N), EVENTHASH_T4_(N + 4), EVENTHASH_T4_(N + 8), \
+	EVENTHASH_T4_(N + 12)
+
+	static_assert(EVENTHASH_SIZE == 64,
+		      "The initializer of table[] must match EVENTHASH_SIZE");
+	static_assert(NR_EVENTS <= EVENTHASH_SIZE / 4,
+		      "EVENTHASH_BITS is too small for the number of events");
+
+	/* The event type of each slot, or -1 if no known name maps to it */
+	constexpr int8_t table[EVENTHASH_SIZE] = {
+		EVENTHASH_T16_(0), EVENTHASH_T16_(16), EVENTHASH_T16_(32),
+		EVENTHASH_T16_(48)
+	};
+
+#undef EVENTHASH_T4_
+#undef EVENTHASH_T16_
+
+	/*
+	 * Returns the only known event type that the name may have, or -1 if
+	 * it cannot be a known event. The caller needs to compare the name
+	 * with that of the returned type.
+	 */
+	vtl_always_inline int candidate(const char *s, unsigned int len)
+	{
+		return table[slot(s, len, seed)];
+	}
+}
+
+#endif /* EVENTHASH_H */
@@ -51,22 +51,73 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstring>
+
 #include <QApplication>
+#include <QColor>
+#include <QCoreApplication>
+#include <QMap>
 #include <QString>
+#include <QStringList>
 #include <QtCore>
+#include "analyzer/traceanalyzer.h"
 #include "misc/errors.h"
 #include "misc/qtcompat.h"
 #include "misc/resources.h"
+#include "misc/settingstore.h"
 #include "ui/mainwindow.h"
+#include "ui/statsmodel.h"
 #include "ui/tracesharkstyle.h"
+#include "vtl/bsdexits.h"
 #include "vtl/error.h"
 
+#define EVENTS_OPTION "--events="
+#define WINDOW_OPTION "--window="
+#define BATCH_OPTION "--batch"
+#define SCHED_LATENCY_OPTION "--export-sched-latency="
+#define WAKEUP_LATENCY_OPTION "--export-wakeup-latency="
+#define STATS_OPTION "--stats="
+
+#define CSV_SUFFIX ".csv"
+
 static char *prgname;
 
-static void parseOption(const char */*opt*/)
-{}
+struct Options {
+	Options() : batch(false) {}
+	QStringList fileNames;
+	QString events;
+	QString window;
+	/* These are only used in batch mode */
+	bool batch;
+	QString schedLatencyFile;
+	QString wakeupLatencyFile;
+	QString statsFile;
+};
+
+static bool isOption(const char *opt, const char *name)
+{
+	return !strncmp(opt, name, strlen(name));
+}
+
+static void parseOption(Options *options, const char *opt)
+{
+	if (isOption(opt, EVENTS_OPTION))
+		options->events = QString(opt + strlen(EVENTS_OPTION));
+	else if (isOption(opt, WINDOW_OPTION))
+		options->window = QString(opt + strlen(WINDOW_OPTION));
+	else if (!strcmp(opt, BATCH_OPTION))
+		options->batch = true;
+	else if (isOption(opt, SCHED_LATENCY_OPTION))
+		options->schedLatencyFile =
+			QString(opt + strlen(SCHED_LATENCY_OPTION));
+	else if (isOption(opt, WAKEUP_LATENCY_OPTION))
+		options->wakeupLatencyFile =
+			QString(opt + strlen(WAKEUP_LATENCY_OPTION));
+	else if (isOption(opt, STATS_OPTION))
+		options->statsFile = QString(opt + strlen(STATS_OPTION));
+}
 
-static void parseArguments(QString *fileName, int argc, char* argv[])
+static void parseArguments(Options *options, int argc, char* argv[])
 {
 	if (argc > 0) {
 		prgname = *argv;
@@ -76,17 +127,127 @@ static void parseArguments(QString *fileName, int argc, char* argv[])
 
 	while (argc > 0) {
 		if (**argv == '-')
-			parseOption(*argv);
+			parseOption(options, *argv);
 		else
-			*fileName = QString(*argv);
+			options->fileNames.append(QString(*argv));
 		argc--;
 		argv++;
 	}
 }
 
+/*
+ * This is needed before the arguments are parsed, because the QApplication
+ * removes the Qt options from the arguments and there is no QApplication in
+ * batch mode.
+ */
+static bool isBatch(int argc, char* argv[])
+{
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], BATCH_OPTION))
+			return true;
+	}
+	return false;
+}
+
+static void exportLatencies(TraceAnalyzer *analyzer,
+			    TraceAnalyzer::latencytype_t type,
+			    const QString &fileName)
+{
+	TraceAnalyzer::exportformat_t format = TraceAnalyzer::EXPORT_ASCII;
+	int ts_errno = 0;
+
+	if (fileName.isEmpty())
+		return;
+	if (fileName.endsWith(QLatin1String(CSV_SUFFIX)))
+		format = TraceAnalyzer::EXPORT_CSV;
+	if (!analyzer->exportLatencies(format, type,
+				       fileName.toLocal8Bit().data(),
+				       &ts_errno))
+		vtl::err(BSD_EX_CANTCREAT, ts_errno,
+			 "Failed to export latencies to %s",
+			 fileName.toLocal8Bit().data());
+}
+
+static void exportStats(TraceAnalyzer *analyzer, const QString &fileName)
+{
+	StatsModel model;
+	int ts_errno;
+
+	if (fileName.isEmpty())
+		return;
+	model.setTaskMap(&analyzer->taskMap, analyzer->getNrCPUs());
+	ts_errno = model.exportStats(fileName.endsWith(
+					     QLatin1String(CSV_SUFFIX)),
+				     fileName);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_CANTCREAT, ts_errno,
+			 "Failed to export statistics to %s",
+			 fileName.toLocal8Bit().data());
+}
+
+/*
+ * Analyzes the trace and writes the results to the files that were given with
+ * the options, without creating any widgets, so that this can be used on a
+ * machine without a display. The files with a .csv suffix are written as CSV.
+ */
+static int runBatch(int argc, char* argv[])
+{
+	QCoreApplication app(argc, argv);
+	SettingStore settingStore;
+	TraceAnalyzer analyzer(&settingStore);
+	Options options;
+	int ts_errno;
+
+	vtl::set_strerror(ts_strerror);
+
+	parseArguments(&options, argc, argv);
+	if (options.fileNames.isEmpty())
+		vtl::errx(BSD_EX_USAGE, "No trace file was given with %s",
+			  BATCH_OPTION);
+
+	ts_errno = settingStore.loadSettings();
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to load settings from %s",
+			  TS_SETTING_FILENAME);
+	/* A followed trace would never be complete */
+	settingStore.setBoolValue(Setting::FOLLOW_TRACE, false);
+	ts_errno = analyzer.setRetentionPolicy(options.events);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_USAGE, ts_errno, "Bad %s%s", EVENTS_OPTION,
+			 options.events.toLocal8Bit().data());
+	ts_errno = analyzer.setTimeWindow(options.window);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_USAGE, ts_errno, "Bad %s%s", WINDOW_OPTION,
+			 options.window.toLocal8Bit().data());
+
+	ts_errno = analyzer.open(options.fileNames);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_NOINPUT, ts_errno,
+			 "Failed to open trace file %s",
+			 options.fileNames.join(QLatin1String(", "))
+			 .toLocal8Bit().data());
+	analyzer.processTrace(QMap<int, QColor>());
+	analyzer.doStats();
+
+	exportLatencies(&analyzer, TraceAnalyzer::LATENCY_SCHED,
+			options.schedLatencyFile);
+	exportLatencies(&analyzer, TraceAnalyzer::LATENCY_WAKEUP,
+			options.wakeupLatencyFile);
+	exportStats(&analyzer, options.statsFile);
+
+	analyzer.close(&ts_errno);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to close() trace file");
+	return BSD_EX_OK;
+}
 
 int main(int argc, char* argv[])
 {
+	if (isBatch(argc, argv))
+		return runBatch(argc, argv);
+
 	QtCompat::enableHighDpi();
 
 	QApplication app(argc, argv);
@@ -94,11 +255,20 @@ int main(int argc, char* argv[])
 	QPixmap pm(QLatin1String(RESSRC_GPH_SHARK64));
 	QIcon icon;
 	QString appname = QLatin1String("Traceshark");
-	QString fileName;
+	Options options;
+	int ts_errno;
 
 	vtl::set_strerror(ts_strerror);
 
-	parseArguments(&fileName, argc, argv);
+	parseArguments(&options, argc, argv);
+	ts_errno = mainWindow.setRetentionPolicy(options.events);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_USAGE, ts_errno, "Bad %s%s", EVENTS_OPTION,
+			 options.events.toLocal8Bit().data());
+	ts_errno = mainWindow.setTimeWindow(options.window);
+	if (ts_errno != 0)
+		vtl::err(BSD_EX_USAGE, ts_errno, "Bad %s%s", WINDOW_OPTION,
+			 options.window.toLocal8Bit().data());
 
 	QtCompat::Qt4_enableOpenGL();
 
@@ -112,8 +282,8 @@ int main(int argc, char* argv[])
 
 	mainWindow.show();
 
-	if (!fileName.isEmpty())
-		mainWindow.openFile(fileName);
+	if (!options.fileNames.isEmpty())
+		mainWindow.openFile(options.fileNames);
 
 	return app.exec();
 }
@@ -81,6 +81,8 @@ extern "C" {
 						   s2.st_ctimespec)
 #define cmp_mtimespec(s1, s2) TShark::cmp_timespec(s1.st_mtimespec,	\
 						   s2.st_mtimespec)
+#define tshark_ctimespec(s) ((s).st_ctimespec)
+#define tshark_mtimespec(s) ((s).st_mtimespec)
 
 #define tshark_pthread_setname_np(NAME) pthread_setname_np(NAME)
 
@@ -89,6 +91,8 @@ extern "C" {
 /* These are the Linux versions, note the difference in members names */
 #define cmp_ctimespec(s1, s2) TShark::cmp_timespec(s1.st_ctim, s2.st_ctim)
 #define cmp_mtimespec(s1, s2) TShark::cmp_timespec(s1.st_mtim, s2.st_mtim)
+#define tshark_ctimespec(s) ((s).st_ctim)
+#define tshark_mtimespec(s) ((s).st_mtim)
 
 #define tshark_pthread_setname_np(NAME) pthread_setname_np(pthread_self(), \
 							   NAME)
@@ -108,6 +112,8 @@ extern "C" {
 						   s2.st_ctimespec)
 #define cmp_mtimespec(s1, s2) TShark::cmp_timespec(s1.st_mtimespec,	\
 						   s2.st_mtimespec)
+#define tshark_ctimespec(s) ((s).st_ctimespec)
+#define tshark_mtimespec(s) ((s).st_mtimespec)
 
 #define tshark_pthread_setname_np(NAME) pthread_setname_np(NAME)
 
@@ -85,6 +85,15 @@ public:
 		FREQ_LINE_WIDTH,
 		MIGRATION_WIDTH,
 		EVENT_PID_FLT_INCL_ON,
+		PARALLEL_PARSE,
+		MAPPED_LOAD,
+		LOAD_BUFFERS,
+		LOAD_BUFFER_SIZE,
+		LAZY_ARGS,
+		INDEX_CACHE,
+		EVENT_COLUMNS,
+		FOLLOW_TRACE,
+		FOLLOW_MAX_EVENTS,
 		LOAD_WINDOW_SIZE_START,
 		MAINWINDOW_HEIGHT,
 		MAINWINDOW_WIDTH,
@@ -176,6 +185,7 @@ public:
 
 	inline static bool isSizeSetting(Index id);
 	inline static bool isFilterSetting(Index id);
+	inline static bool isLoadSetting(Index id);
 	static bool isWideScreen();
 	static bool isLowResScreen();
 
@@ -399,4 +409,16 @@ inline bool Setting::isFilterSetting(Index id) {
 	return id == EVENT_PID_FLT_INCL_ON;
 }
 
+inline bool Setting::isLoadSetting(Index id) {
+	return id == PARALLEL_PARSE ||
+		id == MAPPED_LOAD ||
+		id == LOAD_BUFFERS ||
+		id == LOAD_BUFFER_SIZE ||
+		id == LAZY_ARGS ||
+		id == INDEX_CACHE ||
+		id == EVENT_COLUMNS ||
+		id == FOLLOW_TRACE ||
+		id == FOLLOW_MAX_EVENTS;
+}
+
 #endif /* SETTING_H */
@@ -71,6 +71,7 @@ SettingStore::SettingStore()
 	Setting::Dependency openglDep(Setting::OPENGL_ENABLED, true);
 	Setting::Dependency vertlatDep(Setting::VERTICAL_LATENCY, true);
 	Setting::Dependency loadsizeDep(Setting::LOAD_WINDOW_SIZE_START, true);
+	Setting::Dependency followDep(Setting::FOLLOW_TRACE, true);
 
 	setName(Setting::SHOW_SCHED_GRAPHS, q.tr("Show scheduling graphs"));
 	setKey(Setting::SHOW_SCHED_GRAPHS, QString("SHOW_SCHED_GRAPHS"));
@@ -213,6 +214,62 @@ SettingStore::SettingStore()
 	       QString("EVENT_PID_FLT_INCL_ON"));
 	initBoolValue(Setting::EVENT_PID_FLT_INCL_ON, false);
 
+	setName(Setting::PARALLEL_PARSE,
+		q.tr("Parse large trace files with multiple threads"));
+	setKey(Setting::PARALLEL_PARSE, QString("PARALLEL_PARSE"));
+	initBoolValue(Setting::PARALLEL_PARSE, true);
+
+	setName(Setting::MAPPED_LOAD,
+		q.tr("Load trace files by mapping them into memory"));
+	setKey(Setting::MAPPED_LOAD, QString("MAPPED_LOAD"));
+	initBoolValue(Setting::MAPPED_LOAD, true);
+
+	setName(Setting::LOAD_BUFFERS,
+		q.tr("Number of buffers used to load trace files"));
+	setKey(Setting::LOAD_BUFFERS, QString("LOAD_BUFFERS"));
+	initIntValue(Setting::LOAD_BUFFERS, DEFAULT_LOAD_BUFFERS);
+	initMaxIntValue(Setting::LOAD_BUFFERS, MAX_LOAD_BUFFERS);
+	initMinIntValue(Setting::LOAD_BUFFERS, MIN_LOAD_BUFFERS);
+
+	setName(Setting::LOAD_BUFFER_SIZE,
+		q.tr("Size of the buffers used to load trace files"));
+	setUnit(Setting::LOAD_BUFFER_SIZE, q.tr("MB"));
+	setKey(Setting::LOAD_BUFFER_SIZE, QString("LOAD_BUFFER_SIZE"));
+	initIntValue(Setting::LOAD_BUFFER_SIZE, DEFAULT_LOAD_BUFFER_SIZE);
+	initMaxIntValue(Setting::LOAD_BUFFER_SIZE, MAX_LOAD_BUFFER_SIZE);
+	initMinIntValue(Setting::LOAD_BUFFER_SIZE, MIN_LOAD_BUFFER_SIZE);
+
+	setName(Setting::LAZY_ARGS,
+		q.tr("Read the arguments of unknown events on demand"));
+	setKey(Setting::LAZY_ARGS, QString("LAZY_ARGS"));
+	initBoolValue(Setting::LAZY_ARGS, false);
+
+	setName(Setting::INDEX_CACHE,
+		q.tr("Cache parsed traces for faster reopening"));
+	setKey(Setting::INDEX_CACHE, QString("INDEX_CACHE"));
+	initBoolValue(Setting::INDEX_CACHE, false);
+
+	setName(Setting::EVENT_COLUMNS,
+		q.tr("Store events in columns for faster searching"));
+	setKey(Setting::EVENT_COLUMNS, QString("EVENT_COLUMNS"));
+	initBoolValue(Setting::EVENT_COLUMNS, false);
+
+	setName(Setting::FOLLOW_TRACE,
+		q.tr("Follow trace files that are growing"));
+	setKey(Setting::FOLLOW_TRACE, QString("FOLLOW_TRACE"));
+	initBoolValue(Setting::FOLLOW_TRACE, false);
+
+	setName(Setting::FOLLOW_MAX_EVENTS,
+		q.tr("Maximum number of events when following a trace"));
+	setUnit(Setting::FOLLOW_MAX_EVENTS, q.tr("millions"));
+	setKey(Setting::FOLLOW_MAX_EVENTS, QString("FOLLOW_MAX_EVENTS"));
+	initIntValue(Setting::FOLLOW_MAX_EVENTS, DEFAULT_FOLLOW_MAX_EVENTS);
+	initMaxIntValue(Setting::FOLLOW_MAX_EVENTS, MAX_FOLLOW_MAX_EVENTS);
+	initMinIntValue(Setting::FOLLOW_MAX_EVENTS, MIN_FOLLOW_MAX_EVENTS);
+	initDisabledIntValue(Setting::FOLLOW_MAX_EVENTS,
+			     DEFAULT_FOLLOW_MAX_EVENTS);
+	addDependency(Setting::FOLLOW_MAX_EVENTS, followDep);
+
 	/*
 	 * These are legacy settings that are needed for file compatibility in
 	 * settingstore.cpp
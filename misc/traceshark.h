@@ -91,6 +91,25 @@ QT_END_NAMESPACE
 #define DEFAULT_MAINWINDOW_HEIGHT (950)
 #define MAX_MAINWINDOW_HEIGHT (8640)
 #define MIN_MAINWINDOW_HEIGHT (200)
+#define DEFAULT_LOAD_BUFFERS (4)
+#define MIN_LOAD_BUFFERS (2)
+#define MAX_LOAD_BUFFERS (64)
+#define DEFAULT_LOAD_BUFFER_SIZE (2)
+#define MIN_LOAD_BUFFER_SIZE (1)
+#define MAX_LOAD_BUFFER_SIZE (256)
+#define DEFAULT_FOLLOW_MAX_EVENTS (10)
+#define MIN_FOLLOW_MAX_EVENTS (1)
+#define MAX_FOLLOW_MAX_EVENTS (1000)
+#define FOLLOW_POLL_INTERVAL_US (100000)
+#define FOLLOW_REFRESH_INTERVAL_MS (1000)
+
+/*
+ * The progress of the loading of a trace is updated at this interval and it is
+ * only shown if the loading takes longer than PROGRESS_MIN_DURATION_MS.
+ */
+#define PROGRESS_INTERVAL_MS (100)
+#define PROGRESS_MIN_DURATION_MS (1000)
+#define PROGRESS_STEPS (1000)
 
 #ifdef QCUSTOMPLOT_USE_OPENGL
 #define has_opengl() (true)
@@ -206,6 +225,121 @@ namespace TShark {
 		return uvalue.word32;
 	}
 
+	/*
+	 * The functions below implement a 64-bit hash of the full string,
+	 * after the wyhash algorithm. It is used when the cheap StrHash32()
+	 * above would give too many collisions, e.g. for "kworker/12:1" and
+	 * "kworker/13:1".
+	 */
+#define STRHASH_P0 (0xa0761d6478bd642fULL)
+#define STRHASH_P1 (0xe7037ed1a0b428dbULL)
+#define STRHASH_P2 (0x8ebc6af09c88c6e3ULL)
+#define STRHASH_P3 (0x589965cc75374cc3ULL)
+
+	vtl_always_inline void strhash_mum(uint64_t *a, uint64_t *b)
+	{
+#ifdef __SIZEOF_INT128__
+		__extension__ unsigned __int128 r = *a;
+		r *= *b;
+		*a = (uint64_t) r;
+		*b = (uint64_t) (r >> 64);
+#else
+		uint64_t ha = *a >> 32, hb = *b >> 32;
+		uint64_t la = (uint32_t) *a, lb = (uint32_t) *b;
+		uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la;
+		uint64_t rl = la * lb, t = rl + (rm0 << 32);
+		uint64_t c = t < rl;
+		uint64_t lo = t + (rm1 << 32);
+		c += lo < t;
+		*a = lo;
+		*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+	}
+
+	vtl_always_inline uint64_t strhash_mix(uint64_t a, uint64_t b)
+	{
+		strhash_mum(&a, &b);
+		return a ^ b;
+	}
+
+	vtl_always_inline uint64_t strhash_r8(const char *p)
+	{
+		uint64_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	vtl_always_inline uint64_t strhash_r4(const char *p)
+	{
+		uint32_t v;
+		memcpy(&v, p, sizeof(v));
+		return v;
+	}
+
+	vtl_always_inline uint64_t strhash_r3(const char *p, unsigned int n)
+	{
+		return (((uint64_t) (uint8_t) p[0]) << 16) |
+			(((uint64_t) (uint8_t) p[n >> 1]) << 8) |
+			(uint8_t) p[n - 1];
+	}
+
+	vtl_always_inline uint64_t StrHash64(const TString *str)
+	{
+		const char *p = str->ptr;
+		unsigned int len = str->len;
+		unsigned int i;
+		uint64_t seed, see1, see2;
+		uint64_t a, b;
+
+		seed = STRHASH_P0 ^ strhash_mix(STRHASH_P0, STRHASH_P1);
+		if (likely(len <= 16)) {
+			if (len >= 4) {
+				i = (len >> 3) << 2;
+				a = (strhash_r4(p) << 32) | strhash_r4(p + i);
+				b = (strhash_r4(p + len - 4) << 32) |
+					strhash_r4(p + len - 4 - i);
+			} else if (len > 0) {
+				a = strhash_r3(p, len);
+				b = 0;
+			} else {
+				a = 0;
+				b = 0;
+			}
+		} else {
+			i = len;
+			if (unlikely(i > 48)) {
+				see1 = seed;
+				see2 = seed;
+				do {
+					seed = strhash_mix(
+						strhash_r8(p) ^ STRHASH_P1,
+						strhash_r8(p + 8) ^ seed);
+					see1 = strhash_mix(
+						strhash_r8(p + 16) ^ STRHASH_P2,
+						strhash_r8(p + 24) ^ see1);
+					see2 = strhash_mix(
+						strhash_r8(p + 32) ^ STRHASH_P3,
+						strhash_r8(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i > 48);
+				seed ^= see1 ^ see2;
+			}
+			while (i > 16) {
+				seed = strhash_mix(strhash_r8(p) ^ STRHASH_P1,
+						   strhash_r8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = strhash_r8(p + i - 16);
+			b = strhash_r8(p + i - 8);
+		}
+		a ^= STRHASH_P1;
+		b ^= seed;
+		strhash_mum(&a, &b);
+		return strhash_mix(a ^ STRHASH_P0 ^ len, b ^ STRHASH_P1);
+	}
+
 	vtl_always_inline bool cmp_timespec(const struct timespec &s1,
 					    const struct timespec &s2) {
 		return s1.tv_sec == s2.tv_sec && s1.tv_nsec == s2.tv_nsec;
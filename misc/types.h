@@ -55,12 +55,6 @@
 
 typedef uint32_t taskstate_t;
 
-/*
- * This is the maximum length of strings in TRACEEVENT_DEFS_. If a new string is
- * added and it is longer than the value below, then it must be increased.
- */
-#define EVENTSTRINGS_MAXLEN 20
-
 #define TRACEEVENTS_DEFS_						\
 	TSHARK_ITEM_(CPU_FREQUENCY = 0,	"cpu_frequency"),		\
 	TSHARK_ITEM_(CPU_IDLE,		"cpu_idle"),			\
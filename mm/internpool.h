@@ -0,0 +1,482 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef INTERNPOOL_H
+#define INTERNPOOL_H
+
+#include <cstdint>
+#include <cstring>
+#include "mm/mempool.h"
+#include "misc/osapi.h"
+#include "misc/traceshark.h"
+#include "misc/tstring.h"
+#include "mm/stringtable.h"
+#include "vtl/compiler.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+#define INTERNPOOL_SSE2
+#include <emmintrin.h>
+#endif
+
+/*
+ * InternPool is an open addressing hash table for interning strings. It has
+ * the same interface as StringPool, so that it can be used instead of it.
+ *
+ * The table consists of an array of tag bytes and an array of entry pointers.
+ * The tags are the highest 7 bits of the 64-bit hash, or INTERNPOOL_EMPTY for
+ * an empty slot. The slots are probed a group of 16 tags at a time, so that
+ * the strings only need to be compared when the tag matches. The strings are
+ * stored in a MemPool, each one directly after its TString header and its
+ * hash, so the pointers that are returned stay valid until clear() is called.
+ *
+ * There is no way to remove individual strings, so empty slots only appear
+ * when the table is cleared or grown and no tombstones are needed.
+ *
+ * If a StringTable has been set with setStringTable(), then allocId() can be
+ * used instead of allocString(), it returns the id of the string in the table.
+ * Each interned string is added to the table only once, when it is first seen,
+ * and the strings that are rejected by the cutoff heuristic are stored without
+ * a TString header of their own, since the header is in the table.
+ */
+
+#define INTERNPOOL_GROUP (16)
+#define INTERNPOOL_EMPTY ((uint8_t) 0x80)
+#define INTERNPOOL_MAX_CLASSES (65536)
+
+/* The load factor is kept below 7/8 */
+#define INTERNPOOL_MAXUSED(SLOTS) ((SLOTS) - (SLOTS) / 8)
+
+class InternPoolEntry {
+public:
+	TString str;
+	uint64_t hash;
+	/* The id in the StringTable, if there is one */
+	uint32_t id;
+	/* The characters follow here */
+	vtl_always_inline char *chars() {
+		return (char*) (this + 1);
+	}
+};
+
+class InternPoolDefaultHashFunc {
+public:
+	vtl_always_inline uint64_t operator()(const TString *str) const
+	{
+		return TShark::StrHash64(str);
+	}
+};
+
+template<typename HashFunc = InternPoolDefaultHashFunc>
+class InternPool
+{
+public:
+	InternPool(unsigned int nr_pages = 256 * 10,
+		   unsigned int hSizeP = 256);
+	~InternPool();
+	vtl_always_inline const TString *allocString(const TString *str,
+						   uint32_t cutoff);
+	vtl_always_inline uint32_t allocId(const TString *str,
+					   uint32_t cutoff);
+	void setStringTable(StringTable *table);
+	void clear();
+	void reset();
+private:
+	static vtl_always_inline uint32_t matchTag(const uint8_t *group,
+						   uint8_t tag);
+	static vtl_always_inline uint32_t matchEmpty(const uint8_t *group);
+	static vtl_always_inline unsigned int roundUp(unsigned int n);
+	vtl_always_inline InternPoolEntry *newEntry(const TString *str,
+						    uint64_t hval);
+	vtl_always_inline bool isCold(const TString *str, uint32_t cutoff,
+				      uint32_t &cval);
+	vtl_always_inline InternPoolEntry *internString(const TString *str,
+							uint32_t cutoff,
+							uint32_t cval);
+	vtl_always_inline const TString *allocUniqueString(const TString *str);
+	vtl_always_inline uint32_t allocUniqueId(const TString *str);
+	vtl_always_inline void insertEntry(InternPoolEntry *entry);
+	void allocTable(unsigned int nrGroups);
+	void growTable();
+	MemPool *entryPool;
+	MemPool *coldPool;
+	uint8_t *tags;
+	InternPoolEntry **entries;
+	unsigned int groupMask;
+	unsigned int nrUsed;
+	unsigned int maxUsed;
+	unsigned int *countAllocs;
+	unsigned int *countReuse;
+	unsigned int classMask;
+	StringTable *stringTable;
+	HashFunc hFunc;
+};
+
+template<typename HashFunc>
+vtl_always_inline
+uint32_t InternPool<HashFunc>::matchTag(const uint8_t *group, uint8_t tag)
+{
+#ifdef INTERNPOOL_SSE2
+	__m128i g = _mm_loadu_si128((const __m128i *) group);
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(tag)));
+#else
+	uint32_t m = 0;
+	int i;
+
+	for (i = 0; i < INTERNPOOL_GROUP; i++)
+		m |= (uint32_t) (group[i] == tag) << i;
+	return m;
+#endif
+}
+
+template<typename HashFunc>
+vtl_always_inline
+uint32_t InternPool<HashFunc>::matchEmpty(const uint8_t *group)
+{
+#ifdef INTERNPOOL_SSE2
+	__m128i g = _mm_loadu_si128((const __m128i *) group);
+	return _mm_movemask_epi8(g);
+#else
+	uint32_t m = 0;
+	int i;
+
+	for (i = 0; i < INTERNPOOL_GROUP; i++)
+		m |= (uint32_t) (group[i] >> 7) << i;
+	return m;
+#endif
+}
+
+template<typename HashFunc>
+vtl_always_inline unsigned int InternPool<HashFunc>::roundUp(unsigned int n)
+{
+	unsigned int r = 1;
+
+	while (r < n && r < 0x80000000U)
+		r <<= 1;
+	return r;
+}
+
+/*
+ * The cutoff heuristic works like in StringPool. It is meant to detect classes
+ * of strings that are unlikely to be reused, such as numbers, so it uses the
+ * cheap hash, which looks at the first and last characters, in order to
+ * classify the strings.
+ */
+template<typename HashFunc>
+vtl_always_inline bool InternPool<HashFunc>::isCold(const TString *str,
+						    uint32_t cutoff,
+						    uint32_t &cval)
+{
+	cval = TShark::StrHash32(str) & classMask;
+	return countAllocs[cval] > cutoff &&
+		countAllocs[cval] > countReuse[cval];
+}
+
+template<typename HashFunc>
+vtl_always_inline
+const TString *InternPool<HashFunc>::allocString(const TString *str,
+						 uint32_t cutoff)
+{
+	InternPoolEntry *entry;
+	uint32_t cval = 0;
+
+	if (cutoff != 0 && isCold(str, cutoff, cval))
+		return allocUniqueString(str);
+	entry = internString(str, cutoff, cval);
+	return entry != nullptr ? &entry->str : nullptr;
+}
+
+/*
+ * Like allocString() but returns the id of the string in the StringTable, or
+ * STRINGTABLE_NO_ID if the memory allocation fails.
+ */
+template<typename HashFunc>
+vtl_always_inline uint32_t InternPool<HashFunc>::allocId(const TString *str,
+							 uint32_t cutoff)
+{
+	InternPoolEntry *entry;
+	uint32_t cval = 0;
+
+	if (cutoff != 0 && isCold(str, cutoff, cval))
+		return allocUniqueId(str);
+	entry = internString(str, cutoff, cval);
+	return entry != nullptr ? entry->id : STRINGTABLE_NO_ID;
+}
+
+template<typename HashFunc>
+vtl_always_inline
+InternPoolEntry *InternPool<HashFunc>::internString(const TString *str,
+						   uint32_t cutoff,
+						   uint32_t cval)
+{
+	InternPoolEntry *entry;
+	const uint8_t *group;
+	unsigned int g, step, idx;
+	uint64_t hval;
+	uint32_t m;
+	uint8_t tag;
+
+	hval = hFunc(str);
+	tag = (uint8_t) (hval >> 57);
+	g = (unsigned int) hval & groupMask;
+	step = 0;
+	while (true) {
+		group = tags + g * INTERNPOOL_GROUP;
+		m = matchTag(group, tag);
+		while (m != 0) {
+			idx = g * INTERNPOOL_GROUP + __builtin_ctz(m);
+			entry = entries[idx];
+			if (entry->str.len == str->len &&
+			    memcmp(entry->str.ptr, str->ptr, str->len) == 0) {
+				if (cutoff != 0)
+					countReuse[cval]++;
+				return entry;
+			}
+			m &= m - 1;
+		}
+		m = matchEmpty(group);
+		if (likely(m != 0))
+			break;
+		step++;
+		g = (g + step) & groupMask;
+	}
+
+	entry = newEntry(str, hval);
+	if (entry == nullptr)
+		return nullptr;
+	if (unlikely(nrUsed >= maxUsed)) {
+		growTable();
+		insertEntry(entry);
+	} else {
+		/*
+		 * Nothing is ever removed, so the first empty slot on the probe
+		 * sequence is in the group where the search ended.
+		 */
+		idx = g * INTERNPOOL_GROUP + __builtin_ctz(m);
+		tags[idx] = tag;
+		entries[idx] = entry;
+	}
+	nrUsed++;
+	if (cutoff != 0)
+		countAllocs[cval]++;
+	return entry;
+}
+
+template<typename HashFunc>
+vtl_always_inline void InternPool<HashFunc>::insertEntry(InternPoolEntry
+							 *entry)
+{
+	unsigned int g = (unsigned int) entry->hash & groupMask;
+	unsigned int step = 0;
+	unsigned int idx;
+	uint32_t m;
+
+	while ((m = matchEmpty(tags + g * INTERNPOOL_GROUP)) == 0) {
+		step++;
+		g = (g + step) & groupMask;
+	}
+	idx = g * INTERNPOOL_GROUP + __builtin_ctz(m);
+	tags[idx] = (uint8_t) (entry->hash >> 57);
+	entries[idx] = entry;
+}
+
+template<typename HashFunc>
+vtl_always_inline
+InternPoolEntry *InternPool<HashFunc>::newEntry(const TString *str,
+						uint64_t hval)
+{
+	InternPoolEntry *entry;
+	unsigned int size;
+
+	size = sizeof(InternPoolEntry) + str->len + 1;
+	size = (size + alignof(InternPoolEntry) - 1) &
+		~(alignof(InternPoolEntry) - 1);
+	entry = (InternPoolEntry*) entryPool->allocBytes(size);
+	if (entry == nullptr)
+		return nullptr;
+	entry->hash = hval;
+	entry->str.len = str->len;
+	entry->str.ptr = entry->chars();
+	memcpy(entry->str.ptr, str->ptr, str->len);
+	entry->str.ptr[str->len] = '\0';
+	entry->id = stringTable != nullptr ?
+		stringTable->add(entry->str) : STRINGTABLE_NO_ID;
+	return entry;
+}
+
+template<typename HashFunc>
+vtl_always_inline
+const TString *InternPool<HashFunc>::allocUniqueString(const TString *str)
+{
+	TString *newstr;
+	unsigned int size;
+
+	size = sizeof(TString) + str->len + 1;
+	size = (size + alignof(TString) - 1) & ~(alignof(TString) - 1);
+	newstr = (TString*) coldPool->allocBytes(size);
+	if (newstr == nullptr)
+		return nullptr;
+	newstr->len = str->len;
+	newstr->ptr = (char*) (newstr + 1);
+	memcpy(newstr->ptr, str->ptr, str->len);
+	newstr->ptr[str->len] = '\0';
+	return newstr;
+}
+
+template<typename HashFunc>
+vtl_always_inline uint32_t InternPool<HashFunc>::allocUniqueId(const TString
+							       *str)
+{
+	TString newstr;
+
+	newstr.ptr = (char*) coldPool->allocChars(str->len + 1);
+	if (newstr.ptr == nullptr)
+		return STRINGTABLE_NO_ID;
+	newstr.len = str->len;
+	memcpy(newstr.ptr, str->ptr, str->len);
+	newstr.ptr[str->len] = '\0';
+	return stringTable->add(newstr);
+}
+
+template<typename HashFunc>
+InternPool<HashFunc>::InternPool(unsigned int nr_pages, unsigned int hSizeP)
+{
+	unsigned int nrGroups;
+	unsigned int nrClasses;
+
+	nrGroups = roundUp((hSizeP + INTERNPOOL_GROUP - 1) / INTERNPOOL_GROUP);
+	nrClasses = roundUp(hSizeP);
+	if (nrClasses > INTERNPOOL_MAX_CLASSES)
+		nrClasses = INTERNPOOL_MAX_CLASSES;
+	classMask = nrClasses - 1;
+	stringTable = nullptr;
+
+	entryPool = new MemPool(nr_pages, 1);
+	coldPool = new MemPool(nr_pages, 1);
+	countAllocs = new unsigned int[nrClasses];
+	countReuse = new unsigned int[nrClasses];
+	tshark_bzero(countAllocs, nrClasses * sizeof(unsigned int));
+	tshark_bzero(countReuse, nrClasses * sizeof(unsigned int));
+	allocTable(nrGroups);
+}
+
+template<typename HashFunc>
+InternPool<HashFunc>::~InternPool()
+{
+	delete entryPool;
+	delete coldPool;
+	delete[] tags;
+	delete[] entries;
+	delete[] countAllocs;
+	delete[] countReuse;
+}
+
+template<typename HashFunc>
+void InternPool<HashFunc>::allocTable(unsigned int nrGroups)
+{
+	unsigned int nrSlots = nrGroups * INTERNPOOL_GROUP;
+
+	tags = new uint8_t[nrSlots];
+	entries = new InternPoolEntry*[nrSlots];
+	memset(tags, INTERNPOOL_EMPTY, nrSlots);
+	groupMask = nrGroups - 1;
+	maxUsed = INTERNPOOL_MAXUSED(nrSlots);
+	nrUsed = 0;
+}
+
+template<typename HashFunc>
+void InternPool<HashFunc>::growTable()
+{
+	unsigned int oldSlots = (groupMask + 1) * INTERNPOOL_GROUP;
+	uint8_t *oldTags = tags;
+	InternPoolEntry **oldEntries = entries;
+	unsigned int used = nrUsed;
+	unsigned int i;
+
+	allocTable((groupMask + 1) * 2);
+	for (i = 0; i < oldSlots; i++) {
+		if (oldTags[i] != INTERNPOOL_EMPTY)
+			insertEntry(oldEntries[i]);
+	}
+	nrUsed = used;
+	delete[] oldTags;
+	delete[] oldEntries;
+}
+
+/*
+ * Sets the table that allocId() adds the strings to. This should only be done
+ * when the pool is empty, because the strings that are already in the pool
+ * would not get ids in the new table.
+ */
+template<typename HashFunc>
+void InternPool<HashFunc>::setStringTable(StringTable *table)
+{
+	stringTable = table;
+}
+
+template<typename HashFunc>
+void InternPool<HashFunc>::clear()
+{
+	memset(tags, INTERNPOOL_EMPTY, (groupMask + 1) * INTERNPOOL_GROUP);
+	nrUsed = 0;
+	tshark_bzero(countAllocs, (classMask + 1) * sizeof(unsigned int));
+	tshark_bzero(countReuse, (classMask + 1) * sizeof(unsigned int));
+	entryPool->reset();
+	coldPool->reset();
+}
+
+template<typename HashFunc>
+void InternPool<HashFunc>::reset()
+{
+	clear();
+}
+
+#endif /* INTERNPOOL_H */
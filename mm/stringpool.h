@@ -85,7 +85,7 @@ template <class T>
 class AVLCompareSP {
 public:
 	vtl_always_inline static int compare(const T &a, const T &b) {
-		return strcmp(a.ptr, b.ptr);
+		return TString::strcmp(&a, &b);
 	}
 };
 
@@ -101,7 +101,8 @@ public:
 			pools.nodePool->allocObj();
 		node->key.len = key.len;
 		node->key.ptr = (char*) pools.charPool->allocChars(key.len + 1);
-		strcpy(node->key.ptr, key.ptr);
+		memcpy(node->key.ptr, key.ptr, key.len);
+		node->key.ptr[key.len] = '\0';
 		return node;
 	}
 	vtl_always_inline int clear() {
@@ -192,7 +193,8 @@ const TString *StringPool<HashFunc>::allocString(const TString *str,
 	if (hashTable[hval] != nullptr) {
 		entry = hashTable[hval];
 		if (entry->cachePtr != nullptr &&
-		    strcmp(entry->cache, str->ptr) == 0) {
+		    entry->cachePtr->len == str->len &&
+		    memcmp(entry->cache, str->ptr, str->len) == 0) {
 			if (cutoff != 0)
 				countReuse[hval]++;
 			return entry->cachePtr;
@@ -238,7 +240,8 @@ const TString *StringPool<HashFunc>::allocUniqueString(const TString *str)
 	newstr->ptr = (char*) coldCharPool->allocChars(str->len + 1);
 	if (newstr->ptr == nullptr)
 		return nullptr;
-	strcpy(newstr->ptr, str->ptr);
+	memcpy(newstr->ptr, str->ptr, str->len);
+	newstr->ptr[str->len] = '\0';
 	return newstr;
 }
 
@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+
+#include <cstdint>
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
+#include "vtl/tlist.h"
+
+/*
+ * StringTable is a flat array of TString headers, so that a string can be
+ * referred to by a 32-bit id, which is its index, instead of by a pointer.
+ * The characters are not owned by the table, they are normally in the pools
+ * of an InternPool, see InternPool::allocId().
+ *
+ * Strings are only ever appended, so the ids and the headers stay valid until
+ * clear() is called. Like with TList, one thread may append strings while other
+ * threads look up the strings that have already been appended.
+ *
+ * The table can hold at most STRINGTABLE_MAX_SIZE strings, since that is what
+ * fits in a TList. After that, add() fails and returns STRINGTABLE_NO_ID.
+ */
+
+#define STRINGTABLE_NO_ID (UINT32_C(0xffffffff))
+#define STRINGTABLE_MAX_SIZE ((uint32_t) TLIST_INDEX_MAX)
+
+class StringTable
+{
+public:
+	vtl_always_inline uint32_t add(const TString &str);
+	vtl_always_inline const TString *get(uint32_t id) const;
+	vtl_always_inline uint32_t size() const;
+	vtl_always_inline bool hasRoom(uint32_t n) const;
+	vtl_always_inline void clear();
+private:
+	vtl::TList<TString> list;
+};
+
+vtl_always_inline uint32_t StringTable::add(const TString &str)
+{
+	uint32_t id = list.size();
+
+	if (unlikely(id == STRINGTABLE_MAX_SIZE))
+		return STRINGTABLE_NO_ID;
+	list.append(str);
+	return id;
+}
+
+vtl_always_inline const TString *StringTable::get(uint32_t id) const
+{
+	return &list.at(id);
+}
+
+vtl_always_inline uint32_t StringTable::size() const
+{
+	return list.size();
+}
+
+/* Returns true if n more strings can be added */
+vtl_always_inline bool StringTable::hasRoom(uint32_t n) const
+{
+	return n <= STRINGTABLE_MAX_SIZE - size();
+}
+
+vtl_always_inline void StringTable::clear()
+{
+	list.clear();
+}
+
+#endif /* STRINGTABLE_H */
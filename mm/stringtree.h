@@ -57,90 +57,26 @@
 #include <cstdint>
 #include <cstring>
 #include "mm/mempool.h"
+#include "misc/eventhash.h"
 #include "misc/osapi.h"
 #include "misc/traceshark.h"
 #include "misc/tstring.h"
 #include "misc/types.h"
-#include "vtl/avltree.h"
 #include "vtl/compiler.h"
-#include "vtl/tlist.h"
 
-#define STRINGTREE_MAX(A, B) ((A) >= (B) ? A:B)
-#define STRINGTREE_MIN(A, B) ((A) < (B) ? A:B)
-
-class PoolBundleST {
-public:
-	MemPool *charPool;
-	MemPool *nodePool;
-};
-
-template<typename HashFunc>
-class StringTree;
-
-#define VTL_STRINGTREE_ITERATOR_(name) \
-	vtl::AVLTree<TString, event_t, vtl::AVLBALANCE_USEPOINTERS, \
-	AVLAllocatorST<TString, event_t>, AVLCompareST<TString>>::iterator
-
-template <class T>
-class AVLCompareST {
-public:
-	vtl_always_inline static int compare(const T &a, const T &b) {
-		return strcmp(a.ptr, b.ptr);
-	}
-};
-
-template <class T, class U>
-class AVLAllocatorST {
-public:
-	AVLAllocatorST(void *data) {
-		PoolBundleST *pb = (PoolBundleST*) data;
-		pools = *pb;
-	}
-	vtl_always_inline vtl::AVLNode<T, U> *alloc(const T &key) {
-		vtl::AVLNode<T, U> *node = (vtl::AVLNode<T, U> *)
-			pools.nodePool->allocObj();
-		node->key.len = key.len;
-		node->key.ptr = (char*) pools.charPool->allocChars(key.len + 1);
-		strncpy(node->key.ptr, key.ptr, key.len + 1);
-		return node;
-	}
-	vtl_always_inline int clear() {
-		/*
-		 * Do nothing because the pools are owned by StringTree. This
-		 * is only called from StringTree, via AVLTree, when the object
-		 * is cleared.
-		 */
-		return 0;
-	}
-private:
-	PoolBundleST pools;
-};
-
-#define ST_AVLTREE_SIZE (sizeof(vtl::AVLTree<TString, event_t, \
-vtl::AVLBALANCE_USEPOINTERS, AVLAllocatorST<TString, event_t>, \
-				AVLCompareST<TString>>))
-#define ST_TSTRING_PTR_SIZE (sizeof(TString*))
-#define ST_TYPICAL_CACHE_LINE_SIZE (32)
-
-#define ST_CACHE_SIZE (ST_TYPICAL_CACHE_LINE_SIZE - ST_TSTRING_PTR_SIZE - \
-		       ST_AVLTREE_SIZE)
-
-template<typename HashFunc>
-class StringTreeEntry {
-	friend class StringTree<HashFunc>;
-public:
-StringTreeEntry(void *data): avlTree(data) { }
-protected:
-	vtl::AVLTree<TString, event_t, vtl::AVLBALANCE_USEPOINTERS,
-		AVLAllocatorST<TString, event_t>, AVLCompareST<TString>>
-		avlTree;
-};
+/*
+ * StringTree maps the event names to event types. The names of the events that
+ * traceshark knows about are always present and have the types of event_t,
+ * they are found with the perfect hash of misc/eventhash.h. Other names are
+ * added to a small open addressing hash table, with the type that is given to
+ * searchAllocString().
+ */
 
 class StringTreeDefaultHashFunc {
 public:
-	vtl_always_inline uint32_t operator()(const TString *str) const
+	vtl_always_inline uint64_t operator()(const TString *str) const
 	{
-		return TShark::StrHash32(str);
+		return TShark::StrHash64(str);
 	}
 };
 
@@ -148,8 +84,7 @@ template<typename HashFunc = StringTreeDefaultHashFunc>
 class StringTree
 {
 public:
-	StringTree(unsigned int nr_pages = 256 * 10, unsigned int hSizeP = 256,
-		   unsigned int table_size = 4096);
+	StringTree(unsigned int nr_pages = 8, unsigned int table_size = 4096);
 	~StringTree();
 	vtl_always_inline const TString *stringLookup(event_t value) const;
 	vtl_always_inline event_t searchAllocString(const TString *str,
@@ -158,14 +93,18 @@ public:
 	void clear();
 	void reset();
 private:
-	PoolBundleST avlPools;
-	StringTreeEntry<HashFunc> **hashTable;
-	unsigned int hSize;
+	static vtl_always_inline bool equals(const TString *a,
+					     const TString *b);
+	vtl_always_inline const TString *newString(const TString *str);
+	MemPool *charPool;
+	TString knownStrings[NR_EVENTS];
+	/* The types of the unknown names, EVENT_ERROR for an empty slot */
+	event_t *hashTable;
+	unsigned int hashMask;
 	unsigned int tableSize;
 	event_t maxEvent;
-	TString **stringTable;
+	const TString **stringTable;
 	void clearTable();
-	vtl::TList<StringTreeEntry<HashFunc>*> deleteList;
 	HashFunc hashFunc;
 };
 
@@ -178,43 +117,62 @@ const TString *StringTree<HashFunc>::stringLookup(event_t value) const
 	return stringTable[value];
 }
 
+template<typename HashFunc>
+vtl_always_inline bool StringTree<HashFunc>::equals(const TString *a,
+						    const TString *b)
+{
+	return a->len == b->len && memcmp(a->ptr, b->ptr, a->len) == 0;
+}
+
 template<typename HashFunc>
 vtl_always_inline
 event_t StringTree<HashFunc>::searchAllocString(const TString *str,
 						event_t newval)
 {
-	StringTreeEntry<HashFunc> *entry;
-	bool isNew;
-	uint32_t hval;
+	const TString *s;
+	unsigned int idx;
+	event_t e;
+	int t;
+
+	t = EventHash::candidate(str->ptr, str->len);
+	if (t >= 0 && equals(&knownStrings[t], str))
+		return (event_t) t;
+
+	idx = (unsigned int) hashFunc(str) & hashMask;
+	while ((e = hashTable[idx]) != EVENT_ERROR) {
+		if (equals(stringTable[e], str))
+			return e;
+		idx = (idx + 1) & hashMask;
+	}
 
-	hval = hashFunc(str);
-	hval = hval % hSize;
+	if (newval < 0 || (unsigned int) newval >= tableSize)
+		return EVENT_ERROR;
+	s = newString(str);
+	if (s == nullptr)
+		return EVENT_ERROR;
+	hashTable[idx] = newval;
+	stringTable[newval] = s;
+	maxEvent = newval;
+	return newval;
+}
 
-	if (hashTable[hval] != nullptr) {
-		entry = hashTable[hval];
-		VTL_STRINGTREE_ITERATOR_(iter) iter =
-			entry->avlTree.findInsert(*str, isNew);
-		if (isNew) {
-			event_t &e = iter.value();
-			e = newval;
-			stringTable[newval] = &iter.key();
-			maxEvent = newval;
-			return newval;
-		} else {
-			return iter.value();
-		}
-	} else {
-		entry = new StringTreeEntry<HashFunc>(&avlPools);
-		hashTable[hval] = entry;
-		deleteList.append(entry);
-		VTL_STRINGTREE_ITERATOR_(iter) iter =
-			entry->avlTree.findInsert(*str, isNew);
-		event_t &e = iter.value();
-		e = newval;
-		stringTable[newval] = &iter.key();
-		maxEvent = newval;
-		return newval;
-	}
+template<typename HashFunc>
+vtl_always_inline
+const TString *StringTree<HashFunc>::newString(const TString *str)
+{
+	TString *newstr;
+	unsigned int size;
+
+	size = sizeof(TString) + str->len + 1;
+	size = (size + alignof(TString) - 1) & ~(alignof(TString) - 1);
+	newstr = (TString*) charPool->allocBytes(size);
+	if (newstr == nullptr)
+		return nullptr;
+	newstr->len = str->len;
+	newstr->ptr = (char*) (newstr + 1);
+	memcpy(newstr->ptr, str->ptr, str->len);
+	newstr->ptr[str->len] = '\0';
+	return newstr;
 }
 
 template<typename HashFunc>
@@ -224,28 +182,30 @@ vtl_always_inline event_t StringTree<HashFunc>::getMaxEvent() const
 }
 
 template<typename HashFunc>
-StringTree<HashFunc>::StringTree(unsigned int nr_pages, unsigned int hSizeP,
+StringTree<HashFunc>::StringTree(unsigned int nr_pages,
 				 unsigned int table_size):
 maxEvent((event_t)-1)
 {
-	unsigned int entryPages;
+	unsigned int hSize = 1;
+	int t;
 
-	if (hSizeP == 0)
-		hSize = 1;
-	else
-		hSize = hSizeP;
+	if (table_size < NR_EVENTS)
+		table_size = NR_EVENTS;
+	tableSize = table_size;
 
-	entryPages = 2 * hSize *
-		sizeof(vtl::AVLNode<TString, event_t>) / 4096;
-	entryPages = STRINGTREE_MAX(1, entryPages);
+	/* The load factor of the hash table stays below 1/2 */
+	while (hSize < 2 * tableSize)
+		hSize <<= 1;
+	hashMask = hSize - 1;
 
-	avlPools.charPool = new MemPool(nr_pages, sizeof(char));
-	avlPools.nodePool = new MemPool(entryPages, sizeof(vtl::AVLNode<TString,
-							   event_t>));
-	hashTable = new StringTreeEntry<HashFunc>*[hSize];
+	for (t = 0; t < NR_EVENTS; t++) {
+		knownStrings[t].ptr = (char*) EventHash::names[t];
+		knownStrings[t].len = strlen(EventHash::names[t]);
+	}
 
-	stringTable = new TString*[table_size];
-	tableSize = table_size;
+	charPool = new MemPool(nr_pages, sizeof(char));
+	hashTable = new event_t[hSize];
+	stringTable = new const TString*[tableSize];
 
 	clearTable();
 }
@@ -253,37 +213,30 @@ maxEvent((event_t)-1)
 template<typename HashFunc>
 StringTree<HashFunc>::~StringTree()
 {
-	unsigned int i, s;
-	delete avlPools.charPool;
-	delete avlPools.nodePool;
+	delete charPool;
 	delete[] hashTable;
 	delete[] stringTable;
-	s = deleteList.size();
-	for (i = 0; i < s; i++) {
-		delete deleteList[i];
-	}
 }
 
 template<typename HashFunc>
 void StringTree<HashFunc>::clearTable()
 {
-	tshark_bzero(hashTable, hSize * sizeof(StringTreeEntry<HashFunc>*));
+	unsigned int i;
+	int t;
+
+	for (i = 0; i <= hashMask; i++)
+		hashTable[i] = EVENT_ERROR;
 	tshark_bzero(stringTable, tableSize * sizeof(TString*));
-	maxEvent = (event_t) -1;
+	for (t = 0; t < NR_EVENTS; t++)
+		stringTable[t] = &knownStrings[t];
+	maxEvent = (event_t) (NR_EVENTS - 1);
 }
 
 template<typename HashFunc>
 void StringTree<HashFunc>::clear()
 {
-	unsigned int s, i;
 	clearTable();
-	avlPools.nodePool->reset();
-	avlPools.charPool->reset();
-	s = deleteList.size();
-	for (i = 0; i < s; i++) {
-		delete deleteList[i];
-	}
-	deleteList.clear();
+	charPool->reset();
 }
 
 template<typename HashFunc>
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "misc/chunk.h"
+#include "misc/errors.h"
+#include "parser/argcache.h"
+#include "parser/tokenizer.h"
+#include "parser/tracefile.h"
+
+ArgCache::ArgCache(unsigned int size)
+	: traceFile(nullptr), nrEntries(TSMAX(size, 1U))
+{
+	unsigned int i;
+
+	entries = new Entry[nrEntries];
+	for (i = 0; i < nrEntries; i++) {
+		entries[i].span = 0;
+		entries[i].buf = nullptr;
+		entries[i].bufSize = 0;
+	}
+	clear();
+}
+
+ArgCache::~ArgCache()
+{
+	unsigned int i;
+
+	for (i = 0; i < nrEntries; i++)
+		delete[] entries[i].buf;
+	delete[] entries;
+}
+
+/* The cache is cleared because the spans refer to the previous file */
+void ArgCache::setTraceFile(TraceFile *file)
+{
+	clear();
+	traceFile = file;
+}
+
+void ArgCache::clear()
+{
+	unsigned int i;
+
+	map.clear();
+	first = nullptr;
+	last = nullptr;
+	for (i = 0; i < nrEntries; i++)
+		linkFirst(&entries[i]);
+}
+
+const TString * const *ArgCache::getLazyArgs(const TraceEvent &event,
+					     int &argc)
+{
+	Entry *entry;
+
+	entry = map.value(event.argSpan, nullptr);
+	if (entry == nullptr) {
+		entry = evictEntry();
+		if (!readEntry(entry, event)) {
+			argc = 0;
+			return nullptr;
+		}
+		map.insert(event.argSpan, entry);
+	}
+	unlinkEntry(entry);
+	linkFirst(entry);
+	argc = entry->argc;
+	return entry->argv;
+}
+
+/*
+ * Returns the least recently used entry, after having removed it from the map.
+ * The entry is left last in the list, so that it is reused first if reading
+ * it fails.
+ */
+ArgCache::Entry *ArgCache::evictEntry()
+{
+	Entry *entry = last;
+
+	if (map.value(entry->span, nullptr) == entry)
+		map.remove(entry->span);
+	return entry;
+}
+
+bool ArgCache::readEntry(Entry *entry, const TraceEvent &event)
+{
+	Chunk chunk;
+	unsigned int i, n, next;
+	int ts_errno = 0;
+	int r;
+
+	if (traceFile == nullptr)
+		return false;
+
+	chunk.offset = event.lazyArgsOffset();
+	chunk.len = event.lazyArgsLen();
+	chunk.file = 0;
+	chunk.type = CHUNK_TEXT;
+
+	/* One extra byte is needed to null terminate the last argument */
+	if (entry->bufSize < (unsigned int) chunk.len + 1) {
+		delete[] entry->buf;
+		entry->bufSize = chunk.len + 1;
+		entry->buf = new char[entry->bufSize];
+	}
+
+	r = traceFile->readChunk(&chunk, entry->buf, chunk.len, &ts_errno);
+	if (ts_errno != 0 || r != chunk.len)
+		return false;
+
+	n = Tokenizer::tokenizeLine(entry->buf, 0, chunk.len, entry->strings,
+				    EVENT_MAX_NR_ARGS, &next);
+	for (i = 0; i < n; i++) {
+		entry->strings[i].ptr[entry->strings[i].len] = '\0';
+		entry->argv[i] = &entry->strings[i];
+	}
+	entry->argc = n;
+	entry->span = event.argSpan;
+	return true;
+}
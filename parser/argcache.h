@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ARGCACHE_H
+#define ARGCACHE_H
+
+#include <cstdint>
+
+#include <QHash>
+
+#include "misc/traceshark.h"
+#include "misc/tstring.h"
+#include "parser/traceevent.h"
+
+class TraceFile;
+
+/*
+ * This class provides the arguments of events whose arguments were not stored
+ * by the parser, because the lazy argument mode was enabled, see
+ * TraceParser::setLazyArgs(). The arguments are read from the trace file and
+ * tokenized again. The most recently used argument vectors are kept, so that
+ * for example the rows that are visible in the events view do not need to be
+ * read over and over again. The arguments that were stored are not copied,
+ * getArgs() returns an Args that looks them up by their string ids.
+ *
+ * The arguments that are returned are valid until the next call to getArgs()
+ * or clear(). This class is not thread safe.
+ */
+class ArgCache
+{
+public:
+	/* This can be indexed like an array of TString pointers */
+	class Args {
+	public:
+		vtl_always_inline const TString *operator[](int i) const;
+		/* The arguments of an entry, nullptr if they were stored */
+		const TString * const *ptrs;
+		TraceEvent::ArgVector ids;
+	};
+	ArgCache(unsigned int size = DEFAULT_SIZE);
+	~ArgCache();
+	void setTraceFile(TraceFile *file);
+	void clear();
+	vtl_always_inline Args getArgs(const TraceEvent &event, int &argc);
+	static const unsigned int DEFAULT_SIZE = 256;
+private:
+	class Entry {
+	public:
+		uint64_t span;
+		/* The entries are linked in order of most recent use */
+		Entry *prev;
+		Entry *next;
+		char *buf;
+		unsigned int bufSize;
+		int argc;
+		TString strings[EVENT_MAX_NR_ARGS];
+		const TString *argv[EVENT_MAX_NR_ARGS];
+	};
+	const TString * const *getLazyArgs(const TraceEvent &event, int &argc);
+	Entry *evictEntry();
+	bool readEntry(Entry *entry, const TraceEvent &event);
+	vtl_always_inline void unlinkEntry(Entry *entry);
+	vtl_always_inline void linkFirst(Entry *entry);
+	TraceFile *traceFile;
+	Entry *entries;
+	unsigned int nrEntries;
+	Entry *first;
+	Entry *last;
+	QHash<uint64_t, Entry*> map;
+};
+
+vtl_always_inline const TString *ArgCache::Args::operator[](int i) const
+{
+	if (ptrs != nullptr)
+		return ptrs[i];
+	return ids[i];
+}
+
+vtl_always_inline void ArgCache::unlinkEntry(Entry *entry)
+{
+	if (entry->prev != nullptr)
+		entry->prev->next = entry->next;
+	else
+		first = entry->next;
+	if (entry->next != nullptr)
+		entry->next->prev = entry->prev;
+	else
+		last = entry->prev;
+}
+
+vtl_always_inline void ArgCache::linkFirst(Entry *entry)
+{
+	entry->prev = nullptr;
+	entry->next = first;
+	if (first != nullptr)
+		first->prev = entry;
+	else
+		last = entry;
+	first = entry;
+}
+
+vtl_always_inline ArgCache::Args ArgCache::getArgs(const TraceEvent &event,
+						   int &argc)
+{
+	Args args;
+
+	if (!event.hasLazyArgs()) {
+		argc = event.argc;
+		args.ptrs = nullptr;
+		args.ids = event.argv;
+	} else {
+		args.ptrs = getLazyArgs(event, argc);
+		args.ids.offset = 0;
+	}
+	return args;
+}
+
+#endif /* ARGCACHE_H */
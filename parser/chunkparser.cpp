@@ -0,0 +1,231 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parser/chunkparser.h"
+#include "parser/tracefile.h"
+#include "misc/errors.h"
+
+/* Each chunk has its own load buffers, so we use a bit smaller ones */
+#define CHUNK_BUFFER_SIZE (1024 * 1024)
+
+ChunkParser::ChunkParser(const QString &name, tracetype_t ttype,
+			 int64_t begin, int64_t end, bool mapped, bool lazy,
+			 const RetentionPolicy *policy)
+	: rangeBegin(begin), rangeEnd(end), firstEventBegin(end), ts_errno(0),
+	  fileName(name), mappedLoad(mapped), traceType(ttype),
+	  traceFile(nullptr), tbuffer(nullptr), ftraceGrammar(nullptr),
+	  perfGrammar(nullptr)
+{
+	strings = new EventStrings();
+	if (traceType == TRACE_TYPE_FTRACE) {
+		ftraceGrammar = new FtraceGrammar();
+		ftraceGrammar->setEventStrings(strings);
+		ftraceGrammar->setLazyArgs(lazy);
+		ftraceGrammar->setRetentionPolicy(policy);
+	} else {
+		perfGrammar = new PerfGrammar();
+		perfGrammar->setEventStrings(strings);
+		perfGrammar->setLazyArgs(lazy);
+		perfGrammar->setRetentionPolicy(policy);
+	}
+	postEventPool = new MemPool(1024, sizeof(Chunk));
+	events = new vtl::TList<TraceEvent>();
+	doneWatcher = new IndexWatcher;
+
+	fakeEvent.clear();
+	fakePostEventInfo.offset = 0;
+	fakePostEventInfo.len = 0;
+	fakePostEventInfo.file = 0;
+	fakePostEventInfo.type = CHUNK_TEXT;
+	fakeEvent.postEventInfo = &fakePostEventInfo;
+
+	lineData.clear();
+	lineData.prevEvent = &fakeEvent;
+}
+
+ChunkParser::~ChunkParser()
+{
+	delete ftraceGrammar;
+	delete perfGrammar;
+	delete strings;
+	delete postEventPool;
+	delete events;
+	delete doneWatcher;
+}
+
+/*
+ * This is the function that is run by the WorkQueue, it returns true in case
+ * of an error.
+ */
+bool ChunkParser::parse()
+{
+	unsigned int curbuf = 0;
+	int close_errno;
+	bool eof;
+	LoadBuffer *loadBuffer;
+
+	traceFile = new TraceFile(fileName.toLocal8Bit().data(), ts_errno,
+				  CHUNK_BUFFER_SIZE, rangeBegin, rangeEnd,
+				  mappedLoad);
+	if (ts_errno != 0)
+		goto out;
+
+	tbuffer = new ThreadBuffer<TraceLine>();
+
+	do {
+		loadBuffer = traceFile->getLoadBuffer(curbuf);
+		tbuffer->loadBuffer = loadBuffer;
+		tbuffer->beginProduceBuffer();
+		/*
+		 * The last buffer may be empty, in that case there is nothing
+		 * to tokenize, see TraceParser::threadReader()
+		 */
+		if (!loadBuffer->isEOF() || loadBuffer->nRead > 0)
+			tokenizeBuffer();
+		tbuffer->endProduceBuffer();
+		eof = parseBuffer();
+		traceFile->clearBufferSwitch();
+		curbuf++;
+		if (curbuf == traceFile->getNrBuffers())
+			curbuf = 0;
+	} while (!eof);
+
+	fixLastEvent();
+	delete tbuffer;
+	tbuffer = nullptr;
+out:
+	if (traceFile != nullptr) {
+		traceFile->close(&close_errno);
+		delete traceFile;
+		traceFile = nullptr;
+	}
+	doneWatcher->sendEOF();
+	return ts_errno != 0;
+}
+
+vtl_always_inline void ChunkParser::tokenizeBuffer()
+{
+	while (true) {
+		TraceLine *line = &tbuffer->list.increase();
+		traceFile->ReadLine(line, tbuffer);
+		if (traceFile->getBufferSwitch())
+			break;
+	}
+}
+
+vtl_always_inline bool ChunkParser::parseBuffer()
+{
+	unsigned int i, s;
+	bool eof;
+
+	tbuffer->beginConsumeBuffer();
+
+	s = tbuffer->list.size();
+
+	for (i = 0; i < s; i++) {
+		TraceLine &line = tbuffer->list[i];
+		TraceEvent &event = events->preAlloc();
+		event.argc = 0;
+		event.argv.offset = strings->beginArgs();
+		if (traceType == TRACE_TYPE_FTRACE)
+			parseLineFtrace(line, event);
+		else
+			parseLinePerf(line, event);
+	}
+	eof = tbuffer->loadBuffer->isEOF();
+	tbuffer->endConsumeBuffer();
+	return eof;
+}
+
+/*
+ * Any non event lines at the end of the range belong to the last event, like in
+ * TraceParser::fixLastEvent(). Lines that continue into the next range will be
+ * added by the TraceParser when it stitches the chunks together.
+ */
+void ChunkParser::fixLastEvent()
+{
+	if (traceType != TRACE_TYPE_PERF || events->size() <= 0)
+		return;
+	/* The lines belong to an event that was dropped */
+	if (lineData.prevEvent == &fakeEvent)
+		return;
+	TraceEvent &lastEvent = events->last();
+	if (lineData.prevLineIsEvent) {
+		lastEvent.postEventInfo = nullptr;
+	} else {
+		Chunk *chunk = (Chunk*) postEventPool->allocObj();
+		chunk->offset = lineData.infoBegin;
+		chunk->len = rangeEnd - lineData.infoBegin;
+		chunk->file = 0;
+		chunk->type = CHUNK_TEXT;
+		lastEvent.postEventInfo = chunk;
+	}
+}
+
+void ChunkParser::waitForCompletion()
+{
+	int index;
+	bool eof = false;
+	while (!eof)
+		doneWatcher->waitForNextBatch(eof, index);
+}
+
+/*
+ * This is called when the events and strings have been copied to the final
+ * event list, the characters of the strings are still needed, so the grammar
+ * and pools are kept until the ChunkParser is deleted.
+ */
+void ChunkParser::releaseEvents()
+{
+	events->clear();
+	strings->clear();
+}
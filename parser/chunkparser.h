@@ -0,0 +1,226 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CHUNKPARSER_H
+#define CHUNKPARSER_H
+
+#include <cstdint>
+
+#include <QString>
+
+#include "mm/mempool.h"
+#include "mm/stringtree.h"
+#include "parser/ftrace/ftracegrammar.h"
+#include "parser/perf/perfgrammar.h"
+#include "parser/traceevent.h"
+#include "parser/traceline.h"
+#include "parser/tracelinedata.h"
+#include "misc/chunk.h"
+#include "misc/traceshark.h"
+#include "threads/indexwatcher.h"
+#include "threads/threadbuffer.h"
+#include "vtl/compiler.h"
+#include "vtl/tlist.h"
+
+class TraceFile;
+
+/*
+ * This class parses a range of a trace file, the range must begin and end at
+ * line boundaries. Several ChunkParsers can parse different ranges of the same
+ * file in parallel, because each of them has its own TraceFile, grammar, pools,
+ * event strings and event list. It is up to the TraceParser to stitch the
+ * results together in file order.
+ *
+ * The tokenizing and parsing are done by the same thread, the one that calls
+ * parse(), so there is only one ThreadBuffer. The timestamp rollover fixup is
+ * not done here because it depends on the events in the previous chunk.
+ */
+class ChunkParser
+{
+public:
+	ChunkParser(const QString &name, tracetype_t ttype, int64_t begin,
+		    int64_t end, bool mapped = false, bool lazy = false,
+		    const RetentionPolicy *policy = nullptr);
+	~ChunkParser();
+	bool parse();
+	void waitForCompletion();
+	void releaseEvents();
+	vtl_always_inline const StringTree<> *getEventTree() const;
+	vtl_always_inline const RetentionTable &getRetention() const;
+	vtl_always_inline bool endsWithDroppedEvent() const;
+	int64_t rangeBegin;
+	int64_t rangeEnd;
+	/*
+	 * The offset of the first event in the range, or rangeEnd if there
+	 * are no events. Any lines before it belong to the last event of the
+	 * previous chunk.
+	 */
+	int64_t firstEventBegin;
+	vtl::TList<TraceEvent> *events;
+	/* The string ids in the events refer to these */
+	EventStrings *strings;
+	int ts_errno;
+private:
+	vtl_always_inline void tokenizeBuffer();
+	vtl_always_inline bool parseBuffer();
+	vtl_always_inline bool parseLineFtrace(TraceLine &line,
+					       TraceEvent &event);
+	vtl_always_inline bool parseLinePerf(TraceLine &line,
+					     TraceEvent &event);
+	void fixLastEvent();
+	QString fileName;
+	bool mappedLoad;
+	tracetype_t traceType;
+	TraceFile *traceFile;
+	ThreadBuffer<TraceLine> *tbuffer;
+	FtraceGrammar *ftraceGrammar;
+	PerfGrammar *perfGrammar;
+	MemPool *postEventPool;
+	TraceLineData lineData;
+	TraceEvent fakeEvent;
+	Chunk fakePostEventInfo;
+	/* This is only used to signal that the parsing has been completed */
+	IndexWatcher *doneWatcher;
+};
+
+vtl_always_inline const StringTree<> *ChunkParser::getEventTree() const
+{
+	if (traceType == TRACE_TYPE_FTRACE)
+		return ftraceGrammar->eventTree;
+	return perfGrammar->eventTree;
+}
+
+vtl_always_inline const RetentionTable &ChunkParser::getRetention() const
+{
+	if (traceType == TRACE_TYPE_FTRACE)
+		return ftraceGrammar->retention;
+	return perfGrammar->retention;
+}
+
+/*
+ * Returns true if the last event line of the range was dropped because of the
+ * retention policy, then the lines that continue into the next range should be
+ * dropped too.
+ */
+vtl_always_inline bool ChunkParser::endsWithDroppedEvent() const
+{
+	return traceType == TRACE_TYPE_PERF && firstEventBegin < rangeEnd &&
+		lineData.prevEvent == &fakeEvent;
+}
+
+vtl_always_inline bool ChunkParser::parseLineFtrace(TraceLine &line,
+						    TraceEvent &event)
+{
+	if (ftraceGrammar->parseLine(line, event)) {
+		strings->commitArgs();
+		events->commit();
+
+		event.postEventInfo = nullptr;
+		if (firstEventBegin == rangeEnd)
+			firstEventBegin = line.begin;
+		lineData.nrEvents++;
+		lineData.prevLineIsEvent = true;
+		return true;
+	}
+	return false;
+}
+
+vtl_always_inline bool ChunkParser::parseLinePerf(TraceLine &line,
+						  TraceEvent &event)
+{
+	if (perfGrammar->parseLine(line, event)) {
+		strings->commitArgs();
+		events->commit();
+
+		if (lineData.prevLineIsEvent) {
+			lineData.prevEvent->postEventInfo = nullptr;
+		} else {
+			Chunk *chunk = (Chunk*) postEventPool->allocObj();
+			chunk->offset = lineData.infoBegin;
+			chunk->len = line.begin - lineData.infoBegin;
+			chunk->file = 0;
+			chunk->type = CHUNK_TEXT;
+			lineData.prevEvent->postEventInfo = chunk;
+			lineData.prevLineIsEvent = true;
+		}
+		if (firstEventBegin == rangeEnd)
+			firstEventBegin = line.begin;
+		lineData.prevEvent = &event;
+		lineData.nrEvents++;
+		return true;
+	} else if (perfGrammar->droppedEvent()) {
+		/* See TraceParser::parseLinePerf() */
+		if (lineData.prevLineIsEvent) {
+			lineData.prevEvent->postEventInfo = nullptr;
+		} else if (lineData.prevEvent != &fakeEvent) {
+			Chunk *chunk = (Chunk*) postEventPool->allocObj();
+			chunk->offset = lineData.infoBegin;
+			chunk->len = line.begin - lineData.infoBegin;
+			chunk->file = 0;
+			chunk->type = CHUNK_TEXT;
+			lineData.prevEvent->postEventInfo = chunk;
+		}
+		if (firstEventBegin == rangeEnd)
+			firstEventBegin = line.begin;
+		lineData.prevLineIsEvent = true;
+		lineData.prevEvent = &fakeEvent;
+		return false;
+	} else {
+		if (lineData.prevLineIsEvent) {
+			lineData.infoBegin = line.begin;
+			lineData.prevLineIsEvent = false;
+		}
+		return false;
+	}
+}
+
+#endif /* CHUNKPARSER_H */
@@ -0,0 +1,307 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <cstring>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "parser/compress/compressedfile.h"
+#include "parser/compress/gzipdecompressor.h"
+#include "parser/compress/xzdecompressor.h"
+#include "parser/compress/zstddecompressor.h"
+#include "vtl/error.h"
+
+#define GZIP_MAGIC "\x1f\x8b"
+#define GZIP_MAGIC_LEN (sizeof(GZIP_MAGIC) - 1)
+#define ZSTD_MAGIC "\x28\xb5\x2f\xfd"
+#define ZSTD_MAGIC_LEN (sizeof(ZSTD_MAGIC) - 1)
+#define XZ_MAGIC "\xfd\x37\x7a\x58\x5a\x00"
+#define XZ_MAGIC_LEN (sizeof(XZ_MAGIC) - 1)
+
+/*
+ * The size of the compressed file is needed in order to find the index of an
+ * xz file. The decoders are started when they are first used.
+ */
+CompressedFile::CompressedFile(int myfd, compression_t ctype,
+			       int64_t compressedSize):
+	streamStarted(false), randomValid(false), dataSize(-1)
+{
+#ifdef CONFIG_XZ
+	int64_t xzSize;
+
+	if (ctype == COMPRESSION_XZ) {
+		XzDecompressor::readIndex(myfd, compressedSize, &accessIndex,
+					  &xzSize);
+		dataSize.store(xzSize, std::memory_order_relaxed);
+	}
+#else
+	(void) compressedSize;
+#endif
+	streamDecoder = newDecompressor(ctype, myfd, &accessIndex);
+	randomDecoder = newDecompressor(ctype, myfd, &accessIndex);
+}
+
+CompressedFile::~CompressedFile()
+{
+	delete streamDecoder;
+	delete randomDecoder;
+}
+
+/* Returns the compression format of the file, judging by the magic bytes */
+CompressedFile::compression_t CompressedFile::detect(int fd)
+{
+	char magic[XZ_MAGIC_LEN];
+	ssize_t r;
+
+	do {
+		r = pread(fd, magic, XZ_MAGIC_LEN, 0);
+	} while (r < 0 && errno == EINTR);
+
+	if (r >= (ssize_t) GZIP_MAGIC_LEN &&
+	    memcmp(magic, GZIP_MAGIC, GZIP_MAGIC_LEN) == 0)
+		return COMPRESSION_GZIP;
+	if (r >= (ssize_t) ZSTD_MAGIC_LEN &&
+	    memcmp(magic, ZSTD_MAGIC, ZSTD_MAGIC_LEN) == 0)
+		return COMPRESSION_ZSTD;
+	if (r >= (ssize_t) XZ_MAGIC_LEN &&
+	    memcmp(magic, XZ_MAGIC, XZ_MAGIC_LEN) == 0)
+		return COMPRESSION_XZ;
+	return COMPRESSION_NONE;
+}
+
+/* Returns true if this build of traceshark can decompress the format */
+bool CompressedFile::isSupported(compression_t ctype)
+{
+	switch (ctype) {
+#ifdef CONFIG_GZIP
+	case COMPRESSION_GZIP:
+		return true;
+#endif
+#ifdef CONFIG_ZSTD
+	case COMPRESSION_ZSTD:
+		return true;
+#endif
+#ifdef CONFIG_XZ
+	case COMPRESSION_XZ:
+		return true;
+#endif
+	default:
+		return false;
+	}
+}
+
+Decompressor *CompressedFile::newDecompressor(compression_t ctype, int fd,
+					      AccessIndex *index)
+{
+	Decompressor *decompressor = nullptr;
+
+	switch (ctype) {
+#ifdef CONFIG_GZIP
+	case COMPRESSION_GZIP:
+		decompressor = new GzipDecompressor(fd, index);
+		break;
+#endif
+#ifdef CONFIG_ZSTD
+	case COMPRESSION_ZSTD:
+		decompressor = new ZstdDecompressor(fd, index);
+		break;
+#endif
+#ifdef CONFIG_XZ
+	case COMPRESSION_XZ:
+		decompressor = new XzDecompressor(fd, index);
+		break;
+#endif
+	default:
+		vtl::errx(BSD_EX_SOFTWARE, "Unsupported compression at %s:%d",
+			  __FILE__, __LINE__);
+		break;
+	}
+	return decompressor;
+}
+
+/*
+ * Decompresses the next size bytes sequentially. This is used by the
+ * LoadThread and it is the only user of the streamDecoder, so no locking is
+ * needed.
+ */
+ssize_t CompressedFile::read(char *buf, size_t size, int *ts_errno)
+{
+	ssize_t r;
+
+	if (!streamStarted) {
+		*ts_errno = streamDecoder->start(AccessPoint());
+		if (*ts_errno != 0)
+			return -1;
+		streamStarted = true;
+	}
+	r = streamDecoder->read(buf, size, ts_errno);
+	if (r >= 0 && (size_t) r < size)
+		dataSize.store(streamDecoder->getPosition(),
+				 std::memory_order_relaxed);
+	return r;
+}
+
+/* Skips the next n bytes of the sequential data */
+int64_t CompressedFile::skip(int64_t n, int *ts_errno)
+{
+	int64_t r;
+
+	if (!streamStarted) {
+		*ts_errno = streamDecoder->start(AccessPoint());
+		if (*ts_errno != 0)
+			return -1;
+		streamStarted = true;
+	}
+	r = streamDecoder->skip(n, ts_errno);
+	if (r >= 0 && r < n)
+		dataSize.store(streamDecoder->getPosition(),
+			   std::memory_order_relaxed);
+	return r;
+}
+
+/*
+ * Moves the randomDecoder to offset. It continues from where it is, if no
+ * access point is closer, so that chunks that follow each other are not
+ * decompressed from the point each time. Returns true if offset was reached.
+ * If false is returned and ts_errno is zero, then the data ends before offset.
+ */
+bool CompressedFile::seekRandom(int64_t offset, int *ts_errno)
+{
+	AccessPoint point = accessIndex.find(offset);
+	int64_t pos = randomDecoder->getPosition();
+	int64_t r;
+
+	*ts_errno = 0;
+	if (!randomValid || pos > offset || point.out > pos) {
+		*ts_errno = randomDecoder->start(point);
+		if (*ts_errno != 0)
+			return false;
+		randomValid = true;
+		pos = point.out;
+	}
+	r = randomDecoder->skip(offset - pos, ts_errno);
+	if (r < 0) {
+		randomValid = false;
+		return false;
+	}
+	if (r < offset - pos) {
+		dataSize.store(randomDecoder->getPosition(),
+			       std::memory_order_relaxed);
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Decompresses up to size bytes from offset. Returns the number of bytes, which
+ * is smaller than size only if the end of the data was reached, or -1 in case
+ * of an error.
+ */
+ssize_t CompressedFile::readAt(int64_t offset, char *buf, size_t size,
+			       int *ts_errno)
+{
+	int64_t s = dataSize.load(std::memory_order_relaxed);
+	ssize_t r = 0;
+
+	*ts_errno = 0;
+	if (s >= 0 && offset >= s)
+		return 0;
+
+	mutex.lock();
+	if (!seekRandom(offset, ts_errno)) {
+		if (*ts_errno != 0)
+			r = -1;
+		goto out;
+	}
+	r = randomDecoder->read(buf, size, ts_errno);
+	if (r < 0)
+		randomValid = false;
+	else if ((size_t) r < size)
+		dataSize.store(randomDecoder->getPosition(),
+			       std::memory_order_relaxed);
+out:
+	mutex.unlock();
+	return r;
+}
+
+/*
+ * Returns the size of the decompressed data. If it is not known, then the
+ * whole file is decompressed in order to find it out, which also completes the
+ * index of access points. If the data is corrupt, the size is that of the data
+ * before the error.
+ */
+int64_t CompressedFile::getSize()
+{
+	int64_t s = dataSize.load(std::memory_order_relaxed);
+	int ts_errno;
+
+	if (s >= 0)
+		return s;
+
+	mutex.lock();
+	s = dataSize.load(std::memory_order_relaxed);
+	if (s < 0) {
+		seekRandom(INT64_MAX, &ts_errno);
+		s = dataSize.load(std::memory_order_relaxed);
+		if (s < 0) {
+			s = randomDecoder->getPosition();
+			dataSize.store(s, std::memory_order_relaxed);
+		}
+	}
+	mutex.unlock();
+	return s;
+}
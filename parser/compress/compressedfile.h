@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef COMPRESSEDFILE_H
+#define COMPRESSEDFILE_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <QMutex>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+#include "parser/compress/decompressor.h"
+
+/*
+ * This provides the decompressed data of a compressed trace file. The data is
+ * read sequentially with read(), by the LoadThread, and randomly with readAt(),
+ * when chunks of the file are needed. Both use the same index of access
+ * points, so that the chunks can be decompressed starting from the closest
+ * point before them.
+ */
+class CompressedFile
+{
+public:
+	typedef enum : int {
+		COMPRESSION_NONE = 0,
+		COMPRESSION_GZIP,
+		COMPRESSION_ZSTD,
+		COMPRESSION_XZ
+	} compression_t;
+	CompressedFile(int myfd, compression_t ctype, int64_t compressedSize);
+	~CompressedFile();
+	static compression_t detect(int fd);
+	static bool isSupported(compression_t ctype);
+	ssize_t read(char *buf, size_t size, int *ts_errno);
+	int64_t skip(int64_t n, int *ts_errno);
+	ssize_t readAt(int64_t offset, char *buf, size_t size, int *ts_errno);
+	int64_t getSize();
+private:
+	static Decompressor *newDecompressor(compression_t ctype, int fd,
+					     AccessIndex *index);
+	bool seekRandom(int64_t offset, int *ts_errno);
+	AccessIndex accessIndex;
+	Decompressor *streamDecoder;
+	Decompressor *randomDecoder;
+	bool streamStarted;
+	/* False if the randomDecoder needs to be started at a point */
+	bool randomValid;
+	/* The size of the decompressed data, or -1 if it is not yet known */
+	std::atomic<int64_t> dataSize;
+	/* Serializes the use of the randomDecoder */
+	QMutex mutex;
+};
+
+#endif /* COMPRESSEDFILE_H */
@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+
+extern "C" {
+#include <unistd.h>
+}
+
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "parser/compress/decompressor.h"
+
+AccessPoint::AccessPoint():
+	type(POINT_START), in(0), out(0), bits(0)
+{}
+
+AccessIndex::AccessIndex():
+	lastOut(0)
+{
+	points.append(AccessPoint());
+}
+
+/*
+ * The points must be added in the order of the decompressed data. A point that
+ * is too close to the previous one, or behind it, is ignored, so that more than
+ * one decoder can add points.
+ */
+void AccessIndex::add(const AccessPoint &point)
+{
+	mutex.lock();
+	if (point.out - points.last().out >= SPAN) {
+		points.append(point);
+		lastOut.store(point.out, std::memory_order_relaxed);
+	}
+	mutex.unlock();
+}
+
+/* Returns the last point that is at or before out */
+AccessPoint AccessIndex::find(int64_t out)
+{
+	AccessPoint point;
+	int low = 0;
+	int high;
+	int mid;
+
+	mutex.lock();
+	high = points.size() - 1;
+	while (low < high) {
+		mid = (low + high + 1) / 2;
+		if (points[mid].out <= out)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	point = points[low];
+	mutex.unlock();
+	return point;
+}
+
+Decompressor::Decompressor(int myfd, AccessIndex *index):
+	fd(myfd), accessIndex(index), inPos(0), outPos(0)
+{
+	inBuf = new char[INBUF_SIZE];
+}
+
+Decompressor::~Decompressor()
+{
+	delete[] inBuf;
+}
+
+/*
+ * Decompresses size bytes to buf. Returns the number of bytes, which is
+ * smaller than size only at the end of the data, or -1 in case of an error.
+ */
+ssize_t Decompressor::read(char *buf, size_t size, int *ts_errno)
+{
+	size_t count = 0;
+	ssize_t r;
+
+	*ts_errno = 0;
+	while (count < size) {
+		r = decode(buf + count, size - count, ts_errno);
+		if (r < 0)
+			return -1;
+		if (r == 0)
+			break;
+		count += r;
+	}
+	return count;
+}
+
+/*
+ * Decompresses and throws away n bytes. Returns the number of bytes, which is
+ * smaller than n only at the end of the data, or -1 in case of an error.
+ */
+int64_t Decompressor::skip(int64_t n, int *ts_errno)
+{
+	const size_t scratchSize = 65536;
+	char *scratch;
+	int64_t count = 0;
+	ssize_t r;
+
+	*ts_errno = 0;
+	scratch = new char[scratchSize];
+	while (count < n) {
+		r = decode(scratch, (size_t) TSMIN(n - count,
+						   (int64_t) scratchSize),
+			   ts_errno);
+		if (r < 0) {
+			count = -1;
+			break;
+		}
+		if (r == 0)
+			break;
+		count += r;
+	}
+	delete[] scratch;
+	return count;
+}
+
+/*
+ * Reads the next part of the compressed file to inBuf. Returns the number of
+ * bytes, which is zero at the end of the file, or -1 in case of an error.
+ */
+ssize_t Decompressor::readInput(int *ts_errno)
+{
+	ssize_t r;
+
+	r = readInputAt(inPos, inBuf, INBUF_SIZE, ts_errno);
+	if (r > 0)
+		inPos += r;
+	return r;
+}
+
+ssize_t Decompressor::readInputAt(int64_t offset, char *buf, size_t size,
+				  int *ts_errno)
+{
+	ssize_t r;
+
+	do {
+		r = pread(fd, buf, size, (off_t) offset);
+	} while (r < 0 && errno == EINTR);
+
+	if (r < 0) {
+		if (errno != 0)
+			*ts_errno = errno;
+		else
+			*ts_errno = - TS_ERROR_ERROR;
+	}
+	return r;
+}
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef DECOMPRESSOR_H
+#define DECOMPRESSOR_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QVector>
+
+extern "C" {
+#include <sys/types.h>
+}
+
+#include "vtl/compiler.h"
+
+/*
+ * A position in the compressed file, where decompression can be started
+ * without decompressing everything that comes before it.
+ */
+class AccessPoint
+{
+public:
+	typedef enum : int {
+		/* A gzip member, zstd frame or xz stream begins at in */
+		POINT_START = 0,
+		/*
+		 * The decoder is resumed at in, with the help of bits and
+		 * window for gzip, or with the block header at in for xz.
+		 */
+		POINT_RESUME
+	} pointtype_t;
+	AccessPoint();
+	pointtype_t type;
+	/* The offset in the compressed file */
+	int64_t in;
+	/* The offset in the decompressed data */
+	int64_t out;
+	/* The number of bits of the byte before in, that belong to the point */
+	int bits;
+	/* The last 32 kB of the decompressed data, needed by gzip */
+	QByteArray window;
+};
+
+/*
+ * This is the list of access points of a compressed file. It is built lazily
+ * while the file is decompressed, so that the chunks of the file, such as the
+ * backtraces of perf events, can be decompressed by starting at the closest
+ * point before them. There is always a point at the beginning of the file.
+ */
+class AccessIndex
+{
+public:
+	AccessIndex();
+	vtl_always_inline bool wants(int64_t out) const;
+	void add(const AccessPoint &point);
+	AccessPoint find(int64_t out);
+	/* The decompressed data between points should not be more than this */
+	static const int64_t SPAN = 8 * 1024 * 1024;
+private:
+	QVector<AccessPoint> points;
+	/* The out of the last point, so that wants() doesn't need the mutex */
+	std::atomic<int64_t> lastOut;
+	QMutex mutex;
+};
+
+/*
+ * Returns true if a point at out would be added. The gzip decoder uses this
+ * in order to avoid copying the window unnecessarily.
+ */
+vtl_always_inline bool AccessIndex::wants(int64_t out) const
+{
+	return out - lastOut.load(std::memory_order_relaxed) >= SPAN;
+}
+
+/*
+ * This is the base class of the decoders of the different compression formats.
+ * A decoder reads the compressed file with pread(), so that it does not disturb
+ * the file position, and several decoders can work with the same file. If the
+ * decoder has an index, then it adds the access points that it comes across.
+ */
+class Decompressor
+{
+public:
+	Decompressor(int myfd, AccessIndex *index);
+	virtual ~Decompressor();
+	/* Prepares the decoder to decompress from point */
+	virtual int start(const AccessPoint &point) = 0;
+	ssize_t read(char *buf, size_t size, int *ts_errno);
+	int64_t skip(int64_t n, int *ts_errno);
+	vtl_always_inline int64_t getPosition() const;
+protected:
+	/*
+	 * Decompresses at most size bytes to buf and updates outPos. Returns
+	 * the number of bytes, which is zero only at the end of the data, or
+	 * -1 in case of an error.
+	 */
+	virtual ssize_t decode(char *buf, size_t size, int *ts_errno) = 0;
+	ssize_t readInput(int *ts_errno);
+	ssize_t readInputAt(int64_t offset, char *buf, size_t size,
+			    int *ts_errno);
+	int fd;
+	AccessIndex *accessIndex;
+	/* The offset in the compressed file of the next readInput() */
+	int64_t inPos;
+	/* The offset in the decompressed data of the next decode() */
+	int64_t outPos;
+	char *inBuf;
+	static const size_t INBUF_SIZE = 256 * 1024;
+};
+
+vtl_always_inline int64_t Decompressor::getPosition() const
+{
+	return outPos;
+}
+
+#endif /* DECOMPRESSOR_H */
@@ -0,0 +1,207 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef CONFIG_GZIP
+
+#include <climits>
+#include <cstring>
+
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "parser/compress/gzipdecompressor.h"
+#include "vtl/error.h"
+
+GzipDecompressor::GzipDecompressor(int myfd, AccessIndex *index):
+	Decompressor(myfd, index), raw(false), memberEnd(false),
+	trailerLeft(0)
+{
+	memset(&strm, 0, sizeof(strm));
+	if (inflateInit2(&strm, GZIP_WBITS) != Z_OK)
+		vtl::errx(BSD_EX_SOFTWARE, "inflateInit2() failed");
+}
+
+GzipDecompressor::~GzipDecompressor()
+{
+	inflateEnd(&strm);
+}
+
+int GzipDecompressor::start(const AccessPoint &point)
+{
+	unsigned char c;
+	int ts_errno = 0;
+
+	strm.next_in = nullptr;
+	strm.avail_in = 0;
+	inPos = point.in;
+	outPos = point.out;
+	memberEnd = false;
+	trailerLeft = 0;
+
+	if (point.type == AccessPoint::POINT_START) {
+		raw = false;
+		if (inflateReset2(&strm, GZIP_WBITS) != Z_OK)
+			return - TS_ERROR_INTERNAL;
+		return 0;
+	}
+
+	raw = true;
+	if (inflateReset2(&strm, RAW_WBITS) != Z_OK)
+		return - TS_ERROR_INTERNAL;
+	/* The point may begin in the middle of a byte */
+	if (point.bits > 0) {
+		if (readInputAt(point.in - 1, (char*) &c, 1, &ts_errno) != 1)
+			return ts_errno != 0 ? ts_errno : - TS_ERROR_EOF;
+		if (inflatePrime(&strm, point.bits, c >> (8 - point.bits)) !=
+		    Z_OK)
+			return - TS_ERROR_INTERNAL;
+	}
+	if (inflateSetDictionary(&strm,
+				 (const Bytef*) point.window.constData(),
+				 point.window.size()) != Z_OK)
+		return - TS_ERROR_INTERNAL;
+	return 0;
+}
+
+ssize_t GzipDecompressor::decode(char *buf, size_t size, int *ts_errno)
+{
+	ssize_t r;
+	unsigned int n;
+	uInt before;
+	int ret;
+	AccessPoint point;
+
+	size = TSMIN(size, (size_t) UINT_MAX);
+	strm.next_out = (Bytef*) buf;
+	strm.avail_out = (uInt) size;
+
+	while (strm.avail_out > 0) {
+		if (strm.avail_in == 0) {
+			r = readInput(ts_errno);
+			if (r < 0)
+				return -1;
+			if (r == 0) {
+				/* It's only OK for the file to end after a member */
+				if (memberEnd && trailerLeft == 0)
+					break;
+				*ts_errno = - TS_ERROR_EOF;
+				return -1;
+			}
+			strm.next_in = (Bytef*) inBuf;
+			strm.avail_in = (uInt) r;
+		}
+
+		if (trailerLeft > 0) {
+			n = TSMIN(trailerLeft, strm.avail_in);
+			strm.next_in += n;
+			strm.avail_in -= n;
+			trailerLeft -= n;
+			continue;
+		}
+
+		if (memberEnd) {
+			/* There is more data, so another member begins here */
+			memberEnd = false;
+			raw = false;
+			if (inflateReset2(&strm, GZIP_WBITS) != Z_OK) {
+				*ts_errno = - TS_ERROR_INTERNAL;
+				return -1;
+			}
+			if (accessIndex != nullptr &&
+			    accessIndex->wants(outPos)) {
+				point.type = AccessPoint::POINT_START;
+				point.in = inPos - strm.avail_in;
+				point.out = outPos;
+				accessIndex->add(point);
+			}
+		}
+
+		before = strm.avail_out;
+		ret = inflate(&strm, Z_BLOCK);
+		outPos += before - strm.avail_out;
+
+		if (ret == Z_STREAM_END) {
+			memberEnd = true;
+			if (raw)
+				trailerLeft = TRAILER_SIZE;
+			continue;
+		}
+		if (ret != Z_OK && !(ret == Z_BUF_ERROR && strm.avail_in == 0)) {
+			*ts_errno = - TS_ERROR_DECOMPRESS;
+			return -1;
+		}
+
+		/* Bit 7 is set at the end of a block, bit 6 if it was the last */
+		if (accessIndex != nullptr && (strm.data_type & 128) != 0 &&
+		    (strm.data_type & 64) == 0 && accessIndex->wants(outPos))
+			addPoint();
+	}
+	return size - strm.avail_out;
+}
+
+void GzipDecompressor::addPoint()
+{
+	AccessPoint point;
+	uInt len = 32768;
+
+	point.type = AccessPoint::POINT_RESUME;
+	point.in = inPos - strm.avail_in;
+	point.out = outPos;
+	point.bits = strm.data_type & 7;
+	point.window.resize(len);
+	if (inflateGetDictionary(&strm, (Bytef*) point.window.data(), &len) !=
+	    Z_OK)
+		return;
+	point.window.resize(len);
+	accessIndex->add(point);
+}
+
+#endif /* CONFIG_GZIP */
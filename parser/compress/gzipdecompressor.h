@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef GZIPDECOMPRESSOR_H
+#define GZIPDECOMPRESSOR_H
+
+#ifdef CONFIG_GZIP
+
+extern "C" {
+#include <zlib.h>
+}
+
+#include "parser/compress/decompressor.h"
+
+/*
+ * This decompresses gzip files with zlib, including files with more than one
+ * member. The access points are made at the end of deflate blocks, where the
+ * decoder can be resumed with inflatePrime() and inflateSetDictionary(), in
+ * the same way as in the zran.c example of zlib.
+ */
+class GzipDecompressor : public Decompressor
+{
+public:
+	GzipDecompressor(int myfd, AccessIndex *index);
+	~GzipDecompressor();
+	int start(const AccessPoint &point);
+protected:
+	ssize_t decode(char *buf, size_t size, int *ts_errno);
+private:
+	void addPoint();
+	z_stream strm;
+	/* Raw deflate data is decoded when we have resumed at a point */
+	bool raw;
+	/* True when a member has ended and the next has not yet begun */
+	bool memberEnd;
+	/* The gzip trailer must be skipped by us, if we are decoding raw */
+	unsigned int trailerLeft;
+	static const int GZIP_WBITS = 15 + 32;
+	static const int RAW_WBITS = -15;
+	static const unsigned int TRAILER_SIZE = 8;
+};
+
+#endif /* CONFIG_GZIP */
+
+#endif /* GZIPDECOMPRESSOR_H */
@@ -0,0 +1,276 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef CONFIG_XZ
+
+#include <cstdlib>
+#include <cstring>
+
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "parser/compress/xzdecompressor.h"
+
+XzDecompressor::XzDecompressor(int myfd, AccessIndex *index):
+	Decompressor(myfd, index), blockMode(false), checkKnown(false),
+	check(LZMA_CHECK_NONE), inputEOF(false), streamEnd(false)
+{
+	lzma_stream init = LZMA_STREAM_INIT;
+
+	strm = init;
+	memset(&block, 0, sizeof(block));
+}
+
+XzDecompressor::~XzDecompressor()
+{
+	lzma_end(&strm);
+}
+
+/*
+ * Makes an access point of every block that is listed in the index. This is
+ * only done if the file consists of a single stream, because then the index at
+ * the end of the file covers all of it. The size of the decompressed data is
+ * returned in size, or -1 if it is not known.
+ */
+void XzDecompressor::readIndex(int fd, int64_t fileSize, AccessIndex *index,
+			       int64_t *size)
+{
+	uint8_t footer[LZMA_STREAM_HEADER_SIZE];
+	lzma_stream_flags flags;
+	lzma_index *idx = nullptr;
+	lzma_index_iter iter;
+	uint64_t memlimit = UINT64_MAX;
+	uint8_t *buf = nullptr;
+	size_t pos = 0;
+	int64_t indexPos;
+	AccessPoint point;
+
+	*size = -1;
+	if (fileSize < 2 * LZMA_STREAM_HEADER_SIZE)
+		return;
+	if (pread(fd, footer, LZMA_STREAM_HEADER_SIZE,
+		  fileSize - LZMA_STREAM_HEADER_SIZE) !=
+	    LZMA_STREAM_HEADER_SIZE)
+		return;
+	/* This fails if the file has stream padding, then we give up */
+	if (lzma_stream_footer_decode(&flags, footer) != LZMA_OK)
+		return;
+	indexPos = fileSize - LZMA_STREAM_HEADER_SIZE -
+		(int64_t) flags.backward_size;
+	if (indexPos < LZMA_STREAM_HEADER_SIZE)
+		return;
+
+	buf = new uint8_t[flags.backward_size];
+	if (pread(fd, buf, flags.backward_size, indexPos) !=
+	    (ssize_t) flags.backward_size)
+		goto out;
+	if (lzma_index_buffer_decode(&idx, &memlimit, nullptr, buf, &pos,
+				     flags.backward_size) != LZMA_OK) {
+		idx = nullptr;
+		goto out;
+	}
+	/* If there are more streams before this one, then we give up */
+	if (lzma_index_stream_size(idx) != (lzma_vli) fileSize)
+		goto out;
+
+	lzma_index_iter_init(&iter, idx);
+	while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK)) {
+		point.type = AccessPoint::POINT_RESUME;
+		point.in = iter.block.compressed_file_offset;
+		point.out = iter.block.uncompressed_file_offset;
+		index->add(point);
+	}
+	*size = lzma_index_uncompressed_size(idx);
+out:
+	if (idx != nullptr)
+		lzma_index_end(idx, nullptr);
+	delete[] buf;
+}
+
+int XzDecompressor::start(const AccessPoint &point)
+{
+	int ts_errno;
+
+	strm.next_in = nullptr;
+	strm.avail_in = 0;
+	inPos = point.in;
+	outPos = point.out;
+	inputEOF = false;
+	streamEnd = false;
+
+	if (point.type == AccessPoint::POINT_START) {
+		blockMode = false;
+		if (lzma_stream_decoder(&strm, UINT64_MAX, LZMA_CONCATENATED) !=
+		    LZMA_OK)
+			return - TS_ERROR_INTERNAL;
+		return 0;
+	}
+
+	blockMode = true;
+	if (!checkKnown) {
+		ts_errno = readCheck();
+		if (ts_errno != 0)
+			return ts_errno;
+	}
+	return startBlock(point.in);
+}
+
+/* The check type is stored in the stream header at the beginning */
+int XzDecompressor::readCheck()
+{
+	uint8_t header[LZMA_STREAM_HEADER_SIZE];
+	lzma_stream_flags flags;
+	int ts_errno = 0;
+
+	if (readInputAt(0, (char*) header, LZMA_STREAM_HEADER_SIZE,
+			&ts_errno) != LZMA_STREAM_HEADER_SIZE)
+		return ts_errno != 0 ? ts_errno : - TS_ERROR_EOF;
+	if (lzma_stream_header_decode(&flags, header) != LZMA_OK)
+		return - TS_ERROR_DECOMPRESS;
+	check = flags.check;
+	checkKnown = true;
+	return 0;
+}
+
+/*
+ * Starts the block decoder with the block at offset. If there is no block
+ * there, but the index, then we are at the end of the stream.
+ */
+int XzDecompressor::startBlock(int64_t offset)
+{
+	uint8_t header[LZMA_BLOCK_HEADER_SIZE_MAX];
+	lzma_filter filters[LZMA_FILTERS_MAX + 1];
+	lzma_ret ret;
+	int ts_errno = 0;
+	ssize_t r;
+	int i;
+
+	strm.next_in = nullptr;
+	strm.avail_in = 0;
+
+	r = readInputAt(offset, (char*) header, 1, &ts_errno);
+	if (r != 1)
+		return ts_errno != 0 ? ts_errno : - TS_ERROR_EOF;
+	if (header[0] == 0x00) {
+		streamEnd = true;
+		return 0;
+	}
+
+	memset(&block, 0, sizeof(block));
+	block.version = 1;
+	block.check = check;
+	block.filters = filters;
+	block.header_size = lzma_block_header_size_decode(header[0]);
+	r = readInputAt(offset + 1, (char*) header + 1, block.header_size - 1,
+			&ts_errno);
+	if (r != (ssize_t) block.header_size - 1)
+		return ts_errno != 0 ? ts_errno : - TS_ERROR_EOF;
+	if (lzma_block_header_decode(&block, nullptr, header) != LZMA_OK)
+		return - TS_ERROR_DECOMPRESS;
+
+	ret = lzma_block_decoder(&strm, &block);
+	/* The filter options are only needed to initialize the decoder */
+	for (i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++)
+		free(filters[i].options);
+	if (ret != LZMA_OK)
+		return - TS_ERROR_DECOMPRESS;
+
+	inPos = offset + block.header_size;
+	return 0;
+}
+
+ssize_t XzDecompressor::decode(char *buf, size_t size, int *ts_errno)
+{
+	ssize_t r;
+	size_t before;
+	lzma_ret ret;
+
+	strm.next_out = (uint8_t*) buf;
+	strm.avail_out = size;
+
+	while (strm.avail_out > 0 && !streamEnd) {
+		if (strm.avail_in == 0 && !inputEOF) {
+			r = readInput(ts_errno);
+			if (r < 0)
+				return -1;
+			if (r == 0)
+				inputEOF = true;
+			strm.next_in = (uint8_t*) inBuf;
+			strm.avail_in = r;
+		}
+
+		before = strm.avail_out;
+		ret = lzma_code(&strm, inputEOF ? LZMA_FINISH : LZMA_RUN);
+		outPos += before - strm.avail_out;
+
+		if (ret == LZMA_STREAM_END) {
+			if (!blockMode) {
+				streamEnd = true;
+				break;
+			}
+			/* The next block follows directly after this one */
+			*ts_errno = startBlock(inPos - strm.avail_in);
+			if (*ts_errno != 0)
+				return -1;
+			continue;
+		}
+		if (ret != LZMA_OK) {
+			if (ret == LZMA_BUF_ERROR && inputEOF)
+				*ts_errno = - TS_ERROR_EOF;
+			else
+				*ts_errno = - TS_ERROR_DECOMPRESS;
+			return -1;
+		}
+	}
+	return size - strm.avail_out;
+}
+
+#endif /* CONFIG_XZ */
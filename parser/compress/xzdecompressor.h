@@ -0,0 +1,98 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef XZDECOMPRESSOR_H
+#define XZDECOMPRESSOR_H
+
+#ifdef CONFIG_XZ
+
+extern "C" {
+#include <lzma.h>
+}
+
+#include "parser/compress/decompressor.h"
+
+/*
+ * This decompresses xz files with liblzma. The blocks of an xz file can be
+ * decoded independently and their locations are stored in the index at the end
+ * of the file, so the access points are made from the index when the file is
+ * opened. Files that are compressed with more than one thread, or with the
+ * --block-size option of xz, have many blocks.
+ */
+class XzDecompressor : public Decompressor
+{
+public:
+	XzDecompressor(int myfd, AccessIndex *index);
+	~XzDecompressor();
+	int start(const AccessPoint &point);
+	static void readIndex(int fd, int64_t fileSize, AccessIndex *index,
+			      int64_t *size);
+protected:
+	ssize_t decode(char *buf, size_t size, int *ts_errno);
+private:
+	int readCheck();
+	int startBlock(int64_t offset);
+	lzma_stream strm;
+	/* The block decoder updates this while it decodes the block */
+	lzma_block block;
+	/* True if single blocks are decoded, instead of the whole stream */
+	bool blockMode;
+	/* The check type of the stream is needed in order to decode blocks */
+	bool checkKnown;
+	lzma_check check;
+	bool inputEOF;
+	bool streamEnd;
+};
+
+#endif /* CONFIG_XZ */
+
+#endif /* XZDECOMPRESSOR_H */
@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifdef CONFIG_ZSTD
+
+#include "misc/errors.h"
+#include "parser/compress/zstddecompressor.h"
+#include "vtl/error.h"
+
+ZstdDecompressor::ZstdDecompressor(int myfd, AccessIndex *index):
+	Decompressor(myfd, index), inFrame(false)
+{
+	dctx = ZSTD_createDCtx();
+	if (dctx == nullptr)
+		vtl::errx(BSD_EX_SOFTWARE, "ZSTD_createDCtx() failed");
+	input.src = inBuf;
+	input.size = 0;
+	input.pos = 0;
+}
+
+ZstdDecompressor::~ZstdDecompressor()
+{
+	ZSTD_freeDCtx(dctx);
+}
+
+int ZstdDecompressor::start(const AccessPoint &point)
+{
+	if (ZSTD_isError(ZSTD_DCtx_reset(dctx, ZSTD_reset_session_only)))
+		return - TS_ERROR_INTERNAL;
+	input.size = 0;
+	input.pos = 0;
+	inPos = point.in;
+	outPos = point.out;
+	inFrame = false;
+	return 0;
+}
+
+ssize_t ZstdDecompressor::decode(char *buf, size_t size, int *ts_errno)
+{
+	ZSTD_outBuffer output;
+	AccessPoint point;
+	ssize_t r;
+	size_t before;
+	size_t ret;
+
+	output.dst = buf;
+	output.size = size;
+	output.pos = 0;
+
+	while (output.pos < output.size) {
+		if (input.pos == input.size) {
+			r = readInput(ts_errno);
+			if (r < 0)
+				return -1;
+			if (r == 0) {
+				/* It's only OK for the file to end after a frame */
+				if (!inFrame)
+					break;
+				*ts_errno = - TS_ERROR_EOF;
+				return -1;
+			}
+			input.size = r;
+			input.pos = 0;
+		}
+
+		before = output.pos;
+		ret = ZSTD_decompressStream(dctx, &output, &input);
+		outPos += output.pos - before;
+		if (ZSTD_isError(ret)) {
+			*ts_errno = - TS_ERROR_DECOMPRESS;
+			return -1;
+		}
+
+		/* A return value of zero means that a frame was completed */
+		inFrame = ret != 0;
+		if (!inFrame && accessIndex != nullptr &&
+		    accessIndex->wants(outPos)) {
+			point.type = AccessPoint::POINT_START;
+			point.in = inPos - (int64_t) (input.size - input.pos);
+			point.out = outPos;
+			accessIndex->add(point);
+		}
+	}
+	return output.pos;
+}
+
+#endif /* CONFIG_ZSTD */
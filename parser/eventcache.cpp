@@ -0,0 +1,662 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include "misc/errors.h"
+#include "misc/osapi.h"
+#include "parser/eventcache.h"
+#include "parser/eventstrings.h"
+#include "parser/traceevent.h"
+#include "parser/tracefile.h"
+#include "vtl/error.h"
+#include "vtl/tlist.h"
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+}
+
+#define EVENTCACHE_MAGIC "TSHKIDX"
+/*
+ * Version 2 stopped writing the time precision, which version 1 readers would
+ * take to be zero.
+ */
+#define EVENTCACHE_VERSION (2)
+#define EVENTCACHE_BYTE_ORDER (0x01020304)
+#define EVENTCACHE_FLAG_LAZY_ARGS (1)
+#define EVENTCACHE_SUFFIX ".tsidx"
+#define EVENTCACHE_DIR "traceshark"
+#define EVENTCACHE_NO_STRING (UINT32_MAX)
+/* This is the size of the string tables of the event trees of the grammars */
+#define EVENTCACHE_MAX_TYPES (4096)
+#define EVENTCACHE_WRITE_BUFSIZE (1024 * 1024)
+
+/*
+ * The index file begins with this header, which is followed by the sections in
+ * the order arguments, chunks, events, strings, types and chars. All sections
+ * except the arguments and chars consist of 8-byte aligned records.
+ */
+class EventCache::Header {
+public:
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	int32_t traceType;
+	uint32_t flags;
+	/* The stat data of the trace when the index was written */
+	uint64_t dev;
+	uint64_t ino;
+	int64_t size;
+	int64_t mtimeSec;
+	int64_t mtimeNsec;
+	int64_t ctimeSec;
+	int64_t ctimeNsec;
+	/* The size of the index file itself */
+	uint64_t indexSize;
+	uint64_t nrEvents;
+	uint64_t nrStrings;
+	uint64_t nrArgs;
+	uint64_t nrChunks;
+	uint64_t nrTypes;
+	uint64_t charsSize;
+	uint64_t argsOffset;
+	uint64_t chunksOffset;
+	uint64_t eventsOffset;
+	uint64_t stringsOffset;
+	uint64_t typesOffset;
+	uint64_t charsOffset;
+};
+
+class CacheEvent {
+public:
+	int64_t time;
+	/* The index of the first argument, or the argSpan of lazy arguments */
+	uint64_t args;
+	uint32_t taskName;
+	int32_t pid;
+	uint32_t cpu;
+	int32_t intArg;
+	int32_t type;
+	int32_t argc;
+	/* The index of the chunk plus one, zero if there is no chunk */
+	uint32_t chunk;
+	/* This was the precision of the time, which is now guessed per trace */
+	uint32_t reserved;
+};
+
+/* A null terminated string in the chars section */
+class CacheString {
+public:
+	uint64_t offset;
+	uint32_t len;
+	uint32_t reserved;
+};
+
+class CacheChunk {
+public:
+	int64_t offset;
+	int32_t len;
+	int32_t type;
+};
+
+/*
+ * Returns the id in the index of the string that has the id in eventStrings,
+ * the strings that are not used by any event are not written to the index.
+ */
+static vtl_always_inline uint32_t
+stringId(QVector<uint32_t> &ids, QVector<const TString*> &strs,
+	 const EventStrings *eventStrings, uint32_t id)
+{
+	if (id == STRINGTABLE_NO_ID)
+		return EVENTCACHE_NO_STRING;
+	if (ids[id] == EVENTCACHE_NO_STRING) {
+		ids[id] = strs.size();
+		strs.append(eventStrings->getString(id));
+	}
+	return ids[id];
+}
+
+EventCache::EventCache()
+	: header(nullptr), mapping(nullptr), mappingSize(0), chunks(nullptr)
+{}
+
+EventCache::~EventCache()
+{
+	clear();
+}
+
+void EventCache::clear()
+{
+	delete[] chunks;
+	chunks = nullptr;
+	if (mapping != nullptr) {
+		if (munmap(mapping, mappingSize) != 0)
+			munmap_err();
+		mapping = nullptr;
+	}
+	mappingSize = 0;
+	header = nullptr;
+}
+
+/*
+ * Returns the path of the index of the file, or an empty array on failure. If
+ * create is true, then the cache directory is created if it doesn't exist.
+ */
+QByteArray EventCache::cachePath(TraceFile *file, bool create, int *ts_errno)
+{
+	const struct stat &st = file->fileInfo.getStat();
+	QByteArray path;
+	QByteArray dir;
+	const char *env;
+	char name[64];
+
+	*ts_errno = 0;
+	env = getenv("XDG_CACHE_HOME");
+	if (env != nullptr && *env == '/') {
+		dir = QByteArray(env);
+	} else {
+		env = getenv("HOME");
+		if (env == nullptr || *env != '/') {
+			*ts_errno = -TS_ERROR_ERROR;
+			return path;
+		}
+		dir = QByteArray(env);
+		dir.append("/.cache");
+		if (create && mkdir(dir.constData(), 0700) != 0 &&
+		    errno != EEXIST) {
+			*ts_errno = errno;
+			return path;
+		}
+	}
+	dir.append("/" EVENTCACHE_DIR);
+	if (create && mkdir(dir.constData(), 0700) != 0 && errno != EEXIST) {
+		*ts_errno = errno;
+		return path;
+	}
+
+	snprintf(name, sizeof(name), "/%llx-%llx" EVENTCACHE_SUFFIX,
+		 (unsigned long long) st.st_dev,
+		 (unsigned long long) st.st_ino);
+	path = dir;
+	path.append(name);
+	return path;
+}
+
+void EventCache::fillHeader(Header *h, TraceFile *file, bool lazyArgs,
+			    tracetype_t ttype)
+{
+	const struct stat &st = file->fileInfo.getStat();
+
+	tshark_bzero(h, sizeof(Header));
+	strncpy(h->magic, EVENTCACHE_MAGIC, sizeof(h->magic));
+	h->version = EVENTCACHE_VERSION;
+	h->byteOrder = EVENTCACHE_BYTE_ORDER;
+	h->traceType = ttype;
+	h->flags = lazyArgs ? EVENTCACHE_FLAG_LAZY_ARGS : 0;
+	h->dev = st.st_dev;
+	h->ino = st.st_ino;
+	h->size = st.st_size;
+	h->mtimeSec = tshark_mtimespec(st).tv_sec;
+	h->mtimeNsec = tshark_mtimespec(st).tv_nsec;
+	h->ctimeSec = tshark_ctimespec(st).tv_sec;
+	h->ctimeNsec = tshark_ctimespec(st).tv_nsec;
+}
+
+/*
+ * Returns true if there is a valid index for the file. If lazyArgs differs
+ * from what it was when the index was written, then the index is not used.
+ */
+bool EventCache::open(TraceFile *file, bool lazyArgs)
+{
+	Header key;
+	QByteArray path;
+	struct stat st;
+	int ts_errno;
+	void *m;
+	int fd;
+
+	clear();
+	path = cachePath(file, false, &ts_errno);
+	if (path.isEmpty())
+		return false;
+	fd = ::open(path.constData(), O_RDONLY);
+	if (fd < 0)
+		return false;
+	if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(Header)) {
+		::close(fd);
+		return false;
+	}
+	m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (m == MAP_FAILED)
+		return false;
+	mapping = (char*) m;
+	mappingSize = st.st_size;
+	header = (const Header*) mapping;
+
+	fillHeader(&key, file, lazyArgs, (tracetype_t) header->traceType);
+	/* The stat data and all fields before it must be identical */
+	if (memcmp(&key, header, offsetof(Header, indexSize)) != 0)
+		goto fail;
+	if (header->traceType != TRACE_TYPE_FTRACE &&
+	    header->traceType != TRACE_TYPE_PERF)
+		goto fail;
+	if (header->indexSize != mappingSize ||
+	    header->nrEvents > (uint64_t) INT_MAX ||
+	    header->nrStrings >= (uint64_t) EVENTCACHE_NO_STRING ||
+	    header->nrChunks >= (uint64_t) UINT32_MAX ||
+	    header->nrTypes > EVENTCACHE_MAX_TYPES)
+		goto fail;
+	if (!checkSection(header->argsOffset, header->nrArgs,
+			  sizeof(uint32_t)) ||
+	    !checkSection(header->chunksOffset, header->nrChunks,
+			  sizeof(CacheChunk)) ||
+	    !checkSection(header->eventsOffset, header->nrEvents,
+			  sizeof(CacheEvent)) ||
+	    !checkSection(header->stringsOffset, header->nrStrings,
+			  sizeof(CacheString)) ||
+	    !checkSection(header->typesOffset, header->nrTypes,
+			  sizeof(CacheString)) ||
+	    !checkSection(header->charsOffset, header->charsSize, 1))
+		goto fail;
+	return true;
+fail:
+	clear();
+	return false;
+}
+
+/* The section must be within the mapping and aligned for its records */
+bool EventCache::checkSection(uint64_t offset, uint64_t nr,
+			      uint64_t size) const
+{
+	uint64_t align = size >= 8 ? 8 : size;
+
+	if (offset > mappingSize || offset % align != 0)
+		return false;
+	return nr <= (mappingSize - offset) / size;
+}
+
+tracetype_t EventCache::getTraceType() const
+{
+	return (tracetype_t) header->traceType;
+}
+
+int EventCache::getNrTypes() const
+{
+	return (int) header->nrTypes;
+}
+
+/*
+ * The name of a type that has no name is empty. Returns false if the index is
+ * damaged.
+ */
+bool EventCache::getTypeName(int type, TString *name) const
+{
+	const CacheString *types = (const CacheString *)
+		(mapping + header->typesOffset);
+	const char *chars = mapping + header->charsOffset;
+	const CacheString &s = types[type];
+
+	if (s.offset >= header->charsSize ||
+	    s.len >= header->charsSize - s.offset ||
+	    chars[s.offset + s.len] != '\0')
+		return false;
+	name->ptr = (char*) chars + s.offset;
+	name->len = s.len;
+	return true;
+}
+
+/*
+ * Appends the events of the index to events. The types of the index are
+ * translated with typeMap, which must have getNrTypes() elements, a negative
+ * element means that no event may have that type. Returns false if the index
+ * is damaged, then events is cleared.
+ */
+bool EventCache::readEvents(const QVector<event_t> &typeMap,
+			    vtl::TList<TraceEvent> *events,
+			    EventStrings *eventStrings)
+{
+	const uint32_t *args = (const uint32_t *)
+		(mapping + header->argsOffset);
+	const CacheChunk *cchunks = (const CacheChunk *)
+		(mapping + header->chunksOffset);
+	const CacheEvent *cevents = (const CacheEvent *)
+		(mapping + header->eventsOffset);
+	const CacheString *cstrings = (const CacheString *)
+		(mapping + header->stringsOffset);
+	const char *chars = mapping + header->charsOffset;
+	uint32_t stringBase;
+	uint64_t argBase;
+	TString str;
+	uint64_t i;
+
+	if (!eventStrings->table.hasRoom(header->nrStrings))
+		goto fail;
+	stringBase = eventStrings->table.size();
+	for (i = 0; i < header->nrStrings; i++) {
+		const CacheString &s = cstrings[i];
+		if (s.offset >= header->charsSize ||
+		    s.len >= header->charsSize - s.offset ||
+		    chars[s.offset + s.len] != '\0')
+			goto fail;
+		str.ptr = (char*) chars + s.offset;
+		str.len = s.len;
+		eventStrings->table.add(str);
+	}
+
+	argBase = eventStrings->beginArgs();
+	for (i = 0; i < header->nrArgs; i++) {
+		if (args[i] >= header->nrStrings)
+			goto fail;
+		eventStrings->addArg(stringBase + args[i]);
+	}
+	eventStrings->commitArgs();
+
+	chunks = new Chunk[header->nrChunks];
+	for (i = 0; i < header->nrChunks; i++) {
+		const CacheChunk &c = cchunks[i];
+		if (c.offset < 0 || c.len < 0 || c.type < CHUNK_TEXT ||
+		    c.type > CHUNK_CALLCHAIN_SWAP)
+			goto fail;
+		chunks[i].offset = c.offset;
+		chunks[i].len = c.len;
+		chunks[i].file = 0;
+		chunks[i].type = (chunktype_t) c.type;
+	}
+
+	for (i = 0; i < header->nrEvents; i++) {
+		const CacheEvent &c = cevents[i];
+		if (c.type < 0 || c.type >= typeMap.size() ||
+		    typeMap[c.type] < 0 || c.chunk > header->nrChunks)
+			goto fail;
+		if (c.taskName != EVENTCACHE_NO_STRING &&
+		    c.taskName >= header->nrStrings)
+			goto fail;
+		if (c.argc != TraceEvent::ARGC_LAZY &&
+		    (c.argc < 0 || c.argc > EVENT_MAX_NR_ARGS ||
+		     c.args > header->nrArgs ||
+		     (uint64_t) c.argc > header->nrArgs - c.args))
+			goto fail;
+
+		TraceEvent &event = events->increase();
+		event.taskNameId = c.taskName == EVENTCACHE_NO_STRING ?
+			STRINGTABLE_NO_ID : stringBase + c.taskName;
+		event.pid = c.pid;
+		event.cpu = c.cpu;
+		event.time = vtl::CompactTime(c.time);
+		event.intArg = c.intArg;
+		event.type = typeMap[c.type];
+		event.argc = c.argc;
+		if (c.argc == TraceEvent::ARGC_LAZY)
+			event.argSpan = c.args;
+		else
+			event.argv.offset = argBase + c.args;
+		event.postEventInfo = c.chunk == 0 ?
+			nullptr : &chunks[c.chunk - 1];
+	}
+	return true;
+fail:
+	events->clear();
+	eventStrings->clear();
+	clear();
+	return false;
+}
+
+int EventCache::writeData(FILE *fp, const void *data, size_t size)
+{
+	if (fwrite(data, size, 1, fp) == 1)
+		return 0;
+	return errno != 0 ? errno : -TS_ERROR_ERROR;
+}
+
+int EventCache::writeAlign(FILE *fp, uint64_t *pos)
+{
+	static const char zeros[8] = { 0 };
+	uint64_t pad = (8 - *pos % 8) % 8;
+
+	if (pad == 0)
+		return 0;
+	*pos += pad;
+	return writeData(fp, zeros, pad);
+}
+
+/*
+ * Writes the index of the file. The index is first written to a temporary file
+ * that is renamed when it is complete, so that an incomplete index is never
+ * seen. Returns 0 or an error code.
+ */
+int EventCache::write(TraceFile *file, bool lazyArgs, tracetype_t ttype,
+		      const vtl::TList<TraceEvent> *events,
+		      const EventStrings *eventStrings,
+		      const StringTree<> *eventTree)
+{
+	QVector<uint32_t> ids(eventStrings->table.size(),
+			      EVENTCACHE_NO_STRING);
+	QVector<const TString*> strs;
+	QByteArray path;
+	QByteArray tmpPath;
+	Header h;
+	CacheEvent ce;
+	CacheChunk cc;
+	CacheString cs;
+	const TString *name;
+	uint64_t pos;
+	uint64_t argIdx;
+	uint32_t chunkIdx;
+	uint32_t id;
+	int nrTypes;
+	int ts_errno;
+	char pidstr[32];
+	FILE *fp;
+	int i;
+	int a;
+	int t;
+
+	path = cachePath(file, true, &ts_errno);
+	if (path.isEmpty())
+		return ts_errno;
+	snprintf(pidstr, sizeof(pidstr), ".%ld", (long) getpid());
+	tmpPath = path;
+	tmpPath.append(pidstr);
+	fp = fopen(tmpPath.constData(), "w");
+	if (fp == nullptr)
+		return errno != 0 ? errno : -TS_ERROR_ERROR;
+	setvbuf(fp, nullptr, _IOFBF, EVENTCACHE_WRITE_BUFSIZE);
+
+	/* The header is written again when it is complete */
+	fillHeader(&h, file, lazyArgs, ttype);
+	ts_errno = writeData(fp, &h, sizeof(h));
+	if (ts_errno != 0)
+		goto error;
+	pos = sizeof(h);
+
+	/* The arguments, this also gives every string an id */
+	h.argsOffset = pos;
+	for (i = 0; i < events->size(); i++) {
+		const TraceEvent &event = events->at(i);
+		stringId(ids, strs, eventStrings, event.taskNameId);
+		if (event.hasLazyArgs())
+			continue;
+		for (a = 0; a < event.argc; a++) {
+			id = eventStrings->getArgId(event.argv.offset + a);
+			id = stringId(ids, strs, eventStrings, id);
+			ts_errno = writeData(fp, &id, sizeof(id));
+			if (ts_errno != 0)
+				goto error;
+		}
+		h.nrArgs += event.argc;
+	}
+	pos += h.nrArgs * sizeof(uint32_t);
+	ts_errno = writeAlign(fp, &pos);
+	if (ts_errno != 0)
+		goto error;
+
+	h.chunksOffset = pos;
+	for (i = 0; i < events->size(); i++) {
+		const Chunk *chunk = events->at(i).postEventInfo;
+		if (chunk == nullptr)
+			continue;
+		cc.offset = chunk->offset;
+		cc.len = chunk->len;
+		cc.type = chunk->type;
+		ts_errno = writeData(fp, &cc, sizeof(cc));
+		if (ts_errno != 0)
+			goto error;
+		h.nrChunks++;
+	}
+	pos += h.nrChunks * sizeof(CacheChunk);
+
+	h.eventsOffset = pos;
+	argIdx = 0;
+	chunkIdx = 0;
+	tshark_bzero(&ce, sizeof(ce));
+	for (i = 0; i < events->size(); i++) {
+		const TraceEvent &event = events->at(i);
+		ce.time = event.time.getNanoseconds();
+		ce.taskName = stringId(ids, strs, eventStrings,
+				       event.taskNameId);
+		ce.pid = event.pid;
+		ce.cpu = event.cpu;
+		ce.intArg = event.intArg;
+		ce.type = event.type;
+		ce.argc = event.argc;
+		if (event.hasLazyArgs()) {
+			ce.args = event.argSpan;
+		} else {
+			ce.args = argIdx;
+			argIdx += event.argc;
+		}
+		ce.chunk = event.postEventInfo == nullptr ? 0 : ++chunkIdx;
+		ts_errno = writeData(fp, &ce, sizeof(ce));
+		if (ts_errno != 0)
+			goto error;
+	}
+	h.nrEvents = events->size();
+	pos += h.nrEvents * sizeof(CacheEvent);
+
+	h.stringsOffset = pos;
+	cs.reserved = 0;
+	for (i = 0; i < strs.size(); i++) {
+		cs.offset = h.charsSize;
+		cs.len = strs[i]->len;
+		ts_errno = writeData(fp, &cs, sizeof(cs));
+		if (ts_errno != 0)
+			goto error;
+		h.charsSize += cs.len + 1;
+	}
+	h.nrStrings = strs.size();
+	pos += h.nrStrings * sizeof(CacheString);
+
+	h.typesOffset = pos;
+	nrTypes = eventTree->getMaxEvent() + 1;
+	for (t = 0; t < nrTypes; t++) {
+		name = eventTree->stringLookup((event_t) t);
+		cs.offset = h.charsSize;
+		cs.len = name == nullptr ? 0 : name->len;
+		ts_errno = writeData(fp, &cs, sizeof(cs));
+		if (ts_errno != 0)
+			goto error;
+		h.charsSize += cs.len + 1;
+	}
+	h.nrTypes = nrTypes;
+	pos += h.nrTypes * sizeof(CacheString);
+
+	h.charsOffset = pos;
+	for (i = 0; i < strs.size(); i++) {
+		ts_errno = writeData(fp, strs[i]->ptr, strs[i]->len);
+		if (ts_errno == 0)
+			ts_errno = writeData(fp, "", 1);
+		if (ts_errno != 0)
+			goto error;
+	}
+	for (t = 0; t < nrTypes; t++) {
+		name = eventTree->stringLookup((event_t) t);
+		if (name != nullptr)
+			ts_errno = writeData(fp, name->ptr, name->len);
+		if (ts_errno == 0)
+			ts_errno = writeData(fp, "", 1);
+		if (ts_errno != 0)
+			goto error;
+	}
+	pos += h.charsSize;
+	h.indexSize = pos;
+
+	if (fseek(fp, 0, SEEK_SET) != 0) {
+		ts_errno = errno;
+		goto error;
+	}
+	ts_errno = writeData(fp, &h, sizeof(h));
+	if (ts_errno != 0)
+		goto error;
+	if (fclose(fp) != 0) {
+		fp = nullptr;
+		ts_errno = errno;
+		goto error;
+	}
+	fp = nullptr;
+	if (rename(tmpPath.constData(), path.constData()) != 0) {
+		ts_errno = errno;
+		goto error;
+	}
+	return 0;
+error:
+	if (fp != nullptr)
+		fclose(fp);
+	unlink(tmpPath.constData());
+	return ts_errno != 0 ? ts_errno : -TS_ERROR_ERROR;
+}
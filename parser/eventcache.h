@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTCACHE_H
+#define EVENTCACHE_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "mm/stringtree.h"
+#include "misc/chunk.h"
+#include "misc/traceshark.h"
+#include "misc/tstring.h"
+
+class EventStrings;
+class TraceEvent;
+class TraceFile;
+namespace vtl {
+	template<class T> class TList;
+}
+
+/*
+ * The EventCache stores the parsed events of a text trace in a binary index
+ * file, so that the trace can be opened again without tokenizing and parsing
+ * it. The index files are kept in $XDG_CACHE_HOME/traceshark, or in
+ * ~/.cache/traceshark, and they are named after the device and inode of the
+ * trace. An index is only used if the size, mtime and ctime of the trace are
+ * the same as when the index was written, and if the index was written by the
+ * same version of the format with the same byte order.
+ *
+ * An index is read with mmap(), the strings are used directly from the mapping
+ * and they are appended to the EventStrings of the trace, so only the string
+ * ids and the argument offsets of the events need to be translated. Every index
+ * and offset in the file is checked before it is used, so that a damaged index
+ * is ignored instead of crashing us, then the trace is parsed as usual.
+ */
+class EventCache
+{
+public:
+	EventCache();
+	~EventCache();
+	bool open(TraceFile *file, bool lazyArgs);
+	tracetype_t getTraceType() const;
+	int getNrTypes() const;
+	bool getTypeName(int type, TString *name) const;
+	bool readEvents(const QVector<event_t> &typeMap,
+			vtl::TList<TraceEvent> *events,
+			EventStrings *eventStrings);
+	void clear();
+	static int write(TraceFile *file, bool lazyArgs, tracetype_t ttype,
+			 const vtl::TList<TraceEvent> *events,
+			 const EventStrings *eventStrings,
+			 const StringTree<> *eventTree);
+private:
+	class Header;
+	static QByteArray cachePath(TraceFile *file, bool create,
+				    int *ts_errno);
+	static void fillHeader(Header *header, TraceFile *file,
+			       bool lazyArgs, tracetype_t ttype);
+	static int writeData(FILE *fp, const void *data, size_t size);
+	static int writeAlign(FILE *fp, uint64_t *pos);
+	bool checkSection(uint64_t offset, uint64_t nr, uint64_t size) const;
+	const Header *header;
+	char *mapping;
+	uint64_t mappingSize;
+	Chunk *chunks;
+};
+
+#endif /* EVENTCACHE_H */
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parser/eventstrings.h"
+
+EventStrings::EventStrings()
+	: usedArgs(0), committedArgs(0)
+{}
+
+EventStrings::~EventStrings()
+{
+	clear();
+}
+
+void EventStrings::addBlock()
+{
+	blocks.append(new uint32_t[EVENTSTRINGS_BLOCK_SIZE]);
+}
+
+/*
+ * Appends the strings and the committed arguments of other. A string id of
+ * other becomes the id plus stringBase here, and an argument offset becomes the
+ * offset plus argBase. The characters are not copied, so the strings of other
+ * must stay valid for as long as these are used. Returns false, without
+ * appending anything, if the strings of other do not fit in the table.
+ */
+bool EventStrings::append(const EventStrings *other, uint32_t *stringBase,
+			  uint64_t *argBase)
+{
+	uint64_t i;
+	uint64_t s;
+
+	if (!table.hasRoom(other->table.size()))
+		return false;
+	*argBase = beginArgs();
+	*stringBase = table.size();
+
+	s = other->table.size();
+	for (i = 0; i < s; i++)
+		table.add(*other->table.get(i));
+	s = other->nrArgs();
+	for (i = 0; i < s; i++)
+		addArg(other->getArgId(i) + *stringBase);
+	commitArgs();
+	return true;
+}
+
+void EventStrings::clear()
+{
+	int i;
+
+	table.clear();
+	for (i = 0; i < blocks.size(); i++)
+		delete[] blocks.at(i);
+	blocks.clear();
+	usedArgs = 0;
+	committedArgs = 0;
+}
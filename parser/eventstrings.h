@@ -0,0 +1,150 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTSTRINGS_H
+#define EVENTSTRINGS_H
+
+#include <cstdint>
+#include "misc/tstring.h"
+#include "mm/stringtable.h"
+#include "vtl/compiler.h"
+#include "vtl/tlist.h"
+
+/*
+ * This class holds the strings that the events of a trace refer to. The task
+ * names and the arguments are stored in the events as 32-bit ids in table. The
+ * arguments of all events are kept in one array of string ids, where each
+ * event has a range that is given by an offset and its argc, so the events
+ * themselves do not contain any pointers to strings.
+ *
+ * The arguments of an event are added between beginArgs() and commitArgs(),
+ * if the event is not committed, then the next call to beginArgs() drops them.
+ * Like with TList, one thread may add strings and arguments while other
+ * threads read those of the events that have been committed.
+ *
+ * A TList has int indices, which would limit the arguments of a trace to about
+ * 2^31. Instead, the arguments are stored in blocks of EVENTSTRINGS_BLOCK_SIZE
+ * ids, and the offsets are 64-bit.
+ */
+
+#define EVENTSTRINGS_BLOCK_SHIFT (20)
+#define EVENTSTRINGS_BLOCK_SIZE (UINT64_C(1) << EVENTSTRINGS_BLOCK_SHIFT)
+#define EVENTSTRINGS_BLOCK_MASK (EVENTSTRINGS_BLOCK_SIZE - 1)
+
+class EventStrings
+{
+public:
+	EventStrings();
+	~EventStrings();
+	vtl_always_inline const TString *getString(uint32_t id) const;
+	vtl_always_inline const TString *getArg(uint64_t index) const;
+	vtl_always_inline uint32_t getArgId(uint64_t index) const;
+	vtl_always_inline uint64_t nrArgs() const;
+	vtl_always_inline uint64_t beginArgs();
+	vtl_always_inline void addArg(uint32_t id);
+	vtl_always_inline void commitArgs();
+	bool append(const EventStrings *other, uint32_t *stringBase,
+		    uint64_t *argBase);
+	void clear();
+	StringTable table;
+private:
+	void addBlock();
+	vtl::TList<uint32_t*> blocks;
+	uint64_t usedArgs;
+	uint64_t committedArgs;
+};
+
+vtl_always_inline const TString *EventStrings::getString(uint32_t id) const
+{
+	return table.get(id);
+}
+
+vtl_always_inline const TString *EventStrings::getArg(uint64_t index) const
+{
+	return table.get(getArgId(index));
+}
+
+vtl_always_inline uint32_t EventStrings::getArgId(uint64_t index) const
+{
+	return blocks.at(index >> EVENTSTRINGS_BLOCK_SHIFT)
+		[index & EVENTSTRINGS_BLOCK_MASK];
+}
+
+/* Returns the number of arguments that have been committed */
+vtl_always_inline uint64_t EventStrings::nrArgs() const
+{
+	return committedArgs;
+}
+
+/* Returns the offset of the arguments of the next event */
+vtl_always_inline uint64_t EventStrings::beginArgs()
+{
+	usedArgs = committedArgs;
+	return committedArgs;
+}
+
+vtl_always_inline void EventStrings::addArg(uint32_t id)
+{
+	uint64_t block = usedArgs >> EVENTSTRINGS_BLOCK_SHIFT;
+
+	if (block == (uint64_t) blocks.size())
+		addBlock();
+	blocks.at(block)[usedArgs & EVENTSTRINGS_BLOCK_MASK] = id;
+	usedArgs++;
+}
+
+vtl_always_inline void EventStrings::commitArgs()
+{
+	committedArgs = usedArgs;
+}
+
+#endif /* EVENTSTRINGS_H */
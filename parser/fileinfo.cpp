@@ -98,3 +98,8 @@ int64_t FileInfo::getFileSize()
 {
 	return st.st_size;
 }
+
+const struct stat &FileInfo::getStat() const
+{
+	return st;
+}
@@ -66,6 +66,7 @@ public:
 	void saveStat(int fd, int *ts_errno);
 	bool cmpStat(int fd, int *ts_errno);
 	int64_t getFileSize();
+	const struct stat &getStat() const;
 private:
 	struct stat st;
 };
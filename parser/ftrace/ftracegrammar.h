@@ -54,9 +54,11 @@
 #define FTRACEGRAMMAR_H
 
 #include "misc/traceshark.h"
-#include "mm/stringpool.h"
+#include "mm/internpool.h"
 #include "mm/stringtree.h"
+#include "parser/eventstrings.h"
 #include "parser/paramhelpers.h"
+#include "parser/retentionpolicy.h"
 #include "parser/traceevent.h"
 #include "vtl/compiler.h"
 #include "vtl/time.h"
@@ -77,9 +79,14 @@ public:
 	void clear();
 	vtl_always_inline bool parseLine(const TraceLine &line,
 				       TraceEvent &event);
+	vtl_always_inline event_t addEventType(const TString *str);
+	void setEventStrings(EventStrings *eventStrings);
+	void setLazyArgs(bool enable);
+	void setRetentionPolicy(const RetentionPolicy *policy);
 	StringTree<> *eventTree;
+	/* The events that are dropped because of the retention policy */
+	RetentionTable retention;
 private:
-	void setupEventTree();
 	vtl_always_inline bool NamePidMatch(const TString *str,
 					  TraceEvent &event);
 	vtl_always_inline bool CPUMatch(const TString *str,
@@ -89,8 +96,15 @@ private:
 	vtl_always_inline
 	bool EventMatch(const TString *str, TraceEvent &event);
 	vtl_always_inline bool ArgMatch(const TString *str, TraceEvent &event);
-	StringPool<> *argPool;
-	StringPool<> *namePool;
+	vtl_always_inline bool LazyArgMatch(const TraceLine &line,
+					    const TString *str,
+					    unsigned int n,
+					    TraceEvent &event);
+	InternPool<> *argPool;
+	InternPool<> *namePool;
+	EventStrings *strings;
+	/* Store only the location of the arguments of unknown events */
+	bool lazyArgs;
 	int unknownTypeCounter;
 	typedef enum : int {
 		STATE_NAMEPID = 0,
@@ -125,6 +139,7 @@ vtl_always_inline bool FtraceGrammar::CPUMatch(const TString *str,
 					       TraceEvent &event)
 {
 	char *c;
+	char *end = str->ptr + str->len;
 	unsigned int cpu = 0;
 	int digit;
 
@@ -132,7 +147,7 @@ vtl_always_inline bool FtraceGrammar::CPUMatch(const TString *str,
 		return false;
 
 	cpu = 0;
-	for (c = str->ptr + 1; *c != '\0' && *c != ']'; c++) {
+	for (c = str->ptr + 1; c < end && *c != ']'; c++) {
 		digit = *c - '0';
 		if (digit > 9 || digit < 0)
 			goto error;
@@ -194,7 +209,7 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 	bool rval;
 	TString namestr;
 	TString finistr;
-	const TString *newname;
+	uint32_t newname;
 	char nbuf[256];
 	char fbuf[256];
 	const int maxlen = arraylen(nbuf) - 1;
@@ -243,45 +258,29 @@ vtl_always_inline bool FtraceGrammar::TimeMatch(const TString *str,
 			}
 			if (!namestr.merge(&finistr, maxlen))
 				return false;
-			newname = namePool->allocString(&namestr, 0);
+			newname = namePool->allocId(&namestr, 0);
 		} else {
 			/* This is the common case, no spaces in the name. */
-			newname = namePool->allocString(&finistr, 0);
+			newname = namePool->allocId(&finistr, 0);
 		}
 
-		if (newname == nullptr)
+		if (newname == STRINGTABLE_NO_ID)
 			return false;
-		event.taskName = newname;
+		event.taskNameId = newname;
 	}
 	return rval;
 }
 
-vtl_always_inline bool FtraceGrammar::EventMatch(const TString *str,
-						 TraceEvent &event)
+/*
+ * Returns the event type of the event name str, a new event type is allocated
+ * if the name has not been seen before.
+ */
+vtl_always_inline event_t FtraceGrammar::addEventType(const TString *str)
 {
-	char buf[512];
-	TString estr;
-	estr.len = 0;
-	estr.ptr = buf;
-	const int maxlen = arraylen(buf) - 1;
-	estr.set(str, maxlen);
-	char *lastChr = estr.ptr + estr.len - 1;
 	event_t type;
 
-	if (estr.len < 1)
-		return false;
-
-	if (*lastChr == ':') {
-		*lastChr = '\0';
-		estr.len--;
-	} else
-		return false;
-
-	type = eventTree->searchAllocString(&estr,
-					    (event_t) unknownTypeCounter);
-	if (type == EVENT_ERROR)
-		return false;
-	else if (type == unknownTypeCounter) {
+	type = eventTree->searchAllocString(str, (event_t) unknownTypeCounter);
+	if (type == unknownTypeCounter) {
 		/*
 		 * This event is a new event, so for the next one we need to
 		 * bump the counter in order to use a unique eventType value 
@@ -289,6 +288,27 @@ vtl_always_inline bool FtraceGrammar::EventMatch(const TString *str,
 		 */
 		unknownTypeCounter++;
 	}
+	return type;
+}
+
+vtl_always_inline bool FtraceGrammar::EventMatch(const TString *str,
+						 TraceEvent &event)
+{
+	TString estr;
+	event_t type;
+
+	/*
+	 * The string may point directly into a read-only mapping of the trace
+	 * file, so the trailing colon is excluded by means of the length only.
+	 */
+	if (str->len < 1 || str->ptr[str->len - 1] != ':')
+		return false;
+
+	estr.ptr = str->ptr;
+	estr.len = str->len - 1;
+	type = addEventType(&estr);
+	if (type == EVENT_ERROR)
+		return false;
 	event.type = type;
 	return true;
 }
@@ -296,18 +316,29 @@ vtl_always_inline bool FtraceGrammar::EventMatch(const TString *str,
 vtl_always_inline bool FtraceGrammar::ArgMatch(const TString *str,
 					       TraceEvent &event)
 {
-	const TString *newstr;
+	uint32_t newstr;
 	if (event.argc < EVENT_MAX_NR_ARGS) {
-		newstr = argPool->allocString(str, 16);
-		if (newstr == nullptr)
+		newstr = argPool->allocId(str, 16);
+		if (newstr == STRINGTABLE_NO_ID)
 			return false;
-		event.argv[event.argc] = newstr;
+		strings->addArg(newstr);
 		event.argc++;
 		return true;
 	}
 	return false;
 }
 
+vtl_always_inline bool FtraceGrammar::LazyArgMatch(const TraceLine &line,
+						   const TString *str,
+						   unsigned int n,
+						   TraceEvent &event)
+{
+	const TString *last = str + TSMIN(n, (unsigned int) EVENT_MAX_NR_ARGS) - 1;
+	int64_t offset = line.begin + (str->ptr - line.ptr);
+	int64_t len = last->ptr + last->len - str->ptr;
+
+	return event.setLazyArgs(offset, len);
+}
 
 vtl_always_inline bool FtraceGrammar::parseLine(const TraceLine &line,
 						TraceEvent &event)
@@ -344,9 +375,18 @@ vtl_always_inline bool FtraceGrammar::parseLine(const TraceLine &line,
 		case STATE_EVENT:
 			if (!EventMatch(str, event))
 				return false;
+			if (!retention.retain(event.type, eventTree))
+				return false;
 			NEXTTOKEN(true);
 			ts_fallthrough;
 		case STATE_ARG:
+			/*
+			 * The arguments of the event types that we know about
+			 * are always stored because the analyzer needs them.
+			 */
+			if (lazyArgs && event.type >= NR_EVENTS &&
+			    LazyArgMatch(line, str, n, event))
+				return true;
 			while (ArgMatch(str, event))
 				NEXTTOKEN(true);
 			return false;
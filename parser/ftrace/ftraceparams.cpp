@@ -53,18 +53,18 @@
 #include "parser/ftrace/ftraceparams.h"
 
 const char *ftrace_sched_wakeup_name_strdup(const TraceEvent &event,
-					    StringPool<> *pool) {
+					    InternPool<> *pool) {
 	return ftrace_sched_wakeup_name_strdup_(event, pool);
 }
 
 const char *ftrace_sched_process_fork_childname_strdup(const TraceEvent &event,
-						       StringPool<> *pool) {
+						       InternPool<> *pool) {
 	return ftrace_sched_process_fork_childname_strdup_(event, pool);
 }
 
 const char *
 ftrace_sched_switch_handle_newname_strdup(const TraceEvent &event,
-					  StringPool<> *pool,
+					  InternPool<> *pool,
 					  const sched_switch_handle &handle)
 {
 	return ftrace_sched_switch_handle_newname_strdup_(event, pool, handle);
@@ -72,7 +72,7 @@ ftrace_sched_switch_handle_newname_strdup(const TraceEvent &event,
 
 const char *
 ftrace_sched_switch_handle_oldname_strdup(const TraceEvent &event,
-					  StringPool<> *pool,
+					  InternPool<> *pool,
 					  const sched_switch_handle &handle)
 {
 	return ftrace_sched_switch_handle_oldname_strdup_(event, pool, handle);
@@ -80,7 +80,7 @@ ftrace_sched_switch_handle_oldname_strdup(const TraceEvent &event,
 
 
 const char *
-ftrace_sched_waking_name_strdup(const TraceEvent &event, StringPool<> *pool)
+ftrace_sched_waking_name_strdup(const TraceEvent &event, InternPool<> *pool)
 {
 	return ftrace_sched_waking_name_strdup_(event, pool);
 }
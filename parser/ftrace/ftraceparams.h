@@ -57,7 +57,7 @@
 #include <cstdint>
 
 #include "vtl/compiler.h"
-#include "mm/stringpool.h"
+#include "mm/internpool.h"
 #include "parser/traceevent.h"
 #include "parser/paramhelpers.h"
 #include "misc/errors.h"
@@ -141,7 +141,7 @@ ftrace_sched_switch_parse(const TraceEvent &event, sched_switch_handle& handle)
 
 static vtl_always_inline const char *
 ftrace_sched_switch_handle_newname_strdup_(const TraceEvent &event,
-					   StringPool<> *pool,
+					   InternPool<> *pool,
 					   const sched_switch_handle &handle)
 {
 	int i;
@@ -205,13 +205,13 @@ ftrace_sched_switch_handle_newname_strdup_(const TraceEvent &event,
 
 const char *
 ftrace_sched_switch_handle_newname_strdup(const TraceEvent &event,
-					  StringPool<> *pool,
+					  InternPool<> *pool,
 					  const sched_switch_handle &handle);
 
 
 static vtl_always_inline const char *
 ftrace_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
-					   StringPool<> *pool,
+					   InternPool<> *pool,
 					   const sched_switch_handle &handle)
 {
 	int i;
@@ -280,7 +280,7 @@ ftrace_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
 
 const char *
 ftrace_sched_switch_handle_oldname_strdup(const TraceEvent &event,
-					  StringPool<> *pool,
+					  InternPool<> *pool,
 					  const sched_switch_handle &handle);
 
 static vtl_always_inline int
@@ -445,7 +445,7 @@ out:
 }
 
 static vtl_always_inline const char
-*ftrace_sched_wakeup_name_strdup_(const TraceEvent &event, StringPool<> *pool)
+*ftrace_sched_wakeup_name_strdup_(const TraceEvent &event, InternPool<> *pool)
 {
 	int beginidx;
 	int endidx;
@@ -527,7 +527,7 @@ static vtl_always_inline const char
 }
 
 const char *ftrace_sched_wakeup_name_strdup(const TraceEvent &event,
-					    StringPool<> *pool);
+					    InternPool<> *pool);
 
 #define ftrace_sched_process_fork_args_ok(EVENT) (EVENT.argc >= 4)
 #define ftrace_sched_process_fork_childpid(EVENT) \
@@ -556,7 +556,7 @@ ftrace_sched_process_fork_parent_pid(const TraceEvent &event) {
 
 static vtl_always_inline const char *
 ftrace_sched_process_fork_childname_strdup_(const TraceEvent &event,
-					    StringPool<> *pool)
+					    InternPool<> *pool)
 {
 	int i;
 	const int endidx = event.argc - 2;
@@ -619,7 +619,7 @@ found:
 }
 
 const char *ftrace_sched_process_fork_childname_strdup(const TraceEvent &event,
-						       StringPool<> *pool);
+						       InternPool<> *pool);
 
 #define ftrace_sched_process_exit_args_ok(EVENT) (EVENT.argc >= 3)
 #define ftrace_sched_process_exit_pid(EVENT) \
@@ -640,7 +640,7 @@ const char *ftrace_sched_process_fork_childname_strdup(const TraceEvent &event,
 	 !prefixcmp(EVENT.argv[EVENT.argc - 1]->ptr, FTRACE_WAKING_CPU_PFIX))
 
 static vtl_always_inline const char *
-ftrace_sched_waking_name_strdup_(const TraceEvent &event, StringPool<> *pool)
+ftrace_sched_waking_name_strdup_(const TraceEvent &event, InternPool<> *pool)
 {
 	int beginidx;
 	int endidx;
@@ -682,7 +682,7 @@ ftrace_sched_waking_name_strdup_(const TraceEvent &event, StringPool<> *pool)
 }
 
 const char *
-ftrace_sched_waking_name_strdup(const TraceEvent &event, StringPool<> *pool);
+ftrace_sched_waking_name_strdup(const TraceEvent &event, InternPool<> *pool);
 
 #define ftrace_sched_waking_pid(EVENT) \
 	(int_after_char(EVENT, EVENT.argc - 3, '='))
@@ -76,7 +76,7 @@ static vtl_always_inline RETTYPE FNAME(tracetype_t tt,	  	   \
 #define DECLARE_GENERIC_TRACEFN_POOL(FNAME, RETTYPE)		   \
 static vtl_always_inline RETTYPE FNAME(tracetype_t tt,	  	   \
 				       const TraceEvent &event,	   \
-				       StringPool<> *pool)	   \
+				       InternPool<> *pool)	   \
 {							           \
 	if (tt == TRACE_TYPE_FTRACE)				   \
 		return ftrace_##FNAME(event, pool);		   \
@@ -100,7 +100,7 @@ static vtl_always_inline RETTYPE FNAME(tracetype_t tt,	  	   \
 #define DECLARE_GENERIC_TRACEFN_POOL_HANDLE(FNAME, RETTYPE, HANDLETYPE)	\
 	static vtl_always_inline RETTYPE FNAME(tracetype_t tt,		\
 					       const TraceEvent &event,	\
-					       StringPool<> *pool,	\
+					       InternPool<> *pool,	\
 					       HANDLETYPE handle)	\
 	{								\
 		if (tt == TRACE_TYPE_FTRACE)				\
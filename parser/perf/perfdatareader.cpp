@@ -0,0 +1,847 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "parser/perf/perfdatareader.h"
+#include "parser/perf/perfgrammar.h"
+#include "parser/tracecmd/eventformat.h"
+#include "parser/tracefile.h"
+#include "misc/chunk.h"
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "threads/indexwatcher.h"
+
+/*
+ * The magic is a 64-bit number, so it will appear reversed if the file was
+ * written by a host with the opposite byte order.
+ */
+#define PERF_MAGIC "PERFILE2"
+#define PERF_MAGIC_SWAPPED "2ELIFREP"
+#define PERF_MAGIC_LEN (8)
+
+/*
+ * The layout of struct perf_file_header, see tools/perf/util/header.h in the
+ * Linux kernel sources. A perf.data file that was written to a pipe has a
+ * shorter header, such files are not supported.
+ */
+#define FILE_HEADER_SIZE (104)
+#define HEADER_ATTR_SIZE_OFFSET (16)
+#define HEADER_ATTRS_OFFSET (24)
+#define HEADER_DATA_OFFSET (40)
+#define HEADER_FEATURES_OFFSET (72)
+#define NR_FEATURES (256)
+
+#define HEADER_TRACING_DATA (1)
+#define HEADER_EVENT_DESC (12)
+
+/* The layout of struct perf_event_attr, see include/uapi/linux/perf_event.h */
+#define ATTR_TYPE_OFFSET (0)
+#define ATTR_CONFIG_OFFSET (8)
+#define ATTR_SAMPLE_TYPE_OFFSET (24)
+#define ATTR_READ_FORMAT_OFFSET (32)
+#define ATTR_MIN_SIZE (64)
+#define FILE_SECTION_SIZE (16)
+
+#define PERF_TYPE_HARDWARE (0)
+#define PERF_TYPE_SOFTWARE (1)
+#define PERF_TYPE_TRACEPOINT (2)
+
+#define SAMPLE_IP         (1ULL << 0)
+#define SAMPLE_TID        (1ULL << 1)
+#define SAMPLE_TIME       (1ULL << 2)
+#define SAMPLE_ADDR       (1ULL << 3)
+#define SAMPLE_READ       (1ULL << 4)
+#define SAMPLE_CALLCHAIN  (1ULL << 5)
+#define SAMPLE_ID         (1ULL << 6)
+#define SAMPLE_CPU        (1ULL << 7)
+#define SAMPLE_PERIOD     (1ULL << 8)
+#define SAMPLE_STREAM_ID  (1ULL << 9)
+#define SAMPLE_RAW        (1ULL << 10)
+#define SAMPLE_IDENTIFIER (1ULL << 16)
+
+#define FORMAT_TOTAL_TIME_ENABLED (1ULL << 0)
+#define FORMAT_TOTAL_TIME_RUNNING (1ULL << 1)
+#define FORMAT_ID                 (1ULL << 2)
+#define FORMAT_GROUP              (1ULL << 3)
+#define FORMAT_LOST               (1ULL << 4)
+
+#define RECORD_HEADER_SIZE (8)
+#define RECORD_COMM (3)
+#define RECORD_FORK (7)
+#define RECORD_SAMPLE (9)
+#define RECORD_FINISHED_ROUND (68)
+#define RECORD_COMPRESSED (81)
+
+/* The markers that separate the kernel and user parts of a callchain */
+#define CONTEXT_KERNEL ((uint64_t) -128)
+#define CONTEXT_GUEST_KERNEL ((uint64_t) -2176)
+#define CONTEXT_MAX ((uint64_t) -4095)
+
+/* The size of the buffer where the data section is read */
+#define DATA_BUFSIZE (1024 * 1024)
+
+/* The size of the buffer where the arguments of an event are printed */
+#define ARGBUF_SIZE (16384)
+
+/* Sections larger than this are considered to be corrupt */
+#define MAX_SECTION_SIZE (64 * 1024 * 1024)
+
+/* This is what perf script shows for the idle task and for unknown tasks */
+#define IDLE_TASK "swapper"
+#define UNKNOWN_TASK_FMT ":%d"
+
+#define KERNEL_DSO "[kernel.kallsyms]"
+#define UNKNOWN_DSO "[unknown]"
+#define UNKNOWN_SYMBOL "[unknown]"
+
+static const char * const hardwareEvents[] = {
+	"cycles", "instructions", "cache-references", "cache-misses",
+	"branches", "branch-misses", "bus-cycles", "stalled-cycles-frontend",
+	"stalled-cycles-backend", "ref-cycles"
+};
+
+static const char * const softwareEvents[] = {
+	"cpu-clock", "task-clock", "page-faults", "context-switches",
+	"cpu-migrations", "minor-faults", "major-faults", "alignment-faults",
+	"emulation-faults", "dummy", "bpf-output", "cgroup-switches"
+};
+
+PerfDataReader::PerfDataReader(TraceFile *file):
+	traceFile(file), swap(false), hasTracingData(false), idPos(-1),
+	ts_errno(0)
+{
+	argPool = new InternPool<>(2048, 1024 * 1024);
+	namePool = new InternPool<>(1024, 65536);
+	argBuf = new char[ARGBUF_SIZE];
+	argStrings = new TString[EVENT_MAX_NR_ARGS];
+	dataBuf = new char[DATA_BUFSIZE];
+	data.offset = 0;
+	data.size = 0;
+}
+
+PerfDataReader::~PerfDataReader()
+{
+	delete argPool;
+	delete namePool;
+	delete[] argBuf;
+	delete[] argStrings;
+	delete[] dataBuf;
+}
+
+bool PerfDataReader::isPerfData(TraceFile *file)
+{
+	char magic[PERF_MAGIC_LEN];
+	int ts_errno;
+
+	if (file->readAt(0, magic, PERF_MAGIC_LEN, &ts_errno) !=
+	    PERF_MAGIC_LEN)
+		return false;
+	return memcmp(magic, PERF_MAGIC, PERF_MAGIC_LEN) == 0 ||
+		memcmp(magic, PERF_MAGIC_SWAPPED, PERF_MAGIC_LEN) == 0;
+}
+
+/*
+ * Formats a callchain in the same way as perf script does it when it cannot
+ * resolve the symbols.
+ */
+QByteArray PerfDataReader::formatCallchain(const char *data, int len,
+					   bool swap)
+{
+	QByteArray rval;
+	char line[128];
+	const char *dso = UNKNOWN_DSO;
+	const char *p;
+	uint64_t ip;
+	int w;
+
+	for (p = data; p + sizeof(uint64_t) <= data + len;
+	     p += sizeof(uint64_t)) {
+		ip = tracecmd_read64(p, swap);
+		if (ip >= CONTEXT_MAX) {
+			if (ip == CONTEXT_KERNEL || ip == CONTEXT_GUEST_KERNEL)
+				dso = KERNEL_DSO;
+			else
+				dso = UNKNOWN_DSO;
+			continue;
+		}
+		w = snprintf(line, sizeof(line), "\t    %16" PRIx64 " %s (%s)\n",
+			     ip, UNKNOWN_SYMBOL, dso);
+		if (w > 0)
+			rval.append(line, TSMIN(w, (int) sizeof(line) - 1));
+	}
+	rval.append('\n');
+	return rval;
+}
+
+int PerfDataReader::readAt(int64_t offset, void *buf, int64_t len)
+{
+	ssize_t r;
+	int err;
+
+	r = traceFile->readAt(offset, (char*) buf, (size_t) len, &err);
+	if (err != 0)
+		return err;
+	if (r != len)
+		return -TS_ERROR_EOF;
+	return 0;
+}
+
+int PerfDataReader::open()
+{
+	char header[FILE_HEADER_SIZE];
+	const char *h;
+	int64_t fileSize = traceFile->getFileSize();
+	Section attrSection;
+	uint64_t attrSize;
+	uint64_t sampleType;
+	int r;
+
+	r = readAt(0, header, FILE_HEADER_SIZE);
+	if (r != 0)
+		return r;
+	if (memcmp(header, PERF_MAGIC, PERF_MAGIC_LEN) == 0)
+		swap = tracecmd_host_is_bigendian();
+	else if (memcmp(header, PERF_MAGIC_SWAPPED, PERF_MAGIC_LEN) == 0)
+		swap = !tracecmd_host_is_bigendian();
+	else
+		return -TS_ERROR_FILEFORMAT;
+
+	if (read64(header + PERF_MAGIC_LEN) < FILE_HEADER_SIZE)
+		return -TS_ERROR_FILEFORMAT;
+	attrSize = read64(header + HEADER_ATTR_SIZE_OFFSET);
+	h = header + HEADER_ATTRS_OFFSET;
+	attrSection.offset = read64(h);
+	attrSection.size = read64(h + sizeof(uint64_t));
+	h = header + HEADER_DATA_OFFSET;
+	data.offset = read64(h);
+	data.size = read64(h + sizeof(uint64_t));
+	if (data.offset > (uint64_t) fileSize)
+		return -TS_ERROR_FILEFORMAT;
+
+	r = parseAttrs(attrSection, attrSize);
+	if (r != 0)
+		return r;
+	r = parseFeatures(header + HEADER_FEATURES_OFFSET);
+	if (r != 0)
+		return r;
+	/* Read what there is, if the recording was interrupted */
+	data.size = TSMIN(data.size, (uint64_t) fileSize - data.offset);
+
+	if (features[HEADER_TRACING_DATA].size > 0) {
+		r = tracingData.parse(traceFile,
+				      features[HEADER_TRACING_DATA].offset,
+				      features[HEADER_TRACING_DATA].offset +
+				      features[HEADER_TRACING_DATA].size);
+		if (r != 0)
+			return r;
+		hasTracingData = true;
+	}
+	if (features[HEADER_EVENT_DESC].size > 0) {
+		r = parseEventDesc(features[HEADER_EVENT_DESC]);
+		if (r != 0)
+			return r;
+	}
+	setupAttrs();
+
+	/*
+	 * perf record makes sure that the sample id is at the same position
+	 * for all events, so that the event of a sample can be identified.
+	 */
+	sampleType = attrs[0].sampleType;
+	if (sampleType & SAMPLE_IDENTIFIER) {
+		idPos = 0;
+	} else if (sampleType & SAMPLE_ID) {
+		idPos = 0;
+		if (sampleType & SAMPLE_IP)
+			idPos++;
+		if (sampleType & SAMPLE_TID)
+			idPos++;
+		if (sampleType & SAMPLE_TIME)
+			idPos++;
+		if (sampleType & SAMPLE_ADDR)
+			idPos++;
+	} else {
+		idPos = -1;
+	}
+	return 0;
+}
+
+int PerfDataReader::parseAttrs(const Section &attrSection, uint64_t attrSize)
+{
+	QByteArray buf;
+	QVector<uint64_t> ids;
+	const char *a;
+	uint64_t nrAttrs;
+	uint64_t i;
+	uint64_t nrIds;
+	uint64_t j;
+	Section idSection;
+	Attr attr;
+	int r;
+
+	if (attrSize < ATTR_MIN_SIZE + FILE_SECTION_SIZE ||
+	    attrSize > MAX_SECTION_SIZE || attrSection.size > MAX_SECTION_SIZE)
+		return -TS_ERROR_FILEFORMAT;
+	nrAttrs = attrSection.size / attrSize;
+	if (nrAttrs == 0)
+		return -TS_ERROR_FILEFORMAT;
+
+	buf.resize((int) attrSize);
+	for (i = 0; i < nrAttrs; i++) {
+		r = readAt(attrSection.offset + i * attrSize, buf.data(),
+			   attrSize);
+		if (r != 0)
+			return r;
+		a = buf.constData();
+		attr.type = read32(a + ATTR_TYPE_OFFSET);
+		attr.config = read64(a + ATTR_CONFIG_OFFSET);
+		attr.sampleType = read64(a + ATTR_SAMPLE_TYPE_OFFSET);
+		attr.readFormat = read64(a + ATTR_READ_FORMAT_OFFSET);
+		attr.format = nullptr;
+		attr.eventType = EVENT_ERROR;
+		attrs.append(attr);
+
+		/* The ids of the attr are in a section after the attr */
+		a += attrSize - FILE_SECTION_SIZE;
+		idSection.offset = read64(a);
+		idSection.size = read64(a + sizeof(uint64_t));
+		if (idSection.size > MAX_SECTION_SIZE)
+			return -TS_ERROR_FILEFORMAT;
+		nrIds = idSection.size / sizeof(uint64_t);
+		ids.resize((int) nrIds);
+		r = readAt(idSection.offset, ids.data(),
+			   nrIds * sizeof(uint64_t));
+		if (r != 0)
+			return r;
+		for (j = 0; j < nrIds; j++)
+			attrById.insert(read64((const char*) &ids.data()[j]),
+					(int) i);
+	}
+	return 0;
+}
+
+/*
+ * The feature sections are located after the data section. There is a
+ * section descriptor for every feature bit that is set in the header.
+ */
+int PerfDataReader::parseFeatures(const char *bitmap)
+{
+	char desc[FILE_SECTION_SIZE];
+	uint64_t word;
+	int64_t pos;
+	int feat;
+	int r;
+
+	features.resize(NR_FEATURES);
+	for (feat = 0; feat < NR_FEATURES; feat++) {
+		features[feat].offset = 0;
+		features[feat].size = 0;
+	}
+
+	pos = (int64_t) (data.offset + data.size);
+	/* The first bit is reserved */
+	for (feat = 1; feat < NR_FEATURES; feat++) {
+		word = read64(bitmap + feat / 64 * sizeof(uint64_t));
+		if ((word & (1ULL << (feat % 64))) == 0)
+			continue;
+		r = readAt(pos, desc, FILE_SECTION_SIZE);
+		/* A missing section is not fatal, the file may be truncated */
+		if (r != 0)
+			break;
+		features[feat].offset = read64(desc);
+		features[feat].size = read64(desc + sizeof(uint64_t));
+		pos += FILE_SECTION_SIZE;
+	}
+	return 0;
+}
+
+/*
+ * The event descriptions contain the names of the events, in the same order as
+ * the attrs.
+ */
+int PerfDataReader::parseEventDesc(const Section &section)
+{
+	QByteArray buf;
+	const char *p;
+	const char *end;
+	uint32_t nrEvents;
+	uint32_t attrSize;
+	uint32_t nrIds;
+	uint32_t len;
+	uint32_t i;
+	int r;
+
+	if (section.size > MAX_SECTION_SIZE)
+		return -TS_ERROR_FILEFORMAT;
+	buf.resize((int) section.size);
+	r = readAt(section.offset, buf.data(), section.size);
+	if (r != 0)
+		return r;
+	p = buf.constData();
+	end = p + buf.size();
+
+	if (end - p < 2 * (int) sizeof(uint32_t))
+		return -TS_ERROR_FILEFORMAT;
+	nrEvents = read32(p);
+	attrSize = read32(p + sizeof(uint32_t));
+	p += 2 * sizeof(uint32_t);
+
+	for (i = 0; i < nrEvents && i < (uint32_t) attrs.size(); i++) {
+		if (end - p < (int64_t) attrSize + 2 * (int) sizeof(uint32_t))
+			return -TS_ERROR_FILEFORMAT;
+		p += attrSize;
+		nrIds = read32(p);
+		len = read32(p + sizeof(uint32_t));
+		p += 2 * sizeof(uint32_t);
+		if ((uint64_t) (end - p) <
+		    len + (uint64_t) nrIds * sizeof(uint64_t))
+			return -TS_ERROR_FILEFORMAT;
+		attrs[i].name = QByteArray(p, strnlen(p, len));
+		p += len + nrIds * sizeof(uint64_t);
+	}
+	return 0;
+}
+
+/*
+ * Figures out the event name of each attr. The name of a tracepoint is taken
+ * from its format, and as with the output of perf script, the system name is
+ * not included in the event name. Other events have the names that were used
+ * with perf record, without any modifiers, or a name that is derived from the
+ * type and config of the attr.
+ */
+void PerfDataReader::setupAttrs()
+{
+	const int nrHardware = arraylen(hardwareEvents);
+	const int nrSoftware = arraylen(softwareEvents);
+	int colon;
+	int i;
+
+	for (i = 0; i < attrs.size(); i++) {
+		Attr &attr = attrs[i];
+		colon = attr.name.indexOf(':');
+		if (attr.type == PERF_TYPE_TRACEPOINT) {
+			if (hasTracingData)
+				attr.format = tracingData.getFormat(
+					(int) attr.config);
+			if (attr.format != nullptr)
+				attr.name = attr.format->name;
+			else if (colon >= 0)
+				attr.name = attr.name.mid(colon + 1);
+		} else if (colon > 0) {
+			attr.name = attr.name.left(colon);
+		}
+		if (!attr.name.isEmpty())
+			continue;
+		if (attr.type == PERF_TYPE_HARDWARE &&
+		    attr.config < (uint64_t) nrHardware)
+			attr.name = QByteArray(hardwareEvents[attr.config]);
+		else if (attr.type == PERF_TYPE_SOFTWARE &&
+			 attr.config < (uint64_t) nrSoftware)
+			attr.name = QByteArray(softwareEvents[attr.config]);
+		else
+			attr.name = QByteArray("unknown");
+	}
+}
+
+/* Returns the index of the attr of a sample, or -1 if it cannot be found */
+vtl_always_inline int PerfDataReader::findAttr(const char *body,
+					       unsigned int size) const
+{
+	if (attrs.size() == 1)
+		return 0;
+	if (idPos < 0 || (idPos + 1) * sizeof(uint64_t) > size)
+		return -1;
+	return attrById.value(read64(body + idPos * sizeof(uint64_t)), -1);
+}
+
+vtl_always_inline uint32_t PerfDataReader::getTaskName(int pid)
+{
+	uint32_t name;
+	char comm[32];
+	TString ts;
+
+	name = taskNames.value(pid, STRINGTABLE_NO_ID);
+	if (name != STRINGTABLE_NO_ID)
+		return name;
+
+	if (pid == 0)
+		strncpy(comm, IDLE_TASK, sizeof(comm));
+	else
+		snprintf(comm, sizeof(comm), UNKNOWN_TASK_FMT, pid);
+	ts.ptr = comm;
+	ts.len = strlen(comm);
+	name = namePool->allocId(&ts, 0);
+	taskNames.insert(pid, name);
+	return name;
+}
+
+void PerfDataReader::processComm(const char *body, unsigned int size)
+{
+	uint32_t name;
+	TString ts;
+	int tid;
+
+	if (size <= 2 * sizeof(uint32_t))
+		return;
+	tid = (int) read32(body + sizeof(uint32_t));
+	ts.ptr = (char*) body + 2 * sizeof(uint32_t);
+	ts.len = strnlen(ts.ptr, size - 2 * sizeof(uint32_t));
+	name = namePool->allocId(&ts, 0);
+	if (name != STRINGTABLE_NO_ID)
+		taskNames.insert(tid, name);
+}
+
+/* A new thread has the name of its parent until it has a COMM record */
+void PerfDataReader::processFork(const char *body, unsigned int size)
+{
+	uint32_t name;
+	int tid;
+	int ptid;
+
+	if (size < 4 * sizeof(uint32_t))
+		return;
+	tid = (int) read32(body + 2 * sizeof(uint32_t));
+	ptid = (int) read32(body + 3 * sizeof(uint32_t));
+	name = taskNames.value(ptid, STRINGTABLE_NO_ID);
+	if (name != STRINGTABLE_NO_ID)
+		taskNames.insert(tid, name);
+}
+
+/*
+ * Decodes a sample into the queue. The fields of a sample are present in a
+ * fixed order, depending on the sample type of its attr. We don't need the
+ * fields that come after the raw data.
+ */
+vtl_always_inline void PerfDataReader::decodeSample(const char *body,
+						    unsigned int size,
+						    int64_t fileOffset,
+						    EventStrings *strings,
+						    MemPool *postEventPool,
+						    PerfGrammar *grammar)
+{
+	const char *p = body;
+	const char *end = body + size;
+	const char *raw = nullptr;
+	const char *callchain = nullptr;
+	uint32_t str;
+	uint64_t sampleType;
+	uint64_t readFormat;
+	uint64_t time = 0;
+	uint64_t period = 0;
+	uint64_t nr = 0;
+	uint64_t n;
+	uint32_t rawSize = 0;
+	TString name;
+	Chunk *chunk;
+	int pid = -1;
+	unsigned int cpu = 0;
+	int idx;
+	int argc;
+	int i;
+
+#define SKIP_U64(N)							\
+	do {								\
+		if ((uint64_t) (end - p) < (N) * sizeof(uint64_t))	\
+			return;						\
+		p += (N) * sizeof(uint64_t);				\
+	} while (0)
+
+	idx = findAttr(body, size);
+	if (idx < 0)
+		return;
+	Attr &attr = attrs[idx];
+	sampleType = attr.sampleType;
+
+	if (sampleType & SAMPLE_IDENTIFIER)
+		SKIP_U64(1);
+	if (sampleType & SAMPLE_IP)
+		SKIP_U64(1);
+	if (sampleType & SAMPLE_TID) {
+		SKIP_U64(1);
+		pid = (int) read32(p - sizeof(uint32_t));
+	}
+	if (sampleType & SAMPLE_TIME) {
+		SKIP_U64(1);
+		time = read64(p - sizeof(uint64_t));
+	}
+	if (sampleType & SAMPLE_ADDR)
+		SKIP_U64(1);
+	if (sampleType & SAMPLE_ID)
+		SKIP_U64(1);
+	if (sampleType & SAMPLE_STREAM_ID)
+		SKIP_U64(1);
+	if (sampleType & SAMPLE_CPU) {
+		SKIP_U64(1);
+		cpu = read32(p - sizeof(uint64_t));
+	}
+	if (sampleType & SAMPLE_PERIOD) {
+		SKIP_U64(1);
+		period = read64(p - sizeof(uint64_t));
+	}
+	if (sampleType & SAMPLE_READ) {
+		readFormat = attr.readFormat;
+		n = 0;
+		if (readFormat & FORMAT_TOTAL_TIME_ENABLED)
+			n++;
+		if (readFormat & FORMAT_TOTAL_TIME_RUNNING)
+			n++;
+		if (readFormat & FORMAT_GROUP) {
+			SKIP_U64(1);
+			nr = read64(p - sizeof(uint64_t));
+			if (nr > size)
+				return;
+			n += nr;
+		} else {
+			n++;
+		}
+		if (readFormat & FORMAT_ID)
+			n += (readFormat & FORMAT_GROUP) ? nr : 1;
+		if (readFormat & FORMAT_LOST)
+			n += (readFormat & FORMAT_GROUP) ? nr : 1;
+		SKIP_U64(n);
+	}
+	if (sampleType & SAMPLE_CALLCHAIN) {
+		SKIP_U64(1);
+		nr = read64(p - sizeof(uint64_t));
+		if (nr > size)
+			return;
+		callchain = p;
+		SKIP_U64(nr);
+	}
+	if (sampleType & SAMPLE_RAW) {
+		if ((uint64_t) (end - p) < sizeof(uint32_t))
+			return;
+		rawSize = read32(p);
+		p += sizeof(uint32_t);
+		if ((uint64_t) (end - p) < rawSize)
+			return;
+		raw = p;
+	}
+#undef SKIP_U64
+
+	if (attr.eventType == EVENT_ERROR) {
+		name.ptr = attr.name.data();
+		name.len = attr.name.size();
+		attr.eventType = grammar->addEventType(&name);
+		if (attr.eventType == EVENT_ERROR)
+			return;
+	}
+	if (!grammar->retention.retain(attr.eventType, grammar->eventTree))
+		return;
+
+	queue.resize(queue.size() + 1);
+	TraceEvent &event = queue[queue.size() - 1];
+	argc = 0;
+	event.argv.offset = strings->beginArgs();
+	if (raw != nullptr && attr.format != nullptr)
+		argc = attr.format->formatArgs(raw, rawSize, tracingData.swap,
+					       argBuf, ARGBUF_SIZE, argStrings,
+					       EVENT_MAX_NR_ARGS);
+	for (i = 0; i < argc; i++) {
+		str = argPool->allocId(&argStrings[i], 16);
+		if (str == STRINGTABLE_NO_ID)
+			break;
+		strings->addArg(str);
+	}
+	event.argc = i;
+	strings->commitArgs();
+
+	if (pid < 0 && raw != nullptr && attr.format != nullptr)
+		pid = attr.format->getPid(raw, rawSize, tracingData.swap);
+	event.type = attr.eventType;
+	event.pid = pid;
+	event.taskNameId = getTaskName(pid);
+	event.cpu = cpu;
+	event.time = vtl::Time((vtl::Time::timeint_t) time, 9);
+	event.intArg = (int) period;
+	event.postEventInfo = nullptr;
+	if (callchain != nullptr && nr > 0) {
+		chunk = (Chunk*) postEventPool->allocObj();
+		chunk->offset = fileOffset + (callchain - body);
+		chunk->len = (int32_t) (nr * sizeof(uint64_t));
+		chunk->file = 0;
+		chunk->type = swap ? CHUNK_CALLCHAIN_SWAP : CHUNK_CALLCHAIN;
+		event.postEventInfo = chunk;
+	}
+	if (maxTime < event.time)
+		maxTime = event.time;
+}
+
+vtl_always_inline bool PerfDataReader::isBefore(const TraceEvent &a,
+					       const TraceEvent &b)
+{
+	return a.time < b.time;
+}
+
+/*
+ * Sorts the queue and moves the events that are not later than limit to the
+ * events list. The sort is stable, so that events with the same timestamp
+ * remain in the order of the file.
+ */
+void PerfDataReader::flushEvents(const vtl::Time &limit,
+				 vtl::TList<TraceEvent> *events)
+{
+	int n;
+	int i;
+
+	std::stable_sort(queue.begin(), queue.end(), isBefore);
+	for (n = 0; n < queue.size(); n++) {
+		if (limit < queue[n].time)
+			break;
+	}
+	for (i = 0; i < n; i++) {
+		TraceEvent &event = events->preAlloc();
+		event = queue[i];
+		events->commit();
+	}
+	queue.remove(0, n);
+}
+
+/*
+ * Decodes all samples, in timestamp order, into the events list. The watcher
+ * is notified every now and then so that the analyzer can start to process the
+ * events that have been decoded, but it's up to the caller to send the final
+ * index and EOF.
+ */
+int PerfDataReader::readEvents(vtl::TList<TraceEvent> *events,
+			       EventStrings *strings, MemPool *postEventPool,
+			       PerfGrammar *grammar, IndexWatcher *watcher)
+{
+	const int64_t dataEnd = (int64_t) (data.offset + data.size);
+	int64_t bufOffset = (int64_t) data.offset;
+	unsigned int bufLen = 0;
+	unsigned int bufPos = 0;
+	unsigned int avail;
+	unsigned int size;
+	int64_t len;
+	vtl::Time roundLimit = VTL_TIME_MIN;
+	int lastIndex = 0;
+	const char *rec;
+	int r;
+
+	argPool->setStringTable(&strings->table);
+	namePool->setStringTable(&strings->table);
+	maxTime = VTL_TIME_MIN;
+	while (true) {
+		avail = bufLen - bufPos;
+		if (avail >= RECORD_HEADER_SIZE) {
+			rec = dataBuf + bufPos;
+			size = read16(rec + 6);
+			if (size < RECORD_HEADER_SIZE) {
+				ts_errno = -TS_ERROR_FILEFORMAT;
+				break;
+			}
+			if (avail >= size) {
+				switch (read32(rec)) {
+				case RECORD_SAMPLE:
+					decodeSample(rec + RECORD_HEADER_SIZE,
+						     size - RECORD_HEADER_SIZE,
+						     bufOffset + bufPos +
+						     RECORD_HEADER_SIZE,
+						     strings, postEventPool,
+						     grammar);
+					break;
+				case RECORD_COMM:
+					processComm(rec + RECORD_HEADER_SIZE,
+						    size - RECORD_HEADER_SIZE);
+					break;
+				case RECORD_FORK:
+					processFork(rec + RECORD_HEADER_SIZE,
+						    size - RECORD_HEADER_SIZE);
+					break;
+				case RECORD_FINISHED_ROUND:
+					/*
+					 * Everything up to the end of the
+					 * previous round can be flushed now.
+					 */
+					flushEvents(roundLimit, events);
+					roundLimit = maxTime;
+					if (events->size() - lastIndex >=
+					    0x10000) {
+						lastIndex = events->size();
+						watcher->sendNextIndex(lastIndex);
+					}
+					break;
+				case RECORD_COMPRESSED:
+					ts_errno = -TS_ERROR_FILEFORMAT;
+					goto out;
+				default:
+					break;
+				}
+				bufPos += size;
+				continue;
+			}
+		}
+		/* Move the incomplete record to the beginning and refill */
+		memmove(dataBuf, dataBuf + bufPos, avail);
+		bufOffset += bufPos;
+		bufPos = 0;
+		bufLen = avail;
+		len = TSMIN((int64_t) (DATA_BUFSIZE - avail),
+			    dataEnd - (bufOffset + avail));
+		if (len <= 0)
+			break;
+		r = readAt(bufOffset + avail, dataBuf + avail, len);
+		if (r != 0) {
+			ts_errno = r;
+			break;
+		}
+		bufLen += (unsigned int) len;
+	}
+out:
+	flushEvents(VTL_TIME_MAX, events);
+	return ts_errno;
+}
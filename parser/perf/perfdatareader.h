@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PERFDATAREADER_H
+#define PERFDATAREADER_H
+
+#include <cstdint>
+
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+#include "mm/internpool.h"
+#include "mm/mempool.h"
+#include "parser/eventstrings.h"
+#include "parser/tracecmd/tracingdata.h"
+#include "parser/traceevent.h"
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
+#include "vtl/time.h"
+#include "vtl/tlist.h"
+
+class EventFormat;
+class IndexWatcher;
+class PerfGrammar;
+class TraceFile;
+
+/*
+ * This reads the binary perf.data files that are written by perf record, so
+ * that they don't need to be converted to text with perf script. The formats
+ * of the tracepoints are taken from the HEADER_TRACING_DATA section, which is
+ * parsed by TracingData, and the samples are printed in the same way as by
+ * perf script, so that the events look the same as if they had been parsed by
+ * PerfGrammar.
+ *
+ * The records of the data section are not strictly ordered by time, so the
+ * samples are queued and sorted in the same way as perf does it, by flushing
+ * the queue at every PERF_RECORD_FINISHED_ROUND.
+ *
+ * The callchain of a sample becomes the postEventInfo of the event, as a Chunk
+ * that refers to the instruction pointers in the file. The instruction pointers
+ * are only formatted as text when they are shown, no symbols are resolved.
+ */
+class PerfDataReader
+{
+public:
+	PerfDataReader(TraceFile *file);
+	~PerfDataReader();
+	static bool isPerfData(TraceFile *file);
+	static QByteArray formatCallchain(const char *data, int len, bool swap);
+	int open();
+	int readEvents(vtl::TList<TraceEvent> *events, EventStrings *strings,
+		       MemPool *postEventPool, PerfGrammar *grammar,
+		       IndexWatcher *watcher);
+private:
+	class Attr {
+	public:
+		uint32_t type;
+		uint64_t config;
+		uint64_t sampleType;
+		uint64_t readFormat;
+		QByteArray name;
+		EventFormat *format;
+		event_t eventType;
+	};
+	class Section {
+	public:
+		uint64_t offset;
+		uint64_t size;
+	};
+	int readAt(int64_t offset, void *buf, int64_t len);
+	vtl_always_inline uint16_t read16(const char *p) const;
+	vtl_always_inline uint32_t read32(const char *p) const;
+	vtl_always_inline uint64_t read64(const char *p) const;
+	int parseAttrs(const Section &attrSection, uint64_t attrSize);
+	int parseFeatures(const char *bitmap);
+	int parseEventDesc(const Section &section);
+	void setupAttrs();
+	vtl_always_inline int findAttr(const char *body,
+				       unsigned int size) const;
+	vtl_always_inline void decodeSample(const char *body, unsigned int size,
+					    int64_t fileOffset,
+					    EventStrings *strings,
+					    MemPool *postEventPool,
+					    PerfGrammar *grammar);
+	void processComm(const char *body, unsigned int size);
+	void processFork(const char *body, unsigned int size);
+	vtl_always_inline uint32_t getTaskName(int pid);
+	vtl_always_inline static bool isBefore(const TraceEvent &a,
+					       const TraceEvent &b);
+	void flushEvents(const vtl::Time &limit,
+			 vtl::TList<TraceEvent> *events);
+	TraceFile *traceFile;
+	TracingData tracingData;
+	bool swap;
+	bool hasTracingData;
+	Section data;
+	QVector<Attr> attrs;
+	QHash<uint64_t, int> attrById;
+	/* The position of the sample id, in units of 64 bits, or -1 */
+	int idPos;
+	QVector<Section> features;
+	/* The samples that have been decoded but not yet been flushed */
+	QVector<TraceEvent> queue;
+	vtl::Time maxTime;
+	InternPool<> *argPool;
+	InternPool<> *namePool;
+	QHash<int, uint32_t> taskNames;
+	char *argBuf;
+	TString *argStrings;
+	char *dataBuf;
+	int ts_errno;
+};
+
+vtl_always_inline uint16_t PerfDataReader::read16(const char *p) const
+{
+	return tracecmd_read16(p, swap);
+}
+
+vtl_always_inline uint32_t PerfDataReader::read32(const char *p) const
+{
+	return tracecmd_read32(p, swap);
+}
+
+vtl_always_inline uint64_t PerfDataReader::read64(const char *p) const
+{
+	return tracecmd_read64(p, swap);
+}
+
+#endif /* PERFDATAREADER_H */
@@ -53,16 +53,18 @@
 
 #include <cstring>
 
+#include "misc/osapi.h"
 #include "parser/perf/perfgrammar.h"
 #include "parser/traceevent.h"
 
 PerfGrammar::PerfGrammar() :
-	unknownTypeCounter(EVENT_UNKNOWN)
+	strings(nullptr), lazyArgs(false), dropped(false),
+	unknownTypeCounter(EVENT_UNKNOWN), tmp_argc(0)
 {
-	argPool = new StringPool<>(2048, 1024 * 1024);
-	namePool =  new StringPool<>(1024, 65536);
-	eventTree = new StringTree<>(8, 256, 4096);
-	setupEventTree();
+	argPool = new InternPool<>(2048, 1024 * 1024);
+	namePool =  new InternPool<>(1024, 65536);
+	eventTree = new StringTree<>(8, 4096);
+	tshark_bzero(tmp_argv, sizeof(tmp_argv));
 }
 
 PerfGrammar::~PerfGrammar()
@@ -77,27 +79,27 @@ void PerfGrammar::clear()
 	argPool->clear();
 	namePool->clear();
 	eventTree->clear();
-	setupEventTree();
+	retention.clear();
 	unknownTypeCounter = EVENT_UNKNOWN;
 }
 
-void PerfGrammar::setupEventTree()
+/*
+ * Sets the EventStrings that the strings of the parsed events are added to,
+ * this must be done before any line is parsed.
+ */
+void PerfGrammar::setEventStrings(EventStrings *eventStrings)
 {
-	int t;
-	TString str;
-	char stra[EVENTSTRINGS_MAXLEN];
-	const int maxsize = arraylen(stra);
+	strings = eventStrings;
+	argPool->setStringTable(&strings->table);
+	namePool->setStringTable(&strings->table);
+}
 
-	str.ptr = stra;
+void PerfGrammar::setLazyArgs(bool enable)
+{
+	lazyArgs = enable;
+}
 
-	for (t = 0; t < NR_EVENTS; t++) {
-		str.len = strlen(eventstrings[t]);
-		if (str.len >= maxsize) {
-			vtl::errx(BSD_EX_SOFTWARE,
-				  "Unexpected long string at %s:%d",
-				  __FILE__, __LINE__);
-		}
-		str.ptr = strncpy(str.ptr, eventstrings[t], maxsize);
-		eventTree->searchAllocString(&str, (event_t) t);
-	}
+void PerfGrammar::setRetentionPolicy(const RetentionPolicy *policy)
+{
+	retention.setPolicy(policy);
 }
@@ -54,8 +54,10 @@
 #define PERFGRAMMAR_H
 
 #include "misc/traceshark.h"
-#include "mm/stringpool.h"
+#include "mm/internpool.h"
 #include "mm/stringtree.h"
+#include "parser/eventstrings.h"
+#include "parser/retentionpolicy.h"
 #include "parser/traceevent.h"
 #include "vtl/compiler.h"
 #include "vtl/time.h"
@@ -75,9 +77,15 @@ public:
 	~PerfGrammar();
 	void clear();
 	vtl_always_inline bool parseLine(TraceLine &line, TraceEvent &event);
+	vtl_always_inline event_t addEventType(const TString *str);
+	vtl_always_inline bool droppedEvent() const;
+	void setEventStrings(EventStrings *eventStrings);
+	void setLazyArgs(bool enable);
+	void setRetentionPolicy(const RetentionPolicy *policy);
 	StringTree<> *eventTree;
+	/* The events that are dropped because of the retention policy */
+	RetentionTable retention;
 private:
-	void setupEventTree();
 	vtl_always_inline bool StoreMatch(TString *str, TraceEvent &event);
 	vtl_always_inline bool NameMatch(TString *str, TraceEvent &event);
 	vtl_always_inline bool IntArgMatch(TString *str, TraceEvent &event);
@@ -87,8 +95,17 @@ private:
 	vtl_always_inline bool TimeMatch(TString *str, TraceEvent &event);
 	vtl_always_inline bool EventMatch(TString *str, TraceEvent &event);
 	vtl_always_inline bool ArgMatch(TString *str, TraceEvent &event);
-	StringPool<> *argPool;
-	StringPool<> *namePool;
+	vtl_always_inline bool LazyArgMatch(const TraceLine &line,
+					    const TString *str,
+					    unsigned int n,
+					    TraceEvent &event);
+	InternPool<> *argPool;
+	InternPool<> *namePool;
+	EventStrings *strings;
+	/* Store only the location of the arguments of unknown events */
+	bool lazyArgs;
+	/* The last line was an event that the retention policy dropped */
+	bool dropped;
 
 	/*
 	 * This is a counter that will count up every time a new event name
@@ -106,22 +123,28 @@ private:
 		STATE_EVENT,
 		STATE_ARG
 	} grammarstate_t;
+	int tmp_argc;
+	const TString *tmp_argv[EVENT_MAX_NR_ARGS];
 };
 
+vtl_always_inline bool PerfGrammar::droppedEvent() const
+{
+	return dropped;
+}
+
 vtl_always_inline bool PerfGrammar::StoreMatch(TString *str, TraceEvent &event)
 {
 	/*
-	 * We temporarily store the process name string(s) into the
-	 * argv/argc fields of the event, because we don't know how many
-	 * strings the process name will be split into. It may have been
-	 * split into several strings due to the process name containing
-	 * spaces. We will then consume this stored information in the
-	 * TimeNode class.
+	 * We temporarily store the process name string(s) into
+	 * tmp_argv/tmp_argc, because we don't know how many strings the
+	 * process name will be split into. It may have been split into
+	 * several strings due to the process name containing spaces. We will
+	 * then consume this stored information in the TimeMatch function.
 	 */
-	if (event.argc >= EVENT_MAX_NR_ARGS)
+	if (tmp_argc >= EVENT_MAX_NR_ARGS)
 		return false;
-	event.argv[event.argc] = str;
-	event.argc++;
+	tmp_argv[tmp_argc] = str;
+	tmp_argc++;
 	return true;
 }
 
@@ -167,6 +190,7 @@ vtl_always_inline bool PerfGrammar::PidMatch(TString *str, TraceEvent &event)
 vtl_always_inline bool PerfGrammar::CPUMatch(TString *str, TraceEvent &event)
 {
 	char *c;
+	char *end = str->ptr + str->len;
 	unsigned int cpu = 0;
 	int digit;
 
@@ -174,16 +198,18 @@ vtl_always_inline bool PerfGrammar::CPUMatch(TString *str, TraceEvent &event)
 		return false;
 
 	cpu = 0;
-	for (c = str->ptr + 1; *c != '\0' && *c != ']'; c++) {
+	for (c = str->ptr + 1; c < end && *c != ']'; c++) {
 		digit = *c - '0';
 		if (digit > 9 || digit < 0)
 			goto error;
 		cpu *= 10;
 		cpu += digit;
 	}
+	if (tmp_argc >= EVENT_MAX_NR_ARGS)
+		goto error;
 	event.cpu = cpu;
-	event.argv[event.argc] = str;
-	event.argc++;
+	tmp_argv[tmp_argc] = str;
+	tmp_argc++;
 	return true;
 error:
 	event.cpu = 0;
@@ -199,8 +225,10 @@ vtl_always_inline int PerfGrammar::pidFromString(const TString &str, bool &ok)
 	bool neg = false;
 	ok = true;
 
-	if (str.len < 1 || str.len > 10)
-		return false;
+	if (str.len < 1 || str.len > 10) {
+		ok = false;
+		return 0;
+	}
 
 	pid = 0;
 	c = str.ptr;
@@ -225,7 +253,7 @@ vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 {
 	bool rval;
 	TString namestr;
-	const TString *newname;
+	uint32_t newname;
 	char cstr[256];
 	const unsigned int maxlen = arraylen(cstr) - 1;
 	int i;
@@ -241,36 +269,55 @@ vtl_always_inline bool PerfGrammar::TimeMatch(TString *str, TraceEvent &event)
 	/*
 	 * This is the time field, if it is successful we need to assemble
 	 * the name and pid strings that has been temporarily stored in
-	 * argv/argc.
+	 * tmp_argv/tmp_argc.
 	 */
 	if (rval) {
-		if (event.argc < 3)
+		if (tmp_argc < 3)
 			return false;
 
-		pid = pidFromString(*event.argv[event.argc - 2], ok);
+		pid = pidFromString(*tmp_argv[tmp_argc - 2], ok);
 		if (!ok)
 			return false;
 		event.pid = pid;
 
-		if (event.argc > 3) {
-			namestr.set(event.argv[0], maxlen);
-			for (i = 1; i < event.argc - 2; i++) {
-				if (!namestr.merge(event.argv[i], maxlen))
+		if (tmp_argc > 3) {
+			namestr.set(tmp_argv[0], maxlen);
+			for (i = 1; i < tmp_argc - 2; i++) {
+				if (!namestr.merge(tmp_argv[i], maxlen))
 					return false;
 			}
 
-			newname = namePool->allocString(&namestr, 0);
+			newname = namePool->allocId(&namestr, 0);
 		} else {
-			newname = namePool->allocString(event.argv[0], 0);
+			newname = namePool->allocId(tmp_argv[0], 0);
 		}
-		if (newname == nullptr)
+		if (newname == STRINGTABLE_NO_ID)
 			return false;
-		event.taskName = newname;
-		event.argc = 0;
+		event.taskNameId = newname;
 	}
 	return rval;
 }
 
+/*
+ * Returns the event type of the event name str, a new event type is allocated
+ * if the name has not been seen before.
+ */
+vtl_always_inline event_t PerfGrammar::addEventType(const TString *str)
+{
+	event_t type;
+
+	type = eventTree->searchAllocString(str, (event_t) unknownTypeCounter);
+	if (type == unknownTypeCounter) {
+		/*
+		 * This event is a new event, so for the next one we need to
+		 * bump the counter in order to use a unique eventType value 
+		 * for every event name.
+		 */
+		unknownTypeCounter++;
+	}
+	return type;
+}
+
 vtl_always_inline bool PerfGrammar::EventMatch(TString *str, TraceEvent &event)
 {
 	char *lastChr = str->ptr + str->len - 1;
@@ -281,10 +328,11 @@ vtl_always_inline bool PerfGrammar::EventMatch(TString *str, TraceEvent &event)
 	if (str->len < 1)
 		return false;
 
-	if (*lastChr == ':') {
-		*lastChr = '\0';
-		str->len--;
-	} else
+	/*
+	 * The string may point directly into a read-only mapping of the trace
+	 * file, so the trailing colon is excluded by means of the length only.
+	 */
+	if (*lastChr != ':')
 		return false;
 
 	for (c = str->ptr; c < lastChr; c++)
@@ -296,39 +344,41 @@ vtl_always_inline bool PerfGrammar::EventMatch(TString *str, TraceEvent &event)
 		tmpstr.len = lastChr - tmpstr.ptr;
 	} else {
 		tmpstr.ptr = str->ptr;
-		tmpstr.len = str->len;
+		tmpstr.len = str->len - 1;
 	}
 
-	type = eventTree->searchAllocString(&tmpstr,
-					    (event_t) unknownTypeCounter);
+	type = addEventType(&tmpstr);
 	if (type == EVENT_ERROR)
 		return false;
-	else if (type == unknownTypeCounter) {
-		/*
-		 * This event is a new event, so for the next one we need to
-		 * bump the counter in order to use a unique eventType value 
-		 * for every event name.
-		 */
-		unknownTypeCounter++;
-	}
 	event.type = type;
 	return true;
 }
 
 vtl_always_inline bool PerfGrammar::ArgMatch(TString *str, TraceEvent &event)
 {
-	const TString *newstr;
+	uint32_t newstr;
 	if (event.argc < EVENT_MAX_NR_ARGS) {
-		newstr = argPool->allocString(str, 16);
-		if (newstr == nullptr)
+		newstr = argPool->allocId(str, 16);
+		if (newstr == STRINGTABLE_NO_ID)
 			return false;
-		event.argv[event.argc] = newstr;
+		strings->addArg(newstr);
 		event.argc++;
 		return true;
 	}
 	return false;
 }
 
+vtl_always_inline bool PerfGrammar::LazyArgMatch(const TraceLine &line,
+						 const TString *str,
+						 unsigned int n,
+						 TraceEvent &event)
+{
+	const TString *last = str + TSMIN(n, (unsigned int) EVENT_MAX_NR_ARGS) - 1;
+	int64_t offset = line.begin + (str->ptr - line.ptr);
+	int64_t len = last->ptr + last->len - str->ptr;
+
+	return event.setLazyArgs(offset, len);
+}
 
 vtl_always_inline
 bool PerfGrammar::parseLine(TraceLine &line, TraceEvent &event)
@@ -337,6 +387,8 @@ bool PerfGrammar::parseLine(TraceLine &line, TraceEvent &event)
 	unsigned int n = line.nStrings;
 	grammarstate_t state = STATE_NAME;
 
+	dropped = false;
+	tmp_argc = 0;
 	if (n == 0)
 		return false;
 
@@ -378,9 +430,20 @@ bool PerfGrammar::parseLine(TraceLine &line, TraceEvent &event)
 		case STATE_EVENT:
 			if (!EventMatch(str, event))
 				return false;
+			if (!retention.retain(event.type, eventTree)) {
+				dropped = true;
+				return false;
+			}
 			NEXTTOKEN(true);
 			ts_fallthrough;
 		case STATE_ARG:
+			/*
+			 * The arguments of the event types that we know about
+			 * are always stored because the analyzer needs them.
+			 */
+			if (lazyArgs && event.type >= NR_EVENTS &&
+			    LazyArgMatch(line, str, n, event))
+				return true;
 			while (ArgMatch(str, event))
 				NEXTTOKEN(true);
 			return false;
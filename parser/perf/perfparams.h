@@ -53,7 +53,7 @@
 #ifndef PERFPARAMS_H
 #define PERFPARAMS_H
 
-#include "mm/stringpool.h"
+#include "mm/internpool.h"
 #include "parser/traceevent.h"
 #include "parser/paramhelpers.h"
 #include "parser/perf/helpers.h"
@@ -215,7 +215,7 @@ perf_sched_switch_handle_newprio(const TraceEvent &event,
 
 static vtl_always_inline const char *
 perf_sched_switch_handle_newname_strdup_(const TraceEvent &event,
-					 StringPool<> *pool,
+					 InternPool<> *pool,
 					 const sched_switch_handle &handle)
 {
 	int i;
@@ -275,12 +275,12 @@ perf_sched_switch_handle_newname_strdup_(const TraceEvent &event,
 
 const char *
 perf_sched_switch_handle_newname_strdup(const TraceEvent &event,
-					StringPool<> *pool,
+					InternPool<> *pool,
 					const sched_switch_handle &handle);
 
 static vtl_always_inline const char *
 perf_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
-					 StringPool<> *pool,
+					 InternPool<> *pool,
 					 const sched_switch_handle &handle)
 {
 	int i;
@@ -341,7 +341,7 @@ perf_sched_switch_handle_oldname_strdup_(const TraceEvent &event,
 
 const char *
 perf_sched_switch_handle_oldname_strdup(const TraceEvent &event,
-					StringPool<> *pool,
+					InternPool<> *pool,
 					const sched_switch_handle &handle);
 
 /*
@@ -472,7 +472,7 @@ static vtl_always_inline int perf_sched_wakeup_pid(const TraceEvent &event)
 }
 
 static vtl_always_inline const char *
-perf_sched_wakeup_name_strdup_(const TraceEvent &event, StringPool<> *pool)
+perf_sched_wakeup_name_strdup_(const TraceEvent &event, InternPool<> *pool)
 {
 	const int lastidx = event.argc - 1;
 	int beginidx;
@@ -548,7 +548,7 @@ perf_sched_wakeup_name_strdup_(const TraceEvent &event, StringPool<> *pool)
 }
 
 const char *perf_sched_wakeup_name_strdup(const TraceEvent &event,
-					  StringPool<> *pool);
+					  InternPool<> *pool);
 
 #define perf_sched_process_fork_args_ok(EVENT) (EVENT.argc >= 4)
 
@@ -594,7 +594,7 @@ int perf_sched_process_fork_parent_pid(const TraceEvent &event) {
 
 static vtl_always_inline const char *
 perf_sched_process_fork_childname_strdup_(const TraceEvent &event,
-					  StringPool<> *pool)
+					  InternPool<> *pool)
 {
 	int i;
 	int beginidx;
@@ -638,7 +638,7 @@ perf_sched_process_fork_childname_strdup_(const TraceEvent &event,
 }
 
 const char *perf_sched_process_fork_childname_strdup(const TraceEvent &event,
-						     StringPool<> *pool);
+						     InternPool<> *pool);
 
 /* Normally should be >= 3 but we don't care if the prio argument is missing */
 #define perf_sched_process_exit_args_ok(EVENT) (EVENT.argc >= 2)
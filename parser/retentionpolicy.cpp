@@ -0,0 +1,183 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+
+#include <QStringList>
+
+#include "misc/errors.h"
+#include "parser/retentionpolicy.h"
+
+RetentionPolicy::RetentionPolicy()
+{}
+
+/*
+ * Returns 0 if the spec could be parsed, then it replaces the previous policy,
+ * otherwise the previous policy is kept. An empty spec keeps all events.
+ */
+int RetentionPolicy::parse(const QString &newSpec)
+{
+	QHash<QByteArray, bool> newNames;
+	QList<Pattern> newPatterns;
+	QStringList items = newSpec.split(QLatin1Char(','));
+	Pattern pattern;
+	QByteArray name;
+	bool keep;
+	int star;
+	int i;
+
+	for (i = 0; i < items.size(); i++) {
+		name = items[i].trimmed().toLatin1();
+		if (name.isEmpty())
+			continue;
+		keep = true;
+		if (name.startsWith('-') || name.startsWith('+')) {
+			keep = name.startsWith('+');
+			name.remove(0, 1);
+		}
+		star = name.indexOf('*');
+		if (name.isEmpty() || (star >= 0 && star != name.size() - 1))
+			return -TS_ERROR_POLICY;
+		if (name.endsWith('*')) {
+			pattern.prefix = name.left(name.size() - 1);
+			pattern.keep = keep;
+			newPatterns.append(pattern);
+		} else {
+			newNames.insert(name, keep);
+		}
+	}
+
+	std::stable_sort(newPatterns.begin(), newPatterns.end(),
+			 [] (const Pattern &a, const Pattern &b) -> bool {
+				 return a.prefix.size() > b.prefix.size();
+			 });
+	names = newNames;
+	patterns = newPatterns;
+	spec = newSpec.trimmed();
+	return 0;
+}
+
+void RetentionPolicy::clear()
+{
+	names.clear();
+	patterns.clear();
+	spec.clear();
+}
+
+bool RetentionPolicy::retains(const TString *name) const
+{
+	QByteArray n = QByteArray::fromRawData(name->ptr, name->len);
+	QHash<QByteArray, bool>::const_iterator iter;
+	int i;
+
+	iter = names.find(n);
+	if (iter != names.end())
+		return iter.value();
+	for (i = 0; i < patterns.size(); i++) {
+		if (n.startsWith(patterns[i].prefix))
+			return patterns[i].keep;
+	}
+	return true;
+}
+
+const QString &RetentionPolicy::getSpec() const
+{
+	return spec;
+}
+
+RetentionTable::RetentionTable()
+	: policy(nullptr)
+{}
+
+/* An empty policy is the same as no policy, then retain() is trivial */
+void RetentionTable::setPolicy(const RetentionPolicy *p)
+{
+	policy = (p != nullptr && !p->isEmpty()) ? p : nullptr;
+	clear();
+}
+
+void RetentionTable::clear()
+{
+	keep.clear();
+	dropped.clear();
+}
+
+quint64 RetentionTable::getDropped(event_t type) const
+{
+	if (type < 0 || type >= dropped.size())
+		return 0;
+	return dropped.at(type);
+}
+
+void RetentionTable::addDropped(event_t type, quint64 n)
+{
+	if (type < 0)
+		return;
+	if (type >= dropped.size())
+		dropped.resize(type + 1);
+	dropped[type] += n;
+}
+
+void RetentionTable::resolve(event_t type, const StringTree<> *tree)
+{
+	const TString *name;
+	int t;
+
+	t = keep.size();
+	keep.resize(type + 1);
+	if (dropped.size() < keep.size())
+		dropped.resize(keep.size());
+	for (; t <= type; t++) {
+		name = tree->stringLookup((event_t) t);
+		keep[t] = name == nullptr || policy->retains(name);
+	}
+}
@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef RETENTIONPOLICY_H
+#define RETENTIONPOLICY_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+#include "mm/stringtree.h"
+#include "misc/traceshark.h"
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
+
+/*
+ * A retention policy decides which events are kept when a trace is loaded. It
+ * is a comma separated list of event names. A name that is prefixed with '-'
+ * means that those events are dropped, otherwise they are kept. A name that
+ * ends with '*' matches all events whose name begins with what comes before
+ * the '*'. An exact name has precedence over a pattern and a longer pattern
+ * has precedence over a shorter one. Events that are not matched by any name
+ * are kept. For example, "-*,sched_*,cpu_*" keeps only the sched and cpu
+ * events.
+ *
+ * Dropped events are not stored but they are counted, see RetentionTable.
+ */
+class RetentionPolicy
+{
+public:
+	RetentionPolicy();
+	int parse(const QString &spec);
+	void clear();
+	vtl_always_inline bool isEmpty() const;
+	bool retains(const TString *name) const;
+	const QString &getSpec() const;
+private:
+	class Pattern {
+	public:
+		QByteArray prefix;
+		bool keep;
+	};
+	QHash<QByteArray, bool> names;
+	/* These are sorted so that the longest prefix comes first */
+	QList<Pattern> patterns;
+	QString spec;
+};
+
+vtl_always_inline bool RetentionPolicy::isEmpty() const
+{
+	return names.isEmpty() && patterns.isEmpty();
+}
+
+/*
+ * Each grammar has a RetentionTable, which caches the decision of the policy
+ * for each event type, so that the policy only needs to be consulted the first
+ * time that a type is seen. It also counts the dropped events of each type.
+ */
+class RetentionTable
+{
+public:
+	RetentionTable();
+	void setPolicy(const RetentionPolicy *p);
+	void clear();
+	vtl_always_inline bool retain(event_t type, const StringTree<> *tree);
+	quint64 getDropped(event_t type) const;
+	void addDropped(event_t type, quint64 n);
+private:
+	void resolve(event_t type, const StringTree<> *tree);
+	const RetentionPolicy *policy;
+	QVector<bool> keep;
+	QVector<quint64> dropped;
+};
+
+/* Returns false and counts the event if the event type should be dropped */
+vtl_always_inline bool RetentionTable::retain(event_t type,
+					      const StringTree<> *tree)
+{
+	if (likely(policy == nullptr))
+		return true;
+	if (unlikely(type >= keep.size()))
+		resolve(type, tree);
+	if (keep.at(type))
+		return true;
+	dropped[type]++;
+	return false;
+}
+
+#endif /* RETENTIONPOLICY_H */
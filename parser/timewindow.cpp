@@ -0,0 +1,464 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include <QStringList>
+
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "parser/timewindow.h"
+#include "parser/tokenizer.h"
+#include "parser/tracefile.h"
+
+/* The amount of data that is read at a time when looking for a timestamp */
+#define SAMPLE_SIZE (16 * 1024)
+/*
+ * The timestamps are parsed in place and the parsing may load 16 bytes, even
+ * if the timestamp is at the end of the buffer.
+ */
+#define SAMPLE_PADDING (16)
+
+/*
+ * The names of the tasks that ran before the window are looked up in this
+ * many blocks, which are evenly spread out over the skipped part of the file.
+ */
+#define PRESCAN_BLOCKS (64)
+#define PRESCAN_SIZE (64 * 1024)
+
+#define SWITCH_EVENT_SFIX "sched_switch:"
+#define SWITCH_PCOM_PFIX "prev_comm="
+#define SWITCH_PPID_PFIX "prev_pid="
+#define SWITCH_NCOM_PFIX "next_comm="
+#define SWITCH_NPID_PFIX "next_pid="
+
+static vtl_always_inline bool beginsWith(const TString *str, const char *pfix)
+{
+	int len = strlen(pfix);
+
+	return str->len >= len && strncmp(str->ptr, pfix, len) == 0;
+}
+
+static vtl_always_inline bool endsWith(const TString *str, const char *sfix)
+{
+	int len = strlen(sfix);
+
+	return str->len >= len &&
+		strncmp(str->ptr + str->len - len, sfix, len) == 0;
+}
+
+/* Returns true if str is the CPU field of a line, e.g. "[001]" */
+static vtl_always_inline bool isCPUField(const TString *str)
+{
+	int i;
+
+	if (str->len < 3 || str->ptr[0] != '[' || str->ptr[str->len - 1] != ']')
+		return false;
+	for (i = 1; i < str->len - 1; i++) {
+		if (str->ptr[i] < '0' || str->ptr[i] > '9')
+			return false;
+	}
+	return true;
+}
+
+TimeWindow::TimeWindow()
+	: hasStart(false), hasEnd(false)
+{}
+
+/*
+ * Returns 0 if the spec could be parsed, then it replaces the previous window,
+ * otherwise the previous window is kept. An empty spec means no window.
+ */
+int TimeWindow::parse(const QString &newSpec)
+{
+	QStringList items = newSpec.split(QLatin1Char(','));
+	QString item;
+	vtl::Time newStart;
+	vtl::Time newEnd;
+	bool newHasStart = false;
+	bool newHasEnd = false;
+	bool ok;
+	double d;
+
+	if (newSpec.trimmed().isEmpty()) {
+		clear();
+		return 0;
+	}
+	if (items.size() != 2)
+		return -TS_ERROR_TIMEWINDOW;
+
+	item = items[0].trimmed();
+	if (!item.isEmpty()) {
+		d = item.toDouble(&ok);
+		if (!ok)
+			return -TS_ERROR_TIMEWINDOW;
+		newStart = vtl::Time::fromDouble(d);
+		newHasStart = true;
+	}
+	item = items[1].trimmed();
+	if (!item.isEmpty()) {
+		d = item.toDouble(&ok);
+		if (!ok)
+			return -TS_ERROR_TIMEWINDOW;
+		newEnd = vtl::Time::fromDouble(d);
+		newHasEnd = true;
+	}
+	if (newHasStart && newHasEnd && newStart > newEnd)
+		return -TS_ERROR_TIMEWINDOW;
+
+	start = newStart;
+	end = newEnd;
+	hasStart = newHasStart;
+	hasEnd = newHasEnd;
+	spec = newSpec.trimmed();
+	return 0;
+}
+
+void TimeWindow::clear()
+{
+	hasStart = false;
+	hasEnd = false;
+	spec.clear();
+}
+
+bool TimeWindow::isEmpty() const
+{
+	return !hasStart && !hasEnd;
+}
+
+const QString &TimeWindow::getSpec() const
+{
+	return spec;
+}
+
+/*
+ * Finds the byte range of the file that contains the lines of the window. The
+ * range begins with the first line that has a timestamp within the window, so
+ * that a perf backtrace that belongs to an earlier event is never included. It
+ * ends with the first line that has a timestamp after the window, so that the
+ * backtrace of the last event in the window is included.
+ */
+int TimeWindow::findRange(TraceFile *file, int64_t *rbegin,
+			  int64_t *rend) const
+{
+	int ts_errno = 0;
+	char *buf;
+
+	*rbegin = 0;
+	*rend = INT64_MAX;
+	if (isEmpty())
+		return 0;
+
+	buf = new char[SAMPLE_SIZE + SAMPLE_PADDING];
+	if (hasStart) {
+		*rbegin = findOffset(file, start, true, buf, &ts_errno);
+		if (ts_errno != 0)
+			goto out;
+	}
+	if (hasEnd) {
+		*rend = findOffset(file, end, false, buf, &ts_errno);
+		if (ts_errno != 0)
+			goto out;
+	}
+out:
+	delete[] buf;
+	return ts_errno;
+}
+
+/*
+ * Returns the offset of the first line whose timestamp is later than t, or
+ * equal to t if inclusive is true. If there is no such line, then the size of
+ * the file is returned.
+ */
+int64_t TimeWindow::findOffset(TraceFile *file, const vtl::Time &t,
+			       bool inclusive, char *buf, int *ts_errno) const
+{
+	int64_t size = file->getFileSize();
+	int64_t lo = -1;
+	int64_t hi = size;
+	int64_t mid;
+	int64_t lineBegin;
+	vtl::Time time;
+
+	/*
+	 * The invariant is that the first line with a timestamp at or after lo
+	 * is before the window edge and the one at or after hi is not.
+	 */
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (!sampleLine(file, mid, buf, &lineBegin, &time, ts_errno)) {
+			if (*ts_errno != 0)
+				return 0;
+			hi = mid;
+		} else if (time < t || (!inclusive && time == t)) {
+			/* Every position up to lineBegin has the same line */
+			lo = lineBegin;
+		} else {
+			hi = mid;
+		}
+	}
+	if (!sampleLine(file, hi, buf, &lineBegin, &time, ts_errno))
+		return *ts_errno != 0 ? 0 : size;
+	return lineBegin;
+}
+
+/*
+ * Finds the first line that begins at or after pos and that has a timestamp.
+ * Returns false if there is no such line or if an error occurs.
+ */
+bool TimeWindow::sampleLine(TraceFile *file, int64_t pos, char *buf,
+			    int64_t *lineBegin, vtl::Time *time,
+			    int *ts_errno) const
+{
+	TString words[EVENT_MAX_NR_ARGS];
+	unsigned int end;
+	unsigned int next;
+	unsigned int i;
+	unsigned int n;
+	char *eol;
+	ssize_t r;
+	bool partial;
+
+	/* Read from the previous character, pos may be the begin of a line */
+	partial = pos > 0;
+	if (partial)
+		pos--;
+
+	for (;;) {
+		r = file->readAt(pos, buf, SAMPLE_SIZE, ts_errno);
+		if (r <= 0)
+			return false;
+		memset(buf + r, 0, SAMPLE_PADDING);
+		end = (unsigned int) r;
+		i = 0;
+		if (partial) {
+			eol = (char*) memchr(buf, '\n', r);
+			if (eol == nullptr) {
+				pos += r;
+				continue;
+			}
+			i = eol - buf + 1;
+			partial = false;
+		}
+		/* Only complete lines, unless this is the end of the file */
+		if (r == SAMPLE_SIZE) {
+			eol = (char*) memrchr(buf + i, '\n', end - i);
+			if (eol == nullptr) {
+				/* A very long line, which we skip */
+				pos += r;
+				partial = true;
+				continue;
+			}
+			end = eol - buf + 1;
+		}
+		for (; i < end; i = next) {
+			n = Tokenizer::tokenizeLine(buf, i, end, words,
+						    EVENT_MAX_NR_ARGS, &next);
+			if (lineTime(words, n, time)) {
+				*lineBegin = pos + i;
+				return true;
+			}
+			if (next <= i)
+				break;
+		}
+		pos += end;
+	}
+}
+
+/*
+ * Both ftrace and perf lines have the timestamp after the CPU field, ftrace
+ * may have a field with the irq flags in between.
+ */
+bool TimeWindow::lineTime(const TString *words, unsigned int n,
+			  vtl::Time *time)
+{
+	unsigned int i;
+	unsigned int j;
+	bool ok;
+
+	for (i = 0; i < n; i++) {
+		if (isCPUField(&words[i]))
+			break;
+	}
+	for (j = i + 1; j < n && j <= i + 2; j++) {
+		if (words[j].ptr[words[j].len - 1] != ':')
+			continue;
+		*time = vtl::Time::fromString(words[j].ptr, ok);
+		if (ok)
+			return true;
+	}
+	return false;
+}
+
+/*
+ * Collects the task names from the sched_switch events in a sparse sample of
+ * the file before end. The names of the tasks are usually known from the
+ * events in the window but a task that is only referred to by pid, e.g. by a
+ * sched_process_exit event, would otherwise remain nameless. A later name
+ * replaces an earlier one.
+ */
+int TimeWindow::prescanNames(TraceFile *file, int64_t end,
+			     QHash<int, QByteArray> *names) const
+{
+	TString words[EVENT_MAX_NR_ARGS];
+	int64_t step;
+	int64_t pos;
+	unsigned int i;
+	unsigned int n;
+	unsigned int next;
+	unsigned int bend;
+	bool partial = false;
+	int ts_errno = 0;
+	char *buf;
+	char *eol;
+	ssize_t r;
+
+	names->clear();
+	if (end <= 0)
+		return 0;
+	step = TSMAX(end / PRESCAN_BLOCKS, (int64_t) PRESCAN_SIZE);
+	buf = new char[PRESCAN_SIZE];
+
+	for (pos = 0; pos < end; ) {
+		r = file->readAt(pos, buf, TSMIN((int64_t) PRESCAN_SIZE,
+						 end - pos), &ts_errno);
+		if (r <= 0)
+			break;
+		i = 0;
+		if (partial) {
+			eol = (char*) memchr(buf, '\n', r);
+			i = eol == nullptr ? r : eol - buf + 1;
+		}
+		eol = (char*) memrchr(buf + i, '\n', r - i);
+		bend = eol == nullptr ? i : eol - buf + 1;
+		for (; i < bend; i = next) {
+			n = Tokenizer::tokenizeLine(buf, i, bend, words,
+						    EVENT_MAX_NR_ARGS, &next);
+			scanSwitchNames(words, n, names);
+			if (next <= i)
+				break;
+		}
+		/*
+		 * If the blocks are adjacent, then the next block continues
+		 * with the incomplete line at the end of this one.
+		 */
+		if (step == PRESCAN_SIZE && bend > 0) {
+			pos += bend;
+			partial = false;
+		} else {
+			pos += step;
+			partial = true;
+		}
+	}
+
+	delete[] buf;
+	return ts_errno;
+}
+
+/*
+ * The sched_switch events have the same format in ftrace and in the output of
+ * newer versions of perf:
+ * prev_comm=foo prev_pid=1 prev_prio=120 prev_state=S ==> next_comm=bar ...
+ */
+void TimeWindow::scanSwitchNames(const TString *words, unsigned int n,
+				 QHash<int, QByteArray> *names)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		if (endsWith(&words[i], SWITCH_EVENT_SFIX))
+			break;
+	}
+	if (i >= n)
+		return;
+	for (i++; i < n; i++) {
+		if (!scanComm(words, n, &i, SWITCH_PCOM_PFIX, SWITCH_PPID_PFIX,
+			      names))
+			scanComm(words, n, &i, SWITCH_NCOM_PFIX,
+				 SWITCH_NPID_PFIX, names);
+	}
+}
+
+/*
+ * If the word at *i is a comm field, then the name, which may contain spaces,
+ * is stored with the pid that follows it and *i is moved to the pid field.
+ */
+bool TimeWindow::scanComm(const TString *words, unsigned int n,
+			  unsigned int *i, const char *commKey,
+			  const char *pidKey, QHash<int, QByteArray> *names)
+{
+	int klen = strlen(commKey);
+	int plen = strlen(pidKey);
+	unsigned int j;
+	QByteArray name;
+	QByteArray pidStr;
+	bool ok;
+	int pid;
+
+	if (!beginsWith(&words[*i], commKey))
+		return false;
+	name = QByteArray(words[*i].ptr + klen, words[*i].len - klen);
+	for (j = *i + 1; j < n; j++) {
+		if (beginsWith(&words[j], pidKey))
+			break;
+		name.append(' ');
+		name.append(words[j].ptr, words[j].len);
+	}
+	if (j >= n)
+		return false;
+	pidStr = QByteArray(words[j].ptr + plen, words[j].len - plen);
+	pid = pidStr.toInt(&ok);
+	if (ok && pid > 0 && !name.isEmpty())
+		names->insert(pid, name);
+	*i = j;
+	return true;
+}
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TIMEWINDOW_H
+#define TIMEWINDOW_H
+
+#include <cstdint>
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "misc/tstring.h"
+#include "vtl/time.h"
+
+class TraceFile;
+
+/*
+ * A time window limits the loading of a text trace to the events whose
+ * timestamps are within [start, end]. It is given as "START,END" in seconds,
+ * either of them may be left out, e.g. "1000.5,1002.5" or "1000.5,".
+ *
+ * Since the lines of ftrace and perf text traces are sorted by time, the byte
+ * range of the window can be found with a binary search, where the timestamps
+ * are sampled at line boundaries. Only that byte range is then loaded.
+ */
+class TimeWindow
+{
+public:
+	TimeWindow();
+	int parse(const QString &spec);
+	void clear();
+	bool isEmpty() const;
+	const QString &getSpec() const;
+	int findRange(TraceFile *file, int64_t *rbegin, int64_t *rend) const;
+	int prescanNames(TraceFile *file, int64_t end,
+			 QHash<int, QByteArray> *names) const;
+private:
+	int64_t findOffset(TraceFile *file, const vtl::Time &t, bool inclusive,
+			   char *buf, int *ts_errno) const;
+	bool sampleLine(TraceFile *file, int64_t pos, char *buf,
+			int64_t *lineBegin, vtl::Time *time,
+			int *ts_errno) const;
+	static bool lineTime(const TString *words, unsigned int n,
+			     vtl::Time *time);
+	static void scanSwitchNames(const TString *words, unsigned int n,
+				    QHash<int, QByteArray> *names);
+	static bool scanComm(const TString *words, unsigned int n,
+			     unsigned int *i, const char *commKey,
+			     const char *pidKey, QHash<int, QByteArray> *names);
+	bool hasStart;
+	bool hasEnd;
+	vtl::Time start;
+	vtl::Time end;
+	QString spec;
+};
+
+#endif /* TIMEWINDOW_H */
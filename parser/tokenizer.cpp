@@ -0,0 +1,310 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#include "parser/tokenizer.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__i386__))
+#define TOKENIZER_X86
+#include <immintrin.h>
+#define tokenizer_target(x) __attribute__((target(x)))
+#endif
+
+const char * const Tokenizer::tokenizerNames[] = {
+	"scalar",
+#ifdef TOKENIZER_X86
+	"sse2",
+	"avx2",
+#endif
+	nullptr
+};
+
+#define NR_TOKENIZERS ((int) (sizeof(Tokenizer::tokenizerNames) /	\
+			      sizeof(Tokenizer::tokenizerNames[0]) - 1))
+
+unsigned int Tokenizer::tokenizeScalar(const char *buf, unsigned int pos,
+				       unsigned int end, TString *strings,
+				       unsigned int maxStrings,
+				       unsigned int *next)
+{
+	unsigned int n = 0;
+	unsigned int wbegin = 0;
+	unsigned int p;
+	bool inWord = false;
+	char c;
+
+	for (p = pos; p < end; p++) {
+		c = buf[p];
+		if (c == ' ' || c == '\n') {
+			if (inWord) {
+				strings[n].ptr = (char*) buf + wbegin;
+				strings[n].len = p - wbegin;
+				n++;
+				inWord = false;
+				if (c == '\n' || n == maxStrings)
+					goto out;
+			} else if (c == '\n') {
+				goto out;
+			}
+		} else if (!inWord) {
+			inWord = true;
+			wbegin = p;
+		}
+	}
+	if (inWord) {
+		strings[n].ptr = (char*) buf + wbegin;
+		strings[n].len = end - wbegin;
+		n++;
+	}
+	*next = end;
+	return n;
+out:
+	*next = p + 1;
+	return n;
+}
+
+#ifdef TOKENIZER_X86
+
+/*
+ * The scanners classify a block of bytes and return one bitmask for the
+ * delimiters, i.e. spaces and newlines, and another one for the newlines only.
+ * Bit i corresponds to the byte at offset i.
+ */
+class ScannerSSE2
+{
+public:
+	typedef uint32_t mask_t;
+	static const unsigned int BLOCK_SIZE = 32;
+	tokenizer_target("sse2")
+	static inline void scan(const char *p, mask_t &delim, mask_t &nl) {
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i newline = _mm_set1_epi8('\n');
+		__m128i v0 = _mm_loadu_si128((const __m128i *) p);
+		__m128i v1 = _mm_loadu_si128((const __m128i *) (p + 16));
+		__m128i n0 = _mm_cmpeq_epi8(v0, newline);
+		__m128i n1 = _mm_cmpeq_epi8(v1, newline);
+		__m128i d0 = _mm_or_si128(_mm_cmpeq_epi8(v0, space), n0);
+		__m128i d1 = _mm_or_si128(_mm_cmpeq_epi8(v1, space), n1);
+
+		nl = (mask_t) _mm_movemask_epi8(n0) |
+			((mask_t) _mm_movemask_epi8(n1) << 16);
+		delim = (mask_t) _mm_movemask_epi8(d0) |
+			((mask_t) _mm_movemask_epi8(d1) << 16);
+	}
+	static inline unsigned int ctz(mask_t m) {
+		return __builtin_ctz(m);
+	}
+};
+
+class ScannerAVX2
+{
+public:
+	typedef uint32_t mask_t;
+	static const unsigned int BLOCK_SIZE = 32;
+	tokenizer_target("avx2")
+	static inline void scan(const char *p, mask_t &delim, mask_t &nl) {
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i newline = _mm256_set1_epi8('\n');
+		__m256i v = _mm256_loadu_si256((const __m256i *) p);
+		__m256i n = _mm256_cmpeq_epi8(v, newline);
+		__m256i d = _mm256_or_si256(_mm256_cmpeq_epi8(v, space), n);
+
+		nl = (mask_t) _mm256_movemask_epi8(n);
+		delim = (mask_t) _mm256_movemask_epi8(d);
+	}
+	static inline unsigned int ctz(mask_t m) {
+		return __builtin_ctz(m);
+	}
+};
+
+/*
+ * This does the same as tokenizeScalar() but it classifies a whole block at a
+ * time and then jumps directly between the word boundaries with the help of
+ * the bitmasks. The last block of a buffer is copied, so that we never read
+ * beyond end.
+ */
+template<class Scanner>
+static vtl_always_inline unsigned int
+tokenizeBlocks(const char *buf, unsigned int pos, unsigned int end,
+	       TString *strings, unsigned int maxStrings, unsigned int *next)
+{
+	typedef typename Scanner::mask_t mask_t;
+	const unsigned int bsize = Scanner::BLOCK_SIZE;
+	char tail[Scanner::BLOCK_SIZE];
+	unsigned int n = 0;
+	unsigned int wbegin = 0;
+	unsigned int p;
+	unsigned int lim;
+	unsigned int b;
+	unsigned int i;
+	bool inWord = false;
+	mask_t delim;
+	mask_t nl;
+	mask_t cand;
+
+	for (p = pos; p < end; p += lim) {
+		lim = end - p;
+		if (likely(lim >= bsize)) {
+			lim = bsize;
+			Scanner::scan(buf + p, delim, nl);
+		} else {
+			/* Pad with spaces, they are beyond lim and ignored */
+			memset(tail, ' ', bsize);
+			memcpy(tail, buf + p, lim);
+			Scanner::scan(tail, delim, nl);
+		}
+		b = 0;
+		while (b < lim) {
+			if (!inWord)
+				cand = (~delim | nl) & (~(mask_t) 0 << b);
+			else
+				cand = delim & (~(mask_t) 0 << b);
+			if (cand == 0)
+				break;
+			i = Scanner::ctz(cand);
+			if (i >= lim)
+				break;
+			if (!inWord) {
+				if ((nl >> i) & 1)
+					goto out;
+				inWord = true;
+				wbegin = p + i;
+			} else {
+				strings[n].ptr = (char*) buf + wbegin;
+				strings[n].len = p + i - wbegin;
+				n++;
+				inWord = false;
+				if (((nl >> i) & 1) || n == maxStrings)
+					goto out;
+			}
+			b = i + 1;
+		}
+	}
+	if (inWord) {
+		strings[n].ptr = (char*) buf + wbegin;
+		strings[n].len = end - wbegin;
+		n++;
+	}
+	*next = end;
+	return n;
+out:
+	*next = p + i + 1;
+	return n;
+}
+
+tokenizer_target("sse2")
+static unsigned int tokenizeSSE2(const char *buf, unsigned int pos,
+				 unsigned int end, TString *strings,
+				 unsigned int maxStrings, unsigned int *next)
+{
+	return tokenizeBlocks<ScannerSSE2>(buf, pos, end, strings, maxStrings,
+					   next);
+}
+
+tokenizer_target("avx2")
+static unsigned int tokenizeAVX2(const char *buf, unsigned int pos,
+				 unsigned int end, TString *strings,
+				 unsigned int maxStrings, unsigned int *next)
+{
+	return tokenizeBlocks<ScannerAVX2>(buf, pos, end, strings, maxStrings,
+					   next);
+}
+
+#endif /* TOKENIZER_X86 */
+
+/*
+ * Returns the tokenizer with the given name, or nullptr if it is not available
+ * on this CPU.
+ */
+Tokenizer::tokenize_fn Tokenizer::getTokenizer(const char *name)
+{
+#ifdef TOKENIZER_X86
+	__builtin_cpu_init();
+	if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2"))
+		return tokenizeAVX2;
+	if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2"))
+		return tokenizeSSE2;
+#endif
+	if (strcmp(name, "scalar") == 0)
+		return tokenizeScalar;
+	return nullptr;
+}
+
+/* Select the first available tokenizer, starting with the most advanced */
+Tokenizer::tokenize_fn Tokenizer::selectTokenizer()
+{
+	tokenize_fn fn;
+	int i;
+
+	for (i = NR_TOKENIZERS - 1; i >= 0; i--) {
+		fn = getTokenizer(tokenizerNames[i]);
+		if (fn != nullptr)
+			return fn;
+	}
+	return tokenizeScalar;
+}
+
+const char *Tokenizer::getTokenizerName()
+{
+	int i;
+
+	for (i = NR_TOKENIZERS - 1; i >= 0; i--) {
+		if (getTokenizer(tokenizerNames[i]) == tokenizeFn)
+			return tokenizerNames[i];
+	}
+	return tokenizerNames[0];
+}
+
+Tokenizer::tokenize_fn Tokenizer::tokenizeFn = Tokenizer::selectTokenizer();
@@ -0,0 +1,103 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
+
+/*
+ * This class splits lines of a buffer into words. Words are separated by one
+ * or more spaces and a line is terminated by a newline. There are vectorized
+ * implementations that are selected at runtime, depending on what the CPU
+ * supports, and a scalar fallback that is used everywhere else.
+ */
+class Tokenizer
+{
+public:
+	/*
+	 * Splits the line that begins at pos into at most maxStrings words.
+	 * Words are not allowed to extend beyond end. The position where the
+	 * next call should continue is stored in next, this is end if the end
+	 * was reached. Returns the number of words.
+	 */
+	typedef unsigned int (*tokenize_fn)(const char *buf, unsigned int pos,
+					    unsigned int end,
+					    TString *strings,
+					    unsigned int maxStrings,
+					    unsigned int *next);
+	static vtl_always_inline unsigned int
+		tokenizeLine(const char *buf, unsigned int pos,
+			     unsigned int end, TString *strings,
+			     unsigned int maxStrings, unsigned int *next);
+	static unsigned int tokenizeScalar(const char *buf, unsigned int pos,
+					   unsigned int end, TString *strings,
+					   unsigned int maxStrings,
+					   unsigned int *next);
+	static tokenize_fn getTokenizer(const char *name);
+	static const char *getTokenizerName();
+	static const char * const tokenizerNames[];
+private:
+	static tokenize_fn selectTokenizer();
+	static tokenize_fn tokenizeFn;
+};
+
+vtl_always_inline unsigned int
+Tokenizer::tokenizeLine(const char *buf, unsigned int pos, unsigned int end,
+			TString *strings, unsigned int maxStrings,
+			unsigned int *next)
+{
+	return tokenizeFn(buf, pos, end, strings, maxStrings, next);
+}
+
+#endif /* TOKENIZER_H */
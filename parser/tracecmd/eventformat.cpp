@@ -0,0 +1,577 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstdlib>
+#include <cstring>
+
+#include <QList>
+
+#include "parser/tracecmd/eventformat.h"
+#include "misc/traceshark.h"
+
+#define FIELD_PFIX "field:"
+#define NAME_PFIX "name:"
+#define ID_PFIX "ID:"
+#define PRINT_PFIX "print fmt:"
+#define COMMON_PFIX "common_"
+
+/* The prev_state flags of modern kernels, used if they cannot be parsed */
+static const struct {
+	uint64_t flag;
+	const char *str;
+} default_state_flags[] = {
+	{ 0x01, "S" }, { 0x02, "D" }, { 0x04, "T" }, { 0x08, "t" },
+	{ 0x10, "X" }, { 0x20, "Z" }, { 0x40, "P" }, { 0x80, "I" }
+};
+
+static vtl_always_inline char *append_str(char *c, char *end, const char *s,
+					  int len)
+{
+	int room = end - c;
+
+	if (len > room)
+		len = room;
+	memcpy(c, s, len);
+	return c + len;
+}
+
+static vtl_always_inline char *append_chr(char *c, char *end, char chr)
+{
+	if (c < end)
+		*c++ = chr;
+	return c;
+}
+
+static char *append_uint(char *c, char *end, uint64_t v, int width)
+{
+	char tmp[24];
+	const int tmax = sizeof(tmp);
+	int n = 0;
+
+	do {
+		n++;
+		tmp[tmax - n] = '0' + v % 10;
+		v /= 10;
+	} while (v != 0);
+	while (n < width && n < tmax) {
+		n++;
+		tmp[tmax - n] = '0';
+	}
+	return append_str(c, end, tmp + tmax - n, n);
+}
+
+static char *append_int(char *c, char *end, int64_t v, int width)
+{
+	if (v < 0) {
+		c = append_chr(c, end, '-');
+		return append_uint(c, end, - (uint64_t) v, width);
+	}
+	return append_uint(c, end, (uint64_t) v, width);
+}
+
+static char *append_hex(char *c, char *end, uint64_t v)
+{
+	static const char digits[] = "0123456789abcdef";
+	char tmp[16];
+	const int tmax = sizeof(tmp);
+	int n = 0;
+
+	do {
+		n++;
+		tmp[tmax - n] = digits[v & 0xf];
+		v >>= 4;
+	} while (v != 0);
+	c = append_str(c, end, "0x", 2);
+	return append_str(c, end, tmp + tmax - n, n);
+}
+
+static char *append_elements(char *c, char *end, const char *data,
+			     unsigned int len, unsigned int elemSize,
+			     bool swap)
+{
+	unsigned int i;
+	uint64_t v;
+
+	c = append_chr(c, end, '{');
+	for (i = 0; i + elemSize <= len; i += elemSize) {
+		if (i > 0)
+			c = append_chr(c, end, ',');
+		switch (elemSize) {
+		case sizeof(uint16_t):
+			v = tracecmd_read16(data + i, swap);
+			break;
+		case sizeof(uint32_t):
+			v = tracecmd_read32(data + i, swap);
+			break;
+		case sizeof(uint64_t):
+			v = tracecmd_read64(data + i, swap);
+			break;
+		default:
+			v = (unsigned char) data[i];
+			break;
+		}
+		c = append_hex(c, end, v);
+	}
+	return append_chr(c, end, '}');
+}
+
+/* Returns the unsigned number after pfix on the line, or -1 */
+static long long number_after(const QByteArray &line, const char *pfix)
+{
+	int idx = line.indexOf(pfix);
+	const char *c;
+	char *e;
+	long long v;
+
+	if (idx < 0)
+		return -1;
+	c = line.constData() + idx + strlen(pfix);
+	v = strtoll(c, &e, 0);
+	if (e == c)
+		return -1;
+	return v;
+}
+
+EventField::EventField():
+	offset(0), size(0), arrayLen(0), isSigned(false), relative(false),
+	style(STYLE_UNSIGNED), width(0), arrow(false)
+{}
+
+uint64_t EventField::readUnsigned(const char *data, bool swap) const
+{
+	const char *p = data + offset;
+
+	switch (size) {
+	case sizeof(uint8_t):
+		return (uint8_t) *p;
+	case sizeof(uint16_t):
+		return tracecmd_read16(p, swap);
+	case sizeof(uint32_t):
+		return tracecmd_read32(p, swap);
+	case sizeof(uint64_t):
+		return tracecmd_read64(p, swap);
+	default:
+		return 0;
+	}
+}
+
+int64_t EventField::readSigned(const char *data, bool swap) const
+{
+	const char *p = data + offset;
+
+	switch (size) {
+	case sizeof(int8_t):
+		return (int8_t) *p;
+	case sizeof(int16_t):
+		return (int16_t) tracecmd_read16(p, swap);
+	case sizeof(int32_t):
+		return (int32_t) tracecmd_read32(p, swap);
+	case sizeof(int64_t):
+		return (int64_t) tracecmd_read64(p, swap);
+	default:
+		return 0;
+	}
+}
+
+EventFormat::EventFormat():
+	id(-1), type(EVENT_ERROR), pidOffset(0), pidSize(0), preemptFlag(0)
+{}
+
+/*
+ * Parses all lines of the form below, it's used both for event formats and
+ * for the header_page of the ring buffer:
+ *
+ * field:char prev_comm[16];	offset:8;	size:16;	signed:0;
+ */
+bool EventFormat::parseFields(const char *text, int len,
+			      QVector<EventField> &fields)
+{
+	QList<QByteArray> lines = QByteArray(text, len).split('\n');
+	QList<QByteArray>::const_iterator iter;
+
+	for (iter = lines.begin(); iter != lines.end(); iter++) {
+		const QByteArray &line = *iter;
+		EventField field;
+		QByteArray decl;
+		QByteArray base;
+		long long offset;
+		long long size;
+		long long isSigned;
+		int begin;
+		int semicolon;
+		int bracket;
+		int space;
+
+		begin = line.indexOf(FIELD_PFIX);
+		if (begin < 0)
+			continue;
+		begin += strlen(FIELD_PFIX);
+		semicolon = line.indexOf(';', begin);
+		if (semicolon < 0)
+			return false;
+		decl = line.mid(begin, semicolon - begin).trimmed();
+
+		offset = number_after(line, "offset:");
+		size = number_after(line, "size:");
+		isSigned = number_after(line, "signed:");
+		if (offset < 0 || size < 0)
+			return false;
+		field.offset = (unsigned int) offset;
+		field.size = (unsigned int) size;
+		field.isSigned = isSigned > 0;
+
+		/* A name with a length, as in prev_comm[16] */
+		if (decl.endsWith(']')) {
+			bracket = decl.lastIndexOf('[');
+			if (bracket < 0)
+				return false;
+			field.arrayLen = (unsigned int)
+				atoi(decl.constData() + bracket + 1);
+			if (field.arrayLen == 0)
+				field.arrayLen = 1;
+			decl.truncate(bracket);
+		}
+		space = decl.lastIndexOf(' ');
+		if (space < 0)
+			return false;
+		field.name = decl.mid(space + 1);
+		field.type = decl.left(space).trimmed();
+		while (field.name.startsWith('*')) {
+			field.name.remove(0, 1);
+			field.type.append('*');
+		}
+		if (field.name.isEmpty())
+			return false;
+		field.label = field.name;
+
+		base = field.type;
+		if (base.startsWith("__data_loc") ||
+		    base.startsWith("__rel_loc")) {
+			field.relative = base.startsWith("__rel_loc");
+			field.style = base.contains("char") ?
+				EventField::STYLE_DYNSTRING :
+				EventField::STYLE_DYNARRAY;
+		} else if (field.arrayLen > 0) {
+			field.style = base == "char" ?
+				EventField::STYLE_STRING :
+				EventField::STYLE_ARRAY;
+		} else if (base.contains('*')) {
+			field.style = EventField::STYLE_HEX;
+		} else if (field.isSigned) {
+			field.style = EventField::STYLE_SIGNED;
+		} else {
+			field.style = EventField::STYLE_UNSIGNED;
+		}
+		fields.append(field);
+	}
+	return true;
+}
+
+bool EventFormat::parse(const char *text, int len, const QByteArray &sys)
+{
+	QVector<EventField> allFields;
+	QVector<EventField>::const_iterator iter;
+	QList<QByteArray> lines = QByteArray(text, len).split('\n');
+	QList<QByteArray>::const_iterator liter;
+	long long n;
+
+	system = sys;
+	for (liter = lines.begin(); liter != lines.end(); liter++) {
+		const QByteArray &line = *liter;
+		if (line.startsWith(NAME_PFIX)) {
+			name = line.mid(strlen(NAME_PFIX)).trimmed();
+		} else if (line.startsWith(ID_PFIX)) {
+			n = number_after(line, ID_PFIX);
+			if (n < 0)
+				return false;
+			id = (int) n;
+		}
+	}
+	if (name.isEmpty() || id < 0)
+		return false;
+
+	if (!parseFields(text, len, allFields))
+		return false;
+
+	for (iter = allFields.begin(); iter != allFields.end(); iter++) {
+		if (iter->name.startsWith(COMMON_PFIX)) {
+			if (iter->name == "common_pid") {
+				pidOffset = iter->offset;
+				pidSize = iter->size;
+			}
+			continue;
+		}
+		fields.append(*iter);
+	}
+	setupPrinting(text, len);
+	return true;
+}
+
+/*
+ * The kernel has its own way of printing some of the events that we need to
+ * understand, this tweaks the fields so that formatArgs() will print them
+ * like the kernel would.
+ */
+void EventFormat::setupPrinting(const char *text, int len)
+{
+	QVector<EventField>::iterator iter;
+	QByteArray all(text, len);
+	int idx;
+
+	if (name == "sched_switch") {
+		for (iter = fields.begin(); iter != fields.end(); iter++) {
+			if (iter->name == "prev_state")
+				iter->style = EventField::STYLE_TASKSTATE;
+			else if (iter->name == "next_comm")
+				iter->arrow = true;
+		}
+		idx = all.indexOf(PRINT_PFIX);
+		parseStateFlags(idx < 0 ? "" : all.constData() + idx);
+	} else if (name == "sched_process_fork") {
+		/* The parent_comm and parent_pid are printed as comm and pid */
+		for (iter = fields.begin(); iter != fields.end(); iter++) {
+			if (iter->label.startsWith("parent_"))
+				iter->label.remove(0, strlen("parent_"));
+		}
+	} else if (name == "sched_wakeup" || name == "sched_wakeup_new" ||
+		   name == "sched_waking") {
+		for (iter = fields.begin(); iter != fields.end(); iter++) {
+			if (iter->name == "target_cpu")
+				iter->width = 3;
+		}
+	}
+}
+
+/*
+ * The prev_state of sched_switch is printed with __print_flags() and a table
+ * like { 0x01, "S" }, { 0x02, "D" }, ... that has changed between kernel
+ * versions, so we take the table from the print fmt of the trace. The preempt
+ * flag, printed as '+', is the one after the last flag in the table.
+ */
+void EventFormat::parseStateFlags(const char *fmt)
+{
+	const char *c = strstr(fmt, "__print_flags(");
+	const char *e;
+	char *numend;
+	stateflag_t sf;
+	int i;
+
+	stateFlags.clear();
+	c = c == nullptr ? nullptr : strchr(c, '{');
+	while (c != nullptr) {
+		c++;
+		sf.flag = strtoull(c, &numend, 0);
+		if (numend == c)
+			break;
+		c = numend;
+		while (*c == ' ' || *c == ',')
+			c++;
+		if (*c != '"')
+			break;
+		c++;
+		e = strchr(c, '"');
+		if (e == nullptr)
+			break;
+		sf.str = QByteArray(c, e - c);
+		c = strchr(e, '}');
+		if (c == nullptr)
+			break;
+		stateFlags.append(sf);
+		c++;
+		while (*c == ' ')
+			c++;
+		if (*c != ',')
+			break;
+		c++;
+		while (*c == ' ')
+			c++;
+		if (*c != '{')
+			break;
+	}
+
+	if (stateFlags.isEmpty()) {
+		for (i = 0; i < (int) arraylen(default_state_flags); i++) {
+			sf.flag = default_state_flags[i].flag;
+			sf.str = QByteArray(default_state_flags[i].str);
+			stateFlags.append(sf);
+		}
+	}
+
+	preemptFlag = 0;
+	for (i = 0; i < stateFlags.size(); i++)
+		preemptFlag = TSMAX(preemptFlag, stateFlags[i].flag);
+	preemptFlag <<= 1;
+}
+
+int EventFormat::formatState(uint64_t state, char *c, char *end) const
+{
+	char *begin = c;
+	uint64_t v = state & (preemptFlag - 1);
+	bool first = true;
+	int i;
+
+	if (v == 0) {
+		c = append_chr(c, end, 'R');
+	} else {
+		for (i = 0; i < stateFlags.size(); i++) {
+			const stateflag_t &sf = stateFlags[i];
+			if (sf.flag == 0 || (v & sf.flag) != sf.flag)
+				continue;
+			if (!first)
+				c = append_chr(c, end, '|');
+			c = append_str(c, end, sf.str.constData(),
+				       sf.str.size());
+			v &= ~sf.flag;
+			first = false;
+		}
+		if (v != 0) {
+			if (!first)
+				c = append_chr(c, end, '|');
+			c = append_hex(c, end, v);
+		}
+	}
+	if ((state & preemptFlag) != 0)
+		c = append_chr(c, end, '+');
+	return c - begin;
+}
+
+/*
+ * Prints the fields of the event record in data as "name=value" into buf and
+ * splits the result into args at spaces, in the same way as the tokenizer does
+ * with a text trace. The return value is the number of args.
+ */
+int EventFormat::formatArgs(const char *data, unsigned int size, bool swap,
+			    char *buf, int bufSize, TString *args,
+			    int maxArgs) const
+{
+	char *c = buf;
+	char *end = buf + bufSize;
+	char *p;
+	unsigned int loc;
+	unsigned int locOffset;
+	unsigned int locLen;
+	int n;
+	QVector<EventField>::const_iterator iter;
+
+	for (iter = fields.begin(); iter != fields.end(); iter++) {
+		const EventField &field = *iter;
+		if (field.offset + field.size > size)
+			break;
+		if (field.arrow)
+			c = append_str(c, end, "==> ", 4);
+		c = append_str(c, end, field.label.constData(),
+			       field.label.size());
+		c = append_chr(c, end, '=');
+		switch (field.style) {
+		case EventField::STYLE_SIGNED:
+			c = append_int(c, end, field.readSigned(data, swap),
+				       field.width);
+			break;
+		case EventField::STYLE_UNSIGNED:
+			c = append_uint(c, end, field.readUnsigned(data, swap),
+					field.width);
+			break;
+		case EventField::STYLE_HEX:
+			c = append_hex(c, end, field.readUnsigned(data, swap));
+			break;
+		case EventField::STYLE_STRING:
+			c = append_str(c, end, data + field.offset,
+				       strnlen(data + field.offset,
+					       field.size));
+			break;
+		case EventField::STYLE_ARRAY:
+			c = append_elements(c, end, data + field.offset,
+					    field.size,
+					    field.size / field.arrayLen, swap);
+			break;
+		case EventField::STYLE_DYNSTRING:
+		case EventField::STYLE_DYNARRAY:
+			loc = tracecmd_read32(data + field.offset, swap);
+			locOffset = loc & 0xffff;
+			locLen = loc >> 16;
+			if (field.relative)
+				locOffset += field.offset + field.size;
+			if (locOffset + locLen > size)
+				break;
+			if (field.style == EventField::STYLE_DYNSTRING)
+				c = append_str(c, end, data + locOffset,
+					       strnlen(data + locOffset,
+						       locLen));
+			else
+				c = append_elements(c, end, data + locOffset,
+						    locLen, 1, swap);
+			break;
+		case EventField::STYLE_TASKSTATE:
+			c += formatState(field.readUnsigned(data, swap),
+					 c, end);
+			break;
+		default:
+			break;
+		}
+		c = append_chr(c, end, ' ');
+	}
+
+	n = 0;
+	p = buf;
+	while (p < c && n < maxArgs) {
+		while (p < c && *p == ' ')
+			p++;
+		if (p == c)
+			break;
+		args[n].ptr = p;
+		while (p < c && *p != ' ')
+			p++;
+		args[n].len = p - args[n].ptr;
+		n++;
+	}
+	return n;
+}
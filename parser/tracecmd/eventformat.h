@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTFORMAT_H
+#define EVENTFORMAT_H
+
+#include <cstdint>
+#include <cstring>
+
+#include <QByteArray>
+#include <QVector>
+
+#include "misc/tstring.h"
+#include "misc/types.h"
+#include "vtl/compiler.h"
+
+/*
+ * These read an integer from the binary trace data, which may have been
+ * recorded on a machine with the other endianness. The data is not assumed to
+ * be aligned.
+ */
+static vtl_always_inline uint16_t tracecmd_read16(const char *p, bool swap)
+{
+	uint16_t v;
+	memcpy(&v, p, sizeof(v));
+	return swap ? __builtin_bswap16(v) : v;
+}
+
+static vtl_always_inline uint32_t tracecmd_read32(const char *p, bool swap)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return swap ? __builtin_bswap32(v) : v;
+}
+
+static vtl_always_inline uint64_t tracecmd_read64(const char *p, bool swap)
+{
+	uint64_t v;
+	memcpy(&v, p, sizeof(v));
+	return swap ? __builtin_bswap64(v) : v;
+}
+
+static vtl_always_inline bool tracecmd_host_is_bigendian()
+{
+	const uint16_t v = 1;
+	return *((const char*) &v) == 0;
+}
+
+/*
+ * This describes one field of a tracepoint, as it is given by a line like this
+ * in the format file of the tracepoint:
+ *
+ * field:char prev_comm[16];	offset:8;	size:16;	signed:0;
+ */
+class EventField
+{
+public:
+	typedef enum : int {
+		STYLE_SIGNED = 0,
+		STYLE_UNSIGNED,
+		STYLE_HEX,
+		STYLE_STRING,
+		STYLE_DYNSTRING,
+		STYLE_ARRAY,
+		STYLE_DYNARRAY,
+		STYLE_TASKSTATE
+	} style_t;
+	EventField();
+	uint64_t readUnsigned(const char *data, bool swap) const;
+	int64_t readSigned(const char *data, bool swap) const;
+	QByteArray name;
+	QByteArray type;
+	/* The name that is used when the field is printed */
+	QByteArray label;
+	unsigned int offset;
+	unsigned int size;
+	unsigned int arrayLen;
+	bool isSigned;
+	/* A __rel_loc field is relative to the end of the field itself */
+	bool relative;
+	style_t style;
+	/* The minimum number of digits printed, zero padded */
+	int width;
+	/* Whether an "==>" is printed before this field, as in sched_switch */
+	bool arrow;
+};
+
+/*
+ * This is a parsed event format descriptor, as found in
+ * /sys/kernel/tracing/events/<system>/<event>/format and stored in the
+ * trace.dat and perf.data files. It is used to print the fields of a binary
+ * event record as the arguments of the TraceEvent, in the same way as the
+ * kernel prints them in the text trace, so that the analyzer doesn't need to
+ * know where the event came from.
+ */
+class EventFormat
+{
+public:
+	EventFormat();
+	bool parse(const char *text, int len, const QByteArray &sys);
+	static bool parseFields(const char *text, int len,
+				QVector<EventField> &fields);
+	int formatArgs(const char *data, unsigned int size, bool swap,
+		       char *buf, int bufSize, TString *args,
+		       int maxArgs) const;
+	vtl_always_inline int getPid(const char *data, unsigned int size,
+				     bool swap) const;
+	int id;
+	QByteArray name;
+	QByteArray system;
+	/* These are the non-common fields, in the order they were declared */
+	QVector<EventField> fields;
+	/* The event type, this is set by the user of this class */
+	event_t type;
+private:
+	typedef struct {
+		uint64_t flag;
+		QByteArray str;
+	} stateflag_t;
+	void setupPrinting(const char *text, int len);
+	void parseStateFlags(const char *fmt);
+	int formatState(uint64_t state, char *c, char *end) const;
+	unsigned int pidOffset;
+	unsigned int pidSize;
+	QVector<stateflag_t> stateFlags;
+	uint64_t preemptFlag;
+};
+
+vtl_always_inline int EventFormat::getPid(const char *data,
+					  unsigned int size, bool swap) const
+{
+	if (pidOffset + pidSize > size)
+		return 0;
+	if (pidSize == sizeof(uint32_t))
+		return (int) tracecmd_read32(data + pidOffset, swap);
+	if (pidSize == sizeof(uint16_t))
+		return (int16_t) tracecmd_read16(data + pidOffset, swap);
+	return 0;
+}
+
+#endif /* EVENTFORMAT_H */
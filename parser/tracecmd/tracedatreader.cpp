@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include "parser/ftrace/ftracegrammar.h"
+#include "parser/tracecmd/tracedatreader.h"
+#include "parser/tracefile.h"
+#include "misc/errors.h"
+#include "misc/traceshark.h"
+#include "threads/indexwatcher.h"
+
+#define SECTION_NAME_LEN (10)
+#define SECTION_OPTIONS "options  "
+#define SECTION_LATENCY "latency  "
+#define SECTION_FLYRECORD "flyrecord"
+
+/* The number of ring buffer pages that are read at a time for each CPU */
+#define READ_PAGES (16)
+
+/* The size of the buffer where the arguments of an event are printed */
+#define ARGBUF_SIZE (16384)
+
+/*
+ * The event header of the ring buffer, see include/linux/ring_buffer.h in the
+ * Linux kernel sources. The type_len is the 5 least significant bits with a
+ * little endian kernel.
+ */
+#define TYPE_LEN_BITS (5)
+#define TYPE_LEN_MASK ((1 << TYPE_LEN_BITS) - 1)
+#define TIME_DELTA_BITS (27)
+#define TIME_DELTA_MASK ((1 << TIME_DELTA_BITS) - 1)
+#define TYPE_PADDING (29)
+#define TYPE_TIME_EXTEND (30)
+#define TYPE_TIME_STAMP (31)
+#define COMMIT_MASK ((1 << 27) - 1)
+
+/* This is what trace-cmd report shows for tasks without a saved cmdline */
+#define UNKNOWN_TASK "<...>"
+#define IDLE_TASK "<idle>"
+
+TraceDatReader::TraceDatReader(TraceFile *file):
+	traceFile(file), ts_errno(0)
+{
+	argPool = new InternPool<>(2048, 1024 * 1024);
+	namePool = new InternPool<>(1024, 65536);
+	argBuf = new char[ARGBUF_SIZE];
+	argStrings = new TString[EVENT_MAX_NR_ARGS];
+}
+
+TraceDatReader::~TraceDatReader()
+{
+	clearStreams();
+	delete argPool;
+	delete namePool;
+	delete[] argBuf;
+	delete[] argStrings;
+}
+
+void TraceDatReader::clearStreams()
+{
+	int i;
+
+	for (i = 0; i < streams.size(); i++) {
+		delete[] streams[i]->buf;
+		delete streams[i];
+	}
+	streams.clear();
+	heap.clear();
+}
+
+bool TraceDatReader::isTraceDat(TraceFile *file)
+{
+	char magic[TRACINGDATA_MAGIC_LEN];
+	int ts_errno;
+
+	if (file->readAt(0, magic, TRACINGDATA_MAGIC_LEN, &ts_errno) !=
+	    TRACINGDATA_MAGIC_LEN)
+		return false;
+	return memcmp(magic, TRACINGDATA_MAGIC, TRACINGDATA_MAGIC_LEN) == 0;
+}
+
+/*
+ * The options contain things like the trace clock and the uname of the
+ * machine, none of which we need.
+ */
+int TraceDatReader::parseOptions()
+{
+	uint16_t option;
+	uint32_t size;
+	int r;
+
+	while (true) {
+		r = tracingData.readU16(option);
+		if (r != 0)
+			return r;
+		if (option == 0)
+			return 0;
+		r = tracingData.readU32(size);
+		if (r != 0)
+			return r;
+		r = tracingData.skip(size);
+		if (r != 0)
+			return r;
+	}
+}
+
+int TraceDatReader::open()
+{
+	char section[SECTION_NAME_LEN];
+	uint32_t nrCpus;
+	uint32_t cpu;
+	uint64_t offset;
+	uint64_t size;
+	int64_t fileSize = traceFile->getFileSize();
+	unsigned int pageSize;
+	CpuStream *stream;
+	int r;
+
+	r = tracingData.parse(traceFile, 0, fileSize);
+	if (r != 0)
+		return r;
+	r = tracingData.parseCmdlines();
+	if (r != 0)
+		return r;
+	r = tracingData.readU32(nrCpus);
+	if (r != 0)
+		return r;
+
+	r = tracingData.read(section, SECTION_NAME_LEN);
+	if (r != 0)
+		return r;
+	if (!memcmp(section, SECTION_OPTIONS, SECTION_NAME_LEN)) {
+		r = parseOptions();
+		if (r != 0)
+			return r;
+		r = tracingData.read(section, SECTION_NAME_LEN);
+		if (r != 0)
+			return r;
+	}
+	/* A latency trace is in text format, it cannot be read here */
+	if (memcmp(section, SECTION_FLYRECORD, SECTION_NAME_LEN))
+		return -TS_ERROR_FILEFORMAT;
+
+	pageSize = tracingData.pageSize;
+	for (cpu = 0; cpu < nrCpus; cpu++) {
+		r = tracingData.readU64(offset);
+		if (r != 0)
+			return r;
+		r = tracingData.readU64(size);
+		if (r != 0)
+			return r;
+		/* Read what there is, if the recording was interrupted */
+		if (offset > (uint64_t) fileSize)
+			size = 0;
+		else
+			size = TSMIN(size, (uint64_t) fileSize - offset);
+		if (size == 0)
+			continue;
+		stream = new CpuStream();
+		stream->cpu = cpu;
+		stream->fileOffset = (int64_t) offset;
+		stream->fileEnd = (int64_t) (offset + size);
+		stream->bufSize = (unsigned int)
+			TSMIN((uint64_t) pageSize * READ_PAGES, size);
+		stream->buf = new char[stream->bufSize];
+		stream->bufLen = 0;
+		stream->page = 0;
+		stream->pos = 0;
+		stream->pageEnd = 0;
+		stream->timestamp = 0;
+		stream->data = nullptr;
+		stream->size = 0;
+		streams.append(stream);
+	}
+	return 0;
+}
+
+/*
+ * Moves to the next page of the stream. The pages are read READ_PAGES at a
+ * time, because there will be a lot of them.
+ */
+bool TraceDatReader::nextPage(CpuStream *stream)
+{
+	const unsigned int pageSize = tracingData.pageSize;
+	const unsigned int dataOffset = tracingData.pageDataOffset;
+	unsigned int avail;
+	uint64_t commit;
+	ssize_t r;
+	int64_t len;
+	char *page;
+
+	if (stream->bufLen > 0)
+		stream->page += pageSize;
+	if (stream->page >= stream->bufLen) {
+		len = TSMIN((int64_t) stream->bufSize,
+			    stream->fileEnd - stream->fileOffset);
+		if (len <= 0)
+			return false;
+		r = traceFile->readAt(stream->fileOffset, stream->buf,
+				      (size_t) len, &ts_errno);
+		if (r <= 0)
+			return false;
+		stream->fileOffset += r;
+		stream->bufLen = (unsigned int) r;
+		stream->page = 0;
+	}
+
+	avail = TSMIN(pageSize, stream->bufLen - stream->page);
+	if (avail <= dataOffset)
+		return false;
+	page = stream->buf + stream->page;
+	stream->timestamp = tracingData.pageTimestamp.readUnsigned(
+		page, tracingData.swap);
+	commit = tracingData.pageCommit.readUnsigned(page, tracingData.swap);
+	commit &= COMMIT_MASK;
+	stream->pos = stream->page + dataOffset;
+	stream->pageEnd = stream->pos +
+		(unsigned int) TSMIN(commit, (uint64_t) avail - dataOffset);
+	return true;
+}
+
+/*
+ * Moves to the next event of the stream. This follows what the kbuffer of
+ * libtraceevent does, so that we get the same timestamps as trace-cmd report.
+ */
+bool TraceDatReader::nextEvent(CpuStream *stream)
+{
+	const bool swap = tracingData.swap;
+	const bool bigEndian = swap != tracecmd_host_is_bigendian();
+	uint32_t header;
+	uint32_t typeLen;
+	uint32_t delta;
+	uint32_t len;
+	uint64_t extend;
+	const char *p;
+
+	while (true) {
+		if (stream->pos + sizeof(uint32_t) > stream->pageEnd) {
+			if (!nextPage(stream))
+				return false;
+			continue;
+		}
+		p = stream->buf + stream->pos;
+		header = tracecmd_read32(p, swap);
+		if (bigEndian) {
+			typeLen = header >> TIME_DELTA_BITS;
+			delta = header & TIME_DELTA_MASK;
+		} else {
+			typeLen = header & TYPE_LEN_MASK;
+			delta = header >> TYPE_LEN_BITS;
+		}
+		p += sizeof(uint32_t);
+		stream->pos += sizeof(uint32_t);
+
+		/* All the types below have a 32-bit word after the header */
+		if (typeLen >= TYPE_PADDING || typeLen == 0) {
+			if (stream->pos + sizeof(uint32_t) > stream->pageEnd) {
+				stream->pos = stream->pageEnd;
+				continue;
+			}
+		}
+
+		switch (typeLen) {
+		case TYPE_PADDING:
+			/* A zero delta means that the rest of page is unused */
+			if (delta == 0) {
+				stream->pos = stream->pageEnd;
+				continue;
+			}
+			len = tracecmd_read32(p, swap);
+			stream->pos += len;
+			stream->timestamp += delta;
+			continue;
+		case TYPE_TIME_EXTEND:
+			extend = tracecmd_read32(p, swap);
+			stream->pos += sizeof(uint32_t);
+			stream->timestamp += (extend << TIME_DELTA_BITS) +
+				delta;
+			continue;
+		case TYPE_TIME_STAMP:
+			extend = tracecmd_read32(p, swap);
+			stream->pos += sizeof(uint32_t);
+			stream->timestamp = (extend << TIME_DELTA_BITS) + delta;
+			continue;
+		case 0:
+			len = tracecmd_read32(p, swap);
+			if (len < sizeof(uint32_t)) {
+				stream->pos = stream->pageEnd;
+				continue;
+			}
+			len = (len - sizeof(uint32_t) + 3) & ~3;
+			p += sizeof(uint32_t);
+			stream->pos += sizeof(uint32_t);
+			break;
+		default:
+			len = typeLen * sizeof(uint32_t);
+			break;
+		}
+		stream->timestamp += delta;
+		if (len > stream->pageEnd - stream->pos) {
+			/* This would be a corrupt page */
+			stream->pos = stream->pageEnd;
+			continue;
+		}
+		stream->data = p;
+		stream->size = len;
+		stream->pos += len;
+		return true;
+	}
+}
+
+vtl_always_inline bool TraceDatReader::isBefore(const CpuStream *a,
+						const CpuStream *b)
+{
+	return a->timestamp < b->timestamp ||
+		(a->timestamp == b->timestamp && a->cpu < b->cpu);
+}
+
+void TraceDatReader::heapPush(CpuStream *stream)
+{
+	int i = heap.size();
+	int parent;
+	CpuStream *tmp;
+
+	heap.append(stream);
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!isBefore(heap[i], heap[parent]))
+			break;
+		tmp = heap[i];
+		heap[i] = heap[parent];
+		heap[parent] = tmp;
+		i = parent;
+	}
+}
+
+void TraceDatReader::heapSiftDown(int i)
+{
+	const int s = heap.size();
+	int child;
+	CpuStream *tmp;
+
+	while (true) {
+		child = 2 * i + 1;
+		if (child >= s)
+			break;
+		if (child + 1 < s && isBefore(heap[child + 1], heap[child]))
+			child++;
+		if (!isBefore(heap[child], heap[i]))
+			break;
+		tmp = heap[i];
+		heap[i] = heap[child];
+		heap[child] = tmp;
+		i = child;
+	}
+}
+
+vtl_always_inline uint32_t TraceDatReader::getTaskName(int pid)
+{
+	uint32_t name;
+	QByteArray comm;
+	TString ts;
+
+	name = taskNames.value(pid, STRINGTABLE_NO_ID);
+	if (name != STRINGTABLE_NO_ID)
+		return name;
+
+	if (pid == 0)
+		comm = QByteArray(IDLE_TASK);
+	else
+		comm = tracingData.cmdlines.value(pid, QByteArray(UNKNOWN_TASK));
+	ts.ptr = comm.data();
+	ts.len = comm.size();
+	name = namePool->allocId(&ts, 0);
+	taskNames.insert(pid, name);
+	return name;
+}
+
+vtl_always_inline void TraceDatReader::decodeEvent(const CpuStream *stream,
+						   vtl::TList<TraceEvent>
+						   *events,
+						   EventStrings *strings,
+						   FtraceGrammar *grammar)
+{
+	const bool swap = tracingData.swap;
+	EventFormat *format;
+	uint32_t str;
+	TString name;
+	int argc;
+	int i;
+
+	if (stream->size < sizeof(uint16_t))
+		return;
+	/* The common_type field is always first */
+	format = tracingData.getFormat(tracecmd_read16(stream->data, swap));
+	if (format == nullptr)
+		return;
+	if (format->type == EVENT_ERROR) {
+		name.ptr = format->name.data();
+		name.len = format->name.size();
+		format->type = grammar->addEventType(&name);
+		if (format->type == EVENT_ERROR)
+			return;
+	}
+	if (!grammar->retention.retain(format->type, grammar->eventTree))
+		return;
+
+	TraceEvent &event = events->preAlloc();
+	event.argv.offset = strings->beginArgs();
+	argc = format->formatArgs(stream->data, stream->size, swap, argBuf,
+				  ARGBUF_SIZE, argStrings, EVENT_MAX_NR_ARGS);
+	for (i = 0; i < argc; i++) {
+		str = argPool->allocId(&argStrings[i], 16);
+		if (str == STRINGTABLE_NO_ID)
+			break;
+		strings->addArg(str);
+	}
+	event.argc = i;
+	strings->commitArgs();
+
+	event.type = format->type;
+	event.pid = format->getPid(stream->data, stream->size, swap);
+	event.taskNameId = getTaskName(event.pid);
+	event.cpu = stream->cpu;
+	event.time = vtl::Time((vtl::Time::timeint_t) stream->timestamp, 9);
+	event.intArg = 0;
+	event.postEventInfo = nullptr;
+	events->commit();
+}
+
+/*
+ * Decodes all events, in timestamp order, into the events list. The watcher
+ * is notified every now and then so that the analyzer can start to process the
+ * events that have been decoded, but it's up to the caller to send the final
+ * index and EOF.
+ */
+int TraceDatReader::readEvents(vtl::TList<TraceEvent> *events,
+			       EventStrings *strings, FtraceGrammar *grammar,
+			       IndexWatcher *watcher)
+{
+	CpuStream *stream;
+	unsigned long nr = 0;
+	int i;
+
+	argPool->setStringTable(&strings->table);
+	namePool->setStringTable(&strings->table);
+
+	for (i = 0; i < streams.size(); i++) {
+		if (nextEvent(streams[i]))
+			heapPush(streams[i]);
+	}
+
+	while (!heap.isEmpty()) {
+		stream = heap[0];
+		decodeEvent(stream, events, strings, grammar);
+		if (!nextEvent(stream)) {
+			heap[0] = heap.last();
+			heap.removeLast();
+		}
+		if (!heap.isEmpty())
+			heapSiftDown(0);
+		nr++;
+		if ((nr & 0xffff) == 0)
+			watcher->sendNextIndex(events->size());
+	}
+	clearStreams();
+	return ts_errno;
+}
@@ -0,0 +1,140 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACEDATREADER_H
+#define TRACEDATREADER_H
+
+#include <cstdint>
+
+#include <QHash>
+#include <QVector>
+
+#include "mm/internpool.h"
+#include "mm/mempool.h"
+#include "parser/eventstrings.h"
+#include "parser/tracecmd/tracingdata.h"
+#include "parser/traceevent.h"
+#include "misc/tstring.h"
+#include "vtl/compiler.h"
+#include "vtl/tlist.h"
+
+class FtraceGrammar;
+class IndexWatcher;
+class TraceFile;
+
+/*
+ * This reads the binary trace.dat files that are written by trace-cmd record,
+ * so that they don't need to be converted to text with trace-cmd report. The
+ * file contains the tracing data, which is parsed by TracingData, followed by
+ * the raw ring buffer pages of each CPU. The events of the CPUs are merged by
+ * timestamp and their fields are printed as arguments with the help of the
+ * event formats, so that the events look the same as if they had been parsed
+ * from the text output of trace-cmd report by FtraceGrammar.
+ *
+ * Only version 6 of the file format is supported, which is what trace-cmd
+ * writes by default.
+ */
+class TraceDatReader
+{
+public:
+	TraceDatReader(TraceFile *file);
+	~TraceDatReader();
+	static bool isTraceDat(TraceFile *file);
+	int open();
+	int readEvents(vtl::TList<TraceEvent> *events, EventStrings *strings,
+		       FtraceGrammar *grammar, IndexWatcher *watcher);
+private:
+	class CpuStream {
+	public:
+		unsigned int cpu;
+		/* The part of the file that has not been read yet */
+		int64_t fileOffset;
+		int64_t fileEnd;
+		char *buf;
+		unsigned int bufSize;
+		unsigned int bufLen;
+		/* Offsets into buf */
+		unsigned int page;
+		unsigned int pos;
+		unsigned int pageEnd;
+		/* The current event */
+		uint64_t timestamp;
+		const char *data;
+		unsigned int size;
+	};
+	int parseOptions();
+	bool nextPage(CpuStream *stream);
+	bool nextEvent(CpuStream *stream);
+	vtl_always_inline void decodeEvent(const CpuStream *stream,
+					   vtl::TList<TraceEvent> *events,
+					   EventStrings *strings,
+					   FtraceGrammar *grammar);
+	vtl_always_inline uint32_t getTaskName(int pid);
+	vtl_always_inline static bool isBefore(const CpuStream *a,
+					       const CpuStream *b);
+	void heapPush(CpuStream *stream);
+	void heapSiftDown(int i);
+	void clearStreams();
+	TraceFile *traceFile;
+	TracingData tracingData;
+	QVector<CpuStream*> streams;
+	/* A min heap of the streams that have events left */
+	QVector<CpuStream*> heap;
+	InternPool<> *argPool;
+	InternPool<> *namePool;
+	QHash<int, uint32_t> taskNames;
+	char *argBuf;
+	TString *argStrings;
+	int ts_errno;
+};
+
+#endif /* TRACEDATREADER_H */
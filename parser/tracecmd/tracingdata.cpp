@@ -0,0 +1,389 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+#include <QList>
+
+#include "parser/tracecmd/tracingdata.h"
+#include "parser/tracefile.h"
+#include "misc/errors.h"
+
+/* These limits are only there to detect files that are obviously corrupt */
+#define MAX_STRING_LEN (4096)
+#define MIN_PAGE_SIZE (256)
+#define MAX_PAGE_SIZE (64 * 1024 * 1024)
+#define MAX_EVENT_ID (65535)
+
+/* Versions newer than this have a different layout after the page size */
+#define MAX_VERSION (6)
+
+TracingData::TracingData():
+	swap(false), longSize(0), pageSize(0), pageDataOffset(0), pos(0),
+	traceFile(nullptr), fileEnd(0)
+{}
+
+TracingData::~TracingData()
+{
+	clear();
+}
+
+void TracingData::clear()
+{
+	int i;
+
+	for (i = 0; i < formats.size(); i++)
+		delete formats[i];
+	formats.clear();
+	formatById.clear();
+	cmdlines.clear();
+	version.clear();
+}
+
+int TracingData::read(char *buf, int64_t len)
+{
+	ssize_t r;
+	int ts_errno;
+
+	if (len < 0 || len > fileEnd - pos)
+		return -TS_ERROR_EOF;
+	r = traceFile->readAt(pos, buf, (size_t) len, &ts_errno);
+	if (r < 0)
+		return ts_errno;
+	if (r != len)
+		return -TS_ERROR_EOF;
+	pos += len;
+	return 0;
+}
+
+int TracingData::readU16(uint16_t &v)
+{
+	char buf[sizeof(uint16_t)];
+	int ts_errno = read(buf, sizeof(buf));
+
+	if (ts_errno == 0)
+		v = tracecmd_read16(buf, swap);
+	return ts_errno;
+}
+
+int TracingData::readU32(uint32_t &v)
+{
+	char buf[sizeof(uint32_t)];
+	int ts_errno = read(buf, sizeof(buf));
+
+	if (ts_errno == 0)
+		v = tracecmd_read32(buf, swap);
+	return ts_errno;
+}
+
+int TracingData::readU64(uint64_t &v)
+{
+	char buf[sizeof(uint64_t)];
+	int ts_errno = read(buf, sizeof(buf));
+
+	if (ts_errno == 0)
+		v = tracecmd_read64(buf, swap);
+	return ts_errno;
+}
+
+int TracingData::skip(int64_t len)
+{
+	if (len < 0 || len > fileEnd - pos)
+		return -TS_ERROR_EOF;
+	pos += len;
+	return 0;
+}
+
+/* Reads a null terminated string */
+int TracingData::readString(QByteArray &str)
+{
+	char buf[64];
+	int64_t n;
+	ssize_t r;
+	const char *nul;
+	int ts_errno;
+
+	str.clear();
+	while (str.size() < MAX_STRING_LEN) {
+		n = TSMIN((int64_t) sizeof(buf), fileEnd - pos);
+		if (n <= 0)
+			return -TS_ERROR_EOF;
+		r = traceFile->readAt(pos, buf, (size_t) n, &ts_errno);
+		if (r < 0)
+			return ts_errno;
+		if (r == 0)
+			return -TS_ERROR_EOF;
+		nul = (const char*) memchr(buf, '\0', r);
+		if (nul != nullptr) {
+			str.append(buf, nul - buf);
+			pos += nul - buf + 1;
+			return 0;
+		}
+		str.append(buf, r);
+		pos += r;
+	}
+	return -TS_ERROR_FILEFORMAT;
+}
+
+int TracingData::readSection(QByteArray &data, int64_t len)
+{
+	if (len < 0 || len > fileEnd - pos || len > INT_MAX)
+		return -TS_ERROR_EOF;
+	data.resize((int) len);
+	return read(data.data(), len);
+}
+
+int TracingData::parseHeaderPage(const QByteArray &text)
+{
+	QVector<EventField> fields;
+	int i;
+	bool hasCommit = false;
+	bool hasData = false;
+
+	if (!EventFormat::parseFields(text.constData(), text.size(), fields))
+		return -TS_ERROR_FILEFORMAT;
+
+	for (i = 0; i < fields.size(); i++) {
+		const EventField &field = fields[i];
+		if (field.name == "timestamp") {
+			pageTimestamp = field;
+		} else if (field.name == "commit") {
+			pageCommit = field;
+			hasCommit = true;
+		} else if (field.name == "data") {
+			pageDataOffset = field.offset;
+			hasData = true;
+		}
+	}
+
+	if (!hasCommit || !hasData || pageDataOffset >= pageSize ||
+	    pageTimestamp.size != sizeof(uint64_t))
+		return -TS_ERROR_FILEFORMAT;
+	return 0;
+}
+
+int TracingData::parseFormats(const QByteArray &system, unsigned int count)
+{
+	unsigned int i;
+	uint64_t size;
+	QByteArray text;
+	EventFormat *format;
+	int ts_errno;
+
+	for (i = 0; i < count; i++) {
+		ts_errno = readU64(size);
+		if (ts_errno != 0)
+			return ts_errno;
+		ts_errno = readSection(text, (int64_t) size);
+		if (ts_errno != 0)
+			return ts_errno;
+		format = new EventFormat();
+		/*
+		 * A format that we don't understand is not fatal, the events
+		 * of that type will simply be ignored.
+		 */
+		if (!format->parse(text.constData(), text.size(), system) ||
+		    format->id > MAX_EVENT_ID) {
+			delete format;
+			continue;
+		}
+		formats.append(format);
+		if (format->id >= formatById.size())
+			formatById.resize(format->id + 1);
+		formatById[format->id] = format;
+	}
+	return 0;
+}
+
+int TracingData::parse(TraceFile *file, int64_t offset, int64_t end)
+{
+	char magic[TRACINGDATA_MAGIC_LEN];
+	char c;
+	QByteArray name;
+	QByteArray text;
+	uint64_t size64;
+	uint32_t size32;
+	uint32_t count;
+	uint32_t nrSystems;
+	uint32_t i;
+	int ts_errno;
+
+	clear();
+	traceFile = file;
+	pos = offset;
+	fileEnd = end;
+
+	ts_errno = read(magic, TRACINGDATA_MAGIC_LEN);
+	if (ts_errno != 0)
+		return ts_errno;
+	if (memcmp(magic, TRACINGDATA_MAGIC, TRACINGDATA_MAGIC_LEN) != 0)
+		return -TS_ERROR_FILEFORMAT;
+
+	/* This is "6" for trace.dat files and "0.6" or "0.5" for perf.data */
+	ts_errno = readString(version);
+	if (ts_errno != 0)
+		return ts_errno;
+	if (atoi(version.constData()) > MAX_VERSION)
+		return -TS_ERROR_NEWFORMAT;
+
+	ts_errno = read(&c, 1);
+	if (ts_errno != 0)
+		return ts_errno;
+	swap = (c != 0) != tracecmd_host_is_bigendian();
+	ts_errno = read(&c, 1);
+	if (ts_errno != 0)
+		return ts_errno;
+	longSize = (unsigned char) c;
+	ts_errno = readU32(pageSize);
+	if (ts_errno != 0)
+		return ts_errno;
+	if (pageSize < MIN_PAGE_SIZE || pageSize > MAX_PAGE_SIZE)
+		return -TS_ERROR_FILEFORMAT;
+
+	ts_errno = readString(name);
+	if (ts_errno != 0)
+		return ts_errno;
+	if (name != "header_page")
+		return -TS_ERROR_FILEFORMAT;
+	ts_errno = readU64(size64);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = readSection(text, (int64_t) size64);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = parseHeaderPage(text);
+	if (ts_errno != 0)
+		return ts_errno;
+
+	/*
+	 * The header_event only describes the event header of the ring
+	 * buffer, which hasn't changed since it was introduced.
+	 */
+	ts_errno = readString(name);
+	if (ts_errno != 0)
+		return ts_errno;
+	if (name != "header_event")
+		return -TS_ERROR_FILEFORMAT;
+	ts_errno = readU64(size64);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = skip((int64_t) size64);
+	if (ts_errno != 0)
+		return ts_errno;
+
+	ts_errno = readU32(count);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = parseFormats(QByteArray("ftrace"), count);
+	if (ts_errno != 0)
+		return ts_errno;
+
+	ts_errno = readU32(nrSystems);
+	if (ts_errno != 0)
+		return ts_errno;
+	for (i = 0; i < nrSystems; i++) {
+		ts_errno = readString(name);
+		if (ts_errno != 0)
+			return ts_errno;
+		ts_errno = readU32(count);
+		if (ts_errno != 0)
+			return ts_errno;
+		ts_errno = parseFormats(name, count);
+		if (ts_errno != 0)
+			return ts_errno;
+	}
+
+	/* We don't need the kallsyms and the printk formats */
+	ts_errno = readU32(size32);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = skip(size32);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = readU32(size32);
+	if (ts_errno != 0)
+		return ts_errno;
+	return skip(size32);
+}
+
+/*
+ * The saved command lines, one "pid comm" per line. Note that the comm may
+ * contain spaces.
+ */
+int TracingData::parseCmdlines()
+{
+	uint64_t size;
+	QByteArray text;
+	QList<QByteArray> lines;
+	QList<QByteArray>::const_iterator iter;
+	int space;
+	int ts_errno;
+
+	ts_errno = readU64(size);
+	if (ts_errno != 0)
+		return ts_errno;
+	ts_errno = readSection(text, (int64_t) size);
+	if (ts_errno != 0)
+		return ts_errno;
+
+	lines = text.split('\n');
+	for (iter = lines.begin(); iter != lines.end(); iter++) {
+		const QByteArray &line = *iter;
+		space = line.indexOf(' ');
+		if (space <= 0)
+			continue;
+		cmdlines.insert(atoi(line.constData()), line.mid(space + 1));
+	}
+	return 0;
+}
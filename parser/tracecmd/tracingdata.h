@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TRACINGDATA_H
+#define TRACINGDATA_H
+
+#include <cstdint>
+
+#include <QByteArray>
+#include <QHash>
+#include <QVector>
+
+#include "parser/tracecmd/eventformat.h"
+#include "vtl/compiler.h"
+
+class TraceFile;
+
+#define TRACINGDATA_MAGIC "\027\010\104tracing"
+#define TRACINGDATA_MAGIC_LEN (10)
+
+/*
+ * This parses the "tracing data" that begins with the magic above. It is the
+ * beginning of a trace.dat file written by trace-cmd and it's also stored in
+ * the HEADER_TRACING_DATA section of a perf.data file. It contains the
+ * endianness, the page size and the layout of the ring buffer pages, the format
+ * descriptors of all the events, and optionally the saved command lines of the
+ * tasks.
+ *
+ * The data is read from the file as it is parsed, the current position is in
+ * pos, so that the user of this class can continue to parse whatever follows
+ * after the tracing data.
+ */
+class TracingData
+{
+public:
+	TracingData();
+	~TracingData();
+	int parse(TraceFile *file, int64_t offset, int64_t end);
+	int parseCmdlines();
+	void clear();
+	int read(char *buf, int64_t len);
+	int readU16(uint16_t &v);
+	int readU32(uint32_t &v);
+	int readU64(uint64_t &v);
+	int skip(int64_t len);
+	vtl_always_inline EventFormat *getFormat(int id) const;
+	QByteArray version;
+	bool swap;
+	unsigned int longSize;
+	unsigned int pageSize;
+	/* The layout of the ring buffer pages, from the header_page */
+	EventField pageTimestamp;
+	EventField pageCommit;
+	unsigned int pageDataOffset;
+	QHash<int, QByteArray> cmdlines;
+	int64_t pos;
+private:
+	int readString(QByteArray &str);
+	int readSection(QByteArray &data, int64_t len);
+	int parseHeaderPage(const QByteArray &text);
+	int parseFormats(const QByteArray &system, unsigned int count);
+	TraceFile *traceFile;
+	int64_t fileEnd;
+	QVector<EventFormat*> formats;
+	QVector<EventFormat*> formatById;
+};
+
+vtl_always_inline EventFormat *TracingData::getFormat(int id) const
+{
+	if (id < 0 || id >= formatById.size())
+		return nullptr;
+	return formatById[id];
+}
+
+#endif /* TRACINGDATA_H */
@@ -58,10 +58,6 @@
 /* TSHARK_ITEM_ is used by the TRACEEVENT_DEFS_ macro */
 #undef TSHARK_ITEM_
 #define TSHARK_ITEM_(A, B) B
-/*
- * The maximum length of these strings should be in the macro
- * EVENTSTRINGS_MAXLEN, which is defined misc/types.h
- */
 const char * const eventstrings[] = {
 	TRACEEVENTS_DEFS_
 };
@@ -79,6 +75,18 @@ const StringTree<> *TraceEvent::getStringTree()
 	return stringTree;
 }
 
+const EventStrings *TraceEvent::eventStrings = nullptr;
+
+void TraceEvent::setEventStrings(const EventStrings *strings)
+{
+	eventStrings = strings;
+}
+
+const EventStrings *TraceEvent::getEventStrings()
+{
+	return eventStrings;
+}
+
 const TString *TraceEvent::getEventName() const
 {
 	return stringTree->stringLookup(TraceEvent::type);
@@ -86,14 +94,14 @@ const TString *TraceEvent::getEventName() const
 
 void TraceEvent::clear()
 {
-	taskName = nullptr;
+	taskNameId = STRINGTABLE_NO_ID;
 	pid = 0;
 	cpu = 0;
+	type = EVENT_ERROR;
 	time = VTL_TIME_ZERO;
 	intArg = 0;
-	type = EVENT_ERROR;
-	argv = nullptr;
 	argc = 0;
+	argv.offset = 0;
 	postEventInfo = nullptr;
 }
 
@@ -54,6 +54,7 @@
 #define TRACEEVENT_H
 
 #include "mm/stringtree.h"
+#include "parser/eventstrings.h"
 #include "parser/traceline.h"
 #include "misc/tstring.h"
 #include "misc/types.h"
@@ -138,14 +139,32 @@ class Chunk;
 
 class TraceEvent {
 public:
-	const TString *taskName;
+	/*
+	 * The arguments are stored in the EventStrings of the trace, starting
+	 * at offset. This can be indexed like an array of TString pointers.
+	 */
+	class ArgVector {
+	public:
+		uint64_t offset;
+		vtl_always_inline const TString *operator[](int i) const;
+	};
+	/* The id of the task name in the EventStrings, see getTaskName() */
+	uint32_t taskNameId;
 	int pid;
 	unsigned int cpu;
-	vtl::Time time;
-	int intArg;
 	event_t type;
-	const TString **argv;
+	vtl::CompactTime time;
+	int intArg;
 	int argc;
+	/*
+	 * If argc is ARGC_LAZY, then the arguments have not been stored but
+	 * argSpan tells where in the trace file they are, so that they can be
+	 * tokenized again when needed, see the ArgCache class.
+	 */
+	union {
+		ArgVector argv;
+		uint64_t argSpan;
+	};
 
 	/*
 	 * postEventInfo most likely will contain a backtrace that will occur
@@ -157,18 +176,78 @@ public:
 	Chunk *postEventInfo;
 
 	const TString *getEventName() const;
+	vtl_always_inline const TString *getTaskName() const;
 	void clear();
+	vtl_always_inline bool setLazyArgs(int64_t offset, int64_t len);
+	vtl_always_inline bool hasLazyArgs() const;
+	vtl_always_inline int64_t lazyArgsOffset() const;
+	vtl_always_inline unsigned int lazyArgsLen() const;
+	static const int ARGC_LAZY = -1;
+	static const int LAZY_LEN_BITS = 16;
+	static const int64_t LAZY_MAX_OFFSET = (INT64_C(1) <<
+						(64 - LAZY_LEN_BITS)) - 1;
+	static const int64_t LAZY_MAX_LEN = (INT64_C(1) << LAZY_LEN_BITS) - 1;
 	static const TString *getEventName(event_t event);
 	static void setStringTree(StringTree<> *sTree);
 	static const StringTree<> *getStringTree();
+	static void setEventStrings(const EventStrings *strings);
+	static const EventStrings *getEventStrings();
 	static int getNrEvents();
 private:
 	/* This is supposed to be set to the stringtree that was involved in
 	 * the parsing of the events, so that it can used to translate from
 	 * event_t to event name */
 	static StringTree<> *stringTree;
+	/*
+	 * Likewise, this is supposed to be set to the strings of the parsed
+	 * events, so that the ids of the task names and the arguments can be
+	 * translated to strings.
+	 */
+	static const EventStrings *eventStrings;
 };
 
+vtl_always_inline const TString *TraceEvent::ArgVector::operator[](int i)
+	const
+{
+	return eventStrings->getArg(offset + i);
+}
+
+vtl_always_inline const TString *TraceEvent::getTaskName() const
+{
+	if (taskNameId == STRINGTABLE_NO_ID)
+		return nullptr;
+	return eventStrings->getString(taskNameId);
+}
+
+/*
+ * Returns false if the span cannot be represented, in which case the caller
+ * should store the arguments as usual.
+ */
+vtl_always_inline bool TraceEvent::setLazyArgs(int64_t offset, int64_t len)
+{
+	if (offset < 0 || offset > LAZY_MAX_OFFSET || len < 0 ||
+	    len > LAZY_MAX_LEN)
+		return false;
+	argSpan = ((uint64_t) offset << LAZY_LEN_BITS) | (uint64_t) len;
+	argc = ARGC_LAZY;
+	return true;
+}
+
+vtl_always_inline bool TraceEvent::hasLazyArgs() const
+{
+	return argc == ARGC_LAZY;
+}
+
+vtl_always_inline int64_t TraceEvent::lazyArgsOffset() const
+{
+	return (int64_t) (argSpan >> LAZY_LEN_BITS);
+}
+
+vtl_always_inline unsigned int TraceEvent::lazyArgsLen() const
+{
+	return (unsigned int) (argSpan & LAZY_MAX_LEN);
+}
+
 extern const char * const eventstrings[];
 
 #endif /* TRACEEVENT_H */
@@ -50,6 +50,7 @@
  *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "parser/perf/perfdatareader.h"
 #include "parser/tracefile.h"
 #include "parser/traceline.h"
 #include "threads/loadthread.h"
@@ -59,6 +60,7 @@
 #include "vtl/compiler.h"
 #include "vtl/error.h"
 #include <QtGlobal>
+#include <cstring>
 #include <new>
 
 extern "C" {
@@ -75,17 +77,47 @@ vtl_always_inline static int clib_close(int fd)
 	return close(fd);
 }
 
-TraceFile::TraceFile(char *name, int &ts_errno, unsigned int bsize)
+/*
+ * The file is loaded from rbegin up to, but not including, rend. If bsize is
+ * zero, then no load buffers are allocated and nothing is loaded; the
+ * TraceFile can then only be used to access chunks of the file. If mapped is
+ * true, then the load buffers will point directly into a read-only mapping of
+ * the file, instead of being filled with read(). The file is loaded into nbuf
+ * buffers of bsize bytes in a round robin fashion. A compressed file is
+ * decompressed by the load thread and it is never mapped. If follow is true,
+ * then the loading continues with what is appended to the file, until
+ * stopFollowing() is called; this is only possible with an uncompressed regular
+ * file that is loaded with read().
+ */
+TraceFile::TraceFile(char *name, int &ts_errno, unsigned int bsize,
+		     int64_t rbegin, int64_t rend, bool mapped,
+		     unsigned int nbuf, bool follow)
 	: fd_is_open(false), bufferSwitch(false), nRead(0), lastBuf(0),
-	  lastPos(0), endOfLine(false), mappedFile(nullptr), fileSize(0)
+	  lastPos(0), mappedFile(nullptr), fileSize(0), nrBuffers(nbuf),
+	  loadThread(nullptr), rangeBegin(rbegin), rangeEnd(rend),
+	  compressed(nullptr), following(false)
 {
 	unsigned int i;
+	CompressedFile::compression_t ctype;
 
 	fd = open(name, O_RDONLY);
 	if (fd >= 0) {
 		fd_is_open = true;
 		fileInfo.saveStat(fd, &ts_errno);
 		fileSize = fileInfo.getFileSize();
+		ctype = CompressedFile::detect(fd);
+		if (ts_errno == 0 && ctype != CompressedFile::COMPRESSION_NONE) {
+			if (CompressedFile::isSupported(ctype)) {
+				compressed = new CompressedFile(fd, ctype,
+								fileSize);
+				mapped = false;
+			} else {
+				ts_errno = - TS_ERROR_COMPRESSED;
+			}
+		}
+		following = follow && bsize > 0 && !mapped &&
+			compressed == nullptr &&
+			S_ISREG(fileInfo.getStat().st_mode);
 	} else {
 		if (errno != 0)
 			ts_errno = errno;
@@ -93,10 +125,19 @@ TraceFile::TraceFile(char *name, int &ts_errno, unsigned int bsize)
 			ts_errno = - TS_ERROR_ERROR;
 	}
 
-	for (i = 0; i < NR_BUFFERS; i++) {
-		loadBuffers[i] = new LoadBuffer(bsize);
+	loadBuffers = new LoadBuffer*[nrBuffers];
+	for (i = 0; i < nrBuffers; i++)
+		loadBuffers[i] = nullptr;
+	if (bsize > 0) {
+		for (i = 0; i < nrBuffers; i++)
+			loadBuffers[i] = new LoadBuffer(bsize);
+		/* A mapping can only cover what exists when we start */
+		if (mapped)
+			rend = TSMIN(rend, fileSize);
+		loadThread = new LoadThread(loadBuffers, nrBuffers, fd,
+					    rbegin, rend, mapped, compressed,
+					    following);
 	}
-	loadThread = new LoadThread(loadBuffers, NR_BUFFERS, fd);
 	/*
 	 * Don't start thread if something failed earlier, we go this far in
 	 * order to avoid problems in the destructor
@@ -105,7 +146,7 @@ TraceFile::TraceFile(char *name, int &ts_errno, unsigned int bsize)
 			      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
 	if (buffer == MAP_FAILED)
 		mmap_err();
-	if (ts_errno != 0)
+	if (ts_errno != 0 || loadThread == nullptr)
 		return;
 	loadThread->start();
 }
@@ -113,10 +154,14 @@ TraceFile::TraceFile(char *name, int &ts_errno, unsigned int bsize)
 TraceFile::~TraceFile()
 {
 	unsigned int i;
-	loadThread->wait();
-	delete loadThread;
-	for (i = 0; i < NR_BUFFERS; i++)
+	if (loadThread != nullptr) {
+		loadThread->wait();
+		delete loadThread;
+	}
+	for (i = 0; i < nrBuffers; i++)
 		delete loadBuffers[i];
+	delete[] loadBuffers;
+	delete compressed;
 	if (munmap(buffer, BUFFER_SIZE) != 0)
 		munmap_err();
 }
@@ -136,9 +181,56 @@ void TraceFile::close(int *ts_errno)
 	}
 }
 
+void TraceFile::stopFollowing()
+{
+	if (following && loadThread != nullptr)
+		loadThread->stopFollowing();
+}
+
+/* This may be called from any thread, see LoadThread::stopLoading() */
+void TraceFile::stopLoading()
+{
+	if (loadThread != nullptr)
+		loadThread->stopLoading();
+}
+
+/*
+ * Gets the number of bytes that have been loaded so far and the number of
+ * bytes that will be loaded in total. This may be called from any thread.
+ * Returns false if the total is not known, which is the case with compressed
+ * and followed files.
+ */
+bool TraceFile::getLoadProgress(int64_t *loaded, int64_t *total) const
+{
+	if (loadThread == nullptr || compressed != nullptr || following)
+		return false;
+	*total = TSMIN(rangeEnd, fileSize) - rangeBegin;
+	*loaded = loadThread->getLoadPos() - rangeBegin;
+	return *total > 0;
+}
+
+/*
+ * Returns the position in the file where the loading ended. This waits for the
+ * load thread, so it must only be called when the loading has ended, i.e. when
+ * the last buffer has been consumed.
+ */
+int64_t TraceFile::getLoadEnd()
+{
+	if (loadThread == nullptr)
+		return 0;
+	loadThread->wait();
+	return loadThread->getLoadEnd();
+}
+
 bool TraceFile::isIntact(int *ts_errno)
 {
 	bool intact;
+	int i;
+
+	for (i = 0; i < mergedFiles.size(); i++) {
+		if (!mergedFiles[i]->isIntact(ts_errno))
+			return false;
+	}
 
 	intact = fileInfo.cmpStat(fd, ts_errno);
 	if (*ts_errno != 0)
@@ -147,8 +239,86 @@ bool TraceFile::isIntact(int *ts_errno)
 	return intact;
 }
 
+/*
+ * This makes the TraceFile read the chunks from the files of a trace that has
+ * been merged from several files, the file field of a chunk is the index of
+ * its file in files. The TraceFile doesn't own the files.
+ */
+void TraceFile::setMergedFiles(const QVector<TraceFile*> &files)
+{
+	mergedFiles = files;
+}
+
+/*
+ * Reads up to size bytes from offset, without disturbing the file position that
+ * is used by the load thread. Returns the number of bytes read, which is
+ * smaller than size only if the end of the file was reached, or -1 on error.
+ * With a compressed file, the offset is in the decompressed data.
+ */
+ssize_t TraceFile::readAt(int64_t offset, char *buf, size_t size,
+			  int *ts_errno)
+{
+	size_t count = 0;
+	ssize_t r;
+
+	if (compressed != nullptr)
+		return compressed->readAt(offset, buf, size, ts_errno);
+
+	*ts_errno = 0;
+	while (count < size) {
+		r = pread(fd, buf + count, size - count,
+			  (off_t) (offset + count));
+		if (r < 0) {
+			if (errno == EINTR)
+				continue;
+			if (errno != 0)
+				*ts_errno = errno;
+			else
+				*ts_errno = - TS_ERROR_ERROR;
+			return -1;
+		}
+		if (r == 0)
+			break;
+		count += r;
+	}
+	return count;
+}
+
+/*
+ * Returns the offset of the first line that begins at or after pos, or the
+ * size of the file if there is no such line.
+ */
+int64_t TraceFile::findLineBegin(int64_t pos, int *ts_errno)
+{
+	ssize_t r;
+	char *c;
+	int64_t size = getFileSize();
+
+	*ts_errno = 0;
+	if (pos <= 0)
+		return 0;
+	/* Start with the previous character, pos may be the begin of a line */
+	pos--;
+	while (pos < size) {
+		r = readAt(pos, buffer, BUFFER_SIZE, ts_errno);
+		if (r <= 0)
+			break;
+		c = (char*) memchr(buffer, '\n', r);
+		if (c != nullptr)
+			return pos + (c - buffer) + 1;
+		pos += r;
+	}
+	return size;
+}
+
 bool TraceFile::allocMmap()
 {
+	/*
+	 * The chunks of a compressed file are always decompressed by readAt()
+	 * and a mapping of a growing file would not cover what is appended.
+	 */
+	if (compressed != nullptr || following)
+		return false;
 	mappedFile = (char*) mmap(nullptr, fileSize, PROT_READ,
 				  MAP_PRIVATE, fd, 0);
 	if (mappedFile == MAP_FAILED) {
@@ -157,7 +327,7 @@ bool TraceFile::allocMmap()
 		 * that case we record the failure by setting mappedFile to
 		 * nullptr, then readChunk() and getChunkArray() will use
 		 * the fallback readChunk_() and getChunkArray_() functions,
-		 * which uses lseek64() and read() to obtain the desired chunks.
+		 * which use readAt() to obtain the desired chunks.
 		 */
 		mappedFile = nullptr;
 		return false;
@@ -174,20 +344,66 @@ void TraceFile::freeMmap()
 	mappedFile = nullptr;
 }
 
-void TraceFile::readChunk(const Chunk *chunk, char *buf, int size,
-			  int *ts_errno)
+/*
+ * A callchain from a perf.data file is read as binary data and formatted as
+ * text, so that it can be used in the same way as a text chunk.
+ */
+QByteArray TraceFile::getCallchainArray(const Chunk *chunk, int *ts_errno)
 {
+	QByteArray raw;
+	ssize_t r;
+
+	raw.resize(chunk->len);
+	r = readAt(chunk->offset, raw.data(), chunk->len, ts_errno);
+	if (*ts_errno != 0)
+		return QByteArray();
+	if (r != chunk->len) {
+		*ts_errno = - TS_ERROR_EOF;
+		return QByteArray();
+	}
+	return PerfDataReader::formatCallchain(raw.constData(), raw.size(),
+					       chunk->type ==
+					       CHUNK_CALLCHAIN_SWAP);
+}
+
+/*
+ * Copies at most size bytes of the chunk to buf and returns the number of
+ * bytes that were copied.
+ */
+int TraceFile::readChunk(const Chunk *chunk, char *buf, int size,
+			 int *ts_errno)
+{
+	QByteArray array;
 	int64_t s;
+
+	if (!mergedFiles.isEmpty()) {
+		if (chunk->file < 0 || chunk->file >= mergedFiles.size()) {
+			*ts_errno = - TS_ERROR_INTERNAL;
+			return 0;
+		}
+		return mergedFiles[chunk->file]->readChunk(chunk, buf, size,
+							   ts_errno);
+	}
+
+	if (chunk->type != CHUNK_TEXT) {
+		array = getCallchainArray(chunk, ts_errno);
+		if (*ts_errno != 0)
+			return 0;
+		s = TSMIN(size, array.size());
+		memcpy(buf, array.constData(), s);
+		return (int) s;
+	}
+	s = TSMIN(size, chunk->len);
 	if (mappedFile == nullptr) {
 		readChunk_(chunk, buf, size, ts_errno);
-		return;
+		return (int) s;
 	}
-	s = TSMIN(size, chunk->len);
 	if (chunk->offset + s > fileSize) {
 		*ts_errno = - TS_ERROR_EOF;
-		return;
+		return 0;
 	}
-	strncpy(buf, mappedFile + chunk->offset, chunk->len);
+	strncpy(buf, mappedFile + chunk->offset, s);
+	return (int) s;
 }
 
 QByteArray TraceFile::getChunkArray(const Chunk *chunk, int *ts_errno)
@@ -195,6 +411,18 @@ QByteArray TraceFile::getChunkArray(const Chunk *chunk, int *ts_errno)
 	char *buf;
 	QByteArray rval;
 
+	if (!mergedFiles.isEmpty()) {
+		if (chunk->file < 0 || chunk->file >= mergedFiles.size()) {
+			*ts_errno = - TS_ERROR_INTERNAL;
+			return rval;
+		}
+		return mergedFiles[chunk->file]->getChunkArray(chunk,
+							       ts_errno);
+	}
+
+	if (chunk->type != CHUNK_TEXT)
+		return getCallchainArray(chunk, ts_errno);
+
 	if (mappedFile == nullptr) {
 		return getChunkArray_(chunk, ts_errno);
 	}
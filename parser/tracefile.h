@@ -64,7 +64,9 @@
 #include "threads/loadbuffer.h"
 #include "threads/threadbuffer.h"
 #include "mm/mempool.h"
+#include "parser/compress/compressedfile.h"
 #include "parser/fileinfo.h"
+#include "parser/tokenizer.h"
 #include "parser/traceline.h"
 #include "misc/chunk.h"
 #include "misc/errors.h"
@@ -76,7 +78,11 @@ class LoadThread;
 class TraceFile
 {
 public:
-	TraceFile(char *name, int &ts_errno, unsigned int bsize = 1024 * 1024);
+	TraceFile(char *name, int &ts_errno, unsigned int bsize = 1024 * 1024,
+		  int64_t rbegin = 0, int64_t rend = INT64_MAX,
+		  bool mapped = false,
+		  unsigned int nbuf = DEFAULT_NR_BUFFERS,
+		  bool follow = false);
 	~TraceFile();
 	void close(int *ts_errno);
 	vtl_always_inline unsigned int
@@ -86,128 +92,82 @@ public:
 	vtl_always_inline void clearBufferSwitch();
 	FileInfo fileInfo;
 	vtl_always_inline LoadBuffer *getLoadBuffer(int index) const;
+	vtl_always_inline unsigned int getNrBuffers() const;
 	QByteArray getChunkArray(const Chunk *chunk,
 						 int *ts_errno);
 	bool isIntact(int *ts_errno);
-	void readChunk(const Chunk *chunk, char *buf, int size,
-				       int *ts_errno);
+	int readChunk(const Chunk *chunk, char *buf, int size,
+		      int *ts_errno);
 	vtl_always_inline int64_t getFileSize();
+	vtl_always_inline bool isCompressed() const;
+	ssize_t readAt(int64_t offset, char *buf, size_t size, int *ts_errno);
+	int64_t findLineBegin(int64_t pos, int *ts_errno);
 	bool allocMmap();
 	void freeMmap();
+	vtl_always_inline bool isFollowing() const;
+	void stopFollowing();
+	void stopLoading();
+	int64_t getLoadEnd();
+	bool getLoadProgress(int64_t *loaded, int64_t *total) const;
+	void setMergedFiles(const QVector<TraceFile*> &files);
+	static const unsigned int DEFAULT_NR_BUFFERS = 4;
 private:
+	QByteArray getCallchainArray(const Chunk *chunk, int *ts_errno);
 	vtl_always_inline QByteArray getChunkArray_(const Chunk *chunk,
 						    int *ts_errno);
 	vtl_always_inline void readChunk_(const Chunk *chunk, char *buf,
 					  int size, int *ts_errno);
 	vtl_always_inline unsigned int nextBufferIdx(unsigned int n);
-	vtl_always_inline unsigned int
-		ReadNextWord(char **word, ThreadBuffer<TraceLine> *tbuffer);
-	vtl_always_inline bool
-		CheckBufferSwitch(unsigned int pos,
-				  ThreadBuffer<TraceLine> *tbuffer);
 	int fd;
 	bool fd_is_open;
 	bool bufferSwitch;
 	unsigned int nRead;
 	unsigned lastBuf;
 	unsigned lastPos;
-	bool endOfLine;
 	char *mappedFile;
 	int64_t fileSize;
-	static const unsigned int NR_BUFFERS = 4;
-	LoadBuffer *loadBuffers[NR_BUFFERS];
+	unsigned int nrBuffers;
+	LoadBuffer **loadBuffers;
 	LoadThread *loadThread;
+	/* The range of the file that is loaded, end is exclusive */
+	int64_t rangeBegin;
+	int64_t rangeEnd;
+	CompressedFile *compressed;
+	/* The file is growing, so fileSize is only the size when it was opened */
+	bool following;
+	/* The files of a merged trace, the chunks are read from these */
+	QVector<TraceFile*> mergedFiles;
 	char *buffer;
 	static const int BUFFER_SIZE = 131072;
 };
 
 
-vtl_always_inline bool TraceFile::CheckBufferSwitch(unsigned int pos,
-						    ThreadBuffer<TraceLine>
-						    *tbuffer)
-{
-	LoadBuffer *loadBuffer = tbuffer->loadBuffer;
-	if (unlikely(pos >= loadBuffer->nRead)) {
-		lastPos = 0;
-		bufferSwitch = true;
-		endOfLine = true;
-		return true;
-	}
-	return false;
-}
-
-vtl_always_inline unsigned int
-TraceFile::ReadNextWord(char **word, ThreadBuffer<TraceLine> *tbuffer)
-{
-	unsigned int pos = lastPos;
-	unsigned int nchar = 0;
-	char c;
-	char *buffer = tbuffer->loadBuffer->buffer;
-
-	if (endOfLine)
-		return 0;
-
-	for (c = buffer[pos]; c == ' '; c = buffer[pos]) {
-		pos++;
-		if (unlikely(CheckBufferSwitch(pos, tbuffer)))
-			return 0;
-	}
-
-	if (c == '\n') {
-		pos++;
-		if (likely(!CheckBufferSwitch(pos, tbuffer)))
-			lastPos = pos;
-		return 0;
-	}
-
-	*word = buffer + pos;
-	pos++;
-
-	while (true) {
-		nchar++;
-		if (unlikely(CheckBufferSwitch(pos, tbuffer)))
-			break;
-		c = buffer[pos];
-		if (c == ' ' || c == '\n')
-			break;
-		pos++;
-	}
-	if (c == '\n')
-		endOfLine = true;
-	/*
-	 * This can be out otside of the buffer, in case hit the break
-	 * above but we have that spare page
-	 */
-	buffer[pos] = '\0';
-	pos++;
-	if (unlikely(CheckBufferSwitch(pos, tbuffer)))
-		return nchar;
-	lastPos = pos;
-	return nchar;
-}
-
 vtl_always_inline unsigned int
 TraceFile::ReadLine(TraceLine *line, ThreadBuffer<TraceLine> *tbuffer)
 {
-	unsigned int col;
+	LoadBuffer *loadBuffer = tbuffer->loadBuffer;
 	unsigned int n;
-	/* This is a setup needed by ReadNextWord() */
-	endOfLine = false;
+	unsigned int next;
 
 	line->strings = (TString*)
 		tbuffer->strPool->preallocN(EVENT_MAX_NR_ARGS);
-	line->begin = tbuffer->loadBuffer->filePos + lastPos;
+	line->begin = loadBuffer->filePos + lastPos;
+	line->ptr = loadBuffer->buffer + lastPos;
 
-	for(col = 0; col < EVENT_MAX_NR_ARGS; col++) {
-		n = ReadNextWord(&line->strings[col].ptr, tbuffer);
-		if (n == 0)
-			break;
-		line->strings[col].len = n;
+	n = Tokenizer::tokenizeLine(loadBuffer->buffer, lastPos,
+				    loadBuffer->nRead, line->strings,
+				    EVENT_MAX_NR_ARGS, &next);
+	if (n > 0)
+		tbuffer->strPool->commitN(n);
+	line->nStrings = n;
+
+	if (unlikely(next >= loadBuffer->nRead)) {
+		lastPos = 0;
+		bufferSwitch = true;
+	} else {
+		lastPos = next;
 	}
-	if (col > 0)
-		tbuffer->strPool->commitN(col);
-	line->nStrings = col;
-	return col;
+	return n;
 }
 
 vtl_always_inline bool TraceFile::getBufferSwitch() const
@@ -223,7 +183,7 @@ vtl_always_inline void TraceFile::clearBufferSwitch()
 vtl_always_inline unsigned int TraceFile::nextBufferIdx(unsigned int n)
 {
 	n++;
-	if (n == NR_BUFFERS)
+	if (n == nrBuffers)
 		n = 0;
 	return n;
 }
@@ -233,12 +193,15 @@ vtl_always_inline LoadBuffer *TraceFile::getLoadBuffer(int index) const
 	return loadBuffers[index];
 }
 
+vtl_always_inline unsigned int TraceFile::getNrBuffers() const
+{
+	return nrBuffers;
+}
+
 vtl_always_inline QByteArray TraceFile::getChunkArray_(const Chunk *chunk,
 						       int *ts_errno)
 {
 	char *buf;
-	size_t count;
-	char *b;
 	ssize_t r;
 	QByteArray rval;
 
@@ -248,37 +211,14 @@ vtl_always_inline QByteArray TraceFile::getChunkArray_(const Chunk *chunk,
 		buf = new char[chunk->len];
 	}
 
-	if (lseek64(fd, chunk->offset, SEEK_SET) != chunk->offset) {
-		if (errno != 0)
-			*ts_errno = errno;
-		else
-			*ts_errno = - TS_ERROR_ERROR;
+	r = readAt(chunk->offset, buf, chunk->len, ts_errno);
+	if (r < 0)
+		goto out;
+	if (r != chunk->len) {
+		*ts_errno = - TS_ERROR_EOF;
 		goto out;
-	}
-
-	count = chunk->len;
-	b = buf;
-
-	while (count > 0) {
-		r = read(fd, b, count);
-		if (r < 0) {
-			if (errno == EINTR)
-				continue;
-			if (errno != 0)
-				*ts_errno = errno;
-			else
-				*ts_errno = - TS_ERROR_ERROR;
-			goto out;
-		}
-		if (r == 0) {
-			*ts_errno = - TS_ERROR_EOF;
-			goto out;
-		}
-		b += r;
-		count -= r;
 	}
 	rval = QByteArray(buf, chunk->len);
-	*ts_errno = 0;
 
 out:
 	if (buf != buffer) {
@@ -292,44 +232,33 @@ vtl_always_inline void TraceFile::readChunk_(const Chunk *chunk, char *buf,
 					     int size, int *ts_errno)
 {
 	size_t count;
-	char *b;
 	ssize_t r;
 
-	if (lseek64(fd, chunk->offset, SEEK_SET) != chunk->offset) {
-		if (errno != 0)
-			*ts_errno = errno;
-		else
-			*ts_errno = - TS_ERROR_ERROR;
-		return;
-	}
-
 	count = TSMIN(chunk->len, size);
-	b = buf;
-
-	while (count > 0) {
-		r = read(fd, b, count);
-		if (r < 0) {
-			if (errno == EINTR)
-				continue;
-			if (errno != 0)
-				*ts_errno = errno;
-			else
-				*ts_errno = - TS_ERROR_ERROR;
-			return;
-		}
-		if (r == 0) {
-			*ts_errno = - TS_ERROR_EOF;
-			return;
-		}
-		b += r;
-		count -= r;
-	}
-	*ts_errno = 0;
+	r = readAt(chunk->offset, buf, count, ts_errno);
+	if (r >= 0 && (size_t) r != count)
+		*ts_errno = - TS_ERROR_EOF;
 }
 
+/*
+ * The size of a compressed file is the size of the decompressed data. It may
+ * be necessary to decompress the whole file in order to find it out.
+ */
 int64_t TraceFile::getFileSize()
 {
+	if (compressed != nullptr)
+		return compressed->getSize();
 	return fileSize;
 }
 
+vtl_always_inline bool TraceFile::isCompressed() const
+{
+	return compressed != nullptr;
+}
+
+vtl_always_inline bool TraceFile::isFollowing() const
+{
+	return following;
+}
+
 #endif
@@ -62,6 +62,8 @@ public:
 	TString *strings;
 	unsigned int nStrings;
 	int64_t begin;
+	/* The beginning of the line in the buffer that was tokenized */
+	const char *ptr;
 };
 
 #endif
@@ -62,7 +62,7 @@ class TraceEvent;
 class TraceLineData {
 public:
 	vtl_always_inline void clear();
-	vtl::Time prevTime;
+	vtl::CompactTime prevTime;
 	bool prevLineIsEvent;
 	TraceEvent *prevEvent;
 	int64_t infoBegin;
@@ -56,36 +56,74 @@
 #include <cstdio>
 #include <limits>
 
+#include <QThread>
+
 #include "misc/tstring.h"
 #include "parser/genericparams.h"
 #include "mm/mempool.h"
+#include "parser/chunkparser.h"
+#include "parser/eventcache.h"
 #include "parser/ftrace/ftracegrammar.h"
+#include "parser/perf/perfdatareader.h"
 #include "parser/perf/perfgrammar.h"
+#include "parser/retentionpolicy.h"
+#include "parser/tracecmd/tracedatreader.h"
 #include "parser/tracefile.h"
 #include "parser/traceparser.h"
+#include "parser/tracesniffer.h"
+#include "parser/timewindow.h"
 #include "misc/errors.h"
 #include "misc/chunk.h"
 #include "misc/traceshark.h"
 #include "threads/indexwatcher.h"
 #include "threads/threadbuffer.h"
+#include "vtl/error.h"
 
 #define TRACE_TYPE_CONFIDENCE_FACTOR (100)
 
+/*
+ * Files that are smaller than this are always parsed by the sequential
+ * reader/parser pipeline, the parallel parsing would not pay off.
+ */
+#define PARALLEL_MIN_FILESIZE (64 * 1024 * 1024)
+#define PARALLEL_MIN_CHUNKSIZE (16 * 1024 * 1024)
+
+/* The file index of a Chunk is 16 bits, this leaves a good margin */
+#define MAX_MERGED_FILES (1024)
+
 TraceParser::TraceParser()
-	: traceType(TRACE_TYPE_UNKNOWN), events(nullptr)
+	: traceType(TRACE_TYPE_UNKNOWN), sniffedType(TRACE_TYPE_UNKNOWN),
+	  parallelParse(false), mappedLoad(false), lazyArgs(false),
+	  retentionPolicy(nullptr), timeWindow(nullptr), rangeBegin(0),
+	  rangeEnd(INT64_MAX), indexCache(false), eventCache(nullptr),
+	  follow(false), loadStopped(false), nrBuffers(DEFAULT_LOAD_BUFFERS),
+	  bufferSize(DEFAULT_LOAD_BUFFER_SIZE * 1024 * 1024),
+	  datReader(nullptr), perfDataReader(nullptr), mergeSource(false),
+	  events(nullptr)
 {
 	traceFile = nullptr;
-	ptrPool = new MemPool(16384, sizeof(TString*));
+	ftraceStrings = new EventStrings();
+	perfStrings = new EventStrings();
 	postEventPool = new MemPool(16384, sizeof(Chunk));
 
 	ftraceGrammar = new FtraceGrammar();
 	perfGrammar = new PerfGrammar();
+	ftraceGrammar->setEventStrings(ftraceStrings);
+	perfGrammar->setEventStrings(perfStrings);
 
-	tbuffers = new ThreadBuffer<TraceLine>*[NR_TBUFFERS];
+	tbuffers = nullptr;
 	parserThread = new WorkThread<TraceParser>
 		(QString("parserThread"), this, &TraceParser::threadParser);
 	readerThread = new WorkThread<TraceParser>
 		(QString("readerThread"), this, &TraceParser::threadReader);
+	stitcherThread = new WorkThread<TraceParser>
+		(QString("stitcherThread"), this,
+		 &TraceParser::threadStitcher);
+	decoderThread = new WorkThread<TraceParser>
+		(QString("decoderThread"), this, &TraceParser::threadDecoder);
+	mergerThread = new WorkThread<TraceParser>
+		(QString("mergerThread"), this, &TraceParser::threadMerger);
+	chunkQueue = new WorkQueue();
 	eventsWatcher = new IndexWatcher(10000);
 	traceTypeWatcher = new IndexWatcher;
 	ftraceEvents = new vtl::TList<TraceEvent>();
@@ -95,6 +133,8 @@ TraceParser::TraceParser()
 
 	fakePostEventInfo.offset = 0;
 	fakePostEventInfo.len = 0;
+	fakePostEventInfo.file = 0;
+	fakePostEventInfo.type = CHUNK_TEXT;
 
 	ftraceLineData.clear();
 	perfLineData.clear();
@@ -104,11 +144,17 @@ TraceParser::~TraceParser()
 {
 	delete ftraceGrammar;
 	delete perfGrammar;
-	delete ptrPool;
+	delete ftraceStrings;
+	delete perfStrings;
 	delete postEventPool;
+	delete eventCache;
 	delete[] tbuffers;
 	delete parserThread;
 	delete readerThread;
+	delete stitcherThread;
+	delete decoderThread;
+	delete mergerThread;
+	delete chunkQueue;
 	delete eventsWatcher;
 	delete traceTypeWatcher;
 	delete ftraceEvents;
@@ -123,33 +169,737 @@ int TraceParser::open(const QString &fileName)
 	if (traceFile != nullptr)
 		return -TS_ERROR_INTERNAL;
 
+	eventsWatcher->reset();
+	traceTypeWatcher->reset();
+
+	/* This declines if the file is not a binary trace.dat file */
+	ts_errno = openTraceDat(fileName);
+	if (ts_errno != 0 || traceFile != nullptr)
+		return ts_errno;
+
+	/* This declines if the file is not a binary perf.data file */
+	ts_errno = openPerfData(fileName);
+	if (ts_errno != 0 || traceFile != nullptr)
+		return ts_errno;
+
+	/* This declines if there is no valid index of the file */
+	ts_errno = openCached(fileName);
+	if (ts_errno != 0 || traceFile != nullptr)
+		return ts_errno;
+
+	ts_errno = findWindowRange(fileName);
+	if (ts_errno != 0)
+		return ts_errno;
+
+	/* A growing file can only be followed by the sequential pipeline */
+	if (parallelParse && !follow) {
+		ts_errno = openParallel(fileName);
+		/* The parallel parsing may decline, then we continue below */
+		if (ts_errno != 0 || traceFile != nullptr)
+			return ts_errno;
+	}
+
 	traceFile = new TraceFile(fileName.toLocal8Bit().data(), ts_errno,
-				  1024 * 1024 * 2);
+				  bufferSize, rangeBegin, rangeEnd,
+				  mappedLoad && !follow, nrBuffers, follow);
 
 	if (ts_errno != 0) {
 		delete traceFile;
 		traceFile = nullptr;
 		return ts_errno;
 	}
+	sniffedType = TraceSniffer::sniff(traceFile);
 
 	/* These buffers will be deleted by the parserThread */
-	for (i = 0; i < NR_TBUFFERS; i++)
+	delete[] tbuffers;
+	tbuffers = new ThreadBuffer<TraceLine>*[nrBuffers];
+	for (i = 0; i < nrBuffers; i++)
 		tbuffers[i] = new ThreadBuffer<TraceLine>();
-	eventsWatcher->reset();
-	traceTypeWatcher->reset();
 	readerThread->start();
 	parserThread->start();
 
 	return 0;
 }
 
+/*
+ * Opens one or several files, the events of several files are merged into one
+ * trace, see openMerged().
+ */
+int TraceParser::open(const QStringList &fileNames)
+{
+	if (fileNames.isEmpty())
+		return -TS_ERROR_OPEN;
+	if (fileNames.size() == 1)
+		return open(fileNames[0]);
+	if (traceFile != nullptr)
+		return -TS_ERROR_INTERNAL;
+
+	eventsWatcher->reset();
+	traceTypeWatcher->reset();
+	return openMerged(fileNames);
+}
+
+/*
+ * Reads the events from the index of a text trace that has been parsed before.
+ * If there is no valid index, then 0 is returned and traceFile remains nullptr.
+ */
+int TraceParser::openCached(const QString &fileName)
+{
+	int ts_errno;
+	int dummy;
+	int nrTypes;
+	int t;
+	tracetype_t ttype;
+	TString name;
+	QVector<event_t> typeMap;
+	vtl::TList<TraceEvent> *list;
+	EventCache *cache;
+	TraceFile *file;
+
+	if (!useCache())
+		return 0;
+
+	file = new TraceFile(fileName.toLocal8Bit().data(), ts_errno, 0);
+	if (ts_errno != 0)
+		goto error;
+	cache = new EventCache();
+	if (!cache->open(file, lazyArgs))
+		goto decline;
+
+	prepareParse();
+	ttype = cache->getTraceType();
+	nrTypes = cache->getNrTypes();
+	typeMap.resize(nrTypes);
+	for (t = 0; t < nrTypes; t++) {
+		if (!cache->getTypeName(t, &name))
+			goto decline_grammars;
+		if (name.len == 0)
+			typeMap[t] = (event_t) -1;
+		else if (ttype == TRACE_TYPE_FTRACE)
+			typeMap[t] = ftraceGrammar->addEventType(&name);
+		else
+			typeMap[t] = perfGrammar->addEventType(&name);
+	}
+	list = ttype == TRACE_TYPE_FTRACE ? ftraceEvents : perfEvents;
+	if (!cache->readEvents(typeMap, list, getEventStrings(ttype)))
+		goto decline_grammars;
+
+	traceFile = file;
+	eventCache = cache;
+	setTraceType(ttype);
+	eventsWatcher->sendNextIndex(events->size());
+	eventsWatcher->sendEOF();
+	return 0;
+
+decline_grammars:
+	ftraceGrammar->clear();
+	perfGrammar->clear();
+decline:
+	delete cache;
+	file->close(&ts_errno);
+	delete file;
+	return ts_errno;
+error:
+	file->close(&dummy);
+	delete file;
+	return ts_errno;
+}
+
+/*
+ * Writes the index of a text trace that has been parsed, so that it can be
+ * opened faster the next time. This is called by the thread that parsed the
+ * trace, after it has sent EOF, the analyzer only reads the events so it can
+ * process them at the same time.
+ */
+void TraceParser::writeCache()
+{
+	int ts_errno;
+	const StringTree<> *tree;
+
+	if (!useCache() || eventCache != nullptr ||
+	    loadStopped.load(std::memory_order_acquire))
+		return;
+	if (traceType == TRACE_TYPE_FTRACE)
+		tree = ftraceGrammar->eventTree;
+	else if (traceType == TRACE_TYPE_PERF)
+		tree = perfGrammar->eventTree;
+	else
+		return;
+	ts_errno = EventCache::write(traceFile, lazyArgs, traceType, events,
+				     getEventStrings(traceType), tree);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to write the index cache");
+}
+
+/*
+ * The index contains all events of the file, so it cannot be used if only a
+ * part of them are loaded because of a time window or a retention policy, or
+ * if the file is still growing.
+ */
+bool TraceParser::useCache() const
+{
+	return indexCache && !follow &&
+		(retentionPolicy == nullptr || retentionPolicy->isEmpty()) &&
+		(timeWindow == nullptr || timeWindow->isEmpty());
+}
+
+/*
+ * Finds the byte range of the time window, if there is one, and the names of
+ * the tasks that were seen before it. A compressed file can only be read
+ * sequentially, so it is always loaded in full.
+ */
+int TraceParser::findWindowRange(const QString &fileName)
+{
+	int ts_errno;
+	int dummy;
+	TraceFile *file;
+
+	rangeBegin = 0;
+	rangeEnd = INT64_MAX;
+	prescanNames.clear();
+	if (timeWindow == nullptr || timeWindow->isEmpty())
+		return 0;
+
+	file = new TraceFile(fileName.toLocal8Bit().data(), ts_errno, 0);
+	if (ts_errno != 0 || file->isCompressed())
+		goto out;
+	ts_errno = timeWindow->findRange(file, &rangeBegin, &rangeEnd);
+	if (ts_errno != 0)
+		goto out;
+	ts_errno = timeWindow->prescanNames(file, rangeBegin, &prescanNames);
+out:
+	file->close(&dummy);
+	delete file;
+	return ts_errno;
+}
+
+/*
+ * Parses the file in ranges using all cores. This is only done with files that
+ * are large enough, not compressed, and if the trace type can be determined
+ * from the beginning of the file. If the file is not suitable for parallel
+ * parsing, then 0 is returned and traceFile remains nullptr.
+ */
+int TraceParser::openParallel(const QString &fileName)
+{
+	int ts_errno;
+	int dummy;
+	int nrChunks;
+	int i;
+	int64_t rbegin;
+	int64_t rend;
+	int64_t begin;
+	int64_t end;
+	tracetype_t ttype;
+	TraceFile *file;
+	ChunkParser *chunk;
+	WorkItem<ChunkParser> *item;
+
+	nrChunks = QThread::idealThreadCount();
+	if (nrChunks < 2)
+		return 0;
+
+	file = new TraceFile(fileName.toLocal8Bit().data(), ts_errno, 0);
+	if (ts_errno != 0)
+		goto error;
+
+	/* A compressed file can only be decompressed sequentially */
+	if (file->isCompressed())
+		goto decline;
+
+	/* Only the range of the time window, if any, is divided into chunks */
+	rbegin = rangeBegin;
+	rend = TSMIN(rangeEnd, file->getFileSize());
+	if (rend - rbegin < PARALLEL_MIN_FILESIZE)
+		goto decline;
+	nrChunks = (int) TSMIN((int64_t) nrChunks,
+			       (rend - rbegin) / PARALLEL_MIN_CHUNKSIZE);
+
+	ttype = TraceSniffer::sniff(file);
+	if (ttype != TRACE_TYPE_FTRACE && ttype != TRACE_TYPE_PERF)
+		goto decline;
+
+	begin = rbegin;
+	for (i = 1; i <= nrChunks; i++) {
+		if (i == nrChunks) {
+			end = rend;
+		} else {
+			end = file->findLineBegin(rbegin + (rend - rbegin) /
+						  nrChunks * i, &ts_errno);
+			if (ts_errno != 0)
+				goto error_chunks;
+		}
+		if (end <= begin)
+			continue;
+		chunk = new ChunkParser(fileName, ttype, begin, end,
+					mappedLoad, lazyArgs, retentionPolicy);
+		item = new WorkItem<ChunkParser>(chunk, &ChunkParser::parse);
+		chunkParsers.append(chunk);
+		chunkItems.append(item);
+		chunkQueue->addWorkItem(item);
+		begin = end;
+	}
+
+	traceFile = file;
+	prepareParse();
+	setTraceType(ttype);
+	stitcherThread->start();
+	return 0;
+
+error_chunks:
+	/* The queue has not been started, so we can remove the items */
+	chunkQueue->setWorkItemsDefault();
+	deleteChunks();
+error:
+	file->close(&dummy);
+	delete file;
+	return ts_errno;
+decline:
+	file->close(&ts_errno);
+	delete file;
+	return ts_errno;
+}
+
+/*
+ * Opens a binary trace.dat file, which is read by the TraceDatReader in the
+ * decoderThread. If the file is not a trace.dat file, then 0 is returned and
+ * traceFile remains nullptr.
+ */
+int TraceParser::openTraceDat(const QString &fileName)
+{
+	int ts_errno;
+	int dummy;
+	TraceFile *file;
+
+	file = new TraceFile(fileName.toLocal8Bit().data(), ts_errno, 0);
+	if (ts_errno != 0)
+		goto error;
+	if (!TraceDatReader::isTraceDat(file))
+		goto decline;
+
+	datReader = new TraceDatReader(file);
+	ts_errno = datReader->open();
+	if (ts_errno != 0) {
+		delete datReader;
+		datReader = nullptr;
+		goto error;
+	}
+
+	traceFile = file;
+	prepareParse();
+	setTraceType(TRACE_TYPE_FTRACE);
+	decoderThread->start();
+	return 0;
+
+error:
+	file->close(&dummy);
+	delete file;
+	return ts_errno;
+decline:
+	file->close(&ts_errno);
+	delete file;
+	return ts_errno;
+}
+
+/*
+ * Opens a binary perf.data file, which is read by the PerfDataReader in the
+ * decoderThread. If the file is not a perf.data file, then 0 is returned and
+ * traceFile remains nullptr.
+ */
+int TraceParser::openPerfData(const QString &fileName)
+{
+	int ts_errno;
+	int dummy;
+	TraceFile *file;
+
+	file = new TraceFile(fileName.toLocal8Bit().data(), ts_errno, 0);
+	if (ts_errno != 0)
+		goto error;
+	if (!PerfDataReader::isPerfData(file))
+		goto decline;
+
+	perfDataReader = new PerfDataReader(file);
+	ts_errno = perfDataReader->open();
+	if (ts_errno != 0) {
+		delete perfDataReader;
+		perfDataReader = nullptr;
+		goto error;
+	}
+
+	traceFile = file;
+	prepareParse();
+	setTraceType(TRACE_TYPE_PERF);
+	decoderThread->start();
+	return 0;
+
+error:
+	file->close(&dummy);
+	delete file;
+	return ts_errno;
+decline:
+	file->close(&ts_errno);
+	delete file;
+	return ts_errno;
+}
+
+/*
+ * Opens several files, such as per-CPU traces or the segments of a rotated
+ * capture, as one trace. Each file is opened by its own TraceParser, so that
+ * they are parsed concurrently, and the mergerThread merges their events by
+ * timestamp. The chunks of the merged events have the index of their file, so
+ * that traceFile can read them from the right file.
+ */
+int TraceParser::openMerged(const QStringList &fileNames)
+{
+	QVector<TraceFile*> files;
+	TraceParser *parser;
+	int ts_errno;
+	int dummy;
+	int i;
+
+	if (fileNames.size() > MAX_MERGED_FILES)
+		return -TS_ERROR_FILE_RESOURCE;
+
+	for (i = 0; i < fileNames.size(); i++) {
+		/*
+		 * The files are already parsed concurrently, so each of them is
+		 * parsed sequentially. Lazy arguments are not used, since their
+		 * location has no file index, and a merged trace is not
+		 * followed.
+		 */
+		parser = new TraceParser();
+		parser->setMappedLoad(mappedLoad);
+		parser->setRetentionPolicy(retentionPolicy);
+		parser->setTimeWindow(timeWindow);
+		parser->setIndexCache(indexCache);
+		parser->setLoadBuffers(nrBuffers, bufferSize);
+		parser->mergeSource = true;
+		mergeParsers.append(parser);
+		ts_errno = parser->open(fileNames[i]);
+		if (ts_errno != 0)
+			goto error;
+		files.append(parser->traceFile);
+	}
+
+	/* This is only used to access the chunks of the files */
+	traceFile = new TraceFile(fileNames[0].toLocal8Bit().data(), ts_errno,
+				  0);
+	if (ts_errno != 0) {
+		traceFile->close(&dummy);
+		delete traceFile;
+		traceFile = nullptr;
+		goto error;
+	}
+	traceFile->setMergedFiles(files);
+	mergeFileNames = fileNames;
+	prepareParse();
+	mergerThread->start();
+	return 0;
+
+error:
+	closeMerged();
+	return ts_errno;
+}
+
+/*
+ * Adds the events of a file that has been parsed to the streams that are
+ * merged. The names of the tasks before the time window are taken from the
+ * first file that has them.
+ */
+void TraceParser::addMergeStream(TraceParser *parser, int file)
+{
+	MergeStream stream;
+	const StringTree<> *stree;
+	QHash<int, QByteArray>::const_iterator iter;
+
+	if (parser->events == nullptr)
+		return;
+
+	if (traceType == TRACE_TYPE_FTRACE) {
+		stree = parser->ftraceGrammar->eventTree;
+		mapEventTypes(stree, parser->ftraceGrammar->retention,
+			      stream.typeMap);
+	} else {
+		stree = parser->perfGrammar->eventTree;
+		mapEventTypes(stree, parser->perfGrammar->retention,
+			      stream.typeMap);
+	}
+
+	for (iter = parser->prescanNames.constBegin();
+	     iter != parser->prescanNames.constEnd(); iter++) {
+		if (!prescanNames.contains(iter.key()))
+			prescanNames.insert(iter.key(), iter.value());
+	}
+
+	if (!getEventStrings(traceType)->append(
+		    parser->getEventStrings(traceType), &stream.stringBase,
+		    &stream.argBase)) {
+		vtl::warnx("Skipping %s, it has too many strings",
+			   mergeFileNames[file].toLocal8Bit().data());
+		return;
+	}
+	stream.events = parser->events;
+	stream.pos = 0;
+	stream.file = file;
+	mergeStreams.append(stream);
+}
+
+void TraceParser::closeMerged()
+{
+	int i;
+	int dummy;
+
+	for (i = 0; i < mergeParsers.size(); i++) {
+		mergeParsers[i]->close(&dummy);
+		delete mergeParsers[i];
+	}
+	mergeParsers.clear();
+	mergeStreams.clear();
+	mergeHeap.clear();
+	mergeFileNames.clear();
+}
+
+vtl_always_inline bool TraceParser::isBefore(const MergeStream *a,
+					     const MergeStream *b)
+{
+	const vtl::CompactTime &ta = a->events->at(a->pos).time;
+	const vtl::CompactTime &tb = b->events->at(b->pos).time;
+
+	return ta < tb || (ta == tb && a->file < b->file);
+}
+
+void TraceParser::mergeHeapPush(MergeStream *stream)
+{
+	int i = mergeHeap.size();
+	int parent;
+	MergeStream *tmp;
+
+	mergeHeap.append(stream);
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (!isBefore(mergeHeap[i], mergeHeap[parent]))
+			break;
+		tmp = mergeHeap[i];
+		mergeHeap[i] = mergeHeap[parent];
+		mergeHeap[parent] = tmp;
+		i = parent;
+	}
+}
+
+void TraceParser::mergeHeapSiftDown(int i)
+{
+	const int s = mergeHeap.size();
+	int child;
+	MergeStream *tmp;
+
+	while (true) {
+		child = 2 * i + 1;
+		if (child >= s)
+			break;
+		if (child + 1 < s && isBefore(mergeHeap[child + 1],
+					      mergeHeap[child]))
+			child++;
+		if (!isBefore(mergeHeap[child], mergeHeap[i]))
+			break;
+		tmp = mergeHeap[i];
+		mergeHeap[i] = mergeHeap[child];
+		mergeHeap[child] = tmp;
+		i = child;
+	}
+}
+
+void TraceParser::deleteChunks()
+{
+	int i;
+	int s = chunkItems.size();
+
+	for (i = 0; i < s; i++)
+		delete chunkItems[i];
+	chunkItems.clear();
+
+	s = chunkParsers.size();
+	for (i = 0; i < s; i++)
+		delete chunkParsers[i];
+	chunkParsers.clear();
+}
+
+void TraceParser::setParallelParse(bool enable)
+{
+	parallelParse = enable;
+}
+
+void TraceParser::setMappedLoad(bool enable)
+{
+	mappedLoad = enable;
+}
+
+/*
+ * If enabled, the arguments of events that are unknown to traceshark are not
+ * stored, only their location in the trace file. This saves a lot of memory
+ * with large traces and the arguments can be retrieved with an ArgCache. This
+ * takes effect the next time that a file is opened.
+ */
+void TraceParser::setLazyArgs(bool enable)
+{
+	lazyArgs = enable;
+}
+
+/*
+ * The events whose type the policy doesn't retain are dropped when they are
+ * parsed, they are only counted. The policy must not be changed while a file
+ * is being parsed. This takes effect the next time that a file is opened.
+ */
+void TraceParser::setRetentionPolicy(const RetentionPolicy *policy)
+{
+	retentionPolicy = policy;
+}
+
+/* Returns the number of events of the type that were dropped */
+quint64 TraceParser::getDroppedEvents(event_t type) const
+{
+	switch (traceType) {
+	case TRACE_TYPE_FTRACE:
+		return ftraceGrammar->retention.getDropped(type);
+	case TRACE_TYPE_PERF:
+		return perfGrammar->retention.getDropped(type);
+	default:
+		return 0;
+	}
+}
+
+/*
+ * If a time window is set, then only the part of a text trace that is within
+ * the window is loaded. The window must not be changed while a file is being
+ * parsed. This takes effect the next time that a file is opened.
+ */
+void TraceParser::setTimeWindow(const TimeWindow *window)
+{
+	timeWindow = window;
+}
+
+/*
+ * If enabled, then the parsed events of a text trace are stored in an index
+ * file, which is read instead of parsing the trace the next time that it is
+ * opened. This takes effect the next time that a file is opened.
+ */
+void TraceParser::setIndexCache(bool enable)
+{
+	indexCache = enable;
+}
+
+/*
+ * If enabled, then a text trace that is opened will be followed, i.e. what is
+ * appended to it will be parsed, until stopFollowing() is called or the trace
+ * is closed. The events watcher will not send EOF before that.
+ */
+void TraceParser::setFollow(bool enable)
+{
+	follow = enable;
+}
+
+/* A file that is not a regular uncompressed text trace is never followed */
+bool TraceParser::isFollowing() const
+{
+	return traceFile != nullptr && traceFile->isFollowing();
+}
+
+void TraceParser::stopFollowing()
+{
+	if (traceFile != nullptr)
+		traceFile->stopFollowing();
+}
+
+/*
+ * Ends the loading of the files early, as if their ends had been reached. This
+ * is used to cancel the loading of a trace, which should be closed after the
+ * events watcher has sent EOF. Only the sequential pipeline can be stopped,
+ * otherwise EOF is sent when the parsing has been completed.
+ */
+void TraceParser::stopLoading()
+{
+	int i;
+
+	loadStopped.store(true, std::memory_order_release);
+	if (traceFile != nullptr)
+		traceFile->stopLoading();
+	for (i = 0; i < mergeParsers.size(); i++)
+		mergeParsers[i]->stopLoading();
+}
+
+/*
+ * Gets the number of bytes of the files that have been loaded so far and the
+ * number of bytes that will be loaded. This may be called from any thread
+ * while the trace is open. Returns false if it is not known, e.g. because the
+ * trace is not loaded by the sequential pipeline.
+ */
+bool TraceParser::getLoadProgress(int64_t *loaded, int64_t *total) const
+{
+	int64_t l, t;
+	int i;
+
+	if (mergeParsers.isEmpty())
+		return traceFile != nullptr &&
+			traceFile->getLoadProgress(loaded, total);
+
+	*loaded = 0;
+	*total = 0;
+	for (i = 0; i < mergeParsers.size(); i++) {
+		if (!mergeParsers[i]->getLoadProgress(&l, &t))
+			return false;
+		*loaded += l;
+		*total += t;
+	}
+	return true;
+}
+
+/*
+ * Returns the names of the tasks that were found in the part of the file that
+ * comes before the time window, by pid.
+ */
+const QHash<int, QByteArray> &TraceParser::getPrescanNames() const
+{
+	return prescanNames;
+}
+
+/*
+ * Sets the number of buffers and the size of each buffer, in bytes, that are
+ * used when a file is parsed sequentially. This takes effect the next time
+ * that a file is opened.
+ */
+void TraceParser::setLoadBuffers(unsigned int nr, unsigned int size)
+{
+	nrBuffers = nr;
+	bufferSize = size;
+}
+
 bool TraceParser::isOpen() const
 {
 	return (traceFile != nullptr);
 }
 
+/* These are idempotent and return immediately if nothing is running */
+void TraceParser::waitForThreads()
+{
+	parserThread->wait();
+	readerThread->wait();
+	stitcherThread->wait();
+	chunkQueue->wait();
+	deleteChunks();
+	decoderThread->wait();
+	mergerThread->wait();
+}
+
 void TraceParser::close(int *ts_errno)
 {
+	/* Otherwise the load thread would wait for more data forever */
+	if (traceFile != nullptr)
+		traceFile->stopFollowing();
+
+	waitForThreads();
+	delete datReader;
+	datReader = nullptr;
+	delete perfDataReader;
+	perfDataReader = nullptr;
+
 	if (traceFile != nullptr) {
 		traceFile->close(ts_errno);
 		delete traceFile;
@@ -157,55 +907,67 @@ void TraceParser::close(int *ts_errno)
 	} else {
 		*ts_errno = 0;
 	}
-	ptrPool->reset();
+	/* The merged events point to the strings of the other parsers */
+	closeMerged();
+	ftraceStrings->clear();
+	perfStrings->clear();
 	perfGrammar->clear();
 	perfEvents->clear();
 	ftraceGrammar->clear();
 	ftraceEvents->clear();
+	prescanNames.clear();
+	/* The events may point to the strings in the mapping of the index */
+	delete eventCache;
+	eventCache = nullptr;
 	events = nullptr;
 	traceType = TRACE_TYPE_UNKNOWN;
+	loadStopped.store(false, std::memory_order_relaxed);
 }
 
 
 void TraceParser::threadReader()
 {
-	unsigned long long nr = 0;
 	unsigned int i = 0;
 	unsigned int curbuf = 0;
 	bool eof;
 
-	for (i = 0; i < NR_TBUFFERS; i++)
+	for (i = 0; i < nrBuffers; i++)
 		tbuffers[i]->loadBuffer = traceFile->getLoadBuffer(i);
 
 	tbuffers[curbuf]->beginProduceBuffer();
 
 	while(true) {
+		/*
+		 * A buffer without a complete line is passed on empty, because
+		 * tokenizing it would give an empty line. This is were EOF will
+		 * be detected in practice, with the current implementation of
+		 * LoadBuffer, but it also happens when a growing file is
+		 * followed and the last line has not been completely written.
+		 */
+		while (tbuffers[curbuf]->loadBuffer->nRead == 0) {
+			eof = tbuffers[curbuf]->loadBuffer->isEOF();
+			tbuffers[curbuf]->endProduceBuffer();
+			if (eof)
+				return;
+			curbuf++;
+			if (curbuf == nrBuffers)
+				curbuf = 0;
+			tbuffers[curbuf]->beginProduceBuffer();
+		}
 		TraceLine *line = &tbuffers[curbuf]->list.increase();
-		quint32 n = traceFile->ReadLine(line, tbuffers[curbuf]);
-		nr += n;
+		traceFile->ReadLine(line, tbuffers[curbuf]);
 		if (traceFile->getBufferSwitch()) {
 			eof = tbuffers[curbuf]->loadBuffer->isEOF();
 			tbuffers[curbuf]->endProduceBuffer();
 			if (eof)
 				break;
 			curbuf++;
-			if (curbuf == NR_TBUFFERS)
+			if (curbuf == nrBuffers)
 				curbuf = 0;
 			traceFile->clearBufferSwitch();
 			tbuffers[curbuf]->beginProduceBuffer();
-			eof = tbuffers[curbuf]->loadBuffer->isEOF();
-			/*
-			 * This is were EOF will be detected in practice, with
-			 * the current implementation of LoadBuffer
-			 */
-			if (eof && tbuffers[curbuf]->loadBuffer->nRead == 0) {
-				tbuffers[curbuf]->endProduceBuffer();
-				break;
-			}
 		}
 	}
-
-	printf("%llu\n", nr);
 }
 
 
@@ -219,6 +981,19 @@ void TraceParser::threadParser()
 	bool eof;
 
 	prepareParse();
+
+	/*
+	 * If the sniffer could tell the trace type, then there is no need to
+	 * parse the first buffers with both grammars.
+	 */
+	if (sniffedType == TRACE_TYPE_FTRACE) {
+		setTraceType(TRACE_TYPE_FTRACE);
+		goto ftrace;
+	} else if (sniffedType == TRACE_TYPE_PERF) {
+		setTraceType(TRACE_TYPE_PERF);
+		goto perf;
+	}
+
 	while(true) {
 		eof = parseBuffer(i);
 		determineTraceType();
@@ -232,7 +1007,7 @@ void TraceParser::threadParser()
 		if (traceType != TRACE_TYPE_UNKNOWN)
 			eventsWatcher->sendNextIndex(events->size());
 		i++;
-		if (i == NR_TBUFFERS)
+		if (i == nrBuffers)
 			i = 0;
 		if (traceType == TRACE_TYPE_FTRACE)
 			goto ftrace;
@@ -258,7 +1033,7 @@ ftrace:
 			break;
 		eventsWatcher->sendNextIndex(ftraceEvents->size());
 		i++;
-		if (i == NR_TBUFFERS)
+		if (i == nrBuffers)
 			i = 0;
 	}
 	goto out;
@@ -269,7 +1044,7 @@ perf:
 			break;
 		eventsWatcher->sendNextIndex(perfEvents->size());
 		i++;
-		if (i == NR_TBUFFERS)
+		if (i == nrBuffers)
 			i = 0;
 	}
 out:
@@ -286,8 +1061,270 @@ out:
 	eventsWatcher->sendNextIndex(events->size());
 	eventsWatcher->sendEOF();
 
-	for (i = 0; i < NR_TBUFFERS; i++)
+	/*
+	 * The readerThread may still be notifying us about the last buffer,
+	 * since it doesn't hold a lock that we would wait for.
+	 */
+	readerThread->wait();
+	for (i = 0; i < nrBuffers; i++)
 		delete tbuffers[i];
+
+	writeCache();
+}
+
+/*
+ * This is run in the stitcherThread when the file is parsed in parallel. The
+ * chunks are appended to the events list in file order, as soon as each of them
+ * has been parsed, so that the analyzer can start processing the beginning of
+ * the trace while the rest is being parsed.
+ */
+void TraceParser::threadStitcher()
+{
+	int i;
+	int s = chunkParsers.size();
+	TraceLineData &lineData = traceType == TRACE_TYPE_FTRACE ?
+		ftraceLineData : perfLineData;
+
+	chunkQueue->start();
+	for (i = 0; i < s; i++) {
+		ChunkParser *chunk = chunkParsers[i];
+		chunk->waitForCompletion();
+		if (chunk->ts_errno != 0)
+			vtl::warn(chunk->ts_errno,
+				  "Failed to parse %lld - %lld",
+				  (long long) chunk->rangeBegin,
+				  (long long) chunk->rangeEnd);
+		stitchChunk(chunk, lineData);
+		eventsWatcher->sendNextIndex(events->size());
+	}
+	chunkQueue->wait();
+
+	eventsWatcher->sendNextIndex(events->size());
+	eventsWatcher->sendEOF();
+
+	writeCache();
+}
+
+/*
+ * This is run in the decoderThread when a binary trace.dat or perf.data file is
+ * read. The events are decoded directly into the events list, there is no text
+ * to tokenize and parse.
+ */
+void TraceParser::threadDecoder()
+{
+	int ts_errno;
+
+	if (datReader != nullptr)
+		ts_errno = datReader->readEvents(ftraceEvents, ftraceStrings,
+						 ftraceGrammar, eventsWatcher);
+	else
+		ts_errno = perfDataReader->readEvents(perfEvents, perfStrings,
+						      postEventPool,
+						      perfGrammar,
+						      eventsWatcher);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to read the trace");
+
+	eventsWatcher->sendNextIndex(events->size());
+	eventsWatcher->sendEOF();
+}
+
+/*
+ * This is run in the mergerThread when several files are opened. It waits for
+ * the files to be parsed and then merges their events by timestamp, into our
+ * events list, while the analyzer processes them. The trace type is the one of
+ * the first file, the files that have another type are skipped.
+ */
+void TraceParser::threadMerger()
+{
+	int i;
+	int s = mergeParsers.size();
+	int index;
+	bool eof;
+	unsigned int nrEvents = 0;
+	tracetype_t ttype = TRACE_TYPE_UNKNOWN;
+	TraceParser *parser;
+	MergeStream *stream;
+
+	for (i = 0; i < s; i++) {
+		parser = mergeParsers[i];
+		parser->waitForTraceType();
+		eof = false;
+		while (!eof)
+			parser->waitForNextBatch(eof, index);
+		if (i == 0) {
+			ttype = parser->traceType;
+			/* mapEventTypes() needs to know our trace type */
+			traceType = ttype;
+		} else if (parser->traceType != ttype) {
+			vtl::warnx("Skipping %s, it has another trace type "
+				   "than %s",
+				   mergeFileNames[i].toLocal8Bit().data(),
+				   mergeFileNames[0].toLocal8Bit().data());
+			continue;
+		}
+		addMergeStream(parser, i);
+	}
+	setTraceType(ttype);
+
+	for (i = 0; i < mergeStreams.size(); i++) {
+		if (mergeStreams[i].events->size() > 0)
+			mergeHeapPush(&mergeStreams[i]);
+	}
+
+	while (!mergeHeap.isEmpty()) {
+		stream = mergeHeap[0];
+		TraceEvent &event = events->preAlloc();
+		event = stream->events->at(stream->pos);
+		if (event.type >= EVENT_UNKNOWN)
+			event.type = stream->typeMap[event.type - EVENT_UNKNOWN];
+		if (event.taskNameId != STRINGTABLE_NO_ID)
+			event.taskNameId += stream->stringBase;
+		if (!event.hasLazyArgs())
+			event.argv.offset += stream->argBase;
+		if (event.postEventInfo != nullptr)
+			event.postEventInfo->file = stream->file;
+		events->commit();
+		nrEvents++;
+		if ((nrEvents & 0xffff) == 0)
+			eventsWatcher->sendNextIndex(events->size());
+
+		stream->pos++;
+		if (stream->pos == stream->events->size()) {
+			mergeHeap[0] = mergeHeap.last();
+			mergeHeap.removeLast();
+		}
+		if (!mergeHeap.isEmpty())
+			mergeHeapSiftDown(0);
+	}
+
+	eventsWatcher->sendNextIndex(events->size());
+	eventsWatcher->sendEOF();
+
+	/*
+	 * The events have been copied, so the event lists of the other parsers
+	 * are not needed anymore. Their threads may still be writing indexes.
+	 */
+	for (i = 0; i < s; i++) {
+		parser = mergeParsers[i];
+		parser->waitForThreads();
+		if (parser->events != nullptr)
+			parser->events->clear();
+	}
+}
+
+/*
+ * Another grammar, whose event tree is stree, has numbered the event types that
+ * are not known in advance independently. This gives the translation of those
+ * types to the numbering of our own grammar in typeMap, the first entry is for
+ * EVENT_UNKNOWN. The events that the other grammar has dropped are added to
+ * our counts.
+ */
+void TraceParser::mapEventTypes(const StringTree<> *stree,
+				const RetentionTable &otherRetention,
+				QVector<event_t> &typeMap)
+{
+	event_t maxType = stree->getMaxEvent();
+	int t;
+
+	RetentionTable &retention = traceType == TRACE_TYPE_FTRACE ?
+		ftraceGrammar->retention : perfGrammar->retention;
+
+	typeMap.clear();
+	for (t = EVENT_UNKNOWN; t <= maxType; t++) {
+		const TString *name = stree->stringLookup((event_t) t);
+		if (traceType == TRACE_TYPE_FTRACE)
+			typeMap.append(ftraceGrammar->addEventType(name));
+		else
+			typeMap.append(perfGrammar->addEventType(name));
+	}
+
+	for (t = 0; t <= maxType; t++) {
+		event_t type = t < EVENT_UNKNOWN ? (event_t) t :
+			typeMap[t - EVENT_UNKNOWN];
+		retention.addDropped(type, otherRetention.getDropped(
+					     (event_t) t));
+	}
+}
+
+/*
+ * Appends the events of a chunk to the events list. The event types that are
+ * not known in advance have been numbered independently by each chunk, so they
+ * need to be translated to the numbering of our own grammar. Likewise, the
+ * strings of the chunk are appended to ours, which changes their ids and the
+ * offsets of the arguments. The check for the timestamp rollover bug is done
+ * here, so that it is done in the same order as with sequential parsing.
+ */
+void TraceParser::stitchChunk(ChunkParser *chunk, TraceLineData &lineData)
+{
+	QVector<event_t> typeMap;
+	uint32_t stringBase;
+	uint64_t argBase;
+	int i;
+	int s;
+	int64_t leadLen;
+	Chunk *info;
+
+	mapEventTypes(chunk->getEventTree(), chunk->getRetention(), typeMap);
+	if (!getEventStrings(traceType)->append(chunk->strings, &stringBase,
+						&argBase)) {
+		vtl::warnx("Dropping the events of a chunk, the trace has too "
+			   "many strings");
+		return;
+	}
+
+	/*
+	 * Lines before the first event of the chunk are a continuation of the
+	 * postEventInfo of the last event of the previous chunk, which ends
+	 * where this chunk begins.
+	 */
+	leadLen = chunk->firstEventBegin - chunk->rangeBegin;
+	if (traceType == TRACE_TYPE_PERF && leadLen > 0 && events->size() > 0 &&
+	    lineData.prevEvent != &fakeEvent) {
+		TraceEvent &lastEvent = events->last();
+		if (lastEvent.postEventInfo == nullptr) {
+			info = (Chunk*) postEventPool->allocObj();
+			info->offset = chunk->rangeBegin;
+			info->len = leadLen;
+			info->file = 0;
+			info->type = CHUNK_TEXT;
+			lastEvent.postEventInfo = info;
+		} else {
+			lastEvent.postEventInfo->len += leadLen;
+		}
+	}
+
+	s = chunk->events->size();
+	for (i = 0; i < s; i++) {
+		TraceEvent &event = events->preAlloc();
+		event = chunk->events->at(i);
+		if (event.type >= EVENT_UNKNOWN)
+			event.type = typeMap[event.type - EVENT_UNKNOWN];
+		if (event.taskNameId != STRINGTABLE_NO_ID)
+			event.taskNameId += stringBase;
+		if (!event.hasLazyArgs())
+			event.argv.offset += argBase;
+		if (event.time < lineData.prevTime) {
+			if (!parseLineBugFixup(&event, lineData.prevTime))
+				continue;
+		}
+		lineData.prevTime = event.time;
+		events->commit();
+		lineData.nrEvents++;
+		if ((lineData.nrEvents & 0xffff) == 0)
+			eventsWatcher->sendNextIndex(events->size());
+	}
+
+	/*
+	 * Here prevEvent only tells whether the last event line so far was
+	 * dropped, so that the lines that continue into the next chunk are
+	 * dropped too.
+	 */
+	if (chunk->endsWithDroppedEvent())
+		lineData.prevEvent = &fakeEvent;
+	else if (chunk->firstEventBegin < chunk->rangeEnd)
+		lineData.prevEvent = nullptr;
+	chunk->releaseEvents();
 }
 
 void TraceParser::waitForTraceType()
@@ -307,6 +1344,8 @@ void TraceParser::prepareParse()
 {
 	fakePostEventInfo.offset = 0;
 	fakePostEventInfo.len = 0;
+	fakePostEventInfo.file = 0;
+	fakePostEventInfo.type = CHUNK_TEXT;
 	fakeEvent.postEventInfo = &fakePostEventInfo;
 
 	perfLineData.clear();
@@ -315,6 +1354,11 @@ void TraceParser::prepareParse()
 	ftraceLineData.clear();
 	ftraceLineData.prevEvent = &fakeEvent;
 
+	ftraceGrammar->setLazyArgs(lazyArgs);
+	perfGrammar->setLazyArgs(lazyArgs);
+	ftraceGrammar->setRetentionPolicy(retentionPolicy);
+	perfGrammar->setRetentionPolicy(retentionPolicy);
+
 	ftraceEvents->clear();
 	perfEvents->clear();
 	events = nullptr;
@@ -351,6 +1395,9 @@ void TraceParser::fixLastEvent()
 	/* If no events were found in the trace, then there is nothing to fix */
 	if (events->size() <= 0)
 		return;
+	/* The lines belong to an event that was dropped */
+	if (perfLineData.prevEvent == &fakeEvent)
+		return;
 	TraceEvent &lastEvent = events->last();
 	if (prevLineIsEvent) {
 		lastEvent.postEventInfo = nullptr;
@@ -358,7 +1405,9 @@ void TraceParser::fixLastEvent()
 		Chunk *chunk = (Chunk*) postEventPool->
 			allocObj();
 		chunk->offset = infoBegin;
-		chunk->len =  traceFile->getFileSize() - infoBegin;
+		chunk->len = traceFile->getLoadEnd() - infoBegin;
+		chunk->file = 0;
+		chunk->type = CHUNK_TEXT;
 		lastEvent.postEventInfo = chunk;
 	}
 }
@@ -367,10 +1416,10 @@ void TraceParser::fixLastEvent()
 #define TIME_10MS  vtl::Time(10000000)
 
 bool TraceParser::parseLineBugFixup(TraceEvent* event,
-				    const vtl::Time &prevTime)
+				    const vtl::CompactTime &prevTime)
 {
-	vtl::Time corrtime = event->time + CORR_DELTA;
-	vtl::Time delta = corrtime - prevTime;
+	vtl::CompactTime corrtime = event->time + CORR_DELTA;
+	vtl::CompactTime delta = corrtime - prevTime;
 	bool retval = false;
 
 	if (delta >= VTL_TIME_ZERO && delta < TIME_10MS) {
@@ -380,21 +1429,42 @@ bool TraceParser::parseLineBugFixup(TraceEvent* event,
 	return retval;
 }
 
+void TraceParser::setTraceType(tracetype_t ttype)
+{
+	traceType = ttype;
+	if (ttype == TRACE_TYPE_FTRACE) {
+		if (!mergeSource)
+			TraceEvent::setStringTree(ftraceGrammar->eventTree);
+		events = ftraceEvents;
+	} else {
+		/* Unknown traces are treated as perf traces */
+		if (!mergeSource)
+			TraceEvent::setStringTree(perfGrammar->eventTree);
+		events = perfEvents;
+	}
+	if (!mergeSource)
+		TraceEvent::setEventStrings(getEventStrings(ttype));
+	/*
+	 * The other grammar is not used for the rest of the trace, so the
+	 * strings of the lines that it parsed before the type was known can be
+	 * dropped.
+	 */
+	if (ttype == TRACE_TYPE_FTRACE)
+		perfStrings->clear();
+	else
+		ftraceStrings->clear();
+	sendTraceType();
+}
+
 void TraceParser::determineTraceType()
 {
 	if (ftraceLineData.nrEvents > (TSMAX(1, perfLineData.nrEvents)
 				       * TRACE_TYPE_CONFIDENCE_FACTOR)) {
-		traceType = TRACE_TYPE_FTRACE;
-		TraceEvent::setStringTree(ftraceGrammar->eventTree);
-		events = ftraceEvents;
-		sendTraceType();
+		setTraceType(TRACE_TYPE_FTRACE);
 		return;
 	} else if (perfLineData.nrEvents > (TSMAX(1, ftraceLineData.nrEvents)
 					    * TRACE_TYPE_CONFIDENCE_FACTOR)) {
-		traceType = TRACE_TYPE_PERF;
-		TraceEvent::setStringTree(perfGrammar->eventTree);
-		events = perfEvents;
-		sendTraceType();
+		setTraceType(TRACE_TYPE_PERF);
 		return;
 	}
 	traceType = TRACE_TYPE_UNKNOWN;
@@ -402,20 +1472,12 @@ void TraceParser::determineTraceType()
 
 void TraceParser::guessTraceType()
 {
-	if (perfLineData.nrEvents > ftraceLineData.nrEvents) {
-		traceType = TRACE_TYPE_PERF;
-		TraceEvent::setStringTree(perfGrammar->eventTree);
-		events = perfEvents;
-	} else if (perfLineData.nrEvents < ftraceLineData.nrEvents) {
-		traceType = TRACE_TYPE_FTRACE;
-		TraceEvent::setStringTree(ftraceGrammar->eventTree);
-		events = ftraceEvents;
-	} else {
-		traceType = TRACE_TYPE_UNKNOWN;
-		TraceEvent::setStringTree(perfGrammar->eventTree);
-		events = perfEvents;
-	}
-	sendTraceType();
+	if (perfLineData.nrEvents > ftraceLineData.nrEvents)
+		setTraceType(TRACE_TYPE_PERF);
+	else if (perfLineData.nrEvents < ftraceLineData.nrEvents)
+		setTraceType(TRACE_TYPE_FTRACE);
+	else
+		setTraceType(TRACE_TYPE_UNKNOWN);
 }
 
 /* This parses a buffer regardless if it's perf or ftrace */
@@ -423,31 +1485,22 @@ bool TraceParser::parseBuffer(unsigned int index)
 {
 	unsigned int i, s;
 	bool eof;
-	const TString **argv;
 
 	ThreadBuffer<TraceLine> *tbuf = tbuffers[index];
 	tbuf->beginConsumeBuffer();
 
 	s = tbuf->list.size();
-	argv = (const TString**)
-		ptrPool->preallocN(EVENT_MAX_NR_ARGS);
 
 	for(i = 0; i < s; i++) {
 		TraceLine &line = tbuf->list[i];
 		TraceEvent &ft_event = ftraceEvents->preAlloc();
 		ft_event.argc = 0;
-		ft_event.argv = argv;
-		if (parseLineFtrace(line, ft_event)) {
-			argv = (const TString**)
-				ptrPool->preallocN(EVENT_MAX_NR_ARGS);
-		}
+		ft_event.argv.offset = ftraceStrings->beginArgs();
+		parseLineFtrace(line, ft_event);
 		TraceEvent &p_event = perfEvents->preAlloc();
 		p_event.argc = 0;
-		p_event.argv = argv;
-		if (parseLinePerf(line, p_event)) {
-			argv = (const TString**)
-				ptrPool->preallocN(EVENT_MAX_NR_ARGS);
-		}
+		p_event.argv.offset = perfStrings->beginArgs();
+		parseLinePerf(line, p_event);
 	}
 	eof = tbuf->loadBuffer->isEOF();
 	tbuf->endConsumeBuffer();
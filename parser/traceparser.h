@@ -53,6 +53,12 @@
 #ifndef TRACEPARSER_H
 #define TRACEPARSER_H
 
+#include <atomic>
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QStringList>
 #include <QVector>
 
 #include "parser/genericparams.h"
@@ -72,8 +78,13 @@
 #include "misc/tstring.h"
 #include "vtl/compiler.h"
 
-#define NR_TBUFFERS (4)
-
+class ChunkParser;
+class EventCache;
+class PerfDataReader;
+class RetentionPolicy;
+class RetentionTable;
+class TimeWindow;
+class TraceDatReader;
 class TraceFile;
 class TraceAnalyzer;
 namespace vtl {
@@ -87,19 +98,55 @@ public:
 	TraceParser();
 	~TraceParser();
 	int open(const QString &fileName);
+	int open(const QStringList &fileNames);
 	bool isOpen() const;
 	void close(int *ts_errno);
+	void setParallelParse(bool enable);
+	void setMappedLoad(bool enable);
+	void setLazyArgs(bool enable);
+	void setRetentionPolicy(const RetentionPolicy *policy);
+	quint64 getDroppedEvents(event_t type) const;
+	void setTimeWindow(const TimeWindow *window);
+	void setIndexCache(bool enable);
+	void setFollow(bool enable);
+	bool isFollowing() const;
+	void stopFollowing();
+	void stopLoading();
+	bool getLoadProgress(int64_t *loaded, int64_t *total) const;
+	const QHash<int, QByteArray> &getPrescanNames() const;
+	void setLoadBuffers(unsigned int nr, unsigned int size);
 	void threadParser();
 	void threadReader();
+	void threadStitcher();
+	void threadDecoder();
+	void threadMerger();
 	vtl_always_inline vtl::TList<TraceEvent> *getEventsTList() const;
 	const StringTree<> *getPerfEventTree();
 	const StringTree<> *getFtraceEventTree();
 protected:
 	vtl_always_inline void waitForNextBatch(bool &eof, int &index);
+	vtl_always_inline void pollNextIndex(bool &eof, int &index);
 	void waitForTraceType();
 	tracetype_t traceType;
 	TraceFile *traceFile;
 private:
+	int openCached(const QString &fileName);
+	void writeCache();
+	bool useCache() const;
+	int findWindowRange(const QString &fileName);
+	int openParallel(const QString &fileName);
+	int openTraceDat(const QString &fileName);
+	int openPerfData(const QString &fileName);
+	int openMerged(const QStringList &fileNames);
+	void addMergeStream(TraceParser *parser, int file);
+	void closeMerged();
+	void waitForThreads();
+	void mapEventTypes(const StringTree<> *stree,
+			   const RetentionTable &otherRetention,
+			   QVector<event_t> &typeMap);
+	void stitchChunk(ChunkParser *chunk, TraceLineData &lineData);
+	void deleteChunks();
+	void setTraceType(tracetype_t ttype);
 	void determineTraceType();
 	void guessTraceType();
 	void sendTraceType();
@@ -114,8 +161,17 @@ private:
 	bool parseLinePerf(TraceLine &line, TraceEvent &event);
 	void fixLastEvent();
 	bool parseBuffer(unsigned int index);
-	bool parseLineBugFixup(TraceEvent* event, const vtl::Time &prevTime);
-	MemPool *ptrPool;
+	bool parseLineBugFixup(TraceEvent* event,
+			       const vtl::CompactTime &prevTime);
+	vtl_always_inline EventStrings *getEventStrings(tracetype_t ttype)
+		const;
+	/*
+	 * Each grammar has its own strings, so that the lines that are parsed
+	 * with both grammars, before the trace type is known, do not add the
+	 * strings of the other grammar to those of the trace.
+	 */
+	EventStrings *ftraceStrings;
+	EventStrings *perfStrings;
 	MemPool *postEventPool;
 	TraceEvent fakeEvent;
 	Chunk fakePostEventInfo;
@@ -124,6 +180,84 @@ private:
 	ThreadBuffer<TraceLine> **tbuffers;
 	WorkThread<TraceParser> *parserThread;
 	WorkThread<TraceParser> *readerThread;
+	WorkThread<TraceParser> *stitcherThread;
+	/* The trace type of a sequentially parsed file, if it could be sniffed */
+	tracetype_t sniffedType;
+	/*
+	 * These are used when a large file is parsed in parallel, then the
+	 * parserThread and readerThread are not used.
+	 */
+	bool parallelParse;
+	WorkQueue *chunkQueue;
+	QList<ChunkParser*> chunkParsers;
+	QList<WorkItem<ChunkParser>*> chunkItems;
+	/* Tokenize directly from a mapping of the file instead of copies */
+	bool mappedLoad;
+	/* Only store the file location of the arguments of unknown events */
+	bool lazyArgs;
+	const RetentionPolicy *retentionPolicy;
+	/*
+	 * Only the byte range [rangeBegin, rangeEnd) of a text trace is loaded
+	 * if there is a time window. The names of the tasks that were seen
+	 * before the range are in prescanNames.
+	 */
+	const TimeWindow *timeWindow;
+	int64_t rangeBegin;
+	int64_t rangeEnd;
+	QHash<int, QByteArray> prescanNames;
+	/*
+	 * The parsed events of a text trace are written to an index, which is
+	 * used instead of parsing the trace when it is opened again.
+	 * eventCache is not nullptr if the events were read from the index.
+	 */
+	bool indexCache;
+	EventCache *eventCache;
+	/*
+	 * Keep loading what is appended to a text trace, until stopFollowing()
+	 * is called. Only the sequential pipeline can do this.
+	 */
+	bool follow;
+	/* The loading was stopped early, so the trace is incomplete */
+	std::atomic<bool> loadStopped;
+	/* The number and size of the buffers in the sequential pipeline */
+	unsigned int nrBuffers;
+	unsigned int bufferSize;
+	/*
+	 * These are used when a binary trace.dat or perf.data file is read,
+	 * then the decoderThread is the only thread that is used.
+	 */
+	TraceDatReader *datReader;
+	PerfDataReader *perfDataReader;
+	WorkThread<TraceParser> *decoderThread;
+	/*
+	 * These are used when several files are opened. Each file is parsed by
+	 * its own TraceParser and the mergerThread merges their events by
+	 * timestamp, with a heap of the streams that have events left.
+	 */
+	class MergeStream {
+	public:
+		const vtl::TList<TraceEvent> *events;
+		int pos;
+		int file;
+		QVector<event_t> typeMap;
+		/* These translate the string ids and argument offsets */
+		uint32_t stringBase;
+		uint64_t argBase;
+	};
+	vtl_always_inline static bool isBefore(const MergeStream *a,
+					       const MergeStream *b);
+	void mergeHeapPush(MergeStream *stream);
+	void mergeHeapSiftDown(int i);
+	QStringList mergeFileNames;
+	QList<TraceParser*> mergeParsers;
+	QVector<MergeStream> mergeStreams;
+	QVector<MergeStream*> mergeHeap;
+	WorkThread<TraceParser> *mergerThread;
+	/*
+	 * The parsers of the merged files run concurrently, so they leave the
+	 * string tree of TraceEvent to the parser that merges them.
+	 */
+	bool mergeSource;
 	TraceLineData ftraceLineData;
 	TraceLineData perfLineData;
 	vtl::TList<TraceEvent> *ftraceEvents;
@@ -140,6 +274,11 @@ vtl_always_inline void TraceParser::waitForNextBatch(bool &eof, int &index)
 	eventsWatcher->waitForNextBatch(eof, index);
 }
 
+vtl_always_inline void TraceParser::pollNextIndex(bool &eof, int &index)
+{
+	eventsWatcher->pollNextIndex(eof, index);
+}
+
 /* This parses a buffer */
 vtl_always_inline bool TraceParser::parseFtraceBuffer(unsigned int index)
 {
@@ -158,32 +297,24 @@ vtl_always_inline bool TraceParser::parseBuffer_(tracetype_t ttype,
 {
 	unsigned int i, s;
 	bool eof;
-	const TString **argv;
 
 	ThreadBuffer<TraceLine> *tbuf = tbuffers[index];
 	tbuf->beginConsumeBuffer();
 
 	s = tbuf->list.size();
-	argv = (const TString**) ptrPool->preallocN(EVENT_MAX_NR_ARGS);
 
 	for(i = 0; i < s; i++) {
 		TraceLine &line = tbuf->list[i];
 		if (ttype == TRACE_TYPE_FTRACE) {
 			TraceEvent &event = ftraceEvents->preAlloc();
 			event.argc = 0;
-			event.argv = argv;
-			if (parseLineFtrace(line, event)) {
-				argv = (const TString**)
-					ptrPool->preallocN(EVENT_MAX_NR_ARGS);
-			}
+			event.argv.offset = ftraceStrings->beginArgs();
+			parseLineFtrace(line, event);
 		} else if (ttype == TRACE_TYPE_PERF) {
 			TraceEvent &event = perfEvents->preAlloc();
 			event.argc = 0;
-			event.argv = argv;
-			if (parseLinePerf(line, event)) {
-				argv = (const TString**)
-					ptrPool->preallocN(EVENT_MAX_NR_ARGS);
-			}
+			event.argv.offset = perfStrings->beginArgs();
+			parseLinePerf(line, event);
 		}
 	}
 	eof = tbuf->loadBuffer->isEOF();
@@ -204,7 +335,7 @@ vtl_always_inline bool TraceParser::parseLineFtrace(TraceLine &line,
 		}
 		ftraceLineData.prevTime = event.time;
 
-		ptrPool->commitN(event.argc);
+		ftraceStrings->commitArgs();
 		ftraceEvents->commit();
 
 		event.postEventInfo = nullptr;
@@ -230,7 +361,7 @@ vtl_always_inline bool TraceParser::parseLinePerf(TraceLine &line,
 		}
 		perfLineData.prevTime = event.time;
 
-		ptrPool->commitN(event.argc);
+		perfStrings->commitArgs();
 		perfEvents->commit();
 
 		if (perfLineData.prevLineIsEvent) {
@@ -240,12 +371,34 @@ vtl_always_inline bool TraceParser::parseLinePerf(TraceLine &line,
 				allocObj();
 			chunk->offset = perfLineData.infoBegin;
 			chunk->len = line.begin - perfLineData.infoBegin;
+			chunk->file = 0;
+			chunk->type = CHUNK_TEXT;
 			perfLineData.prevEvent->postEventInfo = chunk;
 			perfLineData.prevLineIsEvent = true;
 		}
 		perfLineData.prevEvent = &event;
 		perfLineData.nrEvents++;
 		return true;
+	} else if (perfGrammar->droppedEvent()) {
+		/*
+		 * The lines after an event that was dropped, such as a
+		 * backtrace, are given to the fakeEvent so that they are
+		 * dropped too.
+		 */
+		if (perfLineData.prevLineIsEvent) {
+			perfLineData.prevEvent->postEventInfo = nullptr;
+		} else if (perfLineData.prevEvent != &fakeEvent) {
+			Chunk *chunk = (Chunk*) postEventPool->
+				allocObj();
+			chunk->offset = perfLineData.infoBegin;
+			chunk->len = line.begin - perfLineData.infoBegin;
+			chunk->file = 0;
+			chunk->type = CHUNK_TEXT;
+			perfLineData.prevEvent->postEventInfo = chunk;
+		}
+		perfLineData.prevLineIsEvent = true;
+		perfLineData.prevEvent = &fakeEvent;
+		return false;
 	} else {
 		if (perfLineData.prevLineIsEvent) {
 			perfLineData.infoBegin = line.begin;
@@ -260,4 +413,11 @@ vtl_always_inline vtl::TList<TraceEvent> *TraceParser::getEventsTList() const
 	return events;
 }
 
+/* Unknown traces are treated as perf traces, like in setTraceType() */
+vtl_always_inline EventStrings *TraceParser::getEventStrings(tracetype_t ttype)
+	const
+{
+	return ttype == TRACE_TYPE_FTRACE ? ftraceStrings : perfStrings;
+}
+
 #endif /* TRACEPARSER_H */
@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include "parser/tokenizer.h"
+#include "parser/tracefile.h"
+#include "parser/tracesniffer.h"
+#include "parser/traceevent.h"
+
+/* The number of bytes at the beginning of a file that are looked at */
+#define SNIFF_SIZE (64 * 1024)
+
+/*
+ * The number of lines of the winning type that is needed, unless the whole
+ * file fits in SNIFF_SIZE, and how many times more of them there must be than
+ * there are lines of the other type.
+ */
+#define SNIFF_MIN_LINES (16)
+#define SNIFF_CONFIDENCE_FACTOR (20)
+
+#define FTRACE_TRACER_COMMENT "# tracer:"
+#define TRACECMD_CPUS_LINE "cpus="
+
+vtl_always_inline bool TraceSniffer::isNumber(const char *c, const char *end)
+{
+	if (c >= end)
+		return false;
+	for (; c < end; c++) {
+		if (*c < '0' || *c > '9')
+			return false;
+	}
+	return true;
+}
+
+/* Returns true if the word is a CPU column, such as "[001]" */
+vtl_always_inline bool TraceSniffer::isCPU(const TString &word)
+{
+	if (word.len < 3 || word.ptr[0] != '[' ||
+	    word.ptr[word.len - 1] != ']')
+		return false;
+	return isNumber(word.ptr + 1, word.ptr + word.len - 1);
+}
+
+vtl_always_inline tracetype_t TraceSniffer::sniffLine(const char *line,
+						      const TString *words,
+						      unsigned int nWords)
+{
+	const char *end;
+	const char *c;
+	unsigned int i;
+
+	/* A backtrace line of perf script begins with a tab */
+	if (line[0] == '\t')
+		return TRACE_TYPE_PERF;
+	if (nWords == 0)
+		return TRACE_TYPE_UNKNOWN;
+	if (words[0].ptr[0] == '#') {
+		if (!strncmp(line, FTRACE_TRACER_COMMENT,
+			     strlen(FTRACE_TRACER_COMMENT)))
+			return TRACE_TYPE_FTRACE;
+		return TRACE_TYPE_UNKNOWN;
+	}
+	/* The first line of the output of trace-cmd report */
+	if (nWords == 1 && !strncmp(words[0].ptr, TRACECMD_CPUS_LINE,
+				    strlen(TRACECMD_CPUS_LINE)))
+		return TRACE_TYPE_FTRACE;
+
+	/*
+	 * The task name may contain spaces, so we look for the CPU column and
+	 * check the word that precedes it.
+	 */
+	for (i = 1; i < nWords; i++) {
+		if (isCPU(words[i]))
+			break;
+	}
+	if (i == nWords)
+		return TRACE_TYPE_UNKNOWN;
+
+	end = words[i - 1].ptr + words[i - 1].len;
+	if (i >= 2 && isNumber(words[i - 1].ptr, end))
+		return TRACE_TYPE_PERF;
+	c = (const char*) memrchr(words[i - 1].ptr, '-', words[i - 1].len);
+	if (c != nullptr && isNumber(c + 1, end))
+		return TRACE_TYPE_FTRACE;
+	return TRACE_TYPE_UNKNOWN;
+}
+
+tracetype_t TraceSniffer::sniff(TraceFile *file)
+{
+	TString words[EVENT_MAX_NR_ARGS];
+	unsigned long count[TRACE_TYPE_MAX];
+	unsigned long minLines;
+	unsigned int pos;
+	unsigned int next;
+	unsigned int n;
+	unsigned int end;
+	char *buf;
+	char *eol;
+	int ts_errno;
+	ssize_t r;
+	tracetype_t ttype = TRACE_TYPE_UNKNOWN;
+	int t;
+
+	for (t = 0; t < TRACE_TYPE_MAX; t++)
+		count[t] = 0;
+
+	buf = new char[SNIFF_SIZE];
+	r = file->readAt(0, buf, SNIFF_SIZE, &ts_errno);
+	if (r <= 0)
+		goto out;
+
+	/* Only complete lines are looked at, unless this is the whole file */
+	if (r == SNIFF_SIZE) {
+		eol = (char*) memrchr(buf, '\n', r);
+		if (eol == nullptr)
+			goto out;
+		end = eol - buf + 1;
+		minLines = SNIFF_MIN_LINES;
+	} else {
+		end = (unsigned int) r;
+		minLines = 1;
+	}
+
+	for (pos = 0; pos < end; pos = next) {
+		n = Tokenizer::tokenizeLine(buf, pos, end, words,
+					    EVENT_MAX_NR_ARGS, &next);
+		count[sniffLine(buf + pos, words, n)]++;
+		if (next <= pos)
+			break;
+	}
+
+	if (count[TRACE_TYPE_FTRACE] >= minLines &&
+	    count[TRACE_TYPE_FTRACE] > count[TRACE_TYPE_PERF] *
+	    SNIFF_CONFIDENCE_FACTOR)
+		ttype = TRACE_TYPE_FTRACE;
+	else if (count[TRACE_TYPE_PERF] >= minLines &&
+		 count[TRACE_TYPE_PERF] > count[TRACE_TYPE_FTRACE] *
+		 SNIFF_CONFIDENCE_FACTOR)
+		ttype = TRACE_TYPE_PERF;
+out:
+	delete[] buf;
+	return ttype;
+}
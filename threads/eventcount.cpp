@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <climits>
+
+#include "threads/eventcount.h"
+
+#ifdef __linux__
+extern "C" {
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+}
+
+/*
+ * The futex is the seq member, which is a 32-bit integer as the kernel expects.
+ * We never share it between processes, so the private operations are fine.
+ */
+static vtl_always_inline int *futexAddr(std::atomic<uint32_t> *a)
+{
+	return reinterpret_cast<int*>(a);
+}
+#endif
+
+EventCount::EventCount():
+	seq(0), waiters(0)
+{}
+
+/*
+ * Sleeps until notify() has been called after the call to prepareWait() that
+ * returned key. A spurious wakeup is possible, so the caller must check its
+ * condition again.
+ */
+void EventCount::wait(uint32_t key)
+{
+#ifdef __linux__
+	/*
+	 * The kernel checks that seq still equals key before we go to sleep,
+	 * so a notify() that came after prepareWait() cannot be lost.
+	 */
+	syscall(SYS_futex, futexAddr(&seq), FUTEX_WAIT_PRIVATE, (int) key,
+		nullptr, nullptr, 0);
+#else
+	mutex.lock();
+	while (seq.load(std::memory_order_relaxed) == key)
+		changed.wait(&mutex);
+	mutex.unlock();
+#endif
+	waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void EventCount::wake()
+{
+#ifdef __linux__
+	seq.fetch_add(1, std::memory_order_seq_cst);
+	syscall(SYS_futex, futexAddr(&seq), FUTEX_WAKE_PRIVATE, INT_MAX,
+		nullptr, nullptr, 0);
+#else
+	mutex.lock();
+	seq.fetch_add(1, std::memory_order_seq_cst);
+	changed.wakeAll();
+	mutex.unlock();
+#endif
+}
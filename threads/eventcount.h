@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef EVENTCOUNT_H
+#define EVENTCOUNT_H
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef __linux__
+#include <QMutex>
+#include <QWaitCondition>
+#endif
+
+#include "vtl/compiler.h"
+
+/*
+ * An EventCount lets a thread sleep until a condition, which is kept in atomic
+ * variables outside of this class, becomes true. A waiting thread does:
+ *
+ *	while (!condition) {
+ *		key = ec.prepareWait();
+ *		if (condition) {
+ *			ec.cancelWait();
+ *			break;
+ *		}
+ *		ec.wait(key);
+ *	}
+ *
+ * The thread that makes the condition true calls notify() after it has stored
+ * the new value. The notify() is only a load of the number of waiters, unless
+ * some thread is sleeping, so the kernel is only entered when one of the
+ * threads is starved. On Linux, the sleeping is done with a futex, elsewhere
+ * with a QWaitCondition.
+ */
+class EventCount
+{
+public:
+	EventCount();
+	vtl_always_inline uint32_t prepareWait();
+	vtl_always_inline void cancelWait();
+	void wait(uint32_t key);
+	vtl_always_inline void notify();
+	template<typename T>
+	vtl_always_inline void waitForValue(const std::atomic<T> &var,
+					    T value);
+	static vtl_always_inline void cpuRelax();
+	/* The number of times that we poll before going to sleep */
+	static const unsigned int SPIN_COUNT = 256;
+private:
+	void wake();
+	std::atomic<uint32_t> seq;
+	std::atomic<int> waiters;
+#ifndef __linux__
+	QMutex mutex;
+	QWaitCondition changed;
+#endif
+};
+
+vtl_always_inline uint32_t EventCount::prepareWait()
+{
+	waiters.fetch_add(1, std::memory_order_seq_cst);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	return seq.load(std::memory_order_seq_cst);
+}
+
+vtl_always_inline void EventCount::cancelWait()
+{
+	waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+vtl_always_inline void EventCount::notify()
+{
+	/*
+	 * This fence orders the store of the condition before the load of
+	 * waiters, it pairs with the fence in prepareWait().
+	 */
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (unlikely(waiters.load(std::memory_order_relaxed) != 0))
+		wake();
+}
+
+/*
+ * Waits until var has the value value. We spin for a short while first, since
+ * when the threads run at similar speeds, the wait is usually short enough that
+ * going to sleep would cost more than it saves.
+ */
+template<typename T>
+vtl_always_inline void EventCount::waitForValue(const std::atomic<T> &var,
+						T value)
+{
+	unsigned int spin;
+	uint32_t key;
+
+	for (spin = 0; spin < SPIN_COUNT; spin++) {
+		if (var.load(std::memory_order_acquire) == value)
+			return;
+		cpuRelax();
+	}
+	while (var.load(std::memory_order_acquire) != value) {
+		key = prepareWait();
+		if (var.load(std::memory_order_acquire) == value) {
+			cancelWait();
+			break;
+		}
+		wait(key);
+	}
+}
+
+vtl_always_inline void EventCount::cpuRelax()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+	asm volatile("yield" ::: "memory");
+#endif
+}
+
+#endif /* EVENTCOUNT_H */
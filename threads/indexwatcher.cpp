@@ -63,17 +63,14 @@ void IndexWatcher::setBatchSize(int bSize)
 
 void IndexWatcher::sendEOF()
 {
-	mutex.lock();
-	isEOF = true;
-	batchCompleted.wakeAll();
-	mutex.unlock();
+	isEOF.store(true, std::memory_order_release);
+	batchCompleted.notify();
 }
 
+/* This must not be called while the producer or the consumer is running */
 void IndexWatcher::reset()
 {
-	mutex.lock();
-	isEOF = false;
-	postedIndex = 0;
-	receivedIndex = 0;
-	mutex.unlock();
+	isEOF.store(false, std::memory_order_relaxed);
+	postedIndex.store(0, std::memory_order_relaxed);
+	receivedIndex.store(0, std::memory_order_relaxed);
 }
@@ -53,53 +53,96 @@
 #ifndef INDEXWATCHER_H
 #define INDEXWATCHER_H
 
-#include <QMutex>
-#include <QWaitCondition>
+#include <atomic>
 
+#include "threads/eventcount.h"
 #include "vtl/compiler.h"
 
+/*
+ * This class is used by one producer thread to tell one consumer thread how
+ * far it has come. The producer only takes the cost of a store and a fence in
+ * sendNextIndex(), the EventCount is only used to wake up the consumer, when
+ * it is sleeping and a full batch is ready.
+ */
 class IndexWatcher
 {
 public:
 	IndexWatcher(int bSize = 100);
 	void setBatchSize(int bSize);
 	vtl_always_inline void waitForNextBatch(bool &eof, int &index);
+	vtl_always_inline void pollNextIndex(bool &eof, int &index);
 	vtl_always_inline void sendNextIndex(int index);
 	void sendEOF();
 	void reset();
 private:
+	vtl_always_inline bool batchReady() const;
 	int batchSize;
-	bool isEOF;
+	std::atomic<bool> isEOF;
 	/* This is the highest index posted by the producer */
-	int postedIndex;
+	std::atomic<int> postedIndex;
 	/* This is the higher index being received by the consumer */
-	int receivedIndex;
-	QMutex mutex;
-	QWaitCondition batchCompleted;
+	std::atomic<int> receivedIndex;
+	EventCount batchCompleted;
 };
 
+vtl_always_inline bool IndexWatcher::batchReady() const
+{
+	return isEOF.load(std::memory_order_acquire) ||
+		postedIndex.load(std::memory_order_acquire) -
+		receivedIndex.load(std::memory_order_relaxed) >= batchSize;
+}
+
 vtl_always_inline void IndexWatcher::waitForNextBatch(bool &eof, int &index)
 {
-	mutex.lock();
-	while(!isEOF && postedIndex - receivedIndex < batchSize) {
-		batchCompleted.wait(&mutex);
+	unsigned int spin;
+	uint32_t key;
+
+	for (spin = 0; spin < EventCount::SPIN_COUNT; spin++) {
+		if (batchReady())
+			goto ready;
+		EventCount::cpuRelax();
 	}
-	receivedIndex = postedIndex;
-	index = postedIndex;
-	eof = isEOF;
-	mutex.unlock();
+	while (!batchReady()) {
+		key = batchCompleted.prepareWait();
+		if (batchReady()) {
+			batchCompleted.cancelWait();
+			break;
+		}
+		batchCompleted.wait(key);
+	}
+ready:
+	/*
+	 * The producer posts the last index before it sends EOF, so we must
+	 * load isEOF before postedIndex, in order to not miss the last index.
+	 */
+	eof = isEOF.load(std::memory_order_acquire);
+	index = postedIndex.load(std::memory_order_acquire);
+	receivedIndex.store(index, std::memory_order_relaxed);
+}
+
+/*
+ * This is like waitForNextBatch() but it never waits, the index is whatever the
+ * producer has posted so far, even if it is not a full batch.
+ */
+vtl_always_inline void IndexWatcher::pollNextIndex(bool &eof, int &index)
+{
+	eof = isEOF.load(std::memory_order_acquire);
+	index = postedIndex.load(std::memory_order_acquire);
+	receivedIndex.store(index, std::memory_order_relaxed);
 }
 
 vtl_always_inline void IndexWatcher::sendNextIndex(int index)
 {
-	mutex.lock();
-	if (index <= postedIndex)
-		goto out;
-	postedIndex = index;
-	if (postedIndex - receivedIndex >= batchSize)
-		batchCompleted.wakeAll();
-out:
-	mutex.unlock();
+	if (index <= postedIndex.load(std::memory_order_relaxed))
+		return;
+	postedIndex.store(index, std::memory_order_release);
+	/*
+	 * The receivedIndex that we see may be older than the one that the
+	 * consumer has but that can only make us wake it up unnecessarily, it
+	 * cannot make us miss a wakeup.
+	 */
+	if (index - receivedIndex.load(std::memory_order_relaxed) >= batchSize)
+		batchCompleted.notify();
 }
 
 #endif /* INDEXWATCHER_H */
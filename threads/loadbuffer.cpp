@@ -55,6 +55,7 @@
 #include <cstdlib>
 #include <cstring>
 #include "misc/tstring.h"
+#include "parser/compress/compressedfile.h"
 #include "threads/loadbuffer.h"
 #include "vtl/error.h"
 
@@ -69,8 +70,8 @@ LoadBuffer::LoadBuffer(unsigned int size):
 	IOerror(false), IOerrno(0), state(LOADSTATE_EMPTY), eof(false)
 {
 	/*
-	 * We need the extra byte to be able to set a null character in
-	 * TraceFile::ReadNextWord() one byte out of bounds.
+	 * We need the extra byte to be able to set a null character after the
+	 * last line, in case the file does not end with a newline.
 	 */
 	memory = (char*) mmap(nullptr, 2 * size + 1, PROT_READ | PROT_WRITE,
 			      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -87,11 +88,15 @@ LoadBuffer::~LoadBuffer()
 
 /*
  * This function should be called from the IO thread until the function returns
- * true.
+ * true. At most maxRead bytes, which must not be larger than bufSize, are read
+ * from the file. If compressed is not nullptr, then the bytes are decompressed
+ * from it instead.
  */
-bool LoadBuffer::produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin)
+bool LoadBuffer::produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin,
+			       size_t maxRead, CompressedFile *compressed)
 {
 	ssize_t nRawBytes;
+	int ts_errno = 0;
 	char *c;
 
 	waitForConsumptionComplete();
@@ -103,10 +108,15 @@ bool LoadBuffer::produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin)
 	strncpy(buffer, lineBegin->ptr, lineBegin->len);
 
 	filePos = *filePosPtr;
-	nRawBytes = read(fd, readBegin, bufSize);
+	if (compressed != nullptr) {
+		nRawBytes = compressed->read(readBegin, maxRead, &ts_errno);
+	} else {
+		nRawBytes = read(fd, readBegin, maxRead);
+		ts_errno = errno;
+	}
 
 	if (nRawBytes < 0) {
-		IOerrno = errno;
+		IOerrno = ts_errno;
 		IOerror = true;
 		nRawBytes = 0;
 	} else {
@@ -128,6 +138,18 @@ bool LoadBuffer::produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin)
 		lineBegin->len++;
 	}
 
+	/*
+	 * If there was no newline in what was read, e.g. because a growing file
+	 * is being followed and the line has not been completely written yet,
+	 * then the incomplete line that we carried over continues as well.
+	 */
+	if (c < readBegin && nRawBytes > 0) {
+		if (nRead + nRawBytes >= bufSize)
+			abort();
+		lineBegin->len = nRead + nRawBytes;
+		c = buffer - 1;
+	}
+
 	if (lineBegin->len > 0) {
 		c++;
 		strncpy(lineBegin->ptr, c, lineBegin->len);
@@ -135,6 +157,58 @@ bool LoadBuffer::produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin)
 
 	nRead += nRawBytes;
 	nRead -= lineBegin->len;
+	/*
+	 * The words are not null terminated by the tokenizer, so make sure that
+	 * the data after the last word isn't stale data from a previous read.
+	 */
+	buffer[nRead] = '\0';
+
+	completeLoading();
+
+	*filePosPtr += nRead;
+	return eof;
+}
+
+/*
+ * This is the zero-copy alternative to produceBuffer(). The buffer is set to
+ * point directly into a read-only mapping of the file, where mapped is the
+ * byte at *filePosPtr and remaining is the number of bytes left of the range
+ * that is loaded. The buffer ends at the last newline within bufSize bytes,
+ * unless the line is longer than that, in which case the buffer is extended to
+ * the end of the line.
+ */
+bool LoadBuffer::produceMappedBuffer(char *mapped, int64_t *filePosPtr,
+				     int64_t remaining)
+{
+	char *c = nullptr;
+	char *end;
+
+	waitForConsumptionComplete();
+
+	filePos = *filePosPtr;
+	buffer = mapped;
+	IOerror = false;
+	IOerrno = 0;
+
+	if (remaining > (int64_t) bufSize) {
+		for (end = mapped + bufSize - 1; end >= mapped; end--) {
+			if (*end == '\n') {
+				c = end;
+				break;
+			}
+		}
+		if (c == nullptr)
+			c = (char*) memchr(mapped + bufSize, '\n',
+					   remaining - bufSize);
+	}
+
+	if (c != nullptr) {
+		nRead = c - mapped + 1;
+		eof = false;
+	} else {
+		nRead = remaining;
+		eof = true;
+	}
 
 	completeLoading();
 
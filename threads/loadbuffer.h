@@ -53,24 +53,27 @@
 #ifndef LOADBUFFER_H
 #define LOADBUFFER_H
 
+#include <atomic>
 #include <cstdint>
 
-#include <QMutex>
-#include <QWaitCondition>
-
 extern "C" {
 #include <unistd.h>
 }
 
+#include "threads/eventcount.h"
 #include "vtl/compiler.h"
 
+class CompressedFile;
 class TString;
 
 /*
  * This class is a load buffer for three threads where one is a loader, i.e.
  * IO thread, and the second is a tokenizer, and the third is a consumer, which
  * probably is a grammar processing thread. The synchronization functions have
- * not been designed for scenarios with more than one thread per category
+ * not been designed for scenarios with more than one thread per category.
+ * Since there is only one thread per category, the buffer is handed over by
+ * storing the state with release semantics, without taking any lock. A thread
+ * only goes to sleep if the buffer is not ready after a short spin.
  */
 class LoadBuffer
 {
@@ -85,7 +88,11 @@ public:
 	int64_t filePos;
 	bool IOerror;
 	int IOerrno;
-	bool produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin);
+	bool produceBuffer(int fd, int64_t *filePosPtr, TString *lineBegin,
+			   size_t maxRead,
+			   CompressedFile *compressed = nullptr);
+	bool produceMappedBuffer(char *mapped, int64_t *filePosPtr,
+				 int64_t remaining);
 	void beginProduceBuffer();
 	void endProduceBuffer();
 	void beginTokenizeBuffer();
@@ -105,64 +112,37 @@ private:
 		LOADSTATE_LOADED,
 		LOADSTATE_TOKENIZED
 	} loadbufferstate_t;
-	loadbufferstate_t state;
-	QMutex mutex;
-	QWaitCondition consumptionComplete;
-	QWaitCondition loadingComplete;
-	QWaitCondition parsingComplete;
+	std::atomic<loadbufferstate_t> state;
+	/* This is used to sleep, when the other thread is not done yet */
+	EventCount stateChanged;
 	bool eof;
 };
 
 vtl_always_inline void LoadBuffer::waitForLoadingComplete() {
-	mutex.lock();
-	while(state != LOADSTATE_LOADED) {
-		/*
-		 * Note that this implicitely unlocks the mutex while waiting
-		 * and relocks it when done waiting.
-		 */
-		loadingComplete.wait(&mutex);
-	}
+	stateChanged.waitForValue(state, LOADSTATE_LOADED);
 }
 
 vtl_always_inline void LoadBuffer::completeLoading() {
-	state = LOADSTATE_LOADED;
-	loadingComplete.wakeOne();
-	mutex.unlock();
+	state.store(LOADSTATE_LOADED, std::memory_order_release);
+	stateChanged.notify();
 }
 
 vtl_always_inline void LoadBuffer::waitForTokenizationComplete() {
-	mutex.lock();
-	while(state != LOADSTATE_TOKENIZED) {
-		/*
-		 * Note that this implicitely unlocks the mutex while waiting
-		 * and relocks it when done waiting.
-		 */
-		parsingComplete.wait(&mutex);
-	}
+	stateChanged.waitForValue(state, LOADSTATE_TOKENIZED);
 }
 
 vtl_always_inline void LoadBuffer::completeTokenization() {
-	state = LOADSTATE_TOKENIZED;
-	parsingComplete.wakeOne();
-	mutex.unlock();
+	state.store(LOADSTATE_TOKENIZED, std::memory_order_release);
+	stateChanged.notify();
 }
 
-
 vtl_always_inline void LoadBuffer::waitForConsumptionComplete() {
-	mutex.lock();
-	while(state != LOADSTATE_EMPTY) {
-		/*
-		 * Note that this implicitely unlocks the mutex while waiting
-		 * and relocks it when done waiting.
-		 */
-		consumptionComplete.wait(&mutex);
-	}
+	stateChanged.waitForValue(state, LOADSTATE_EMPTY);
 }
 
 vtl_always_inline void LoadBuffer::completeConsumption() {
-	state = LOADSTATE_EMPTY;
-	consumptionComplete.wakeOne();
-	mutex.unlock();
+	state.store(LOADSTATE_EMPTY, std::memory_order_release);
+	stateChanged.notify();
 }
 
 vtl_always_inline bool LoadBuffer::isEOF() const {
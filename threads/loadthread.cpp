@@ -54,28 +54,202 @@
 #include <cstdlib>
 #include <cstring>
 
+#include "misc/osapi.h"
+#include "misc/traceshark.h"
 #include "misc/tstring.h"
+#include "parser/compress/compressedfile.h"
 #include "threads/loadbuffer.h"
 #include "threads/loadthread.h"
 #include "vtl/error.h"
 
 extern "C" {
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 }
 
-LoadThread::LoadThread(LoadBuffer **buffers, unsigned int nBuf, int myfd)
+LoadThread::LoadThread(LoadBuffer **buffers, unsigned int nBuf, int myfd,
+		       int64_t begin, int64_t end, bool mapped,
+		       CompressedFile *compr, bool follow)
 	: TThread(QString("LoadThread")), loadBuffers(buffers), nBuffers(nBuf),
-	  fd(myfd)
-{}
+	  fd(myfd), rangeBegin(begin), rangeEnd(end), useMap(mapped),
+	  compressed(compr), mapping(nullptr), mappingSize(0),
+	  mappedRange(nullptr), following(follow), stopped(false),
+	  loadEnd(begin), loadPos(begin)
+{
+	pageSize = sysconf(_SC_PAGESIZE);
+	if (pageSize <= 0)
+		pageSize = 4096;
+}
+
+/*
+ * The mapping must remain until the thread has been waited for and the
+ * buffers have been consumed, because the buffers point into it.
+ */
+LoadThread::~LoadThread()
+{
+	if (mapping == nullptr)
+		return;
+	if (munmap(mapping, mappingSize) != 0)
+		munmap_err();
+}
 
 void LoadThread::run()
+{
+	if (useMap && !following && compressed == nullptr && mapRange())
+		runMapped();
+	else
+		runRead();
+}
+
+/* This may be called from any thread, the loading ends at the next poll */
+void LoadThread::stopFollowing()
+{
+	stopped.store(true, std::memory_order_release);
+}
+
+/*
+ * This may be called from any thread, the loading ends at the next buffer, as
+ * if the end of the file had been reached there.
+ */
+void LoadThread::stopLoading()
+{
+	stopped.store(true, std::memory_order_release);
+}
+
+/* This must only be called after the thread has been waited for */
+int64_t LoadThread::getLoadEnd() const
+{
+	return loadEnd;
+}
+
+/* This may be called from any thread, in order to show the progress */
+int64_t LoadThread::getLoadPos() const
+{
+	return loadPos.load(std::memory_order_relaxed);
+}
+
+/*
+ * Polls the size of the file until there is data beyond pos. Returns false if
+ * stopFollowing() was called before that. Polling is used instead of inotify,
+ * because inotify does not report writes to files on all file systems, e.g.
+ * NFS, and we would need to poll for the stop request anyway.
+ */
+bool LoadThread::waitForData(int64_t pos)
+{
+	struct stat sbuf;
+
+	while (!stopped.load(std::memory_order_acquire)) {
+		if (fstat(fd, &sbuf) != 0)
+			return false;
+		if ((int64_t) sbuf.st_size > pos)
+			return true;
+		usleep(FOLLOW_POLL_INTERVAL_US);
+	}
+	return false;
+}
+
+/*
+ * Maps the range read-only. In case of mmap() failure, which may happen with
+ * large files on 32-bit platforms, we return false and the caller will fall
+ * back to read(). The range must not extend beyond the end of the file.
+ */
+bool LoadThread::mapRange()
+{
+	int64_t offset;
+	size_t len;
+	char *reserved;
+	char *m;
+
+	if (rangeEnd <= rangeBegin || rangeEnd == INT64_MAX)
+		return false;
+
+	offset = rangeBegin - rangeBegin % pageSize;
+	if ((uint64_t) (rangeEnd - offset) > (uint64_t) (SIZE_MAX - pageSize))
+		return false;
+	len = (size_t) (rangeEnd - offset);
+
+	/*
+	 * Reserve an extra page after the range and then map the file over the
+	 * beginning of the reservation. The extra page will always read as
+	 * zeroes, so a word at the very end of the file is followed by a null
+	 * character, even if the file size is a multiple of the page size.
+	 */
+	reserved = (char*) mmap(nullptr, len + pageSize, PROT_READ,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (reserved == MAP_FAILED)
+		return false;
+	m = (char*) mmap(reserved, len, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd,
+			 (off_t) offset);
+	if (m == MAP_FAILED) {
+		if (munmap(reserved, len + pageSize) != 0)
+			munmap_err();
+		return false;
+	}
+	posix_madvise(m, len, POSIX_MADV_SEQUENTIAL);
+
+	mapping = m;
+	mappingSize = len + pageSize;
+	mappedRange = m + (rangeBegin - offset);
+	return true;
+}
+
+/*
+ * Fault in the pages of the next buffer in this thread, so that the reader
+ * thread will not be stalled by page faults when it tokenizes the buffer.
+ */
+void LoadThread::populate(char *addr, int64_t len)
+{
+	char *begin = addr - ((uintptr_t) addr % pageSize);
+	char *end = addr + len;
+	volatile char sink;
+	char *c;
+
+#ifdef MADV_POPULATE_READ
+	if (madvise(begin, end - begin, MADV_POPULATE_READ) == 0)
+		return;
+#endif
+	for (c = begin; c < end; c += pageSize)
+		sink = *c;
+	(void) sink;
+}
+
+void LoadThread::runMapped()
+{
+	unsigned int i = 0;
+	bool eof;
+	int64_t filePos = rangeBegin;
+	int64_t remaining;
+	int64_t bufSize = (int64_t) loadBuffers[0]->bufSize;
+	char *mapped;
+
+	do {
+		remaining = rangeEnd - filePos;
+		if (stopped.load(std::memory_order_acquire))
+			remaining = 0;
+		mapped = mappedRange + (filePos - rangeBegin);
+		populate(mapped, TSMIN(remaining, bufSize));
+		eof = loadBuffers[i]->produceMappedBuffer(mapped, &filePos,
+							  remaining);
+		loadPos.store(filePos, std::memory_order_relaxed);
+		i++;
+		if (i == nBuffers)
+			i = 0;
+	} while(!eof);
+	loadEnd = filePos;
+}
+
+void LoadThread::runRead()
 {
 	unsigned int i = 0;
 	bool eof;
-	int64_t filePos = 0;
+	int64_t filePos = rangeBegin;
+	int64_t remaining;
+	size_t maxRead;
 	TString lineBegin;
 	size_t bufSize = loadBuffers[0]->bufSize;
+	LoadBuffer *loadBuffer;
+	int ts_errno = 0;
 
 	lineBegin.ptr = (char*) mmap(nullptr, bufSize, PROT_READ|PROT_WRITE,
 			     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
@@ -83,12 +257,52 @@ void LoadThread::run()
 		mmap_err();
 	lineBegin.len = 0;
 
+	/*
+	 * If the seek fails, then the first read() will most likely fail as
+	 * well and the error will be reported through the IOerror member of
+	 * the LoadBuffer.
+	 */
+	if (rangeBegin != 0) {
+		if (compressed != nullptr)
+			compressed->skip(rangeBegin, &ts_errno);
+		else
+			lseek64(fd, rangeBegin, SEEK_SET);
+	}
+
 	do {
-		eof = loadBuffers[i]->produceBuffer(fd, &filePos, &lineBegin);
+		/*
+		 * The bytes that has been read but not yet consumed are those
+		 * of the incomplete line in lineBegin.
+		 */
+		remaining = rangeEnd - (filePos + (int64_t) lineBegin.len);
+		if (stopped.load(std::memory_order_acquire))
+			remaining = 0;
+		if (remaining > 0)
+			maxRead = (size_t) TSMIN(remaining, (int64_t) bufSize);
+		else
+			maxRead = 0;
+		/* A read of zero bytes is taken as the end of the file */
+		if (following && maxRead > 0 &&
+		    !waitForData(filePos + (int64_t) lineBegin.len))
+			maxRead = 0;
+		loadBuffer = loadBuffers[i];
+		eof = loadBuffer->produceBuffer(fd, &filePos, &lineBegin,
+						maxRead, compressed);
+		loadPos.store(filePos, std::memory_order_relaxed);
 		i++;
 		if (i == nBuffers)
 			i = 0;
 	} while(!eof);
+	loadEnd = filePos;
+
+	/*
+	 * A read error ends the loading, like the end of the file. With a
+	 * compressed file, it is likely to be corrupt or truncated, which the
+	 * user should be told about, since the trace would otherwise just
+	 * appear to be shorter than it is.
+	 */
+	if (compressed != nullptr && loadBuffer->IOerror)
+		vtl::warn(loadBuffer->IOerrno, "Failed to decompress the file");
 
 	if (munmap(lineBegin.ptr, bufSize) != 0)
 		munmap_err();
@@ -54,20 +54,59 @@
 #ifndef LOADTHREAD_H
 #define LOADTHREAD_H
 
+#include <atomic>
+#include <cstdint>
+
 #include "threads/tthread.h"
 
+class CompressedFile;
 class LoadBuffer;
 
 class LoadThread : public TThread
 {
 public:
-	LoadThread(LoadBuffer **buffers, unsigned int nBuf, int myfd);
+	LoadThread(LoadBuffer **buffers, unsigned int nBuf, int myfd,
+		   int64_t begin = 0, int64_t end = INT64_MAX,
+		   bool mapped = false, CompressedFile *compr = nullptr,
+		   bool follow = false);
+	~LoadThread();
+	void stopFollowing();
+	void stopLoading();
+	int64_t getLoadEnd() const;
+	int64_t getLoadPos() const;
 protected:
 	void run();
 private:
+	void runRead();
+	void runMapped();
+	bool mapRange();
+	void populate(char *addr, int64_t len);
+	bool waitForData(int64_t pos);
 	LoadBuffer **loadBuffers;
 	unsigned int nBuffers;
 	int fd;
+	/* The range of the file that is loaded, end is exclusive */
+	int64_t rangeBegin;
+	int64_t rangeEnd;
+	bool useMap;
+	/* If this is not nullptr, then the data is decompressed from it */
+	CompressedFile *compressed;
+	/* The mapping, including the sentinel page after the end of range */
+	char *mapping;
+	size_t mappingSize;
+	/* Points to the byte at rangeBegin in the mapping */
+	char *mappedRange;
+	long pageSize;
+	/*
+	 * If following, the end of the file is not the end of the trace, we
+	 * wait for more data until stopFollowing() is called.
+	 */
+	bool following;
+	std::atomic<bool> stopped;
+	/* The file position where the loading ended */
+	int64_t loadEnd;
+	/* The file position up to which buffers have been loaded so far */
+	std::atomic<int64_t> loadPos;
 };
 
 #endif /* LOADTHREAD */
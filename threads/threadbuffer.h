@@ -53,12 +53,12 @@
 #ifndef THREADBUFFER_H
 #define THREADBUFFER_H
 
+#include <atomic>
 #include <cstdint>
 
-#include <QMutex>
-#include <QWaitCondition>
 #include "misc/tstring.h"
 #include "mm/mempool.h"
+#include "threads/eventcount.h"
 #include "threads/loadbuffer.h"
 #include "vtl/compiler.h"
 #include "vtl/tlist.h"
@@ -88,49 +88,31 @@ private:
 	vtl_always_inline void completeProduction();
 	vtl_always_inline void waitForConsumptionComplete();
 	vtl_always_inline void completeConsumption();
-	bool isEmpty;
-	QMutex mutex;
-	QWaitCondition consumptionComplete;
-	QWaitCondition productionComplete;
+	std::atomic<bool> isEmpty;
+	EventCount emptyChanged;
 };
 
 template<class T>
 vtl_always_inline void ThreadBuffer<T>::waitForProductionComplete() {
-	mutex.lock();
-	while(isEmpty) {
-		/*
-		 * Note that this implicitely unlocks the mutex while waiting
-		 * and relocks it when done waiting.
-		 */
-		productionComplete.wait(&mutex);
-	}
+	emptyChanged.waitForValue(isEmpty, false);
 }
 
 template<class T>
 vtl_always_inline void ThreadBuffer<T>::completeProduction() {
-	isEmpty = false;
-	productionComplete.wakeOne();
-	mutex.unlock();
+	isEmpty.store(false, std::memory_order_release);
+	emptyChanged.notify();
 }
 
 template<class T>
 vtl_always_inline void ThreadBuffer<T>::waitForConsumptionComplete() {
-	mutex.lock();
-	while(!isEmpty) {
-		/*
-		 * Note that this implicitely unlocks the mutex while waiting
-		 * and relocks it when done waiting.
-		 */
-		consumptionComplete.wait(&mutex);
-	}
+	emptyChanged.waitForValue(isEmpty, true);
 }
 
 template<class T>
 vtl_always_inline void ThreadBuffer<T>::completeConsumption() {
-	isEmpty = true;
 	list.softclear();
-	consumptionComplete.wakeOne();
-	mutex.unlock();
+	isEmpty.store(true, std::memory_order_release);
+	emptyChanged.notify();
 }
 
 template<class T>ThreadBuffer<T>::ThreadBuffer():
@@ -315,6 +315,13 @@
 # always have the scheduling graphs drawn with a width of 1.
 # DISABLE_OPENGL = yes
 
+# Uncomment these to disable the support for opening compressed trace files.
+# The gzip support needs zlib, the zstd support needs libzstd and the xz
+# support needs liblzma, which is a part of the xz utils.
+# DISABLE_GZIP = yes
+# DISABLE_ZSTD = yes
+# DISABLE_XZ = yes
+
 # Uncomment this to use the libqcustomplot of your system. At the time of
 # writing, this is a bad idea. Only do this if you know exactly what you are
 # doing. traceshark has its own QCustomPlot, which contains important
@@ -435,31 +442,53 @@ HEADERS      +=  analyzer/cpufreq.h
 HEADERS      +=  analyzer/cpu.h
 HEADERS      +=  analyzer/cpuidle.h
 HEADERS      +=  analyzer/cputask.h
+HEADERS      +=  analyzer/eventcolumns.h
 HEADERS      +=  analyzer/filterstate.h
 HEADERS      +=  analyzer/latency.h
 HEADERS      +=  analyzer/latencycomp.h
 HEADERS      +=  analyzer/migration.h
 HEADERS      +=  analyzer/regexfilter.h
+HEADERS      +=  analyzer/schedargs.h
 HEADERS      +=  analyzer/task.h
 HEADERS      +=  analyzer/tcolor.h
 HEADERS      +=  analyzer/traceanalyzer.h
 
+HEADERS      +=  parser/argcache.h
+HEADERS      +=  parser/chunkparser.h
+HEADERS      +=  parser/eventcache.h
+HEADERS      +=  parser/eventstrings.h
 HEADERS      +=  parser/fileinfo.h
 HEADERS      +=  parser/genericparams.h
 HEADERS      +=  parser/paramhelpers.h
+HEADERS      +=  parser/retentionpolicy.h
+HEADERS      +=  parser/timewindow.h
+HEADERS      +=  parser/tokenizer.h
 HEADERS      +=  parser/traceevent.h
 HEADERS      +=  parser/tracefile.h
 HEADERS      +=  parser/tracelinedata.h
 HEADERS      +=  parser/traceline.h
 HEADERS      +=  parser/traceparser.h
+HEADERS      +=  parser/tracesniffer.h
+
+HEADERS      +=  parser/compress/compressedfile.h
+HEADERS      +=  parser/compress/decompressor.h
+HEADERS      +=  parser/compress/gzipdecompressor.h
+HEADERS      +=  parser/compress/xzdecompressor.h
+HEADERS      +=  parser/compress/zstddecompressor.h
 
 HEADERS      +=  parser/ftrace/ftraceparams.h
 HEADERS      +=  parser/ftrace/ftracegrammar.h
 
 HEADERS      +=  parser/perf/helpers.h
+HEADERS      +=  parser/perf/perfdatareader.h
 HEADERS      +=  parser/perf/perfparams.h
 HEADERS      +=  parser/perf/perfgrammar.h
 
+HEADERS      +=  parser/tracecmd/eventformat.h
+HEADERS      +=  parser/tracecmd/tracedatreader.h
+HEADERS      +=  parser/tracecmd/tracingdata.h
+
+HEADERS      +=  threads/eventcount.h
 HEADERS      +=  threads/indexwatcher.h
 HEADERS      +=  threads/loadbuffer.h
 HEADERS      +=  threads/loadthread.h
@@ -470,11 +499,14 @@ HEADERS      +=  threads/workqueue.h
 HEADERS      +=  threads/workthread.h
 
 HEADERS      +=  mm/mempool.h
+HEADERS      +=  mm/internpool.h
 HEADERS      +=  mm/stringpool.h
 HEADERS      +=  mm/stringtree.h
+HEADERS      +=  mm/stringtable.h
 
 HEADERS      +=  misc/chunk.h
 HEADERS      +=  misc/errors.h
+HEADERS      +=  misc/eventhash.h
 HEADERS      +=  misc/maplist.h
 HEADERS      +=  misc/osapi.h
 HEADERS      +=  misc/pngresources.h
@@ -546,6 +578,7 @@ SOURCES      +=  analyzer/abstracttask.cpp
 SOURCES      +=  analyzer/cpufreq.cpp
 SOURCES      +=  analyzer/cpuidle.cpp
 SOURCES      +=  analyzer/cputask.cpp
+SOURCES      +=  analyzer/eventcolumns.cpp
 SOURCES      +=  analyzer/filterstate.cpp
 SOURCES      +=  analyzer/latencycomp.cpp
 SOURCES      +=  analyzer/regexfilter.cpp
@@ -553,17 +586,37 @@ SOURCES      +=  analyzer/task.cpp
 SOURCES      +=  analyzer/tcolor.cpp
 SOURCES      +=  analyzer/traceanalyzer.cpp
 
+SOURCES      +=  parser/argcache.cpp
+SOURCES      +=  parser/chunkparser.cpp
+SOURCES      +=  parser/eventcache.cpp
+SOURCES      +=  parser/eventstrings.cpp
 SOURCES      +=  parser/fileinfo.cpp
+SOURCES      +=  parser/retentionpolicy.cpp
+SOURCES      +=  parser/timewindow.cpp
+SOURCES      +=  parser/tokenizer.cpp
 SOURCES      +=  parser/traceevent.cpp
 SOURCES      +=  parser/tracefile.cpp
 SOURCES      +=  parser/traceparser.cpp
+SOURCES      +=  parser/tracesniffer.cpp
+
+SOURCES      +=  parser/compress/compressedfile.cpp
+SOURCES      +=  parser/compress/decompressor.cpp
+SOURCES      +=  parser/compress/gzipdecompressor.cpp
+SOURCES      +=  parser/compress/xzdecompressor.cpp
+SOURCES      +=  parser/compress/zstddecompressor.cpp
 
 SOURCES      +=  parser/ftrace/ftraceparams.cpp
 SOURCES      +=  parser/ftrace/ftracegrammar.cpp
 
+SOURCES      +=  parser/perf/perfdatareader.cpp
 SOURCES      +=  parser/perf/perfparams.cpp
 SOURCES      +=  parser/perf/perfgrammar.cpp
 
+SOURCES      +=  parser/tracecmd/eventformat.cpp
+SOURCES      +=  parser/tracecmd/tracedatreader.cpp
+SOURCES      +=  parser/tracecmd/tracingdata.cpp
+
+SOURCES      +=  threads/eventcount.cpp
 SOURCES      +=  threads/indexwatcher.cpp
 SOURCES      +=  threads/loadbuffer.cpp
 SOURCES      +=  threads/loadthread.cpp
@@ -584,6 +637,7 @@ SOURCES      +=  misc/translate.cpp
 
 SOURCES      +=  vtl/bitvector.cpp
 SOURCES      +=  vtl/error.cpp
+SOURCES      +=  vtl/time.cpp
 
 ###############################################################################
 # Directories
@@ -676,6 +730,21 @@ DEFINES += QCUSTOMPLOT_USE_OPENGL
 }
 }
 
+!equals(DISABLE_GZIP, yes) {
+DEFINES += CONFIG_GZIP
+LIBS += -lz
+}
+
+!equals(DISABLE_ZSTD, yes) {
+DEFINES += CONFIG_ZSTD
+LIBS += -lzstd
+}
+
+!equals(DISABLE_XZ, yes) {
+DEFINES += CONFIG_XZ
+LIBS += -llzma
+}
+
 ###############################################################################
 # Qt Modules
 #
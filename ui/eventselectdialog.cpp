@@ -118,6 +118,11 @@ void EventSelectDialog::setStringTree(const StringTree<> *stree)
 	eventModel->setStringTree(stree);
 }
 
+void EventSelectDialog::setDroppedCounts(const QVector<quint64> &counts)
+{
+	eventModel->setDroppedCounts(counts);
+}
+
 void EventSelectDialog::beginResetModel()
 {
 	eventModel->beginResetModel();
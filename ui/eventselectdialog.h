@@ -56,6 +56,7 @@
 
 #include <QDialog>
 #include <QString>
+#include <QVector>
 
 #include "analyzer/task.h"
 #include "parser/traceevent.h"
@@ -74,6 +75,7 @@ public:
 	EventSelectDialog(QWidget *parent = 0);
 	~EventSelectDialog();
 	void setStringTree(const StringTree<> *stree);
+	void setDroppedCounts(const QVector<quint64> &counts);
 	void beginResetModel();
 	void endResetModel();
 	void resizeColumnsToContents();
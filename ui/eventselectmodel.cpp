@@ -99,6 +99,23 @@ void EventSelectModel::setStringTree(const StringTree<> *stree)
 		});
 }
 
+/*
+ * The number of events of each type that were dropped by the retention policy
+ * when the trace was loaded. They are shown in a second column.
+ */
+void EventSelectModel::setDroppedCounts(const QVector<quint64> &counts)
+{
+	int i;
+
+	droppedCounts.clear();
+	for (i = 0; i < counts.size(); i++) {
+		if (counts[i] != 0) {
+			droppedCounts = counts;
+			break;
+		}
+	}
+}
+
 int EventSelectModel::rowCount(const QModelIndex & /* index */) const
 {
 	return eventList->size();
@@ -106,7 +123,8 @@ int EventSelectModel::rowCount(const QModelIndex & /* index */) const
 
 int EventSelectModel::columnCount(const QModelIndex & /* index */) const
 {
-	return 1; /* Number from data() and headerData() */
+	/* Number from data() and headerData() */
+	return droppedCounts.isEmpty() ? 1 : 2;
 }
 
 event_t EventSelectModel::rowToEvent(int row, bool &ok) const
@@ -167,6 +185,12 @@ QVariant EventSelectModel::data(const QModelIndex &index, int role) const
 			name = rowToName(row, ok);
 			if (ok)
 				return name;
+		} else if (column == 1) {
+			event_t event = rowToEvent(row, ok);
+			if (ok && event < droppedCounts.size() &&
+			    droppedCounts[event] != 0)
+				return QString::number(droppedCounts[event]);
+			return QString();
 		}
 	}
 	return QVariant();
@@ -185,6 +209,8 @@ QVariant EventSelectModel::headerData(int section,
 	if (role == Qt::DisplayRole && orientation == Qt::Horizontal) {
 		if (section == 0)
 			return QString(tr("Event Name"));
+		if (section == 1)
+			return QString(tr("Dropped"));
 		return *errorStr;
 	}
 	return QVariant();
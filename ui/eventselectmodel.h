@@ -54,6 +54,7 @@
 #define EVENTSELECTMODEL_H
 
 #include <QAbstractTableModel>
+#include <QVector>
 #include "parser/traceevent.h"
 
 namespace vtl {
@@ -76,6 +77,7 @@ public:
 	EventSelectModel(QObject *parent = 0);
 	~EventSelectModel();
 	void setStringTree(const StringTree<> *stree);
+	void setDroppedCounts(const QVector<quint64> &counts);
 	int rowCount(const QModelIndex &parent) const;
 	int columnCount(const QModelIndex &parent) const;
 	QVariant data(const QModelIndex &index, int role) const;
@@ -91,6 +93,8 @@ public:
 private:
 	vtl::TList<event_t> *eventList;
 	const StringTree<> *stringTree;
+	/* Indexed by event_t, empty if no events were dropped */
+	QVector<quint64> droppedCounts;
 	QString *errorStr;
 };
 
@@ -53,6 +53,7 @@
 #include <QVariant>
 #include <QString>
 #include "ui/eventsmodel.h"
+#include "parser/argcache.h"
 #include "parser/traceevent.h"
 #include "misc/traceshark.h"
 #include "vtl/tlist.h"
@@ -60,11 +61,20 @@
 
 EventsModel::EventsModel(QObject *parent):
 	QAbstractTableModel(parent), events(nullptr), eventsPtrs(nullptr)
-{}
+{
+	argCache = new ArgCache();
+}
 
 EventsModel::EventsModel(vtl::TList<TraceEvent> *e, QObject *parent):
 	QAbstractTableModel(parent), events(e), eventsPtrs(nullptr)
-{}
+{
+	argCache = new ArgCache();
+}
+
+EventsModel::~EventsModel()
+{
+	delete argCache;
+}
 
 void EventsModel::setEvents(vtl::TList<TraceEvent> *e)
 {
@@ -78,10 +88,16 @@ void EventsModel::setEvents(vtl::TList<const TraceEvent*> *e)
 	eventsPtrs = e;
 }
 
+void EventsModel::setTraceFile(TraceFile *file)
+{
+	argCache->setTraceFile(file);
+}
+
 void EventsModel::clear()
 {
 	events = nullptr;
 	eventsPtrs = nullptr;
+	argCache->setTraceFile(nullptr);
 }
 
 int EventsModel::rowCount(const QModelIndex & /* parent */) const
@@ -97,6 +113,8 @@ int EventsModel::columnCount(const QModelIndex & /* parent */) const
 QVariant EventsModel::data(const QModelIndex &index, int role) const
 {
 	QString str;
+	ArgCache::Args argv;
+	int argc;
 	int i;
 
 	if (!index.isValid())
@@ -120,7 +138,7 @@ QVariant EventsModel::data(const QModelIndex &index, int role) const
 		case COLUMN_TIME:
 			return event.time.toQString();
 		case COLUMN_TASKNAME:
-			return QString(event.taskName->ptr);
+			return QString(event.getTaskName()->ptr);
 		case COLUMN_PID:
 			return QString::number(event.pid);
 		case COLUMN_CPU:
@@ -134,14 +152,15 @@ QVariant EventsModel::data(const QModelIndex &index, int role) const
 			 * we will display that as if it had been the first 
 			 * argument of the event
 			 */
+			argv = argCache->getArgs(event, argc);
 			if (event.intArg != 0) {
 				str += QString::number(event.intArg);
-				if (event.argc > 0)
+				if (argc > 0)
 					str += QString(tr(" "));
 			}
-			for (i = 0; i < event.argc; i++) {
-				str += QString(event.argv[i]->ptr);
-				if (i < event.argc - 1)
+			for (i = 0; i < argc; i++) {
+				str += QString(argv[i]->ptr);
+				if (i < argc - 1)
 					str += QString(tr(" "));
 			}
 			return str;
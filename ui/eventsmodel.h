@@ -56,7 +56,9 @@
 #include <QAbstractTableModel>
 #include "vtl/compiler.h"
 
+class ArgCache;
 class TraceEvent;
+class TraceFile;
 namespace vtl {
 	template<class T> class TList;
 }
@@ -76,8 +78,10 @@ public:
 	} column_t;
 	EventsModel(QObject *parent = 0);
 	EventsModel(vtl::TList<TraceEvent> *e, QObject *parent = 0);
+	~EventsModel();
 	void setEvents(vtl::TList<TraceEvent> *e);
 	void setEvents(vtl::TList<const TraceEvent*> *e);
+	void setTraceFile(TraceFile *file);
 	void clear();
 	int rowCount(const QModelIndex &parent) const;
 	int columnCount(const QModelIndex &parent) const;
@@ -94,6 +98,8 @@ public:
 private:
 	vtl::TList<TraceEvent> *events;
 	vtl::TList<const TraceEvent*> *eventsPtrs;
+	/* For the arguments that need to be read from the trace file */
+	ArgCache *argCache;
 	const TraceEvent* getEventAt(int index) const;
 	int getSize() const;
 };
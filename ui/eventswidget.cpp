@@ -116,6 +116,11 @@ void EventsWidget::setEvents(vtl::TList<const TraceEvent*> *e)
 	eventsPtrs = e;
 }
 
+void EventsWidget::setTraceFile(TraceFile *file)
+{
+	eventsModel->setTraceFile(file);
+}
+
 void EventsWidget::clear()
 {
 	eventsModel->clear();
@@ -61,6 +61,7 @@
 class TableView;
 class EventsModel;
 class TraceEvent;
+class TraceFile;
 namespace vtl {
 	template<class T> class TList;
 }
@@ -74,6 +75,7 @@ public:
 	virtual ~EventsWidget();
 	void setEvents(vtl::TList<TraceEvent> *e);
 	void setEvents(vtl::TList<const TraceEvent*> *e);
+	void setTraceFile(TraceFile *file);
 	void clear();
 	void clearScrollTime();
 	void beginResetModel();
@@ -233,8 +233,13 @@ void GraphEnableDialog::applyClicked()
 		Setting::Value uivalue = vbox->value();
 		const Setting::Value &setvalue = settingStore->getValue(idxn);
 		if (uivalue != setvalue) {
+			/*
+			 * The load settings take effect the next time that a
+			 * file is opened, so there is nothing to redraw.
+			 */
 			if (!Setting::isSizeSetting(idxn) &&
-			    !Setting::isFilterSetting(idxn))
+			    !Setting::isFilterSetting(idxn) &&
+			    !Setting::isLoadSetting(idxn))
 				changed = true;
 			if (Setting::isFilterSetting(idxn))
 				filter_changed = true;
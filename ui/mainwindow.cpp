@@ -57,8 +57,12 @@
 #include <QApplication>
 #include <QColorDialog>
 #include <QDateTime>
+#include <QEventLoop>
+#include <QInputDialog>
 #include <QList>
+#include <QProgressDialog>
 #include <QScrollBar>
+#include <QTimer>
 #include <QVBoxLayout>
 #include <QToolBar>
 
@@ -100,6 +104,15 @@
 #define TOOLTIP_OPEN			\
 "Open a new trace file"
 
+#define TOOLTIP_RETENTION		\
+"Select the events that are kept when a trace file is opened"
+
+#define TOOLTIP_TIMEWINDOW		\
+"Select the time interval that is loaded when a trace file is opened"
+
+#define TOOLTIP_STOPFOLLOW		\
+"Stop following the growing trace file and keep what has been loaded"
+
 #define TOOLTIP_CLOSE			\
 "Close the currently open tracefile"
 
@@ -270,6 +283,10 @@ const QString MainWindow::CSV_FILTER = QString("CSV (*.csv)");
 const QString MainWindow::ASC_FILTER = QString("ASCII Text (*.asc)");
 const QString MainWindow::TXT_FILTER = QString("ASCII Text (*.txt)");
 const QString MainWindow::ASCTXT_FILTER = QString("ASCII Text (*.asc *.txt)");
+const QString MainWindow::DAT_FILTER = QString("trace-cmd (*.dat)");
+const QString MainWindow::PERFDATA_FILTER = QString("perf (*.data)");
+const QString MainWindow::COMPRESSED_FILTER =
+	QString("Compressed (*.gz *.zst *.xz)");
 
 const double MainWindow::RUNNING_SIZE = 8;
 const double MainWindow::PREEMPTED_SIZE = 8;
@@ -291,7 +308,7 @@ const QColor MainWindow::UNINT_COLOR = QColor(205, 0, 205);
 
 MainWindow::MainWindow():
 	tracePlot(nullptr), scrollBarUpdate(false), graphEnableDialog(nullptr),
-	filterActive(false), foptions(QtCompat::ts_foptions)
+	filterActive(false), foptions(QtCompat::ts_foptions), processing(false)
 {
 	stateFile = new StateFile();
 
@@ -341,6 +358,10 @@ MainWindow::MainWindow():
 	createDialogs();
 	widgetConnections();
 	dialogConnections();
+
+	followTimer = new QTimer(this);
+	followTimer->setInterval(FOLLOW_REFRESH_INTERVAL_MS);
+	tsconnect(followTimer, timeout(), this, followTrace());
 }
 
 void MainWindow::createTracePlot()
@@ -453,6 +474,15 @@ void MainWindow::closeEvent(QCloseEvent *event)
 	int ht;
 	int ts_errno;
 
+	/*
+	 * The analyzer must not be closed while its thread is processing the
+	 * trace, the loading can be canceled from the progress dialog.
+	 */
+	if (processing) {
+		event->ignore();
+		return;
+	}
+
 	/* Here is a great place to save settings, if we ever want to do it */
 	taskSelectDialog->hide();
 	eventSelectDialog->hide();
@@ -475,26 +505,79 @@ void MainWindow::closeEvent(QCloseEvent *event)
 	/* event->ignore() could be used to refuse to close the window */
 }
 
+/* If several files are selected, then they are merged into one trace */
 void MainWindow::openTrace()
 {
-	QString name;
-	QString caption = tr("Open a trace file");
-
-	name = QFileDialog::getOpenFileName(this, caption, QString(),
-					    ASCTXT_FILTER, nullptr,
-					    foptions);
-	if (!name.isEmpty()) {
-		openFile(name);
+	QStringList names;
+	QString caption = tr("Open one or more trace files");
+
+	names = QFileDialog::getOpenFileNames(this, caption, QString(),
+					      ASCTXT_FILTER + F_SEP +
+					      DAT_FILTER + F_SEP +
+					      PERFDATA_FILTER + F_SEP +
+					      COMPRESSED_FILTER,
+					      nullptr, foptions);
+	if (!names.isEmpty()) {
+		openFile(names);
 	}
 }
 
-void MainWindow::openFile(const QString &name)
+void MainWindow::showRetentionPolicy()
 {
+	QString spec;
+	bool ok;
+	int ts_errno;
+
+	spec = QInputDialog::getText(this, tr("Event retention policy"),
+				     tr("Events to keep or -drop, separated by "
+					"commas, e.g. -*,sched_*,cpu_*"),
+				     QLineEdit::Normal,
+				     analyzer->getRetentionPolicy(), &ok);
+	if (!ok)
+		return;
+	ts_errno = setRetentionPolicy(spec);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to set the event retention policy");
+}
+
+/* The policy takes effect when the next trace file is opened */
+int MainWindow::setRetentionPolicy(const QString &spec)
+{
+	return analyzer->setRetentionPolicy(spec);
+}
+
+void MainWindow::showTimeWindow()
+{
+	QString spec;
+	bool ok;
+	int ts_errno;
+
+	spec = QInputDialog::getText(this, tr("Time window"),
+				     tr("The start and end time in seconds, "
+					"either may be empty, e.g. 1000.5,1002.5"),
+				     QLineEdit::Normal,
+				     analyzer->getTimeWindow(), &ok);
+	if (!ok)
+		return;
+	ts_errno = setTimeWindow(spec);
+	if (ts_errno != 0)
+		vtl::warn(ts_errno, "Failed to set the time window");
+}
+
+/* The window takes effect when the next trace file is opened */
+int MainWindow::setTimeWindow(const QString &spec)
+{
+	return analyzer->setTimeWindow(spec);
+}
+
+void MainWindow::openFile(const QStringList &names)
+{
+	QString name = names.join(QLatin1String(", "));
 	int ts_errno;
 
 	if (analyzer->isOpen())
 		closeTrace();
-	ts_errno = loadTraceFile(name);
+	ts_errno = loadTraceFile(names);
 
 	if (ts_errno != 0) {
 		vtl::warn(ts_errno, "Failed to open trace file %s",
@@ -511,7 +594,11 @@ void MainWindow::openFile(const QString &name)
 
 		start = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
 
-		processTrace();
+		if (!processTrace()) {
+			/* The user has canceled the loading */
+			closeTrace();
+			return;
+		}
 		process = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
 
 		computeLayout();
@@ -519,6 +606,7 @@ void MainWindow::openFile(const QString &name)
 
 		eventsWidget->beginResetModel();
 		eventsWidget->setEvents(analyzer->events);
+		eventsWidget->setTraceFile(analyzer->getTraceFile());
 		if (analyzer->events->size() > 0)
 			setEventActionsEnabled(true);
 		setEventActionsEnabled(true);
@@ -531,6 +619,8 @@ void MainWindow::openFile(const QString &name)
 
 		eventSelectDialog->beginResetModel();
 		eventSelectDialog->setStringTree(TraceEvent::getStringTree());
+		eventSelectDialog->setDroppedCounts(analyzer->
+						    getDroppedCounts());
 		eventSelectDialog->endResetModel();
 
 		cpuSelectDialog->beginResetModel();
@@ -545,7 +635,7 @@ void MainWindow::openFile(const QString &name)
 		rescaleTrace();
 		rescale = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
 
-		computeStats();
+		/* The statistics were computed by processTrace() */
 		statsDialog->beginResetModel();
 		statsDialog->setTaskMap(&analyzer->taskMap,
 					analyzer->getNrCPUs());
@@ -584,10 +674,15 @@ void MainWindow::openFile(const QString &name)
 		fflush(stdout);
 		tracePlot->legend->setVisible(true);
 		setCloseActionsEnabled(true);
-		if (analyzer->events->size() <= 0)
-			vtl::warnx("You have opened an empty trace!");
-		else
+		if (analyzer->isFollowing()) {
+			followFileName = names[0];
+			stopFollowAction->setEnabled(true);
+			followTimer->start();
+		}
+		if (analyzer->events->size() > 0)
 			setTraceActionsEnabled(true);
+		else if (!analyzer->isFollowing())
+			vtl::warnx("You have opened an empty trace!");
 	} else {
 		setStatus(STATUS_ERROR);
 		vtl::warnx("Unknown error when opening trace!");
@@ -610,16 +705,94 @@ void MainWindow::resizeEvent(QResizeEvent */*event*/)
 	}
 }
 
-void MainWindow::processTrace()
+/*
+ * The trace is processed by a thread of the analyzer, meanwhile the progress is
+ * shown and the user may cancel the loading. Returns false if it was canceled.
+ * The user input is not processed until the modal progress dialog is shown,
+ * so that the analyzer cannot be closed or reopened while it is processing.
+ */
+bool MainWindow::processTrace()
 {
 	const QMap<int, QColor> &cmap = stateFile->getColorMap();
+	QProgressDialog progress(this);
+	qint64 start, now;
 	bool usercolors;
 
-	usercolors = analyzer->processTrace(cmap);
+	progress.setWindowTitle(tr("Loading trace"));
+	progress.setWindowModality(Qt::ApplicationModal);
+	progress.setMinimumDuration(PROGRESS_MIN_DURATION_MS);
+	progress.setAutoClose(false);
+	progress.setAutoReset(false);
+	progress.setRange(0, PROGRESS_STEPS);
+	progress.setValue(0);
+
+	processing = true;
+	setOpenActionsEnabled(false);
+	setCloseActionsEnabled(false);
+
+	start = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
+	analyzer->startProcessing();
+	while (!analyzer->waitForProcessing(PROGRESS_INTERVAL_MS)) {
+		if (progress.wasCanceled() && !analyzer->isCanceled())
+			analyzer->cancelProcessing();
+		now = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
+		updateProgress(&progress, now - start);
+		if (progress.isVisible())
+			QCoreApplication::processEvents();
+		else
+			QCoreApplication::processEvents(
+				QEventLoop::ExcludeUserInputEvents);
+	}
+
+	usercolors = analyzer->finishProcessing(cmap);
+	setOpenActionsEnabled(true);
+	processing = false;
+	if (analyzer->isCanceled())
+		return false;
 	startTime = analyzer->getStartTime().toDouble();
 	endTime = analyzer->getEndTime().toDouble();
 	if (usercolors)
 		setResetTaskColorEnabled(true);
+	return true;
+}
+
+/*
+ * Shows how much of the trace has been loaded and processed, the rates and the
+ * remaining time. The number of bytes is unknown when the trace is not loaded
+ * by the sequential pipeline, then only the number of events is shown.
+ */
+void MainWindow::updateProgress(QProgressDialog *progress, qint64 elapsed)
+{
+	const double mb = 1024 * 1024;
+	double secs = (double) TSMAX(elapsed, 1) / 1000;
+	int nrEvents = analyzer->getNrProcessedEvents();
+	int64_t loaded, total;
+	double bytesPerSec;
+	QString text;
+
+	if (analyzer->isCanceled()) {
+		progress->setLabelText(tr("Canceling..."));
+		return;
+	}
+
+	if (analyzer->getLoadProgress(&loaded, &total)) {
+		bytesPerSec = loaded / secs;
+		text = tr("Loaded %1 of %2 MB, %3 MB/s\n")
+			.arg(loaded / mb, 0, 'f', 1)
+			.arg(total / mb, 0, 'f', 1)
+			.arg(bytesPerSec / mb, 0, 'f', 1);
+		if (bytesPerSec > 0 && loaded < total)
+			text += tr("Time left: %1 s\n")
+				.arg((total - loaded) / bytesPerSec, 0, 'f', 0);
+		progress->setValue((int) (PROGRESS_STEPS * loaded / total));
+	} else if (progress->maximum() != 0) {
+		/* This shows a busy indicator */
+		progress->setRange(0, 0);
+	}
+	text += tr("Processed %1 events, %2 events/s")
+		.arg(nrEvents)
+		.arg(nrEvents / secs, 0, 'f', 0);
+	progress->setLabelText(text);
 }
 
 void MainWindow::computeLayout()
@@ -1109,6 +1282,16 @@ void MainWindow::setLegendActionsEnabled(bool e)
 	clearLegendAction->setEnabled(e);
 }
 
+/*
+ * These are actions that should be enabled whenever no trace is being processed
+ */
+void MainWindow::setOpenActionsEnabled(bool e)
+{
+	openAction->setEnabled(e);
+	retentionAction->setEnabled(e);
+	timeWindowAction->setEnabled(e);
+}
+
 /*
  * These are action that should be enabled whenever we have a trace open
  */
@@ -1175,6 +1358,9 @@ void MainWindow::closeTrace()
 	quint64 startt, mresett, clearptt, acloset, disablet;
 	int ts_errno = 0;
 
+	followTimer->stop();
+	stopFollowAction->setEnabled(false);
+
 	ts_errno = stateFile->saveState();
 	if (ts_errno != 0)
 		vtl::warn(ts_errno, "Failed to save state file");
@@ -1202,6 +1388,7 @@ void MainWindow::closeTrace()
 
 	eventSelectDialog->beginResetModel();
 	eventSelectDialog->setStringTree(nullptr);
+	eventSelectDialog->setDroppedCounts(QVector<quint64>());
 	eventSelectDialog->endResetModel();
 
 	cpuSelectDialog->beginResetModel();
@@ -1257,6 +1444,130 @@ void MainWindow::closeTrace()
 	}
 }
 
+/*
+ * This is called by followTimer when a growing trace is followed. The events
+ * that have been appended to the file are processed and the plot is redrawn.
+ * If the end of the trace was visible, then the view is moved so that the new
+ * end remains visible.
+ */
+void MainWindow::followTrace()
+{
+	const QMap<int, QColor> &cmap = stateFile->getColorMap();
+	vtl::Time saved = eventsWidget->getSavedScroll();
+	QCPRange range = tracePlot->xAxis->range();
+	double oldStart = startTime;
+	double oldEnd = endTime;
+	bool wasEmpty = analyzer->events->size() <= 0;
+	bool eof = false;
+	int maxEvents;
+	int first;
+	int n;
+
+	n = analyzer->processNewEvents(cmap, eof);
+	if (eof) {
+		followTimer->stop();
+		stopFollowAction->setEnabled(false);
+	}
+	if (n <= 0)
+		return;
+
+	maxEvents = settingStore->getValue(Setting::FOLLOW_MAX_EVENTS).intv() *
+		1000000;
+	if (!eof && analyzer->events->size() > maxEvents) {
+		first = analyzer->events->size() - maxEvents / 2;
+		followWindow(analyzer->events->at(first).time);
+		return;
+	}
+
+	startTime = analyzer->getStartTime().toDouble();
+	endTime = analyzer->getEndTime().toDouble();
+
+	if (wasEmpty) {
+		double red = (startTime + endTime) / 2;
+		double blue = red + (endTime - startTime) / 10;
+		vtl::Time redtime = vtl::Time::fromDouble(red);
+		vtl::Time bluetime = vtl::Time::fromDouble(blue);
+
+		redtime.setPrecision(analyzer->getTimePrecision());
+		bluetime.setPrecision(analyzer->getTimePrecision());
+		moveCursor(redtime, TShark::RED_CURSOR);
+		moveCursor(bluetime, TShark::BLUE_CURSOR);
+		range = QCPRange(startTime, endTime);
+		setTraceActionsEnabled(true);
+	} else if (range.upper >= oldEnd) {
+		if (range.lower <= oldStart)
+			range.upper = endTime;
+		else
+			range += endTime - oldEnd;
+	}
+
+	eventsWidget->beginResetModel();
+	setEventsWidgetEvents();
+	eventsWidget->endResetModel();
+	scrollTo(saved);
+
+	taskSelectDialog->beginResetModel();
+	taskSelectDialog->setTaskMap(&analyzer->taskMap,
+				     analyzer->getNrCPUs());
+	taskSelectDialog->endResetModel();
+
+	eventSelectDialog->beginResetModel();
+	eventSelectDialog->setStringTree(TraceEvent::getStringTree());
+	eventSelectDialog->setDroppedCounts(analyzer->getDroppedCounts());
+	eventSelectDialog->endResetModel();
+
+	cpuSelectDialog->beginResetModel();
+	cpuSelectDialog->setNrCPUs(analyzer->getNrCPUs());
+	cpuSelectDialog->endResetModel();
+
+	computeStats();
+	statsDialog->beginResetModel();
+	statsDialog->setTaskMap(&analyzer->taskMap, analyzer->getNrCPUs());
+	statsDialog->endResetModel();
+
+	statsLimitedDialog->beginResetModel();
+	statsLimitedDialog->setTaskMap(&analyzer->taskMap,
+				       analyzer->getNrCPUs());
+	statsLimitedDialog->endResetModel();
+
+	schedLatencyWidget->setAnalyzer(analyzer);
+	wakeupLatencyWidget->setAnalyzer(analyzer);
+
+	redrawTrace(range);
+}
+
+/*
+ * The events that have been loaded are kept, so that the trace can be examined
+ * without it changing. The timer keeps running until the parser has posted the
+ * last events, after which followTrace() stops it.
+ */
+void MainWindow::stopFollowing()
+{
+	stopFollowAction->setEnabled(false);
+	analyzer->stopFollowing();
+}
+
+/*
+ * Reopens the followed trace so that only the events from start onwards are
+ * loaded. This keeps the memory usage bounded when a trace is followed for a
+ * long time. The time window of the user is restored afterwards, since it is
+ * used when the next trace is opened.
+ */
+void MainWindow::followWindow(const vtl::Time &start)
+{
+	QString savedWindow = analyzer->getTimeWindow();
+	QString name = followFileName;
+	int ts_errno;
+
+	ts_errno = setTimeWindow(start.toQString() + QString(","));
+	if (ts_errno != 0) {
+		vtl::warn(ts_errno, "Failed to set the time window");
+		return;
+	}
+	openFile(QStringList(name));
+	setTimeWindow(savedWindow);
+}
+
 void MainWindow::saveScreenshot()
 {
 	QStringList fileNameList;
@@ -1767,6 +2078,19 @@ void MainWindow::createActions()
 	openAction->setToolTip(tr(TOOLTIP_OPEN));
 	tsconnect(openAction, triggered(), this, openTrace());
 
+	retentionAction = new QAction(tr("Event &retention policy..."), this);
+	retentionAction->setToolTip(tr(TOOLTIP_RETENTION));
+	tsconnect(retentionAction, triggered(), this, showRetentionPolicy());
+
+	timeWindowAction = new QAction(tr("Time &window..."), this);
+	timeWindowAction->setToolTip(tr(TOOLTIP_TIMEWINDOW));
+	tsconnect(timeWindowAction, triggered(), this, showTimeWindow());
+
+	stopFollowAction = new QAction(tr("Stop &following"), this);
+	stopFollowAction->setToolTip(tr(TOOLTIP_STOPFOLLOW));
+	stopFollowAction->setEnabled(false);
+	tsconnect(stopFollowAction, triggered(), this, stopFollowing());
+
 	closeAction = new QAction(tr("&Close"), this);
 	closeAction->setIcon(QIcon(RESSRC_GPH_CLOSE));
 	closeAction->setShortcuts(QKeySequence::Close);
@@ -2080,6 +2404,9 @@ void MainWindow::createMenus()
 {
 	fileMenu = menuBar()->addMenu(tr("&File"));
 	fileMenu->addAction(openAction);
+	fileMenu->addAction(retentionAction);
+	fileMenu->addAction(timeWindowAction);
+	fileMenu->addAction(stopFollowAction);
 	fileMenu->addAction(closeAction);
 	fileMenu->addAction(saveAction);
 	fileMenu->addSeparator();
@@ -2328,21 +2655,23 @@ void MainWindow::setStatus(status_t status, const QString *fileName)
 	statusLabel->setText(string);
 }
 
-int MainWindow::loadTraceFile(const QString &fileName)
+/* The state of a merged trace is kept in the state file of the first file */
+int MainWindow::loadTraceFile(const QStringList &fileNames)
 {
 	qint64 start, stop;
         int rval;
 
-	stateFile->setTraceFile(fileName);
+	stateFile->setTraceFile(fileNames[0]);
 	rval = stateFile->loadState();
 
 	if (rval != 0)
 		vtl::warn(rval, "Failed to load state file");
 
-	printf("opening %s\n", fileName.toLocal8Bit().data());
+	printf("opening %s\n", fileNames.join(QLatin1String(", "))
+	       .toLocal8Bit().data());
 	
 	start = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
-	rval = analyzer->open(fileName);
+	rval = analyzer->open(fileNames);
 	stop = QDateTime::currentDateTimeUtc().toMSecsSinceEpoch();
 
 	stop = stop - start;
@@ -2799,6 +3128,23 @@ void MainWindow::exportLatencies(TraceAnalyzer::exportformat_t format,
 }
 
 void MainWindow::consumeSettings()
+{
+	if (!analyzer->isOpen()) {
+		setupOpenGL();
+		graphEnableDialog->checkConsumption();
+		return;
+	}
+
+	redrawTrace(tracePlot->xAxis->range());
+	graphEnableDialog->checkConsumption();
+}
+
+/*
+ * Recreates all graphs of the plot, while keeping the unified task graphs, the
+ * legends, the cursors and the selected task. The horizontal zoom is set to
+ * rangeX.
+ */
+void MainWindow::redrawTrace(const QCPRange &rangeX)
 {
 	unsigned int cpu;
 	QList<int> taskGraphs;
@@ -2811,12 +3157,6 @@ void MainWindow::consumeSettings()
 	TaskGraph *selected_graph;
 	enum TaskGraph::GraphType graph_type;
 
-	if (!analyzer->isOpen()) {
-		setupOpenGL();
-		graphEnableDialog->checkConsumption();
-		return;
-	}
-
 	/* Save the PIDs of the tasks that have a unified task graph */
 	taskGraphs = taskRangeAllocator->getPidList();
 
@@ -2832,9 +3172,6 @@ void MainWindow::consumeSettings()
 	if (blueCursor != nullptr)
 		bluetime = blueCursor->getTime();
 
-	/* Save the zoom */
-	QCPRange savedRangeX = tracePlot->xAxis->range();
-
 	/* Save wether a task was selected */
 	selected_graph = selectedGraph();
 	if (selected_graph != nullptr) {
@@ -2890,7 +3227,7 @@ void MainWindow::consumeSettings()
 	showTrace();
 	tracePlot->show();
 
-	tracePlot->xAxis->setRange(savedRangeX);
+	tracePlot->xAxis->setRange(rangeX);
 	/* Restore the unified task graphs from the list */
 	QList<int>::const_iterator j;
 	for (j = taskGraphs.begin(); j != taskGraphs.end(); j++)
@@ -2915,7 +3252,6 @@ void MainWindow::consumeSettings()
 		updateAddToLegendAction();
 		updateTaskGraphActions();
 	}
-	graphEnableDialog->checkConsumption();
 }
 
 void MainWindow::consumeFilterSettings()
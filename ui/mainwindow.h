@@ -58,12 +58,14 @@
 #include <QMap>
 #include <QVector>
 #include <QString>
+#include <QStringList>
 #include "analyzer/traceanalyzer.h"
 #include "misc/setting.h"
 #include "misc/traceshark.h"
 #include "parser/traceevent.h"
 #include "threads/workitem.h"
 #include "ui/eventsmodel.h"
+#include "ui/qcustomplot.h"
 
 #ifdef CONFIG_SYSTEM_QCUSTOMPLOT
 	/*
@@ -91,9 +93,11 @@ class QAction;
 class QLabel;
 class QMenu;
 class QPlainTextEdit;
+class QProgressDialog;
 class QMessageBox;
 class QMouseEvent;
 class QScrollBar;
+class QTimer;
 class QToolBar;
 class QVBoxLayhout;
 QT_END_NAMESPACE
@@ -134,14 +138,20 @@ class MainWindow : public QMainWindow
 public:
 	MainWindow();
 	virtual ~MainWindow();
-	void openFile(const QString &name);
+	void openFile(const QStringList &names);
+	int setRetentionPolicy(const QString &spec);
+	int setTimeWindow(const QString &spec);
 	void resizeEvent(QResizeEvent *event);
 protected:
 	void closeEvent(QCloseEvent *event);
 
 private slots:
 	void openTrace();
+	void showRetentionPolicy();
+	void showTimeWindow();
 	void closeTrace();
+	void followTrace();
+	void stopFollowing();
 	void saveScreenshot();
 	void about();
 	void aboutQCustomPlot();
@@ -276,16 +286,19 @@ private:
 	void loadSettings();
 
 	/* Functions for opening and processing a trace*/
-	void processTrace();
+	bool processTrace();
+	void updateProgress(QProgressDialog *progress, qint64 elapsed);
 	void computeLayout();
 	void computeStats();
 	void rescaleTrace();
 	void clearPlot();
 	void showTrace();
+	void redrawTrace(const QCPRange &rangeX);
+	void followWindow(const vtl::Time &start);
 	double adjustScatterSize(double defsize, int linewidth);
 	double maxZoomVSize();
 	double autoZoomVSize();
-	int loadTraceFile(const QString &);
+	int loadTraceFile(const QStringList &);
 	void setStatus(status_t status, const QString *fileName = nullptr);
 
 	/* The rest of the functions */
@@ -318,6 +331,7 @@ private:
 	void resetFilter(FilterState::filter_t filter);
 	void setTraceActionsEnabled(bool e);
 	void setLegendActionsEnabled(bool e);
+	void setOpenActionsEnabled(bool e);
 	void setCloseActionsEnabled(bool e);
 	void setTaskActionsEnabled(bool e);
 	void setWakeupActionsEnabled(bool e);
@@ -370,7 +384,10 @@ private:
 	QString *statusStrings[STATUS_NR];
 
 	QAction *openAction;
+	QAction *retentionAction;
+	QAction *timeWindowAction;
 	QAction *closeAction;
+	QAction *stopFollowAction;
 	QAction *saveAction;
 	QAction *exitAction;
 	QAction *cursorZoomAction;
@@ -470,6 +487,9 @@ private:
 	static const QString ASC_FILTER;
 	static const QString TXT_FILTER;
 	static const QString ASCTXT_FILTER;
+	static const QString DAT_FILTER;
+	static const QString PERFDATA_FILTER;
+	static const QString COMPRESSED_FILTER;
 
 	static const double RUNNING_SIZE;
 	static const double PREEMPTED_SIZE;
@@ -502,6 +522,11 @@ private:
 	QMessageBox *aboutQCPBox;
 	QFileDialog::Options foptions;
 	StateFile *stateFile;
+	/* Processes new events periodically when a trace is followed */
+	QTimer *followTimer;
+	QString followFileName;
+	/* Set while processTrace() waits for the analysis thread */
+	bool processing;
 };
 
 #endif /* MAINWINDOW_H */
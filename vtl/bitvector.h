@@ -67,6 +67,7 @@ public:
 	vtl_always_inline unsigned int read(unsigned int index) const;
 	vtl_always_inline void append(unsigned int value);
 	vtl_always_inline unsigned int size() const;
+	vtl_always_inline void removeLast();
 	void clear();
 	void softclear();
 private:
@@ -145,6 +146,13 @@ vtl_always_inline unsigned int BitVector::size() const
 	return nrElements;
 }
 
+/* The bit will be overwritten by the next append() */
+vtl_always_inline void BitVector::removeLast()
+{
+	if (nrElements > 0)
+		nrElements--;
+}
+
 }
 
 #endif /* _BITVECTOR_H */
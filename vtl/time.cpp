@@ -0,0 +1,165 @@
+// SPDX-License-Identifier: (GPL-2.0-or-later OR BSD-2-Clause)
+/*
+ * Traceshark - a visualizer for visualizing ftrace and perf traces
+ * Copyright (C) 2026  Viktor Rosendahl <viktor.rosendahl@gmail.com>
+ *
+ * This file is dual licensed: you can use it either under the terms of
+ * the GPL, or the BSD license, at your option.
+ *
+ *  a) This program is free software; you can redistribute it and/or
+ *     modify it under the terms of the GNU General Public License as
+ *     published by the Free Software Foundation; either version 2 of the
+ *     License, or (at your option) any later version.
+ *
+ *     This program is distributed in the hope that it will be useful,
+ *     but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *     MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *     GNU General Public License for more details.
+ *
+ *     You should have received a copy of the GNU General Public
+ *     License along with this library; if not, write to the Free
+ *     Software Foundation, Inc., 51 Franklin St, Fifth Floor, Boston,
+ *     MA 02110-1301 USA
+ *
+ * Alternatively,
+ *
+ *  b) Redistribution and use in source and binary forms, with or
+ *     without modification, are permitted provided that the following
+ *     conditions are met:
+ *
+ *     1. Redistributions of source code must retain the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer.
+ *     2. Redistributions in binary form must reproduce the above
+ *        copyright notice, this list of conditions and the following
+ *        disclaimer in the documentation and/or other materials
+ *        provided with the distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND
+ *     CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+ *     INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ *     MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *     DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ *     CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *     SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ *     NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *     HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ *     CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ *     OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE,
+ *     EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "vtl/time.h"
+
+/* Most text traces have microsecond precision */
+unsigned int vtl::CompactTime::tracePrecision = 6;
+
+#ifdef VTL_TIME_SSSE3
+
+#include <immintrin.h>
+
+/*
+ * The 16 bytes that are loaded by fromStringSSSE3_() must not cross this
+ * boundary, because the next page might not be mapped. Every page size is a
+ * multiple of this.
+ */
+#define VTL_TIME_PAGE_ (4096)
+
+namespace vtl {
+
+static const uint32_t powersOf10[] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+	1000000000
+};
+
+/*
+ * This parses strings where the seconds have at most 9 digits and the fraction
+ * has at most 9 digits, such that the whole string, including the character
+ * after it, fits within 16 bytes. For all other strings, false is returned and
+ * fromString() falls back to the scalar parsing. The bytes after the string
+ * are loaded but they do not affect the result.
+ *
+ * The digits are shuffled so that they are right aligned in the vector, without
+ * the decimal point, and then they are combined pairwise with multiply-add
+ * instructions until two numbers of eight digits each remain.
+ */
+__attribute__((target("ssse3")))
+bool Time::fromStringSSSE3_(const char *str, bool &ok, Time &r)
+{
+	const char *c = str;
+	__m128i x, d, k, src, v;
+	unsigned int nondigits;
+	unsigned int n, e, p;
+	uint64_t hi, lo;
+	timeint_t tt;
+	bool negative = false;
+
+	if (*c == '-') {
+		c++;
+		negative = true;
+	}
+
+	if (((uintptr_t) c & (VTL_TIME_PAGE_ - 1)) > VTL_TIME_PAGE_ - 16)
+		return false;
+
+	x = _mm_loadu_si128((const __m128i *) c);
+	d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+	nondigits = ~_mm_movemask_epi8(_mm_cmpeq_epi8(
+		_mm_min_epu8(d, _mm_set1_epi8(9)), d)) & 0xffff;
+
+	/* n is the number of digits of the seconds */
+	if (nondigits == 0)
+		return false;
+	n = __builtin_ctz(nondigits);
+	if (n > 9 || c[n] != '.')
+		return false;
+
+	/* e is the index of the first character after the fraction */
+	nondigits &= nondigits - 1;
+	if (nondigits == 0)
+		return false;
+	e = __builtin_ctz(nondigits);
+	p = e - n - 1;
+	if (p > 9)
+		return false;
+
+	/*
+	 * Byte i of the result is taken from index k = i + e - 17 of the
+	 * string, or from k + 1 if k is at the decimal point or after it. A
+	 * negative index makes the shuffle produce a zero.
+	 */
+	k = _mm_sub_epi8(_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+				       12, 13, 14, 15),
+			 _mm_set1_epi8(17 - e));
+	src = _mm_sub_epi8(k, _mm_cmpgt_epi8(k, _mm_set1_epi8(n - 1)));
+	src = _mm_or_si128(src, _mm_cmpgt_epi8(_mm_setzero_si128(), k));
+	v = _mm_shuffle_epi8(d, src);
+
+	v = _mm_maddubs_epi16(v, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1,
+					       10, 1, 10, 1, 10, 1, 10, 1));
+	v = _mm_madd_epi16(v, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+	v = _mm_packs_epi32(v, v);
+	v = _mm_madd_epi16(v, _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1,
+					     10000, 1));
+	hi = (uint32_t) _mm_cvtsi128_si32(v);
+	lo = (uint32_t) _mm_cvtsi128_si32(_mm_srli_si128(v, 4));
+
+	tt = (timeint_t) ((hi * 100000000 + lo) * powersOf10[9 - p]);
+	r.time = negative ? -tt : tt;
+	r.precision = p;
+	ok = c[e] == ':';
+	return true;
+}
+
+bool Time::selectSSSE3()
+{
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("ssse3");
+}
+
+bool Time::useSSSE3 = Time::selectSSSE3();
+
+}
+
+#endif /* VTL_TIME_SSSE3 */
@@ -92,6 +92,11 @@ namespace vtl {
 #error "A longer long long is required!"
 #endif
 
+#if (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__x86_64__) || defined(__i386__))
+#define VTL_TIME_SSSE3
+#endif
+
 #define VTL_TIME_MAX vtl::Time(VTL_TIME_INT_MAX)
 #define VTL_TIME_MIN vtl::Time(VTL_TIME_INT_MIN)
 #define VTL_TIME_ZERO vtl::Time(0)
@@ -138,6 +143,8 @@ namespace vtl {
 		vtl_always_inline static Time fromDouble(const double &t);
 		vtl_always_inline static Time fromString(const char *str,
 							 bool &ok);
+		vtl_always_inline static Time fromStringScalar(const char *str,
+							       bool &ok);
 		vtl_always_inline static Time fromSpacedString(const char *str,
 							       bool &ok);
 		vtl_always_inline bool isZero();
@@ -147,11 +154,19 @@ namespace vtl {
 		vtl_always_inline Time fabs() const;
 		vtl_always_inline unsigned int getPrecision() const;
 		vtl_always_inline void setPrecision(unsigned int p);
+		vtl_always_inline timeint_t getNanoseconds() const;
+#ifdef VTL_TIME_SSSE3
+		static bool useSSSE3;
+#endif
 	private:
 		vtl_always_inline static Time fromString_(const char *str,
 							  bool &ok,
 							  bool spaced,
 							  bool colonatend);
+#ifdef VTL_TIME_SSSE3
+		static bool fromStringSSSE3_(const char *str, bool &ok, Time &r);
+		static bool selectSSSE3();
+#endif
 		timeint_t time;
 		unsigned int precision : 8;
 	} time_t;
@@ -294,7 +309,24 @@ namespace vtl {
 		return r;
 	}
 
+	/*
+	 * This parses the time field of ftrace and perf lines, which is a
+	 * string like "12345.678901:". On x86, the common strings are parsed
+	 * with SSSE3 if the CPU supports it. fromStringScalar() handles all
+	 * other strings and gives identical results.
+	 */
 	vtl_always_inline Time Time::fromString(const char *str, bool &ok)
+	{
+#ifdef VTL_TIME_SSSE3
+		Time r;
+
+		if (likely(useSSSE3) && likely(fromStringSSSE3_(str, ok, r)))
+			return r;
+#endif
+		return fromString_(str, ok, false, true);
+	}
+
+	vtl_always_inline Time Time::fromStringScalar(const char *str, bool &ok)
 	{
 		return fromString_(str, ok, false, true);
 	}
@@ -462,6 +494,211 @@ namespace vtl {
 		if (p < 10)
 			precision = p;
 	}
+
+	vtl_always_inline Time::timeint_t Time::getNanoseconds() const
+	{
+		return time;
+	}
+
+	/*
+	 * This is the type that is used for the times that are stored in large
+	 * arrays, such as the time of the events and of the latencies. It only
+	 * stores the nanoseconds, so it takes 8 bytes instead of the 16 bytes
+	 * of a Time, and the operators are plain integer operations.
+	 *
+	 * The precision is the same for all times of a trace, it is set with
+	 * setTracePrecision() when the trace has been loaded and is used when a
+	 * CompactTime is converted to a Time or printed.
+	 */
+	class CompactTime final {
+	public:
+		typedef Time::timeint_t timeint_t;
+
+		CompactTime(timeint_t ns = 0):
+			time(ns)
+			{}
+		CompactTime(const Time &t):
+			time(t.getNanoseconds())
+			{}
+		vtl_always_inline operator Time() const;
+		vtl_always_inline CompactTime operator+(const CompactTime &other)
+			const;
+		vtl_always_inline void operator+=(const CompactTime &other);
+		vtl_always_inline CompactTime operator-(const CompactTime &other)
+			const;
+		vtl_always_inline void operator-=(const CompactTime &other);
+		vtl_always_inline bool operator<(const CompactTime &other) const;
+		vtl_always_inline bool operator>(const CompactTime &other) const;
+		vtl_always_inline bool operator<=(const CompactTime &other) const;
+		vtl_always_inline bool operator>=(const CompactTime &other) const;
+		vtl_always_inline bool operator==(const CompactTime &other) const;
+		vtl_always_inline CompactTime operator*(long other) const;
+		vtl_always_inline CompactTime operator*(int other) const;
+		vtl_always_inline int compare(const CompactTime &other) const;
+		vtl_always_inline int rcompare(const CompactTime &other) const;
+		vtl_always_inline bool isZero() const;
+		vtl_always_inline QString toQString() const;
+		vtl_always_inline bool sprint(char *buf) const;
+		vtl_always_inline double toDouble() const;
+		vtl_always_inline CompactTime fabs() const;
+		vtl_always_inline timeint_t getNanoseconds() const;
+		vtl_always_inline static unsigned int getTracePrecision();
+		vtl_always_inline static void setTracePrecision(unsigned int p);
+		vtl_always_inline static unsigned int precisionOf(timeint_t ns);
+	private:
+		timeint_t time;
+		static unsigned int tracePrecision;
+	};
+
+	vtl_always_inline CompactTime::operator Time() const
+	{
+		return Time(time, tracePrecision);
+	}
+
+	vtl_always_inline CompactTime
+	CompactTime::operator+(const CompactTime &other) const
+	{
+		return CompactTime(time + other.time);
+	}
+
+	vtl_always_inline void CompactTime::operator+=(const CompactTime &other)
+	{
+		time += other.time;
+	}
+
+	vtl_always_inline CompactTime
+	CompactTime::operator-(const CompactTime &other) const
+	{
+		return CompactTime(time - other.time);
+	}
+
+	vtl_always_inline void CompactTime::operator-=(const CompactTime &other)
+	{
+		time -= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator<(const CompactTime &other)
+		const
+	{
+		return time < other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator>(const CompactTime &other)
+		const
+	{
+		return time > other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator<=(const CompactTime &other)
+		const
+	{
+		return time <= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator>=(const CompactTime &other)
+		const
+	{
+		return time >= other.time;
+	}
+
+	vtl_always_inline bool CompactTime::operator==(const CompactTime &other)
+		const
+	{
+		return time == other.time;
+	}
+
+	vtl_always_inline CompactTime CompactTime::operator*(long other) const
+	{
+		return CompactTime(time * other);
+	}
+
+	vtl_always_inline CompactTime CompactTime::operator*(int other) const
+	{
+		return CompactTime(time * other);
+	}
+
+	vtl_always_inline int CompactTime::compare(const CompactTime &other)
+		const
+	{
+		timeint_t r = time - other.time;
+
+		if (r < 0)
+			return -1;
+		if (r > 0)
+			return 1;
+		return 0;
+	}
+
+	vtl_always_inline int CompactTime::rcompare(const CompactTime &other)
+		const
+	{
+		timeint_t r = other.time - time;
+
+		if (r < 0)
+			return -1;
+		if (r > 0)
+			return 1;
+		return 0;
+	}
+
+	vtl_always_inline bool CompactTime::isZero() const
+	{
+		return time == 0;
+	}
+
+	vtl_always_inline QString CompactTime::toQString() const
+	{
+		return Time(time, tracePrecision).toQString();
+	}
+
+	vtl_always_inline bool CompactTime::sprint(char *buf) const
+	{
+		return Time(time, tracePrecision).sprint(buf);
+	}
+
+	vtl_always_inline double CompactTime::toDouble() const
+	{
+		return ((double) time) / NSECS_PER_SEC;
+	}
+
+	vtl_always_inline CompactTime CompactTime::fabs() const
+	{
+		return CompactTime(time < 0 ? -time : time);
+	}
+
+	vtl_always_inline CompactTime::timeint_t CompactTime::getNanoseconds()
+		const
+	{
+		return time;
+	}
+
+	vtl_always_inline unsigned int CompactTime::getTracePrecision()
+	{
+		return tracePrecision;
+	}
+
+	vtl_always_inline void CompactTime::setTracePrecision(unsigned int p)
+	{
+		if (p < 10)
+			tracePrecision = p;
+	}
+
+	/*
+	 * Returns the number of decimals that are needed in order to print ns
+	 * as seconds without trailing zeros.
+	 */
+	vtl_always_inline unsigned int CompactTime::precisionOf(timeint_t ns)
+	{
+		unsigned int p = 9;
+
+		if (ns < 0)
+			ns = -ns;
+		while (p > 0 && ns % 10 == 0) {
+			ns /= 10;
+			p--;
+		}
+		return p;
+	}
 }
 
 #endif /* VTL_TIME_H */
@@ -113,6 +113,8 @@ public:
 	vtl_always_inline int size() const;
 	void clear();
 	void softclear();
+	vtl_always_inline void truncate(int size);
+	void share(const TList<T> &other, int size);
 	vtl_always_inline T& operator[](int index);
 	vtl_always_inline const T& operator[](int index) const;
 	vtl_always_inline void swap(TList<T> &other);
@@ -129,11 +131,13 @@ private:
 	int nrMaps;
 	int nrElements;
 	T **mapArray;
+	/* True if mapArray belongs to another list, see share() */
+	bool shared;
 };
 
 template<class T>
 TList<T>::TList():
-nrMaps(0), nrElements(0)
+nrMaps(0), nrElements(0), shared(false)
 {
 	setupMem();
 }
@@ -198,6 +202,13 @@ void TList<T>::clearAll()
 	int i;
 	int r;
 
+	if (shared) {
+		mapArray = nullptr;
+		nrMaps = 0;
+		nrElements = 0;
+		shared = false;
+		return;
+	}
 	for (i = 0; i < nrMaps; i++) {
 		r = munmap(mapArray[i], TLIST_MAP_NR_ELEMENTS * sizeof(T));
 		if (unlikely(r != 0))
@@ -295,20 +306,48 @@ void TList<T>::softclear()
 	nrElements = 0;
 }
 
+/* Drops the elements from index size onwards, no memory is released */
+template<class T>
+vtl_always_inline void TList<T>::truncate(int size)
+{
+	if (size < nrElements)
+		nrElements = size;
+}
+
+/*
+ * Makes this list contain the first size elements of other, without copying
+ * them. This works because the elements of a TList are never moved. Other may
+ * continue to append elements while this is used, but this must not be
+ * modified, except that it may be shared again, with a different size, or
+ * cleared. Other must not be cleared or destroyed while this is used.
+ */
+template<class T>
+void TList<T>::share(const TList<T> &other, int size)
+{
+	clearAll();
+	mapArray = other.mapArray;
+	nrMaps = other.nrMaps;
+	nrElements = size;
+	shared = true;
+}
+
 template<class T>
 vtl_always_inline void TList<T>::swap(TList<T> &other)
 {
 	int tmp_nrMaps = other.nrMaps;
 	int tmp_nrElements = other.nrElements;
 	T **tmp_mapArray = other.mapArray;
+	bool tmp_shared = other.shared;
 
 	other.nrMaps = nrMaps;
 	other.nrElements = nrElements;
 	other.mapArray = mapArray;
+	other.shared = shared;
 
 	nrMaps = tmp_nrMaps;
 	nrElements = tmp_nrElements;
 	mapArray = tmp_mapArray;
+	shared = tmp_shared;
 }
 
 template<class T>